@@ -7,8 +7,9 @@
 #define DEBUG_H
 
 #include <Arduino.h>
+#include "log_buffer.h"
 
-// Debug level control
+// Debug level control, the highest level compiled in (see config.h)
 // 0 = No debug output
 // 1 = Basic debug output
 // 2 = Verbose debug output
@@ -20,16 +21,15 @@ class DebugClass {
 private:
   int currentLevel = DEBUG_LEVEL;
   bool initialized = false;
+  Print* output = &Serial;
 
 public:
-  // Initialize debug output
+  // Initialize debug output - never waits for a host, output before one
+  // attaches is simply lost
   void begin(unsigned long baud) {
     #if DEBUG_LEVEL > 0
+      Serial.setTxBufferSize(LOG_SERIAL_TX_BUFFER_SIZE);
       Serial.begin(baud);
-      while (!Serial && millis() < 5000) {
-        // Wait for serial connection for up to 5 seconds
-        delay(100);
-      }
       initialized = true;
       Serial.println();
       Serial.println(F("Debug output initialized"));
@@ -45,21 +45,32 @@ public:
     return currentLevel;
   }
   
+  // Runtime check used by the LOG_ macros before their arguments are evaluated
+  bool enabled(int level) const {
+    return initialized && level <= currentLevel;
+  }
+  
+  // Redirect debug output, e.g. into binary log frames
+  void setOutput(Print& out) {
+    output = &out;
+  }
+  
   // Print empty line - ADDED TO FIX COMPILATION ERROR
   void println() {
     #if DEBUG_LEVEL > 0
       if (initialized) {
-        Serial.println();
+        recordLog(1, "\r\n");
       }
     #endif
   }
   
-  // Print methods for different debug levels
+  // Print methods for different debug levels. Everything below is queued in
+  // the log buffer and written out by drain(), so callers never wait for the UART.
   template <typename T>
   void print(T message, int level = 1) {
     #if DEBUG_LEVEL > 0
       if (initialized && level <= currentLevel) {
-        Serial.print(message);
+        recordLog(level, logValueFormat<T>(LOG_LAYOUT_PRINT), logValue(message));
       }
     #endif
   }
@@ -68,7 +79,7 @@ public:
   void println(T message, int level = 1) {
     #if DEBUG_LEVEL > 0
       if (initialized && level <= currentLevel) {
-        Serial.println(message);
+        recordLog(level, logValueFormat<T>(LOG_LAYOUT_PRINTLN), logValue(message));
       }
     #endif
   }
@@ -78,7 +89,7 @@ public:
   void println(int level, T message) {
     #if DEBUG_LEVEL > 0
       if (initialized && level <= currentLevel) {
-        Serial.println(message);
+        recordLog(level, logValueFormat<T>(LOG_LAYOUT_PRINTLN), logValue(message));
       }
     #endif
   }
@@ -88,9 +99,7 @@ public:
   void print(const char* prefix, T message, int level = 1) {
     #if DEBUG_LEVEL > 0
       if (initialized && level <= currentLevel) {
-        Serial.print(prefix);
-        Serial.print(": ");
-        Serial.print(message);
+        recordLog(level, logValueFormat<T>(LOG_LAYOUT_PREFIX_PRINT), prefix, logValue(message));
       }
     #endif
   }
@@ -99,36 +108,36 @@ public:
   void println(const char* prefix, T message, int level = 1) {
     #if DEBUG_LEVEL > 0
       if (initialized && level <= currentLevel) {
-        Serial.print(prefix);
-        Serial.print(": ");
-        Serial.println(message);
+        recordLog(level, logValueFormat<T>(LOG_LAYOUT_PREFIX_PRINTLN), prefix, logValue(message));
       }
     #endif
   }
   
-  // For formatting like printf
-  void printf(const char* format, ...) {
+  // For formatting like printf; the format must be a string literal
+  template <typename... Args>
+  void printf(const char* format, Args... args) {
     #if DEBUG_LEVEL > 0
       if (initialized && currentLevel >= 1) {
-        char buffer[256];
-        va_list args;
-        va_start(args, format);
-        vsnprintf(buffer, sizeof(buffer), format, args);
-        va_end(args);
-        Serial.print(buffer);
+        recordLog(1, format, args...);
       }
     #endif
   }
   
-  void printf(int level, const char* format, ...) {
+  template <typename... Args>
+  void printf(int level, const char* format, Args... args) {
     #if DEBUG_LEVEL > 0
       if (initialized && level <= currentLevel) {
-        char buffer[256];
-        va_list args;
-        va_start(args, format);
-        vsnprintf(buffer, sizeof(buffer), format, args);
-        va_end(args);
-        Serial.print(buffer);
+        recordLog(level, format, args...);
+      }
+    #endif
+  }
+  
+  // Write queued output while the loop is idle, only as much as the serial
+  // TX buffer has room for
+  void drain() {
+    #if DEBUG_LEVEL > 0
+      if (initialized) {
+        drainLogRecords(*output, Serial.availableForWrite());
       }
     #endif
   }
@@ -137,4 +146,36 @@ public:
 // Create a global instance
 extern DebugClass Debug;
 
+// Subsystems that can be left out of the build with LOG_CATEGORY_MASK
+enum LogCategory {
+  LOG_CAT_SYSTEM,
+  LOG_CAT_WIFI,
+  LOG_CAT_ALPACA,
+  LOG_CAT_WEB,
+  LOG_CAT_SERIAL,
+  LOG_CAT_CALIBRATOR
+};
+
+// True when messages of this level and category are built into the firmware
+template <int level, LogCategory category>
+constexpr bool logCompiled() {
+  return level <= DEBUG_LEVEL && (LOG_CATEGORY_MASK & (1UL << category)) != 0;
+}
+
+// printf-style logging. A level or category that is compiled out leaves no
+// code behind, and the arguments are only evaluated when the runtime level
+// lets the message through, so String temporaries in them cost nothing when
+// output is off.
+#define LOG_AT(level, category, ...)                          \
+  do {                                                        \
+    if constexpr (logCompiled<level, category>()) {           \
+      if (Debug.enabled(level)) {                             \
+        recordLog(level, __VA_ARGS__);                        \
+      }                                                       \
+    }                                                         \
+  } while (0)
+
+#define LOG_INFO(category, ...) LOG_AT(1, category, __VA_ARGS__)
+#define LOG_VERBOSE(category, ...) LOG_AT(2, category, __VA_ARGS__)
+
 #endif // DEBUG_H
\ No newline at end of file
@@ -5,6 +5,13 @@
 
 #include "alpaca_handler.h"
 #include "calibrator_controller.h"
+#include "event_stream.h"
+#include "html_templates.h"
+#include "web_ui_handler.h"
+#include "heap_monitor.h"
+#include "preset_manager.h"
+#include "flat_solver.h"
+#include "rate_limiter.h"
 #include "Debug.h"
 #include <ArduinoJson.h>
 #include <ESPmDNS.h>
@@ -13,10 +20,13 @@
 WebServer alpacaServer(ALPACA_PORT);
 WiFiUDP udp;
 String uniqueID;
+String mdnsHostname;
 unsigned int serverTransactionID = 1;
+static bool mdnsStarted = false;
 
 #define ASCOM_ERROR_INVALID_VALUE 1025
 #define ASCOM_ERROR_NOT_CONNECTED 1031
+#define ASCOM_ERROR_INVALID_OPERATION 1035
 #define ASCOM_ERROR_NOT_IMPLEMENTED 1036
 
 void setupAlpacaAPI() {
@@ -29,27 +39,59 @@ void setupAlpacaAPI() {
     uniqueID += buf;
   }
   
-  if (MDNS.begin("flatpanelcalibrator")) {
-    Debug.println("MDNS responder started");
-    MDNS.addService("http", "tcp", ALPACA_PORT);
-  }
+  // Per-device hostname so several panels can share a LAN: the last three
+  // MAC bytes of the unique ID, lower case (hostnames cannot hold '_')
+  mdnsHostname = "flatpanel-" + uniqueID.substring(uniqueID.length() - 6);
+  mdnsHostname.toLowerCase();
   
-  Debug.printf("Starting UDP listener on port %d... ", ALPACA_DISCOVERY_PORT);
+  LOG_INFO(LOG_CAT_ALPACA, "Starting UDP listener on port %d... ", ALPACA_DISCOVERY_PORT);
   if (udp.begin(ALPACA_DISCOVERY_PORT)) {
-    Debug.println("SUCCESS!");
+    LOG_INFO(LOG_CAT_ALPACA, "SUCCESS!\n");
   } else {
-    Debug.println("FAILED!");
+    LOG_INFO(LOG_CAT_ALPACA, "FAILED!\n");
   }
   
-  Debug.printf("ESP32 IP address: %s\n", WiFi.localIP().toString().c_str());
-  Debug.printf("Alpaca API port: %d\n", ALPACA_PORT);
+  LOG_INFO(LOG_CAT_ALPACA, "Alpaca API port: %d\n", ALPACA_PORT);
   
   setupAlpacaRoutes();
   alpacaServer.begin();
-  Debug.printf("Alpaca server started on port %d\n", ALPACA_PORT);
+  LOG_INFO(LOG_CAT_ALPACA, "Alpaca server started on port %d\n", ALPACA_PORT);
+}
+
+// Advertise the device once the network is up. _alpaca._tcp carries what a
+// client would otherwise learn from a discovery broadcast and the management
+// API, so it can list the device straight from its mDNS cache.
+void initAlpacaMDNS() {
+  if (!MDNS.begin(mdnsHostname.c_str())) {
+    LOG_INFO(LOG_CAT_ALPACA, "MDNS responder failed to start\n");
+    return;
+  }
+  mdnsStarted = true;
+  LOG_INFO(LOG_CAT_ALPACA, "MDNS responder started as %s.local\n", mdnsHostname.c_str());
+  
+  MDNS.setInstanceName(deviceName);
+  MDNS.addService("http", "tcp", ALPACA_PORT);
+  MDNS.addService("alpaca", "tcp", ALPACA_PORT);
+  MDNS.addServiceTxt("alpaca", "tcp", "devicetype", "CoverCalibrator");
+  MDNS.addServiceTxt("alpaca", "tcp", "devicenumber", "0");
+  MDNS.addServiceTxt("alpaca", "tcp", "uniqueid", uniqueID.c_str());
+  MDNS.addServiceTxt("alpaca", "tcp", "apiversion", "1");
+  MDNS.addServiceTxt("alpaca", "tcp", "name", deviceName.c_str());
+}
+
+// Re-announce the records that carry the device name; setting a TXT key
+// again replaces its value and the responder announces the change
+void updateAlpacaMDNS() {
+  if (!mdnsStarted) {
+    return;
+  }
+  MDNS.setInstanceName(deviceName);
+  MDNS.addServiceTxt("alpaca", "tcp", "name", deviceName.c_str());
+  LOG_INFO(LOG_CAT_ALPACA, "MDNS records updated for %s\n", deviceName.c_str());
 }
 
 void handleAlpacaDiscovery() {
+  HeapScope heapScope(HEAP_IF_ALPACA);
   int packetSize = udp.parsePacket();
   if (packetSize) {
     char packet[64];
@@ -58,7 +100,7 @@ void handleAlpacaDiscovery() {
     
     if (len > 0) {
       packet[len] = 0;
-      Debug.printf(2, "UDP packet: %s\n", packet);
+      LOG_VERBOSE(LOG_CAT_ALPACA, "UDP packet: %s\n", packet);
       
       if (strncmp(packet, ALPACA_DISCOVERY_MESSAGE, strlen(ALPACA_DISCOVERY_MESSAGE)) == 0) {
         DynamicJsonDocument doc(128);
@@ -71,7 +113,7 @@ void handleAlpacaDiscovery() {
         udp.print(response);
         udp.endPacket();
         
-        Debug.printf("Discovery response: %s\n", response.c_str());
+        LOG_INFO(LOG_CAT_ALPACA, "Discovery response: %s\n", response.c_str());
       }
     }
   }
@@ -79,41 +121,59 @@ void handleAlpacaDiscovery() {
 
 void setupAlpacaRoutes() {
   // Management API
-  alpacaServer.on("/management/apiversions", HTTP_GET, handleAPIVersions);
-  alpacaServer.on("/management/v1/description", HTTP_GET, handleDescription);
-  alpacaServer.on("/management/v1/configureddevices", HTTP_GET, handleConfiguredDevices);
+  onRoute(alpacaServer, "/management/apiversions", HTTP_GET, handleAPIVersions);
+  onRoute(alpacaServer, "/management/v1/description", HTTP_GET, handleDescription);
+  onRoute(alpacaServer, "/management/v1/configureddevices", HTTP_GET, handleConfiguredDevices);
   
   // Device routes
-  alpacaServer.on("/api/v1/covercalibrator/0/connected", HTTP_GET, handleConnected);
-  alpacaServer.on("/api/v1/covercalibrator/0/connected", HTTP_PUT, handleSetConnected);
-  alpacaServer.on("/api/v1/covercalibrator/0/description", HTTP_GET, handleDeviceDescription);
-  alpacaServer.on("/api/v1/covercalibrator/0/driverinfo", HTTP_GET, handleDriverInfo);
-  alpacaServer.on("/api/v1/covercalibrator/0/driverversion", HTTP_GET, handleDriverVersion);
-  alpacaServer.on("/api/v1/covercalibrator/0/interfaceversion", HTTP_GET, handleInterfaceVersion);
-  alpacaServer.on("/api/v1/covercalibrator/0/name", HTTP_GET, handleName);
-  alpacaServer.on("/api/v1/covercalibrator/0/supportedactions", HTTP_GET, handleSupportedActions);
-  alpacaServer.on("/api/v1/covercalibrator/0/action", HTTP_PUT, handleAction);
+  onRoute(alpacaServer, "/api/v1/covercalibrator/0/connected", HTTP_GET, handleConnected);
+  onRoute(alpacaServer, "/api/v1/covercalibrator/0/connected", HTTP_PUT, handleSetConnected);
+  onRoute(alpacaServer, "/api/v1/covercalibrator/0/description", HTTP_GET, handleDeviceDescription);
+  onRoute(alpacaServer, "/api/v1/covercalibrator/0/driverinfo", HTTP_GET, handleDriverInfo);
+  onRoute(alpacaServer, "/api/v1/covercalibrator/0/driverversion", HTTP_GET, handleDriverVersion);
+  onRoute(alpacaServer, "/api/v1/covercalibrator/0/interfaceversion", HTTP_GET, handleInterfaceVersion);
+  onRoute(alpacaServer, "/api/v1/covercalibrator/0/name", HTTP_GET, handleName);
+  onRoute(alpacaServer, "/api/v1/covercalibrator/0/supportedactions", HTTP_GET, handleSupportedActions);
+  onRoute(alpacaServer, "/api/v1/covercalibrator/0/action", HTTP_PUT, handleAction);
   
   // CoverCalibrator properties
-  alpacaServer.on("/api/v1/covercalibrator/0/brightness", HTTP_GET, handleBrightness);
-  alpacaServer.on("/api/v1/covercalibrator/0/calibratorstate", HTTP_GET, handleCalibratorState);
-  alpacaServer.on("/api/v1/covercalibrator/0/coverstate", HTTP_GET, handleCoverState);
-  alpacaServer.on("/api/v1/covercalibrator/0/maxbrightness", HTTP_GET, handleMaxBrightness);
+  onRoute(alpacaServer, "/api/v1/covercalibrator/0/brightness", HTTP_GET, handleBrightness);
+  onRoute(alpacaServer, "/api/v1/covercalibrator/0/calibratorstate", HTTP_GET, handleCalibratorState);
+  onRoute(alpacaServer, "/api/v1/covercalibrator/0/coverstate", HTTP_GET, handleCoverState);
+  onRoute(alpacaServer, "/api/v1/covercalibrator/0/maxbrightness", HTTP_GET, handleMaxBrightness);
   
   // CoverCalibrator methods
-  alpacaServer.on("/api/v1/covercalibrator/0/calibratoron", HTTP_PUT, handleCalibratorOn);
-  alpacaServer.on("/api/v1/covercalibrator/0/calibratoroff", HTTP_PUT, handleCalibratorOff);
-  alpacaServer.on("/api/v1/covercalibrator/0/opencover", HTTP_PUT, handleOpenCover);
-  alpacaServer.on("/api/v1/covercalibrator/0/closecover", HTTP_PUT, handleCloseCover);
-  alpacaServer.on("/api/v1/covercalibrator/0/haltcover", HTTP_PUT, handleHaltCover);
+  onRoute(alpacaServer, "/api/v1/covercalibrator/0/calibratoron", HTTP_PUT, handleCalibratorOn);
+  onRoute(alpacaServer, "/api/v1/covercalibrator/0/calibratoroff", HTTP_PUT, handleCalibratorOff);
+  onRoute(alpacaServer, "/api/v1/covercalibrator/0/opencover", HTTP_PUT, handleOpenCover);
+  onRoute(alpacaServer, "/api/v1/covercalibrator/0/closecover", HTTP_PUT, handleCloseCover);
+  onRoute(alpacaServer, "/api/v1/covercalibrator/0/haltcover", HTTP_PUT, handleHaltCover);
   
   // FIXED: Correct ASCOM setup URL
-  alpacaServer.on("/setup", HTTP_GET, handleSetupRedirect);
-  alpacaServer.on("/setup/v1/covercalibrator/0/setup", HTTP_GET, handleCoverCalibratorSetup);
+  onRoute(alpacaServer, "/setup", HTTP_GET, handleSetupRedirect);
+  onRoute(alpacaServer, "/setup/v1/covercalibrator/0/setup", HTTP_GET, handleCoverCalibratorSetup);
+  
+  // State push and static assets for the setup page
+  onRoute(alpacaServer, "/events", HTTP_GET, []() {
+    handleEventStreamRequest(alpacaServer);
+  });
+  registerWebAssets(alpacaServer);
+  
+  // Round-trip probe on the port imaging software actually uses
+  onRoute(alpacaServer, "/api/echo", HTTP_GET, []() {
+    handleEchoRequest(alpacaServer);
+  });
 }
 
 void handleAlpacaAPI() {
-  alpacaServer.handleClient();
+  HeapScope heapScope(HEAP_IF_ALPACA);
+  // A refused request was cheap, so serve the next one in the same pass
+  for (int i = 0; i <= RATE_LIMIT_DRAIN; i++) {
+    alpacaServer.handleClient();
+    if (!takeRefusedRequest()) {
+      break;
+    }
+  }
 }
 
 // FIXED: Ensure ClientTransactionID is always a valid unsigned integer
@@ -168,8 +228,41 @@ void sendAlpacaResponse(int clientID, int clientTransactionID, int errorNumber,
   String response;
   serializeJson(doc, response);
   
+  renewCalibratorLease(clientID);
   alpacaServer.send(200, "application/json", response);
-  Debug.printf(2, "Response: %s\n", response.c_str());
+  LOG_VERBOSE(LOG_CAT_ALPACA, "Response: %s\n", response.c_str());
+}
+
+// Map a command gateway result to the ASCOM error it is reported as
+void sendCommandResult(int clientID, int clientTransactionID, CommandResult result, const char* failureMessage) {
+  switch (result) {
+    case COMMAND_OK:
+      sendAlpacaResponse(clientID, clientTransactionID, 0, "", "");
+      break;
+    case COMMAND_INVALID_VALUE:
+      sendAlpacaResponse(clientID, clientTransactionID, ASCOM_ERROR_INVALID_VALUE,
+                         "Brightness out of range (0-" + String(getMaxBrightness()) + ")", "");
+      break;
+    case COMMAND_BUSY:
+      sendAlpacaResponse(clientID, clientTransactionID, ASCOM_ERROR_INVALID_OPERATION, getCommandBusyMessage(), "");
+      break;
+    default:
+      sendAlpacaResponse(clientID, clientTransactionID, ASCOM_ERROR_INVALID_VALUE, failureMessage, "");
+      break;
+  }
+}
+
+// Answer a request refused by the rate limiter. It is formatted by hand so a
+// flooding client costs as little as possible, and it does not renew a lease.
+void sendAlpacaRateLimited(uint32_t retryAfterMs) {
+  char response[160];
+  snprintf(response, sizeof(response),
+           "{\"ClientTransactionID\":%d,\"ServerTransactionID\":%u,\"ErrorNumber\":%d,"
+           "\"ErrorMessage\":\"Too many requests, retry after %lu ms\"}",
+           getClientTransactionID(), serverTransactionID++, ASCOM_ERROR_INVALID_OPERATION,
+           (unsigned long)retryAfterMs);
+  alpacaServer.sendHeader("Retry-After", String((retryAfterMs + 999) / 1000));
+  alpacaServer.send(429, "application/json", response);
 }
 
 // FIXED: Parameter validation helper
@@ -275,6 +368,9 @@ void handleSetConnected() {
   }
   
   isConnected = connected;
+  if (!connected) {
+    releaseCalibratorLease(clientID);
+  }
   sendAlpacaResponse(clientID, clientTransactionID, 0, "", "");
 }
 
@@ -320,6 +416,10 @@ void handleSupportedActions() {
   DynamicJsonDocument doc(128);
   JsonArray array = doc.to<JsonArray>();
   array.add("status");
+  array.add("preset");
+  array.add("presets");
+  array.add("autoflat");
+  array.add("autoflatreset");
   
   String value;
   serializeJson(doc, value);
@@ -327,6 +427,100 @@ void handleSupportedActions() {
   sendAlpacaResponse(clientID, clientTransactionID, 0, "", value);
 }
 
+// Action "preset", Parameters = preset name. Switches the panel in one call and
+// returns what the sequencer needs for the flat:
+// "brightness=45,rampMs=500,exposureMs=3000"
+static void handlePresetAction(int clientID, int clientTransactionID) {
+  if (!isConnected) {
+    sendAlpacaResponse(clientID, clientTransactionID, ASCOM_ERROR_NOT_CONNECTED, "Not connected", "");
+    return;
+  }
+  
+  String name = alpacaServer.arg("Parameters");
+  name.trim();
+  const CalibratorPreset* preset = findPreset(name.c_str());
+  if (preset == nullptr) {
+    sendAlpacaResponse(clientID, clientTransactionID, ASCOM_ERROR_INVALID_VALUE, "Unknown preset: " + name, "");
+    return;
+  }
+  
+  CommandResult result = commandPreset(COMMAND_SOURCE_ALPACA, clientID, *preset);
+  if (result != COMMAND_OK) {
+    sendCommandResult(clientID, clientTransactionID, result, "Failed to apply preset");
+    return;
+  }
+  char value[64];
+  snprintf(value, sizeof(value), "brightness=%u,rampMs=%u,exposureMs=%lu", preset->brightness, preset->rampMs,
+           (unsigned long)preset->exposureMs);
+  sendAlpacaResponse(clientID, clientTransactionID, 0, "", value);
+}
+
+// Action "autoflat", Parameters = comma separated key=value pairs describing
+// the last test frame: filter, median, exposure (s), target, and optionally
+// bias, brightness (defaults to the current level) and apply=true to set the
+// returned level. Returns
+// "brightness=47,exposure=2.05,predictedAdu=29950,converged=false,frames=2"
+static void handleAutoFlatAction(int clientID, int clientTransactionID) {
+  if (!isConnected) {
+    sendAlpacaResponse(clientID, clientTransactionID, ASCOM_ERROR_NOT_CONNECTED, "Not connected", "");
+    return;
+  }
+  
+  String filter;
+  FlatFrame frame = {nullptr, -1, 0, 0, 0, getCurrentBrightness()};
+  bool apply = false;
+  String parameters = alpacaServer.arg("Parameters");
+  int start = 0;
+  while (start < (int)parameters.length()) {
+    int end = parameters.indexOf(',', start);
+    if (end < 0) {
+      end = parameters.length();
+    }
+    String pair = parameters.substring(start, end);
+    start = end + 1;
+    int equals = pair.indexOf('=');
+    String key = pair.substring(0, equals < 0 ? 0 : equals);
+    String value = pair.substring(equals + 1);
+    key.trim();
+    value.trim();
+    if (key.equalsIgnoreCase("filter")) {
+      filter = value;
+    } else if (key.equalsIgnoreCase("median")) {
+      frame.medianAdu = value.toFloat();
+    } else if (key.equalsIgnoreCase("exposure")) {
+      frame.exposureS = value.toFloat();
+    } else if (key.equalsIgnoreCase("target")) {
+      frame.targetAdu = value.toFloat();
+    } else if (key.equalsIgnoreCase("bias")) {
+      frame.biasAdu = value.toFloat();
+    } else if (key.equalsIgnoreCase("brightness")) {
+      frame.brightness = value.toInt();
+    } else if (key.equalsIgnoreCase("apply")) {
+      apply = value.equalsIgnoreCase("true");
+    }
+  }
+  
+  frame.filter = filter.c_str();
+  FlatStep step;
+  if (frame.medianAdu < 0 || !solveFlatStep(frame, step)) {
+    sendAlpacaResponse(clientID, clientTransactionID, ASCOM_ERROR_INVALID_VALUE,
+                       "Expected filter (up to " + String(FLAT_SOLVER_FILTER_SIZE - 1) +
+                       " characters), median, exposure and target", "");
+    return;
+  }
+  if (apply) {
+    CommandResult result = commandBrightness(COMMAND_SOURCE_ALPACA, clientID, step.brightness);
+    if (result != COMMAND_OK) {
+      sendCommandResult(clientID, clientTransactionID, result, "Failed to set brightness");
+      return;
+    }
+  }
+  char value[96];
+  snprintf(value, sizeof(value), "brightness=%d,exposure=%.3f,predictedAdu=%.0f,converged=%s,frames=%u",
+           step.brightness, step.exposureS, step.predictedAdu, step.converged ? "true" : "false", step.frames);
+  sendAlpacaResponse(clientID, clientTransactionID, 0, "", value);
+}
+
 void handleAction() {
   int clientID = getClientID();
   int clientTransactionID = getClientTransactionID();
@@ -336,6 +530,26 @@ void handleAction() {
   if (actionName == "status") {
     String status = "State: " + getCalibratorStateString() + ", Brightness: " + String(getCurrentBrightness()) + "%";
     sendAlpacaResponse(clientID, clientTransactionID, 0, "", status);
+  } else if (actionName.equalsIgnoreCase("preset")) {
+    handlePresetAction(clientID, clientTransactionID);
+  } else if (actionName.equalsIgnoreCase("autoflat")) {
+    handleAutoFlatAction(clientID, clientTransactionID);
+  } else if (actionName.equalsIgnoreCase("autoflatreset")) {
+    // Parameters = filter; starts a new flat run with the learned slope kept
+    String filter = alpacaServer.arg("Parameters");
+    filter.trim();
+    resetFlatModel(filter.c_str());
+    sendAlpacaResponse(clientID, clientTransactionID, 0, "", "");
+  } else if (actionName.equalsIgnoreCase("presets")) {
+    // Comma separated preset names
+    String names;
+    for (size_t i = 0; i < getPresetCount(); i++) {
+      if (i > 0) {
+        names += ",";
+      }
+      names += getPreset(i).name;
+    }
+    sendAlpacaResponse(clientID, clientTransactionID, 0, "", names);
   } else {
     sendAlpacaResponse(clientID, clientTransactionID, ASCOM_ERROR_NOT_IMPLEMENTED, "Action not implemented", "");
   }
@@ -444,25 +658,12 @@ void handleCalibratorOn() {
     }
     
     int brightness = brightnessStr.toInt();
-    
-    if (brightness < 0 || brightness > getMaxBrightness()) {
-      String errorMsg = "Brightness out of range (0-" + String(getMaxBrightness()) + ")";
-      sendAlpacaResponse(clientID, clientTransactionID, ASCOM_ERROR_INVALID_VALUE, errorMsg, "");
-      return;
-    }
-    
-    if (setCalibratorBrightness(brightness)) {
-      sendAlpacaResponse(clientID, clientTransactionID, 0, "", "");
-    } else {
-      sendAlpacaResponse(clientID, clientTransactionID, 1025, "Failed to set brightness", "");
-    }
+    sendCommandResult(clientID, clientTransactionID,
+                      commandBrightness(COMMAND_SOURCE_ALPACA, clientID, brightness), "Failed to set brightness");
   } else {
     // No brightness parameter - turn on at max brightness
-    if (turnCalibratorOn()) {
-      sendAlpacaResponse(clientID, clientTransactionID, 0, "", "");
-    } else {
-      sendAlpacaResponse(clientID, clientTransactionID, 1025, "Failed to turn on calibrator", "");
-    }
+    sendCommandResult(clientID, clientTransactionID,
+                      commandCalibratorOn(COMMAND_SOURCE_ALPACA, clientID), "Failed to turn on calibrator");
   }
 }
 
@@ -485,11 +686,8 @@ void handleCalibratorOff() {
     // CalibratorOff takes no other parameters - ignore extra params per Postel's Law
   }
   
-  if (turnCalibratorOff()) {
-    sendAlpacaResponse(clientID, clientTransactionID, 0, "", "");
-  } else {
-    sendAlpacaResponse(clientID, clientTransactionID, 1025, "Failed to turn off calibrator", "");
-  }
+  sendCommandResult(clientID, clientTransactionID,
+                    commandCalibratorOff(COMMAND_SOURCE_ALPACA, clientID), "Failed to turn off calibrator");
 }
 
 // Cover methods - not implemented
@@ -559,83 +757,5 @@ void handleSetupRedirect() {
 
 // FIXED: ASCOM-compliant setup page
 void handleCoverCalibratorSetup() {
-  String html = "<!DOCTYPE html><html>";
-  html += "<head><title>Flat Panel Calibrator Setup</title>";
-  html += "<meta name='viewport' content='width=device-width, initial-scale=1'>";
-  html += "<style>";
-  html += "body { font-family: Arial, sans-serif; margin: 20px; background: #f5f5f5; }";
-  html += ".container { max-width: 800px; margin: 0 auto; background: white; padding: 20px; border-radius: 8px; box-shadow: 0 2px 10px rgba(0,0,0,0.1); }";
-  html += "h1 { color: #2c3e50; border-bottom: 2px solid #3498db; padding-bottom: 10px; }";
-  html += ".status { background: #ecf0f1; padding: 15px; border-radius: 5px; margin: 10px 0; }";
-  html += ".controls { background: #f8f9fa; padding: 15px; border-radius: 5px; margin: 10px 0; }";
-  html += "button { background: #3498db; color: white; border: none; padding: 10px 20px; margin: 5px; border-radius: 4px; cursor: pointer; }";
-  html += "button:hover { background: #2980b9; }";
-  html += "button.danger { background: #e74c3c; }";
-  html += "button.danger:hover { background: #c0392b; }";
-  html += "input[type=range] { width: 300px; margin: 10px; }";
-  html += ".brightness-display { font-size: 18px; font-weight: bold; color: #2c3e50; }";
-  html += "</style></head>";
-  html += "<body>";
-  html += "<div class='container'>";
-  html += "<h1>ESP32 Flat Panel Calibrator Setup</h1>";
-  
-  html += "<div class='status'>";
-  html += "<h2>Current Status</h2>";
-  html += "<p><strong>Device:</strong> " + deviceName + "</p>";
-  html += "<p><strong>State:</strong> <span id='state'>" + getCalibratorStateString() + "</span></p>";
-  html += "<p><strong>Brightness:</strong> <span id='currentBrightness'>" + String(getCurrentBrightness()) + "%</span></p>";
-  html += "<p><strong>Max Brightness:</strong> " + String(getMaxBrightness()) + "%</p>";
-  html += "<p><strong>IP Address:</strong> " + WiFi.localIP().toString() + "</p>";
-  html += "</div>";
-  
-  html += "<div class='controls'>";
-  html += "<h2>Manual Controls</h2>";
-  html += "<button onclick='calibratorOn()'>Turn ON (Max)</button>";
-  html += "<button onclick='calibratorOff()' class='danger'>Turn OFF</button>";
-  html += "<br><br>";
-  html += "<label for='brightness'>Set Brightness: </label>";
-  html += "<input type='range' id='brightness' min='0' max='" + String(getMaxBrightness()) + "' value='" + String(getCurrentBrightness()) + "' onchange='setBrightness(this.value)'>";
-  html += "<div class='brightness-display' id='brightnessValue'>" + String(getCurrentBrightness()) + "%</div>";
-  html += "</div>";
-  
-  html += "<div class='status'>";
-  html += "<h2>ASCOM Information</h2>";
-  html += "<p><strong>Device Type:</strong> CoverCalibrator</p>";
-  html += "<p><strong>API Base:</strong> http://" + WiFi.localIP().toString() + ":" + String(ALPACA_PORT) + "/api/v1/covercalibrator/0/</p>";
-  html += "<p><strong>Web Interface:</strong> <a href='http://" + WiFi.localIP().toString() + "'>http://" + WiFi.localIP().toString() + "</a></p>";
-  html += "</div>";
-  
-  html += "</div>";
-  
-  // JavaScript for controls
-  html += "<script>";
-  html += "function updateStatus() {";
-  html += "  fetch('/api/v1/covercalibrator/0/calibratorstate?ClientID=1&ClientTransactionID=1')";
-  html += "    .then(r => r.json()).then(d => document.getElementById('state').innerText = d.Value == 1 ? 'Off' : d.Value == 3 ? 'Ready' : 'Unknown');";
-  html += "  fetch('/api/v1/covercalibrator/0/brightness?ClientID=1&ClientTransactionID=1')";
-  html += "    .then(r => r.json()).then(d => {";
-  html += "      document.getElementById('currentBrightness').innerText = d.Value + '%';";
-  html += "      document.getElementById('brightness').value = d.Value;";
-  html += "      document.getElementById('brightnessValue').innerText = d.Value + '%';";
-  html += "    });";
-  html += "}";
-  html += "function calibratorOn() {";
-  html += "  fetch('/api/v1/covercalibrator/0/calibratoron', {method: 'PUT', headers: {'Content-Type': 'application/x-www-form-urlencoded'}, body: 'ClientID=1&ClientTransactionID=1'})";
-  html += "    .then(() => setTimeout(updateStatus, 200));";
-  html += "}";
-  html += "function calibratorOff() {";
-  html += "  fetch('/api/v1/covercalibrator/0/calibratoroff', {method: 'PUT', headers: {'Content-Type': 'application/x-www-form-urlencoded'}, body: 'ClientID=1&ClientTransactionID=1'})";
-  html += "    .then(() => setTimeout(updateStatus, 200));";
-  html += "}";
-  html += "function setBrightness(value) {";
-  html += "  document.getElementById('brightnessValue').innerText = value + '%';";
-  html += "  fetch('/api/v1/covercalibrator/0/calibratoron', {method: 'PUT', headers: {'Content-Type': 'application/x-www-form-urlencoded'}, body: 'ClientID=1&ClientTransactionID=1&Brightness=' + value})";
-  html += "    .then(() => setTimeout(updateStatus, 200));";
-  html += "}";
-  html += "setInterval(updateStatus, 2000);"; // Auto-refresh every 2 seconds
-  html += "</script>";
-  
-  html += "</body></html>";
-  
-  alpacaServer.send(200, "text/html", html);
-}
\ No newline at end of file
+  sendTemplatePage(alpacaServer, ALPACA_SETUP_PAGE_TEMPLATE, resolveAlpacaSetupPageField);
+}
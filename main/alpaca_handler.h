@@ -9,19 +9,25 @@
 #include <WebServer.h>
 #include <WiFiUdp.h>
 #include "config.h"
+#include "command_gateway.h"
 
 // External references
 extern WebServer alpacaServer;
 extern WiFiUDP udp;
 extern String uniqueID;
+extern String mdnsHostname;
 extern unsigned int serverTransactionID;
 
 // Function prototypes for setup and handling
 void setupAlpacaAPI();
+void initAlpacaMDNS();
+void updateAlpacaMDNS();
 void setupAlpacaRoutes();
 void handleAlpacaDiscovery();
 void handleAlpacaAPI();
 void sendAlpacaResponse(int clientID, int clientTransactionID, int errorNumber, const String& errorMessage, const String& value);
+void sendCommandResult(int clientID, int clientTransactionID, CommandResult result, const char* failureMessage);
+void sendAlpacaRateLimited(uint32_t retryAfterMs);
 
 // Management API handlers
 void handleAPIVersions();
@@ -0,0 +1,115 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Boot Sequencer Implementation
+ */
+
+#include "boot_sequencer.h"
+#include "Debug.h"
+
+static const BootPhase* bootPhases = nullptr;
+static size_t bootPhaseCount = 0;
+static BootPhaseTiming bootTimings[BOOT_MAX_PHASES];
+static uint32_t completedMask = 0;
+static bool bootComplete = false;
+static uint32_t bootCompleteUs = 0;
+
+static_assert(BOOT_MAX_PHASES < 32, "Boot phases are tracked in a 32-bit mask");
+
+static void finishPhase(size_t index) {
+  bootTimings[index].endUs = micros();
+  bootTimings[index].state = BOOT_PHASE_DONE;
+  completedMask |= BOOT_AFTER(index);
+  LOG_VERBOSE(LOG_CAT_SYSTEM, "Boot: %s done in %lu us\n", bootPhases[index].name,
+              (unsigned long)(bootTimings[index].endUs - bootTimings[index].startUs));
+}
+
+// One pass over the table; returns true if any phase started or finished
+static bool advanceBootPhases() {
+  bool progress = false;
+
+  for (size_t i = 0; i < bootPhaseCount; i++) {
+    const BootPhase& phase = bootPhases[i];
+    BootPhaseTiming& timing = bootTimings[i];
+
+    if (timing.state == BOOT_PHASE_PENDING && (phase.dependsOn & ~completedMask) == 0) {
+      timing.state = BOOT_PHASE_RUNNING;
+      timing.startUs = micros();
+      if (phase.start != nullptr) {
+        phase.start();
+      }
+      progress = true;
+    }
+
+    if (timing.state == BOOT_PHASE_RUNNING && (phase.ready == nullptr || phase.ready())) {
+      finishPhase(i);
+      progress = true;
+    }
+  }
+
+  return progress;
+}
+
+// Run every phase that can run now; the rest continue from handleBootSequence()
+void startBootSequence(const BootPhase* phases, size_t count) {
+  if (count > BOOT_MAX_PHASES) {
+    LOG_INFO(LOG_CAT_SYSTEM, "Boot: %u phases, only %d supported\n", (unsigned)count, BOOT_MAX_PHASES);
+    count = BOOT_MAX_PHASES;
+  }
+
+  bootPhases = phases;
+  bootPhaseCount = count;
+  completedMask = 0;
+  bootComplete = false;
+  bootCompleteUs = 0;
+  for (size_t i = 0; i < count; i++) {
+    bootTimings[i] = {BOOT_PHASE_PENDING, 0, 0};
+  }
+
+  handleBootSequence();
+}
+
+// Finish waiting phases and start their dependents; call from loop()
+void handleBootSequence() {
+  if (bootComplete || bootPhases == nullptr) {
+    return;
+  }
+
+  while (advanceBootPhases()) {
+  }
+
+  if (completedMask == BOOT_AFTER(bootPhaseCount) - 1) {
+    bootComplete = true;
+    bootCompleteUs = micros();
+    LOG_INFO(LOG_CAT_SYSTEM, "Boot complete in %lu ms\n", (unsigned long)(bootCompleteUs / 1000));
+  }
+}
+
+bool isBootComplete() {
+  return bootComplete;
+}
+
+// micros() when the last phase finished
+uint32_t getBootCompleteUs() {
+  return bootCompleteUs;
+}
+
+size_t getBootPhaseCount() {
+  return bootPhaseCount;
+}
+
+const BootPhase& getBootPhase(size_t index) {
+  return bootPhases[index];
+}
+
+const BootPhaseTiming& getBootPhaseTiming(size_t index) {
+  return bootTimings[index];
+}
+
+const char* getBootPhaseStateString(BootPhaseState state) {
+  switch (state) {
+    case BOOT_PHASE_PENDING: return "pending";
+    case BOOT_PHASE_RUNNING: return "running";
+    case BOOT_PHASE_DONE:    return "done";
+  }
+  return "unknown";
+}
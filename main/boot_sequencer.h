@@ -0,0 +1,50 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Boot Sequencer Header
+ *
+ * setup() describes the boot as a table of phases, each listing the phases it
+ * must wait for. A phase starts as soon as its dependencies are done; phases
+ * with a ready() check (such as the WiFi connection) finish later from loop(),
+ * so nothing that does not need the network waits for it. Start and end times
+ * of every phase are kept for the BOOT serial command and /api/boot.
+ */
+
+#ifndef BOOT_SEQUENCER_H
+#define BOOT_SEQUENCER_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Dependency mask entry for the phase at table index id
+#define BOOT_AFTER(id) (1UL << (id))
+
+struct BootPhase {
+  const char* name;
+  void (*start)();                      // Kicks the phase off, nullptr if it only waits
+  bool (*ready)();                      // Polled until true, nullptr = done when start() returns
+  uint32_t dependsOn;                   // BOOT_AFTER() of each prerequisite
+};
+
+enum BootPhaseState {
+  BOOT_PHASE_PENDING,
+  BOOT_PHASE_RUNNING,
+  BOOT_PHASE_DONE
+};
+
+struct BootPhaseTiming {
+  BootPhaseState state;
+  uint32_t startUs;                     // micros() when start() was called
+  uint32_t endUs;                       // micros() when the phase completed
+};
+
+// Function prototypes
+void startBootSequence(const BootPhase* phases, size_t count);
+void handleBootSequence();
+bool isBootComplete();
+uint32_t getBootCompleteUs();
+size_t getBootPhaseCount();
+const BootPhase& getBootPhase(size_t index);
+const BootPhaseTiming& getBootPhaseTiming(size_t index);
+const char* getBootPhaseStateString(BootPhaseState state);
+
+#endif // BOOT_SEQUENCER_H
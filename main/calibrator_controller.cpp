@@ -18,8 +18,38 @@ bool serialDebugEnabled = false;
 String deviceName = "Flat Panel Calibrator";
 unsigned long lastStateChange = 0;
 
+static CalibratorChangeListener changeListeners[CALIBRATOR_MAX_LISTENERS];
+static int changeListenerCount = 0;
+
+// Coalescing slot: the latest requested brightness waits here for the next tick
+static bool brightnessPending = false;
+static int appliedPWM = 0;
+static unsigned long lastBrightnessApply = 0;
+static BrightnessCoalescingStats coalescingStats = {};
+
+// Ramp in progress; each tick moves the slot along it
+static bool rampActive = false;
+static int rampFrom = 0;
+static int rampTo = 0;
+static unsigned long rampStart = 0;
+static uint32_t rampDuration = 0;
+
+bool addCalibratorChangeListener(CalibratorChangeListener listener) {
+  if (changeListenerCount >= CALIBRATOR_MAX_LISTENERS) {
+    return false;
+  }
+  changeListeners[changeListenerCount++] = listener;
+  return true;
+}
+
+static void notifyCalibratorChange() {
+  for (int i = 0; i < changeListenerCount; i++) {
+    changeListeners[i]();
+  }
+}
+
 void initializeCalibratorController() {
-  Debug.println("Initializing Flat Panel Calibrator Controller...");
+  LOG_INFO(LOG_CAT_CALIBRATOR, "Initializing Flat Panel Calibrator Controller...\n");
   
   Preferences prefs;
   prefs.begin(PREFERENCES_NAMESPACE, true);
@@ -33,12 +63,13 @@ void initializeCalibratorController() {
   pinMode(PWM_OUTPUT_PIN, OUTPUT);
   
   if (!ledcAttach(PWM_OUTPUT_PIN, PWM_FREQUENCY, PWM_RESOLUTION)) {
-    Debug.println("ERROR: Failed to configure PWM");
+    LOG_INFO(LOG_CAT_CALIBRATOR, "ERROR: Failed to configure PWM\n");
     calibratorState = CALIBRATOR_ERROR;
     return;
   }
   
   ledcWrite(PWM_OUTPUT_PIN, 0);
+  appliedPWM = 0;
   currentBrightness = 0;
   
   // FIXED: Start in OFF state, will change to READY when first commanded
@@ -46,11 +77,32 @@ void initializeCalibratorController() {
   coverState = COVER_NOT_PRESENT;
   lastStateChange = millis();
   
-  Debug.println("Calibrator Controller initialized successfully");
-  Debug.printf("Device Name: %s\n", deviceName.c_str());
-  Debug.printf("Max Brightness: %d%%\n", maxBrightness);
-  Debug.printf("PWM Pin: %d, Frequency: %dHz, Resolution: %d-bit\n", 
-               PWM_OUTPUT_PIN, PWM_FREQUENCY, PWM_RESOLUTION);
+  LOG_INFO(LOG_CAT_CALIBRATOR, "Calibrator Controller initialized successfully\n");
+  LOG_INFO(LOG_CAT_CALIBRATOR, "Device Name: %s\n", deviceName.c_str());
+  LOG_INFO(LOG_CAT_CALIBRATOR, "Max Brightness: %d%%\n", maxBrightness);
+  LOG_INFO(LOG_CAT_CALIBRATOR, "PWM Pin: %d, Frequency: %dHz, Resolution: %d-bit\n", 
+           PWM_OUTPUT_PIN, PWM_FREQUENCY, PWM_RESOLUTION);
+}
+
+// Write the slot to the PWM output; one ledcWrite, log line and change
+// notification however many requests were merged into it
+static void applyPendingBrightness() {
+  brightnessPending = false;
+  lastBrightnessApply = millis();
+  coalescingStats.applied++;
+  
+  int pwmValue = convertBrightnessToPWM(currentBrightness);
+  if (pwmValue != appliedPWM) {
+    ledcWrite(PWM_OUTPUT_PIN, pwmValue);
+    appliedPWM = pwmValue;
+  }
+  
+  if (rampActive) {
+    LOG_VERBOSE(LOG_CAT_CALIBRATOR, "Ramp at %d%% (PWM: %d)\n", currentBrightness, pwmValue);
+  } else {
+    LOG_INFO(LOG_CAT_CALIBRATOR, "Brightness set to %d%% (PWM: %d), State: READY\n", currentBrightness, pwmValue);
+  }
+  notifyCalibratorChange();
 }
 
 void updateCalibratorStatus() {
@@ -58,6 +110,26 @@ void updateCalibratorStatus() {
     return;
   }
   
+  if (rampActive && millis() - lastBrightnessApply >= BRIGHTNESS_APPLY_INTERVAL_MS) {
+    unsigned long elapsed = millis() - rampStart;
+    int level = rampFrom + (int)((long)(rampTo - rampFrom) * (long)elapsed / (long)rampDuration);
+    if (elapsed >= rampDuration) {
+      rampActive = false;
+      level = rampTo;
+      calibratorState = CALIBRATOR_READY;
+      lastStateChange = millis();
+      brightnessPending = true;
+    }
+    if (level != currentBrightness) {
+      currentBrightness = level;
+      brightnessPending = true;
+    }
+  }
+  
+  if (brightnessPending && millis() - lastBrightnessApply >= BRIGHTNESS_APPLY_INTERVAL_MS) {
+    applyPendingBrightness();
+  }
+  
   // FIXED: Once a calibrator command has been issued, state should be READY
   // regardless of brightness level (including 0). Only OFF during initialization.
   // This matches ASCOM behavior where state indicates readiness, not current brightness.
@@ -71,20 +143,49 @@ void updateCalibratorStatus() {
 
 bool setCalibratorBrightness(int brightness) {
   if (brightness < MIN_BRIGHTNESS || brightness > maxBrightness) {
-    Debug.printf("Invalid brightness value: %d (valid range: %d-%d)\n", 
-                 brightness, MIN_BRIGHTNESS, maxBrightness);
+    LOG_INFO(LOG_CAT_CALIBRATOR, "Invalid brightness value: %d (valid range: %d-%d)\n", 
+             brightness, MIN_BRIGHTNESS, maxBrightness);
     return false;
   }
   
-  int pwmValue = convertBrightnessToPWM(brightness);
-  ledcWrite(PWM_OUTPUT_PIN, pwmValue);
+  // The request is acknowledged now and reads back at once; the output
+  // follows on the next tick. It also replaces any ramp in progress.
+  rampActive = false;
+  coalescingStats.requests++;
+  if (brightnessPending) {
+    coalescingStats.merged++;
+  }
+  brightnessPending = true;
   currentBrightness = brightness;
   
   // FIXED: Set state to READY when any brightness command is issued
   calibratorState = CALIBRATOR_READY;
   lastStateChange = millis();
+  return true;
+}
+
+// Move to brightness over rampMs. CalibratorState is NotReady until the ramp
+// ends, so ASCOM clients waiting for Ready start exposing at the final level.
+bool rampCalibratorBrightness(int brightness, uint32_t rampMs) {
+  if (rampMs == 0) {
+    return setCalibratorBrightness(brightness);
+  }
+  if (brightness < MIN_BRIGHTNESS || brightness > maxBrightness) {
+    LOG_INFO(LOG_CAT_CALIBRATOR, "Invalid brightness value: %d (valid range: %d-%d)\n", 
+             brightness, MIN_BRIGHTNESS, maxBrightness);
+    return false;
+  }
   
-  Debug.printf("Brightness set to %d%% (PWM: %d), State: READY\n", brightness, pwmValue);
+  coalescingStats.requests++;
+  rampFrom = currentBrightness;
+  rampTo = brightness;
+  rampStart = millis();
+  rampDuration = rampMs;
+  rampActive = true;
+  calibratorState = CALIBRATOR_NOT_READY;
+  lastStateChange = millis();
+  LOG_INFO(LOG_CAT_CALIBRATOR, "Ramping brightness %d%% -> %d%% over %lu ms\n", rampFrom, rampTo,
+           (unsigned long)rampMs);
   return true;
 }
 
@@ -114,14 +215,34 @@ void setMaxBrightness(int brightness) {
     prefs.putInt(PREF_MAX_BRIGHTNESS, maxBrightness);
     prefs.end();
     
-    Debug.printf("Max brightness set to %d%%\n", maxBrightness);
+    LOG_INFO(LOG_CAT_CALIBRATOR, "Max brightness set to %d%%\n", maxBrightness);
     
     if (currentBrightness > maxBrightness) {
       setCalibratorBrightness(maxBrightness);
+    } else {
+      // A ramp still heading above the new limit now ends at it. It restarts
+      // from the current level at the same rate, so the panel never steps back.
+      if (rampActive && rampTo > maxBrightness) {
+        unsigned long now = millis();
+        unsigned long elapsed = now - rampStart;
+        uint32_t remaining = elapsed < rampDuration ? rampDuration - elapsed : 0;
+        rampDuration = remaining * (uint32_t)(maxBrightness - currentBrightness) / (uint32_t)(rampTo - currentBrightness);
+        if (rampDuration == 0) {
+          rampDuration = 1;
+        }
+        rampFrom = currentBrightness;
+        rampTo = maxBrightness;
+        rampStart = now;
+      }
+      notifyCalibratorChange();
     }
   }
 }
 
+const BrightnessCoalescingStats& getBrightnessCoalescingStats() {
+  return coalescingStats;
+}
+
 CalibratorStatus getCalibratorState() {
   return calibratorState;
 }
@@ -18,15 +18,29 @@ extern bool serialDebugEnabled;
 extern String deviceName;
 extern unsigned long lastStateChange;
 
+// Called after every brightness or max brightness change
+typedef void (*CalibratorChangeListener)();
+
+// Brightness requests from all interfaces go into one slot that
+// updateCalibratorStatus() applies at most once per BRIGHTNESS_APPLY_INTERVAL_MS
+struct BrightnessCoalescingStats {
+  uint32_t requests;                    // Accepted brightness requests
+  uint32_t applied;                     // Times the slot was written to the PWM output
+  uint32_t merged;                      // Requests replaced by a later one before being applied
+};
+
 // Function prototypes
 void initializeCalibratorController();
+bool addCalibratorChangeListener(CalibratorChangeListener listener);
 void updateCalibratorStatus();
 bool setCalibratorBrightness(int brightness);
+bool rampCalibratorBrightness(int brightness, uint32_t rampMs);
 bool turnCalibratorOn();
 bool turnCalibratorOff();
 int getCurrentBrightness();
 int getMaxBrightness();
 void setMaxBrightness(int brightness);
+const BrightnessCoalescingStats& getBrightnessCoalescingStats();
 CalibratorStatus getCalibratorState();
 CoverStatus getCoverState();
 String getCalibratorStateString();
@@ -0,0 +1,163 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Command Gateway Implementation
+ */
+
+#include "command_gateway.h"
+#include "calibrator_controller.h"
+#include "Debug.h"
+
+static const char* const sourceNames[COMMAND_SOURCE_COUNT] = { "alpaca", "web", "serial" };
+
+static bool leaseHeld = false;
+static uint32_t leaseClientID = 0;
+static uint32_t leaseAcquiredAt = 0;
+static uint32_t leaseRenewedAt = 0;
+static CalibratorLease refusingLease = {};     // Holder when the latest command was refused
+static CommandGatewayStats gatewayStats = {};
+
+// Expiry is checked whenever the lease is consulted, so nothing runs from loop()
+static void expireLease() {
+  if (leaseHeld && millis() - leaseRenewedAt >= CALIBRATOR_LEASE_MS) {
+    LOG_INFO(LOG_CAT_CALIBRATOR, "Lease of Alpaca client %lu expired\n", (unsigned long)leaseClientID);
+    leaseHeld = false;
+    gatewayStats.leasesExpired++;
+  }
+}
+
+static CalibratorLease snapshotLease() {
+  CalibratorLease lease = {};
+  lease.held = leaseHeld;
+  if (leaseHeld) {
+    lease.clientID = leaseClientID;
+    lease.acquiredAtMs = leaseAcquiredAt;
+    lease.remainingMs = CALIBRATOR_LEASE_MS - (millis() - leaseRenewedAt);
+  }
+  return lease;
+}
+
+// Priority rules, in order:
+// 1. The lease holder is always admitted and renews its lease
+// 2. With no lease everyone is admitted; an Alpaca client with a ClientID
+//    takes the lease. ClientID 0 is anonymous and never holds one
+// 3. Under a lease everyone else is refused. The web UI and serial console
+//    can end it only through breakCalibratorLease()
+// A refusal keeps a snapshot of the holder for getCommandBusyMessage(), as
+// the lease may expire before the reply is written.
+static bool admitCommand(CommandSource source, uint32_t clientID) {
+  expireLease();
+  bool alpacaClient = source == COMMAND_SOURCE_ALPACA && clientID != 0;
+  
+  if (leaseHeld && !(alpacaClient && clientID == leaseClientID)) {
+    refusingLease = snapshotLease();
+    gatewayStats.rejected[source]++;
+    LOG_VERBOSE(LOG_CAT_CALIBRATOR, "Command from %s refused, Alpaca client %lu holds the lease\n",
+                sourceNames[source], (unsigned long)leaseClientID);
+    return false;
+  }
+  
+  if (alpacaClient && !leaseHeld) {
+    leaseHeld = true;
+    leaseClientID = clientID;
+    leaseAcquiredAt = millis();
+    LOG_INFO(LOG_CAT_CALIBRATOR, "Alpaca client %lu took the calibrator lease\n", (unsigned long)clientID);
+  }
+  if (leaseHeld) {
+    leaseRenewedAt = millis();
+  }
+  gatewayStats.accepted[source]++;
+  return true;
+}
+
+CommandResult commandBrightness(CommandSource source, uint32_t clientID, int brightness) {
+  if (brightness < MIN_BRIGHTNESS || brightness > getMaxBrightness()) {
+    return COMMAND_INVALID_VALUE;
+  }
+  if (!admitCommand(source, clientID)) {
+    return COMMAND_BUSY;
+  }
+  return setCalibratorBrightness(brightness) ? COMMAND_OK : COMMAND_FAILED;
+}
+
+CommandResult commandCalibratorOn(CommandSource source, uint32_t clientID) {
+  return commandBrightness(source, clientID, getMaxBrightness());
+}
+
+CommandResult commandCalibratorOff(CommandSource source, uint32_t clientID) {
+  return commandBrightness(source, clientID, 0);
+}
+
+// A preset brighter than the current maximum is refused rather than clipped,
+// so a flat is never taken at a level other than the one recorded
+CommandResult commandPreset(CommandSource source, uint32_t clientID, const CalibratorPreset& preset) {
+  if (preset.brightness > getMaxBrightness()) {
+    return COMMAND_INVALID_VALUE;
+  }
+  if (!admitCommand(source, clientID)) {
+    return COMMAND_BUSY;
+  }
+  LOG_INFO(LOG_CAT_CALIBRATOR, "Preset %s from %s\n", preset.name, sourceNames[source]);
+  return rampCalibratorBrightness(preset.brightness, preset.rampMs) ? COMMAND_OK : COMMAND_FAILED;
+}
+
+// Lowering the maximum can dim the panel, so it is arbitrated like brightness
+CommandResult commandMaxBrightness(CommandSource source, uint32_t clientID, int brightness) {
+  if (brightness < 1 || brightness > MAX_BRIGHTNESS) {
+    return COMMAND_INVALID_VALUE;
+  }
+  if (!admitCommand(source, clientID)) {
+    return COMMAND_BUSY;
+  }
+  setMaxBrightness(brightness);
+  return COMMAND_OK;
+}
+
+// Any request answered for the holder keeps the lease, so a client polling
+// calibratorstate through a long exposure does not lose it
+void renewCalibratorLease(uint32_t clientID) {
+  expireLease();
+  if (leaseHeld && clientID == leaseClientID) {
+    leaseRenewedAt = millis();
+  }
+}
+
+// The holder disconnecting ends its lease
+void releaseCalibratorLease(uint32_t clientID) {
+  if (leaseHeld && clientID == leaseClientID) {
+    leaseHeld = false;
+    LOG_INFO(LOG_CAT_CALIBRATOR, "Alpaca client %lu released the calibrator lease\n", (unsigned long)clientID);
+  }
+}
+
+// Operator override from the web UI or serial console
+bool breakCalibratorLease(CommandSource source) {
+  expireLease();
+  if (!leaseHeld) {
+    return false;
+  }
+  leaseHeld = false;
+  gatewayStats.leasesBroken++;
+  LOG_INFO(LOG_CAT_CALIBRATOR, "Lease of Alpaca client %lu released from %s\n",
+           (unsigned long)leaseClientID, sourceNames[source]);
+  return true;
+}
+
+CalibratorLease getCalibratorLease() {
+  expireLease();
+  return snapshotLease();
+}
+
+const CommandGatewayStats& getCommandGatewayStats() {
+  return gatewayStats;
+}
+
+const char* getCommandSourceName(CommandSource source) {
+  return sourceNames[source];
+}
+
+// Shared wording for COMMAND_BUSY replies, describing the lease as it was
+// at the refusal rather than now
+String getCommandBusyMessage() {
+  return "Calibrator is controlled by Alpaca client " + String((unsigned long)refusingLease.clientID) +
+         " for another " + String((unsigned long)(refusingLease.remainingMs / 1000)) + " s";
+}
@@ -0,0 +1,65 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Command Gateway Header
+ *
+ * Every front end changes the calibrator through these functions, tagged
+ * with where the command came from, so validation and arbitration happen in
+ * one place. An Alpaca client that sends ClientID takes a lease on its first
+ * calibrator command. While the lease is held, commands from other Alpaca
+ * clients, the web UI and serial are refused with COMMAND_BUSY. The holder's
+ * requests renew the lease. It ends when the holder disconnects, after
+ * CALIBRATOR_LEASE_MS without a request from it, or when an operator at the
+ * web UI or serial console releases it explicitly.
+ */
+
+#ifndef COMMAND_GATEWAY_H
+#define COMMAND_GATEWAY_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "preset_manager.h"
+
+enum CommandSource {
+  COMMAND_SOURCE_ALPACA,
+  COMMAND_SOURCE_WEB,
+  COMMAND_SOURCE_SERIAL,
+  COMMAND_SOURCE_COUNT
+};
+
+enum CommandResult {
+  COMMAND_OK,
+  COMMAND_INVALID_VALUE,                // Outside MIN_BRIGHTNESS..max brightness
+  COMMAND_BUSY,                         // Another client holds the lease
+  COMMAND_FAILED
+};
+
+struct CalibratorLease {
+  bool held;
+  uint32_t clientID;                    // Alpaca ClientID of the holder
+  uint32_t acquiredAtMs;
+  uint32_t remainingMs;
+};
+
+struct CommandGatewayStats {
+  uint32_t accepted[COMMAND_SOURCE_COUNT];
+  uint32_t rejected[COMMAND_SOURCE_COUNT]; // Refused because of a lease
+  uint32_t leasesBroken;                // Released by an operator
+  uint32_t leasesExpired;
+};
+
+// Function prototypes
+CommandResult commandBrightness(CommandSource source, uint32_t clientID, int brightness);
+CommandResult commandCalibratorOn(CommandSource source, uint32_t clientID);
+CommandResult commandCalibratorOff(CommandSource source, uint32_t clientID);
+CommandResult commandMaxBrightness(CommandSource source, uint32_t clientID, int brightness);
+CommandResult commandPreset(CommandSource source, uint32_t clientID, const CalibratorPreset& preset);
+
+void renewCalibratorLease(uint32_t clientID);
+void releaseCalibratorLease(uint32_t clientID);
+bool breakCalibratorLease(CommandSource source);
+CalibratorLease getCalibratorLease();
+const CommandGatewayStats& getCommandGatewayStats();
+const char* getCommandSourceName(CommandSource source);
+String getCommandBusyMessage();
+
+#endif // COMMAND_GATEWAY_H
@@ -8,8 +8,14 @@
 
 #include <Arduino.h>
 
-// Debug level setting
+// Debug level setting - messages above this level are not compiled in; both
+// can also be given as build flags, e.g. -DDEBUG_LEVEL=2
+#ifndef DEBUG_LEVEL
 #define DEBUG_LEVEL 0  // 0=Off, 1=Basic, 2=Verbose
+#endif
+#ifndef LOG_CATEGORY_MASK
+#define LOG_CATEGORY_MASK 0x3F          // Bit per LogCategory in Debug.h, clear a bit to compile it out
+#endif
 
 // Version Information
 #define DEVICE_VERSION "1.0.1"
@@ -38,6 +44,20 @@ const int MIN_BRIGHTNESS = 0;           // Minimum brightness percentage
 #define AP_PASSWORD "FlatPanel123"
 #define AP_TIMEOUT 300000               // 5 minutes in milliseconds
 
+// WiFi station connection
+#define WIFI_CONNECT_TIMEOUT_MS 30000   // Fall back to AP mode if not connected by then
+#define WIFI_RECONNECT_INTERVAL_MS 30000 // Between reconnect attempts after a lost connection
+#define WIFI_FAST_CONNECT_TIMEOUT_MS 5000 // Directed connect to the cached AP before a full scan
+#define WIFI_RECONFIGURE_DELAY_MS 500   // Lets the HTTP response drain before the radio switches
+#define WIFI_RECONFIGURE_OVERLAP_MS 30000 // AP kept up after a live switch so clients can follow
+#define DHCP_LEASE_CONFIRM_TIMEOUT_MS 10000 // Cached IP given up if no DHCP server confirms it by then
+#define DHCP_LEASE_RETRY_MS 2000        // Shortest wait before an unanswered DHCP request is repeated
+#define RESTART_DELAY_MS 500            // Between a restart request and ESP.restart()
+
+// WiFi network scan
+#define WIFI_SCAN_MAX_RESULTS 16        // Distinct SSIDs kept from the last scan
+#define WIFI_SCAN_MIN_INTERVAL_MS 10000 // Scans requested sooner reuse the cached results
+
 // ASCOM Alpaca Configuration
 const int ALPACA_PORT = 11111;
 const int WEB_UI_PORT = 80;
@@ -56,11 +76,75 @@ inline const char* ALPACA_DISCOVERY_MESSAGE = "alpacadiscovery1";
 #define PREF_DEVICE_NAME "deviceName"
 #define PREF_MAX_BRIGHTNESS "maxBrightness"
 #define PREF_SERIAL_DEBUG "serialDebug"
+#define PREF_SERIAL_PERSONALITY "serialPersona"
+#define PREF_WIFI_FAST_CONNECT "wifiFastConn"
+#define PREF_WIFI_PROFILE "wifiProfile"
+#define PREF_PRESETS "presets"
 
 // Serial command settings
 #define SERIAL_BAUD_RATE 115200
 #define COMMAND_BUFFER_SIZE 64
 #define COMMAND_TIMEOUT 5000            // 5 seconds
+#define SERIAL_RX_RING_SIZE 512         // Raw input bytes held between loop passes (power of 2)
+#define SERIAL_MAX_COMMANDS_PER_PASS 8  // Commands dispatched per loop() before yielding
+#define SERIAL_BATCH_BUFFER_SIZE 256    // Combined response for ';' separated commands
+#define SERIAL_HELP_BUFFER_SIZE 1536    // HELP text rendered from the command table
+
+// Server-Sent Events stream
+#define EVENT_STREAM_MAX_CLIENTS 4      // Concurrent /events connections across both ports
+#define EVENT_STREAM_HEARTBEAT_MS 15000 // Comment line sent to idle streams
+#define EVENT_STREAM_BUFFER_SIZE 192    // One formatted state event
+#define CALIBRATOR_MAX_LISTENERS 4      // Change listeners registered with the controller
+
+// Brightness request coalescing
+#define BRIGHTNESS_APPLY_INTERVAL_MS 20 // Brightness requests within one tick are merged, last one wins
+
+// Calibrator command gateway
+#define CALIBRATOR_LEASE_MS 60000       // An Alpaca client keeps exclusive control this long after its last request
+
+// Filter presets
+#define PRESET_MAX_COUNT 12             // Named filter presets kept in NVS
+#define PRESET_NAME_SIZE 8              // Preset name including the terminator
+#define PRESET_MAX_RAMP_MS 60000        // Longest brightness ramp a preset may request
+
+// Auto-flat solver
+#define FLAT_SOLVER_MODELS 8            // Filters the auto-flat solver keeps a model for
+#define FLAT_SOLVER_FILTER_SIZE PRESET_NAME_SIZE // Filter name including the terminator, as for presets
+#define FLAT_SOLVER_TOLERANCE_PCT 3     // A frame this close to the target ADU counts as converged
+
+// Boot sequencing
+#define BOOT_MAX_PHASES 16              // Entries in the boot phase table
+
+// Deferred debug logging
+#define LOG_BUFFER_RECORDS 64           // Records held until the main loop formats them
+#define LOG_RECORD_ARG_BYTES 120        // Packed printf arguments per record, strings included
+#define LOG_LINE_SIZE 256               // One formatted record
+#define LOG_SERIAL_TX_BUFFER_SIZE 1024  // UART TX buffer the log drains into without blocking
+
+// Heap monitoring
+#define HEAP_SAMPLE_INTERVAL_MS 1000    // Largest free block sampled this often
+#define HEAP_LARGEST_BLOCK_WARN 8192    // Logged once when the largest free block drops below
+#define HEAP_ALLOC_TAGGING 0            // Count malloc/free per interface (core needs CONFIG_HEAP_USE_HOOKS)
+
+// Loop latency monitor
+#define LOOP_STAGE_BUDGET_US 20000      // Default budget of each loop() stage
+#define LOOP_PASS_BUDGET_US 50000       // Budget of a whole pass
+#define LOOP_HISTOGRAM_BUCKETS 12       // <16 us, then powers of two up to >= 16 ms
+#define LOOP_OVERRUN_HISTORY 8          // Recent overruns kept for /api/loop and LOOP
+
+// Per-client HTTP rate limiting, shared by the Alpaca and web UI ports
+#define RATE_LIMIT_PER_SECOND 30        // Sustained requests per second per remote IP, 0 = off
+#define RATE_LIMIT_BURST 60             // Requests a quiet client may send back to back
+#define RATE_LIMIT_CLIENTS 8            // Remote IPs tracked, least recently seen replaced first
+#define RATE_LIMIT_DRAIN 8              // Refused requests a server answers in one loop pass on top of a real one
+
+// HTML template rendering
+#define TEMPLATE_BUFFER_SIZE 512        // Bytes collected before an HTTP chunk is sent
+#define TEMPLATE_MAX_PLACEHOLDER 32     // Longest {{name}} accepted in a template
+
+// Alnitak serial personality
+#define ALNITAK_PRODUCT_ID 19           // Reported as a Flat-Man (no cover)
+#define ALNITAK_FIRMWARE_VERSION 101    // Three digit version for ">V000"
 
 // Enum for calibrator status - matches ASCOM CalibratorStatus values
 enum CalibratorStatus {
@@ -0,0 +1,274 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * DHCP Lease Implementation
+ */
+
+#include "dhcp_lease.h"
+#include "Debug.h"
+#include <WiFi.h>
+#include <WiFiUdp.h>
+
+static const uint16_t DHCP_SERVER_PORT = 67;
+static const uint16_t DHCP_CLIENT_PORT = 68;
+static const size_t DHCP_PACKET_SIZE = 300;       // BOOTP minimum, requests are padded to it
+static const size_t DHCP_MAX_REPLY_SIZE = 576;    // Largest reply a client must accept
+static const size_t DHCP_OPTIONS_OFFSET = 240;    // Fixed header plus magic cookie
+static const size_t DHCP_MAX_HOSTNAME = 32;
+static const uint32_t DHCP_MAX_LEASE_SECONDS = 2592000; // 30 days, keeps lease times in millis() range
+
+static const uint8_t DHCP_MAGIC_COOKIE[4] = { 99, 130, 83, 99 };
+
+// Message types, option 53
+static const uint8_t DHCP_REQUEST = 3;
+static const uint8_t DHCP_ACK = 5;
+static const uint8_t DHCP_NAK = 6;
+
+// Option codes
+static const uint8_t DHCP_OPTION_HOSTNAME = 12;
+static const uint8_t DHCP_OPTION_REQUESTED_IP = 50;
+static const uint8_t DHCP_OPTION_LEASE_TIME = 51;
+static const uint8_t DHCP_OPTION_MESSAGE_TYPE = 53;
+static const uint8_t DHCP_OPTION_SERVER_ID = 54;
+static const uint8_t DHCP_OPTION_PARAMETERS = 55;
+static const uint8_t DHCP_OPTION_RENEWAL_TIME = 58;
+static const uint8_t DHCP_OPTION_REBINDING_TIME = 59;
+static const uint8_t DHCP_OPTION_PAD = 0;
+static const uint8_t DHCP_OPTION_END = 255;
+
+static WiFiUDP dhcpUdp;
+static DhcpLeaseState leaseState = DHCP_LEASE_IDLE;
+static IPAddress leaseAddress;
+static IPAddress leaseServer;                     // Server that granted the lease, asked first at T1
+static uint8_t clientMac[6];
+static uint32_t transactionId = 0;
+static unsigned long requestStart = 0;            // millis() when the INIT-REBOOT request began
+static unsigned long leaseStart = 0;              // millis() of the latest ACK
+static uint32_t leaseSeconds = 0;
+static uint32_t renewSeconds = 0;                 // T1
+static uint32_t rebindSeconds = 0;                // T2
+static unsigned long lastSendTime = 0;
+static unsigned long retryDelay = 0;              // Until the current request is repeated
+
+static void writeAddress(uint8_t* target, IPAddress address) {
+  for (int i = 0; i < 4; i++) {
+    target[i] = address[i];
+  }
+}
+
+static uint32_t readUint32(const uint8_t* source) {
+  return ((uint32_t)source[0] << 24) | ((uint32_t)source[1] << 16) | ((uint32_t)source[2] << 8) | source[3];
+}
+
+// Each exchange gets a fresh transaction ID and goes out at the next handleDhcpLease()
+static void enterLeaseState(DhcpLeaseState state) {
+  leaseState = state;
+  transactionId = (uint32_t)random(1, 0x7FFFFFFF);
+  lastSendTime = millis();
+  retryDelay = 0;
+}
+
+// INIT-REBOOT names the address in option 50 and is broadcast; renewing and
+// rebinding put it in ciaddr, and a renewal goes only to the granting server
+static void sendLeaseRequest() {
+  uint8_t packet[DHCP_PACKET_SIZE] = {};
+  bool initReboot = leaseState == DHCP_LEASE_REQUESTING;
+
+  packet[0] = 1;                        // BOOTREQUEST
+  packet[1] = 1;                        // Ethernet
+  packet[2] = sizeof(clientMac);
+  packet[4] = transactionId >> 24;
+  packet[5] = transactionId >> 16;
+  packet[6] = transactionId >> 8;
+  packet[7] = transactionId;
+  if (!initReboot) {
+    writeAddress(&packet[12], leaseAddress);
+  }
+  memcpy(&packet[28], clientMac, sizeof(clientMac));
+  memcpy(&packet[236], DHCP_MAGIC_COOKIE, sizeof(DHCP_MAGIC_COOKIE));
+
+  size_t offset = DHCP_OPTIONS_OFFSET;
+  packet[offset++] = DHCP_OPTION_MESSAGE_TYPE;
+  packet[offset++] = 1;
+  packet[offset++] = DHCP_REQUEST;
+  if (initReboot) {
+    packet[offset++] = DHCP_OPTION_REQUESTED_IP;
+    packet[offset++] = 4;
+    writeAddress(&packet[offset], leaseAddress);
+    offset += 4;
+  }
+  const char* hostname = WiFi.getHostname();
+  size_t hostnameLength = hostname != nullptr ? strnlen(hostname, DHCP_MAX_HOSTNAME) : 0;
+  if (hostnameLength > 0) {
+    packet[offset++] = DHCP_OPTION_HOSTNAME;
+    packet[offset++] = hostnameLength;
+    memcpy(&packet[offset], hostname, hostnameLength);
+    offset += hostnameLength;
+  }
+  packet[offset++] = DHCP_OPTION_PARAMETERS;
+  packet[offset++] = 3;
+  packet[offset++] = DHCP_OPTION_LEASE_TIME;
+  packet[offset++] = DHCP_OPTION_RENEWAL_TIME;
+  packet[offset++] = DHCP_OPTION_REBINDING_TIME;
+  packet[offset++] = DHCP_OPTION_END;
+
+  IPAddress destination = leaseState == DHCP_LEASE_RENEWING ? leaseServer : IPAddress(255, 255, 255, 255);
+  dhcpUdp.beginPacket(destination, DHCP_SERVER_PORT);
+  dhcpUdp.write(packet, sizeof(packet));
+  dhcpUdp.endPacket();
+}
+
+// Deadline of the current exchange: giving up, T2, or the end of the lease
+static unsigned long getLeaseDeadline() {
+  switch (leaseState) {
+    case DHCP_LEASE_REQUESTING: return requestStart + DHCP_LEASE_CONFIRM_TIMEOUT_MS;
+    case DHCP_LEASE_RENEWING:   return leaseStart + rebindSeconds * 1000UL;
+    default:                    return leaseStart + leaseSeconds * 1000UL;
+  }
+}
+
+// Timers default to RFC 2131's 50% and 87.5% of the lease when the server leaves them out
+static void onLeaseAck(IPAddress server, uint32_t lease, uint32_t renew, uint32_t rebind) {
+  leaseSeconds = lease == 0 || lease > DHCP_MAX_LEASE_SECONDS ? DHCP_MAX_LEASE_SECONDS : lease;
+  renewSeconds = renew > 0 && renew < leaseSeconds ? renew : leaseSeconds / 2;
+  rebindSeconds = rebind > renewSeconds && rebind < leaseSeconds ? rebind : leaseSeconds - leaseSeconds / 8;
+  if (rebindSeconds <= renewSeconds) {
+    rebindSeconds = renewSeconds + 1;
+  }
+  leaseServer = server;
+  leaseStart = millis();
+  if (leaseState == DHCP_LEASE_REQUESTING) {
+    LOG_INFO(LOG_CAT_WIFI, "DHCP confirmed %s for %lu s\n", leaseAddress.toString().c_str(), (unsigned long)leaseSeconds);
+  } else {
+    LOG_VERBOSE(LOG_CAT_WIFI, "DHCP lease renewed for %lu s\n", (unsigned long)leaseSeconds);
+  }
+  leaseState = DHCP_LEASE_BOUND;
+}
+
+static void handleLeaseReply(const uint8_t* packet, size_t length) {
+  if (length < DHCP_OPTIONS_OFFSET || packet[0] != 2 || readUint32(&packet[4]) != transactionId ||
+      memcmp(&packet[28], clientMac, sizeof(clientMac)) != 0 ||
+      memcmp(&packet[236], DHCP_MAGIC_COOKIE, sizeof(DHCP_MAGIC_COOKIE)) != 0) {
+    return;
+  }
+
+  uint8_t type = 0;
+  uint32_t lease = 0;
+  uint32_t renew = 0;
+  uint32_t rebind = 0;
+  IPAddress server = dhcpUdp.remoteIP();
+  size_t offset = DHCP_OPTIONS_OFFSET;
+  while (offset < length && packet[offset] != DHCP_OPTION_END) {
+    if (packet[offset] == DHCP_OPTION_PAD) {
+      offset++;
+      continue;
+    }
+    if (offset + 2 > length || offset + 2 + packet[offset + 1] > length) {
+      return;
+    }
+    uint8_t code = packet[offset];
+    uint8_t size = packet[offset + 1];
+    const uint8_t* value = &packet[offset + 2];
+    if (code == DHCP_OPTION_MESSAGE_TYPE && size == 1) {
+      type = value[0];
+    } else if (code == DHCP_OPTION_SERVER_ID && size == 4) {
+      server = IPAddress(value[0], value[1], value[2], value[3]);
+    } else if (code == DHCP_OPTION_LEASE_TIME && size == 4) {
+      lease = readUint32(value);
+    } else if (code == DHCP_OPTION_RENEWAL_TIME && size == 4) {
+      renew = readUint32(value);
+    } else if (code == DHCP_OPTION_REBINDING_TIME && size == 4) {
+      rebind = readUint32(value);
+    }
+    offset += 2 + size;
+  }
+
+  IPAddress offered(packet[16], packet[17], packet[18], packet[19]);
+  if (type == DHCP_NAK) {
+    LOG_INFO(LOG_CAT_WIFI, "DHCP server refused %s\n", leaseAddress.toString().c_str());
+    leaseState = DHCP_LEASE_FAILED;
+  } else if (type == DHCP_ACK && (uint32_t)offered != (uint32_t)leaseAddress) {
+    LOG_INFO(LOG_CAT_WIFI, "DHCP server answered with %s instead of %s\n", offered.toString().c_str(),
+             leaseAddress.toString().c_str());
+    leaseState = DHCP_LEASE_FAILED;
+  } else if (type == DHCP_ACK) {
+    onLeaseAck(server, lease, renew, rebind);
+  }
+}
+
+// Ask for a lease on the address the interface is already configured with
+void startDhcpLease(IPAddress address) {
+  stopDhcpLease();
+  leaseAddress = address;
+  leaseSeconds = 0;
+  WiFi.macAddress(clientMac);
+  if (!dhcpUdp.begin(DHCP_CLIENT_PORT)) {
+    LOG_INFO(LOG_CAT_WIFI, "DHCP client port busy, cannot confirm %s\n", address.toString().c_str());
+    leaseState = DHCP_LEASE_FAILED;
+    return;
+  }
+  requestStart = millis();
+  enterLeaseState(DHCP_LEASE_REQUESTING);
+}
+
+// Release the client port, e.g. before the ESP32's own DHCP client takes over
+void stopDhcpLease() {
+  if (leaseState != DHCP_LEASE_IDLE) {
+    dhcpUdp.stop();
+  }
+  leaseState = DHCP_LEASE_IDLE;
+}
+
+// Read replies, move through T1 and T2 and repeat unanswered requests; call from loop()
+DhcpLeaseState handleDhcpLease() {
+  if (leaseState == DHCP_LEASE_IDLE || leaseState == DHCP_LEASE_FAILED) {
+    return leaseState;
+  }
+
+  uint8_t reply[DHCP_MAX_REPLY_SIZE];
+  while (dhcpUdp.parsePacket() > 0) {
+    int length = dhcpUdp.read(reply, sizeof(reply));
+    if (length > 0) {
+      handleLeaseReply(reply, length);
+    }
+  }
+  if (leaseState == DHCP_LEASE_FAILED) {
+    return leaseState;
+  }
+
+  unsigned long now = millis();
+  if (leaseState == DHCP_LEASE_REQUESTING) {
+    if (now - requestStart >= DHCP_LEASE_CONFIRM_TIMEOUT_MS) {
+      LOG_INFO(LOG_CAT_WIFI, "No DHCP server confirmed %s\n", leaseAddress.toString().c_str());
+      leaseState = DHCP_LEASE_FAILED;
+      return leaseState;
+    }
+  } else {
+    unsigned long elapsed = now - leaseStart;
+    if (elapsed >= leaseSeconds * 1000UL) {
+      LOG_INFO(LOG_CAT_WIFI, "DHCP lease on %s expired\n", leaseAddress.toString().c_str());
+      leaseState = DHCP_LEASE_FAILED;
+      return leaseState;
+    }
+    if (elapsed >= rebindSeconds * 1000UL && leaseState != DHCP_LEASE_REBINDING) {
+      enterLeaseState(DHCP_LEASE_REBINDING);
+    } else if (elapsed >= renewSeconds * 1000UL && leaseState == DHCP_LEASE_BOUND) {
+      enterLeaseState(DHCP_LEASE_RENEWING);
+    }
+  }
+
+  // Repeat after half the time left, as RFC 2131 suggests, but not in a burst
+  if (leaseState != DHCP_LEASE_BOUND && now - lastSendTime >= retryDelay) {
+    sendLeaseRequest();
+    lastSendTime = now;
+    retryDelay = (getLeaseDeadline() - now) / 2;
+    if (retryDelay < DHCP_LEASE_RETRY_MS) {
+      retryDelay = DHCP_LEASE_RETRY_MS;
+    }
+  }
+  return leaseState;
+}
+
+// Length of the current lease, 0 until one is confirmed
+uint32_t getDhcpLeaseSeconds() {
+  return leaseState == DHCP_LEASE_IDLE || leaseState == DHCP_LEASE_FAILED ? 0 : leaseSeconds;
+}
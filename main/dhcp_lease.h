@@ -0,0 +1,35 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * DHCP Lease Header
+ *
+ * Keeps a DHCP lease on the address a fast connect configured statically.
+ * Restarting the ESP32's own DHCP client would clear that address first, so
+ * this module asks for the lease itself: a DHCPREQUEST for the cached address
+ * (RFC 2131 INIT-REBOOT) while the interface keeps using it, then renewals at
+ * T1 and T2. Clients never see the address go away unless the server refuses
+ * it, stays silent or lets the lease run out; then the caller hands the
+ * interface back to the normal DHCP client.
+ */
+
+#ifndef DHCP_LEASE_H
+#define DHCP_LEASE_H
+
+#include <Arduino.h>
+#include "config.h"
+
+enum DhcpLeaseState {
+  DHCP_LEASE_IDLE,                      // Not started or stopped
+  DHCP_LEASE_REQUESTING,                // Asked for the cached address, no answer yet
+  DHCP_LEASE_BOUND,                     // Server confirmed the address
+  DHCP_LEASE_RENEWING,                  // Past T1, asking the server that granted the lease
+  DHCP_LEASE_REBINDING,                 // Past T2, asking any server
+  DHCP_LEASE_FAILED                     // Refused, unanswered or expired: the address must go
+};
+
+// Function prototypes
+void startDhcpLease(IPAddress address);
+void stopDhcpLease();
+DhcpLeaseState handleDhcpLease();
+uint32_t getDhcpLeaseSeconds();
+
+#endif // DHCP_LEASE_H
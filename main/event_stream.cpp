@@ -0,0 +1,109 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Server-Sent Events Stream Implementation
+ */
+
+#include "event_stream.h"
+#include "calibrator_controller.h"
+#include "heap_monitor.h"
+#include "Debug.h"
+#include <WiFi.h>
+
+static WiFiClient eventClients[EVENT_STREAM_MAX_CLIENTS];
+static bool eventPending = false;
+static unsigned long lastHeartbeat = 0;
+
+// Called by the controller on every state change; the event goes out from the loop
+static void onCalibratorChange() {
+  eventPending = true;
+}
+
+void initEventStream() {
+  addCalibratorChangeListener(onCalibratorChange);
+}
+
+static size_t formatStateEvent(char* buffer, size_t size) {
+  int length = snprintf(buffer, size,
+    "event: state\n"
+    "data: {\"brightness\":%d,\"maxBrightness\":%d,\"state\":\"%s\",\"calibratorState\":%d,\"connected\":%s}\n\n",
+    getCurrentBrightness(), getMaxBrightness(), getCalibratorStateString().c_str(),
+    (int)getCalibratorState(), isConnected ? "true" : "false");
+  return length > 0 ? min((size_t)length, size - 1) : 0;
+}
+
+// Write to every open stream, releasing the slots of clients that went away
+static void broadcast(const char* data, size_t length) {
+  for (int i = 0; i < EVENT_STREAM_MAX_CLIENTS; i++) {
+    if (!eventClients[i]) continue;
+    if (!eventClients[i].connected() || eventClients[i].write((const uint8_t*)data, length) != length) {
+      eventClients[i].stop();
+      eventClients[i] = WiFiClient();
+    }
+  }
+}
+
+void handleEventStream() {
+  HeapScope heapScope(HEAP_IF_EVENTS);
+  if (eventPending) {
+    eventPending = false;
+    char event[EVENT_STREAM_BUFFER_SIZE];
+    size_t length = formatStateEvent(event, sizeof(event));
+    broadcast(event, length);
+    lastHeartbeat = millis();
+  } else if (millis() - lastHeartbeat > EVENT_STREAM_HEARTBEAT_MS) {
+    static const char heartbeat[] = ": ping\n\n";
+    broadcast(heartbeat, sizeof(heartbeat) - 1);
+    lastHeartbeat = millis();
+  }
+}
+
+// Take over the current request's connection as an event stream
+void handleEventStreamRequest(WebServer& server) {
+  int slot = -1;
+  for (int i = 0; i < EVENT_STREAM_MAX_CLIENTS; i++) {
+    if (!eventClients[i] || !eventClients[i].connected()) {
+      slot = i;
+      break;
+    }
+  }
+  
+  if (slot < 0) {
+    server.sendHeader("Retry-After", "10");
+    server.send(503, "text/plain", "Too many event stream clients");
+    return;
+  }
+  
+  WiFiClient client = server.client();
+  client.setNoDelay(true);
+  client.print(
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: text/event-stream\r\n"
+    "Cache-Control: no-cache\r\n"
+    "Connection: keep-alive\r\n"
+    "Access-Control-Allow-Origin: *\r\n"
+    "\r\n"
+    "retry: 3000\n\n");
+  
+  // Start the client from the current state
+  char event[EVENT_STREAM_BUFFER_SIZE];
+  size_t length = formatStateEvent(event, sizeof(event));
+  client.write((const uint8_t*)event, length);
+  
+  eventClients[slot] = client;
+  
+  // The stream lives on in eventClients. Drop the server's reference, or it
+  // would wait for this connection to close (HC_WAIT_CLOSE) and accept no
+  // other client meanwhile.
+  server.client() = WiFiClient();
+  LOG_VERBOSE(LOG_CAT_WEB, "Event stream client %d connected from %s\n", slot, client.remoteIP().toString().c_str());
+}
+
+int getEventStreamClientCount() {
+  int count = 0;
+  for (int i = 0; i < EVENT_STREAM_MAX_CLIENTS; i++) {
+    if (eventClients[i] && eventClients[i].connected()) {
+      count++;
+    }
+  }
+  return count;
+}
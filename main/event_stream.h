@@ -0,0 +1,21 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Server-Sent Events Stream Header
+ *
+ * GET /events keeps the connection open and pushes a "state" event whenever the
+ * calibrator changes, plus a comment heartbeat so idle proxies keep it alive.
+ */
+
+#ifndef EVENT_STREAM_H
+#define EVENT_STREAM_H
+
+#include <WebServer.h>
+#include "config.h"
+
+// Function prototypes
+void initEventStream();
+void handleEventStream();
+void handleEventStreamRequest(WebServer& server);
+int getEventStreamClientCount();
+
+#endif // EVENT_STREAM_H
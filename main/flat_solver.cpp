@@ -0,0 +1,123 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Auto-Flat Brightness Solver Implementation
+ */
+
+#include "flat_solver.h"
+#include "calibrator_controller.h"
+#include "Debug.h"
+
+struct FlatModel {
+  char filter[FLAT_SOLVER_FILTER_SIZE];
+  uint8_t frames;
+  uint8_t points;                       // Valid entries in brightness/rate, newest last
+  float brightness[2];
+  float rate[2];                        // ADU above bias per second
+  float slope;                          // Rate per percent, 0 until two frames differ in brightness
+  unsigned long usedAt;
+};
+
+static FlatModel models[FLAT_SOLVER_MODELS];
+
+// Model for the filter, replacing the least recently used one if needed
+static FlatModel& findFlatModel(const char* filter) {
+  FlatModel* oldest = &models[0];
+  for (int i = 0; i < FLAT_SOLVER_MODELS; i++) {
+    if (models[i].filter[0] != '\0' && strcasecmp(models[i].filter, filter) == 0) {
+      return models[i];
+    }
+    if (models[i].usedAt < oldest->usedAt || models[i].filter[0] == '\0') {
+      oldest = &models[i];
+    }
+  }
+  *oldest = FlatModel();
+  strncpy(oldest->filter, filter, sizeof(oldest->filter) - 1);
+  return *oldest;
+}
+
+// Predicted rate at brightness from the newest frame and the slope if known,
+// otherwise proportional to brightness
+static float predictRate(const FlatModel& model, float brightness) {
+  float lastBrightness = model.brightness[model.points - 1];
+  float lastRate = model.rate[model.points - 1];
+  if (model.slope > 0) {
+    return lastRate + model.slope * (brightness - lastBrightness);
+  }
+  return lastBrightness > 0 ? lastRate * brightness / lastBrightness : 0;
+}
+
+bool solveFlatStep(const FlatFrame& frame, FlatStep& step) {
+  if (frame.filter == nullptr || frame.filter[0] == '\0' || strlen(frame.filter) >= FLAT_SOLVER_FILTER_SIZE ||
+      frame.exposureS <= 0 || frame.targetAdu <= frame.biasAdu ||
+      frame.brightness < MIN_BRIGHTNESS || frame.brightness > MAX_BRIGHTNESS) {
+    return false;
+  }
+
+  FlatModel& model = findFlatModel(frame.filter);
+  model.usedAt = millis();
+  if (model.frames < 255) {
+    model.frames++;
+  }
+
+  // A repeat at the same brightness refreshes the newest point instead of
+  // pushing out the one the secant needs
+  float rate = max(0.0f, frame.medianAdu - frame.biasAdu) / frame.exposureS;
+  if (model.points > 0 && model.brightness[model.points - 1] == frame.brightness) {
+    model.rate[model.points - 1] = rate;
+  } else {
+    if (model.points == 2) {
+      model.brightness[0] = model.brightness[1];
+      model.rate[0] = model.rate[1];
+      model.points = 1;
+    }
+    model.brightness[model.points] = frame.brightness;
+    model.rate[model.points] = rate;
+    model.points++;
+  }
+
+  // Secant slope; a flat or falling one is noise and keeps the previous slope
+  if (model.points == 2) {
+    float slope = (model.rate[1] - model.rate[0]) / (model.brightness[1] - model.brightness[0]);
+    if (slope > 0) {
+      model.slope = slope;
+    }
+  }
+
+  float targetRate = (frame.targetAdu - frame.biasAdu) / frame.exposureS;
+  float error = fabsf(frame.medianAdu - frame.targetAdu) / (frame.targetAdu - frame.biasAdu);
+  step.converged = error * 100 <= FLAT_SOLVER_TOLERANCE_PCT;
+  step.frames = model.frames;
+
+  float next = frame.brightness;
+  if (!step.converged) {
+    if ((rate <= 0 || frame.brightness == 0) && model.slope <= 0) {
+      // Nothing to scale from yet: try half of the allowed range, then double
+      next = frame.brightness > 0 ? frame.brightness * 2.0f : getMaxBrightness() / 2.0f;
+    } else if (model.slope > 0) {
+      next = frame.brightness + (targetRate - rate) / model.slope;
+    } else {
+      next = frame.brightness * targetRate / rate;
+    }
+  }
+
+  int maxBrightness = getMaxBrightness();
+  step.brightness = constrain((int)lroundf(next), 1, maxBrightness);
+  float predicted = predictRate(model, step.brightness);
+  step.predictedAdu = frame.biasAdu + predicted * frame.exposureS;
+  step.exposureS = predicted > 0 ? targetRate * frame.exposureS / predicted : frame.exposureS;
+
+  LOG_INFO(LOG_CAT_CALIBRATOR, "Auto-flat %s frame %u: %d%% gave %d ADU, next %d%% (%d ADU predicted)%s\n",
+           model.filter, model.frames, frame.brightness, (int)frame.medianAdu, step.brightness,
+           (int)step.predictedAdu, step.converged ? ", converged" : "");
+  return true;
+}
+
+// Forget the frames but keep the slope, which carries over to the next session
+void resetFlatModel(const char* filter) {
+  for (int i = 0; i < FLAT_SOLVER_MODELS; i++) {
+    if (models[i].filter[0] != '\0' && strcasecmp(models[i].filter, filter) == 0) {
+      models[i].points = 0;
+      models[i].frames = 0;
+    }
+  }
+}
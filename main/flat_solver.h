@@ -0,0 +1,43 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Auto-Flat Brightness Solver Header
+ *
+ * An auto-flat routine reports the median ADU and exposure of each test
+ * frame, and the solver returns the brightness for the next one. Per filter
+ * it keeps the last two frames as flux rate (ADU above bias per second)
+ * against brightness. The next brightness is a secant step through those two
+ * frames, or a Newton step with the slope remembered from earlier frames.
+ * With one frame and no slope yet it assumes flux is proportional to
+ * brightness. Brightness moves in whole percent, so the solver also suggests
+ * the exposure that makes up the rounding, or the clamp at minimum or
+ * maximum brightness.
+ */
+
+#ifndef FLAT_SOLVER_H
+#define FLAT_SOLVER_H
+
+#include <Arduino.h>
+#include "config.h"
+
+struct FlatFrame {
+  const char* filter;                   // Model key, usually the preset name
+  float medianAdu;
+  float exposureS;
+  float targetAdu;
+  float biasAdu;                        // Camera offset, 0 if unknown
+  int brightness;                       // Brightness the frame was taken at
+};
+
+struct FlatStep {
+  int brightness;                       // For the next frame
+  float exposureS;                      // Suggested exposure at that brightness
+  float predictedAdu;                   // At brightness with the frame's exposure
+  bool converged;                       // Frame already within FLAT_SOLVER_TOLERANCE_PCT
+  uint8_t frames;                       // Frames seen for this filter
+};
+
+// Function prototypes
+bool solveFlatStep(const FlatFrame& frame, FlatStep& step);
+void resetFlatModel(const char* filter);
+
+#endif // FLAT_SOLVER_H
@@ -0,0 +1,105 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Heap Monitor Implementation
+ */
+
+#include "heap_monitor.h"
+#include "Debug.h"
+#include <esp_heap_caps.h>
+
+static const char* const interfaceNames[HEAP_IF_COUNT] = {
+  "system", "alpaca", "web", "serial", "events"
+};
+
+static HeapInterfaceStats interfaceStats[HEAP_IF_COUNT];
+static volatile HeapInterface activeInterface = HEAP_IF_SYSTEM;
+static TaskHandle_t loopTask = nullptr;
+static uint32_t minLargestFreeBlock = UINT32_MAX;
+static unsigned long lastSampleTime = 0;
+static bool lowBlockReported = false;
+
+HeapScope::HeapScope(HeapInterface interface)
+  : interface(interface), previous(activeInterface),
+    freeAtStart(heap_caps_get_free_size(MALLOC_CAP_8BIT)),
+    minFreeAtStart(heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT)) {
+  activeInterface = interface;
+}
+
+HeapScope::~HeapScope() {
+  HeapInterfaceStats& stats = interfaceStats[interface];
+  stats.retainedBytes += (int32_t)(freeAtStart - heap_caps_get_free_size(MALLOC_CAP_8BIT));
+  if (heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT) < minFreeAtStart) {
+    stats.lowWaterMarks++;
+  }
+  activeInterface = previous;
+}
+
+#if HEAP_ALLOC_TAGGING
+// Called by the heap on every allocation, from any task and with the heap
+// locked: count and return. Allocations by the WiFi and lwIP tasks are not
+// charged to whatever the loop happens to be running.
+extern "C" void esp_heap_trace_alloc_hook(void* ptr, size_t size, uint32_t caps) {
+  if (xTaskGetCurrentTaskHandle() == loopTask) {
+    interfaceStats[activeInterface].allocations++;
+  }
+}
+
+extern "C" void esp_heap_trace_free_hook(void* ptr) {
+  if (xTaskGetCurrentTaskHandle() == loopTask) {
+    interfaceStats[activeInterface].frees++;
+  }
+}
+#endif
+
+void initHeapMonitor() {
+  loopTask = xTaskGetCurrentTaskHandle();
+  minLargestFreeBlock = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+  lastSampleTime = millis();
+}
+
+// The largest free block is not tracked by the heap itself; sample it
+void handleHeapMonitor() {
+  if (millis() - lastSampleTime < HEAP_SAMPLE_INTERVAL_MS) {
+    return;
+  }
+  lastSampleTime = millis();
+
+  uint32_t largestFreeBlock = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+  if (largestFreeBlock < minLargestFreeBlock) {
+    minLargestFreeBlock = largestFreeBlock;
+  }
+
+  if (largestFreeBlock < HEAP_LARGEST_BLOCK_WARN && !lowBlockReported) {
+    lowBlockReported = true;
+    LOG_INFO(LOG_CAT_SYSTEM, "Heap fragmented: largest free block %lu bytes, %lu free\n",
+             (unsigned long)largestFreeBlock, (unsigned long)heap_caps_get_free_size(MALLOC_CAP_8BIT));
+  } else if (largestFreeBlock >= 2 * HEAP_LARGEST_BLOCK_WARN) {
+    lowBlockReported = false;
+  }
+}
+
+// Walks the whole heap; for status requests, not for every loop pass
+HeapStats getHeapStats() {
+  multi_heap_info_t info;
+  heap_caps_get_info(&info, MALLOC_CAP_8BIT);
+  if (info.largest_free_block < minLargestFreeBlock) {
+    minLargestFreeBlock = info.largest_free_block;
+  }
+
+  HeapStats stats;
+  stats.freeBytes = info.total_free_bytes;
+  stats.largestFreeBlock = info.largest_free_block;
+  stats.minFreeBytes = info.minimum_free_bytes;
+  stats.minLargestFreeBlock = minLargestFreeBlock;
+  stats.allocatedBlocks = info.allocated_blocks;
+  stats.freeBlocks = info.free_blocks;
+  return stats;
+}
+
+const HeapInterfaceStats& getHeapInterfaceStats(HeapInterface interface) {
+  return interfaceStats[interface];
+}
+
+const char* getHeapInterfaceName(HeapInterface interface) {
+  return interfaceNames[interface];
+}
@@ -0,0 +1,66 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Heap Monitor Header
+ *
+ * Tracks free heap, the largest free block and their low-water marks, and
+ * charges heap use to the interface whose handler was running: Alpaca, the
+ * web UI, serial or the event stream. Each handler call is wrapped in a
+ * HeapScope; the free heap it leaves behind is added to that interface.
+ *
+ * With HEAP_ALLOC_TAGGING every malloc/free is also counted against the
+ * active interface. That needs an Arduino core built with
+ * CONFIG_HEAP_USE_HOOKS; otherwise the counts stay at zero.
+ */
+
+#ifndef HEAP_MONITOR_H
+#define HEAP_MONITOR_H
+
+#include <Arduino.h>
+#include "config.h"
+
+enum HeapInterface {
+  HEAP_IF_SYSTEM,                       // Anything outside a HeapScope
+  HEAP_IF_ALPACA,                       // Alpaca API and discovery
+  HEAP_IF_WEB,                          // Web UI server
+  HEAP_IF_SERIAL,                       // Serial command handling
+  HEAP_IF_EVENTS,                       // Event stream pushes
+  HEAP_IF_COUNT
+};
+
+struct HeapInterfaceStats {
+  int32_t retainedBytes;                // Net free heap consumed by this interface's handlers
+  uint32_t allocations;                 // malloc calls while active (HEAP_ALLOC_TAGGING)
+  uint32_t frees;                       // free calls while active (HEAP_ALLOC_TAGGING)
+  uint32_t lowWaterMarks;               // Handler calls that set a new minimum free heap
+};
+
+struct HeapStats {
+  uint32_t freeBytes;
+  uint32_t largestFreeBlock;            // Biggest single allocation that would succeed now
+  uint32_t minFreeBytes;                // Lowest free heap since boot
+  uint32_t minLargestFreeBlock;         // Lowest largest free block seen by the periodic sample
+  uint32_t allocatedBlocks;
+  uint32_t freeBlocks;                  // Many small free blocks = fragmentation
+};
+
+// Scope guard that charges heap use to an interface
+class HeapScope {
+public:
+  explicit HeapScope(HeapInterface interface);
+  ~HeapScope();
+
+private:
+  HeapInterface interface;
+  HeapInterface previous;
+  uint32_t freeAtStart;
+  uint32_t minFreeAtStart;
+};
+
+// Function prototypes
+void initHeapMonitor();
+void handleHeapMonitor();
+HeapStats getHeapStats();
+const HeapInterfaceStats& getHeapInterfaceStats(HeapInterface interface);
+const char* getHeapInterfaceName(HeapInterface interface);
+
+#endif // HEAP_MONITOR_H
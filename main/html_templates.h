@@ -1,6 +1,10 @@
 /*
  * ESP32 ASCOM Alpaca Flat Panel Calibrator
  * HTML Page Templates
+ *
+ * Templates are stored in flash and streamed by TemplateRenderer. Each page has
+ * a resolver for its own placeholders that falls back to resolveCommonField()
+ * for the shared ones ({{head}}, {{nav}}, device and calibrator values).
  */
 
 #ifndef HTML_TEMPLATES_H
@@ -11,396 +15,357 @@
 #include "config.h"
 #include "calibrator_controller.h"
 #include "alpaca_handler.h"
+#include "web_assets.h"
+#include "web_ui_handler.h"
+#include "template_renderer.h"
+#include "wifi_scan.h"
+#include "wifi_manager.h"
+#include "preset_manager.h"
 
-// Function prototypes
-String getPageHeader(String pageTitle);
-String getNavBar();
-String getCommonStyles();
-String getHomePage();
-String getSetupPage();
-String getCalibratorPage();
-String getWifiConfigPage();
+// Common HTML page header - pages open their own <body>
+inline const char PAGE_HEAD_TEMPLATE[] PROGMEM =
+  "<!DOCTYPE html><html>\n"
+  "<head><title>{{title}}</title>\n"
+  "<meta name='viewport' content='width=device-width, initial-scale=1'>\n"
+  "<link rel='stylesheet' href='" WEB_ASSET_APP_CSS_PATH "'>\n"
+  "<script src='" WEB_ASSET_APP_JS_PATH "' defer></script>\n"
+  "</head>\n";
 
-// Common CSS styles used across pages
-inline String getCommonStyles() {
-  String styles = 
-    "body { font-family: Arial, sans-serif; margin: 20px; background-color: #f0f8ff; }\n"
-    "h1, h2 { color: #2c3e50; }\n"
-    "a { color: #3498db; text-decoration: none; }\n"
-    "a:hover { text-decoration: underline; }\n"
-    ".container { max-width: 800px; margin: 0 auto; background-color: white; padding: 20px; border-radius: 10px; box-shadow: 0 2px 10px rgba(0,0,0,0.1); }\n"
-    ".card { background: #f8f9fa; border-radius: 4px; padding: 15px; margin-bottom: 20px; box-shadow: 0 2px 4px rgba(0,0,0,0.1); }\n"
-    ".nav-bar { margin-bottom: 20px; padding: 10px; background-color: #f8f9fa; border-radius: 4px; box-shadow: 0 2px 4px rgba(0,0,0,0.1); }\n"
-    ".nav-button { display: inline-block; margin: 5px; padding: 8px 15px; background-color: #3498db; color: white; border-radius: 4px; text-decoration: none; }\n"
-    ".nav-button:hover { background-color: #2980b9; text-decoration: none; color: white; }\n"
-    "label { display: block; margin-bottom: 5px; font-weight: bold; }\n"
-    "input[type=text], input[type=password], input[type=number] { width: 100%; padding: 8px; margin-bottom: 15px; border: 1px solid #ddd; border-radius: 4px; box-sizing: border-box; }\n"
-    "input[type=range] { width: 100%; margin: 10px 0; }\n"
-    "input[type=submit], button { background: #3498db; color: white; border: none; padding: 10px 15px; border-radius: 4px; cursor: pointer; margin: 5px; }\n"
-    "input[type=submit]:hover, button:hover { background: #2980b9; }\n"
-    "table { border-collapse: collapse; width: 100%; }\n"
-    "table, th, td { border: 1px solid #ddd; }\n"
-    "th, td { padding: 8px; text-align: left; }\n"
-    "th { background-color: #f2f2f2; }\n"
-    ".status-on { color: green; font-weight: bold; }\n"
-    ".status-off { color: red; font-weight: bold; }\n"
-    ".status-ready { color: blue; font-weight: bold; }\n"
-    ".status-error { color: darkred; font-weight: bold; }\n"
-    ".button-row { display: flex; flex-wrap: wrap; gap: 10px; margin-top: 15px; }\n"
-    ".button-primary { background-color: #3498db; }\n"
-    ".button-success { background-color: #2ecc71; }\n"
-    ".button-warning { background-color: #f39c12; }\n"
-    ".button-danger { background-color: #e74c3c; }\n"
-    ".brightness-control { margin: 20px 0; }\n"
-    ".brightness-display { font-size: 24px; font-weight: bold; margin: 10px 0; }\n"
-    ".success { color: green; font-weight: bold; }\n"
-    ".error { color: red; font-weight: bold; }\n"
-    ".center { text-align: center; }\n";
-  
-  return styles;
-}
+// Navigation links
+inline const char NAV_BAR_TEMPLATE[] PROGMEM = R"HTML(<div class='nav-bar'>
+<a href='/' class='nav-button'>Home</a>
+<a href='/calibrator' class='nav-button'>Calibrator</a>
+<a href='/setup' class='nav-button'>Setup</a>
+<a href='/wificonfig' class='nav-button'>WiFi Config</a>
+<a href='{{alpacaUrl}}/setup/v1/covercalibrator/0/setup' class='nav-button'>ASCOM Controls</a>
+</div>
+)HTML";
 
-// Common HTML page header
-inline String getPageHeader(String pageTitle) {
-  String header = "<!DOCTYPE html><html>\n"
-    "<head><title>" + pageTitle + "</title>\n"
-    "<meta name='viewport' content='width=device-width, initial-scale=1'>\n"
-    "<style>\n" + 
-    getCommonStyles() + 
-    "</style>\n"
-    "</head>\n"
-    "<body>\n"
-    "<div class='container'>\n";
-  
-  return header;
-}
+// Home page
+inline const char HOME_PAGE_TEMPLATE[] PROGMEM = R"HTML({{head}}<body>
+<div class='container'>
+<h1>ESP32 Flat Panel Calibrator</h1>
+<p>Version: {{version}}</p>
+{{nav}}<div class='card'>
+<h2>Current Status</h2>
+<table>
+<tr><td>Device Name</td><td>{{deviceName}}</td></tr>
+<tr><td>Firmware Version</td><td>{{version}}</td></tr>
+<tr><td>Unique ID</td><td>{{uniqueID}}</td></tr>
+<tr><td>IP Address</td><td>{{ip}}</td></tr>
+<tr><td>Calibrator State</td><td id='stateCell' class='{{stateClass}}'>{{state}}</td></tr>
+<tr><td>Current Brightness</td><td id='brightnessCell'>{{brightness}}%</td></tr>
+<tr><td>Max Brightness</td><td id='maxBrightnessCell'>{{maxBrightness}}%</td></tr>
+<tr><td>Connected</td><td id='connectedCell'>{{connected}}</td></tr>
+</table>
+</div>
+<div class='card'>
+<h2>Quick Controls</h2>
+<div class='button-row'>
+<button onclick='calibratorOn()' class='button-success'>Turn ON</button>
+<button onclick='calibratorOff()' class='button-danger'>Turn OFF</button>
+</div>
+<div class='brightness-control'>
+<label for='brightness'>Brightness Control:</label>
+<input type='range' id='brightness' min='0' max='{{maxBrightness}}' value='{{brightness}}' onchange='setBrightness(this.value)'>
+<div class='brightness-display center' id='brightnessValue'>{{brightness}}%</div>
+</div>
+</div>
+<div class='card'>
+<h2>Network Information</h2>
+<table>
+{{wifiRows}}<tr><td>MAC Address</td><td>{{macAddress}}</td></tr>
+<tr><td>Web Interface</td><td><a href='{{webUrl}}'>{{webUrl}}</a></td></tr>
+<tr><td>ASCOM Alpaca API</td><td><a href='{{alpacaUrl}}'>{{alpacaUrl}}</a></td></tr>
+<tr><td>Free Heap</td><td>{{freeHeap}} bytes</td></tr>
+</table>
+</div>
+</div></body></html>)HTML";
 
-// Navigation links 
-inline String getNavBar() {
-  String navbar = 
-    "<div class='nav-bar'>\n"
-    "<a href='/' class='nav-button'>Home</a>\n"
-    "<a href='/calibrator' class='nav-button'>Calibrator</a>\n"
-    "<a href='/setup' class='nav-button'>Setup</a>\n"
-    "<a href='/wificonfig' class='nav-button'>WiFi Config</a>\n"
-    "<a href='http://" + WiFi.localIP().toString() + ":" + String(ALPACA_PORT) + "/setup/v1/covercalibrator/0/setup' class='nav-button'>ASCOM Controls</a>\n"
-    "</div>\n";
-  
-  return navbar;
-}
+// Device setup page
+inline const char SETUP_PAGE_TEMPLATE[] PROGMEM = R"HTML({{head}}<body>
+<div class='container'>
+<h1>Device Setup</h1>
+{{nav}}<div class='card'>
+<h2>Device Settings</h2>
+<form method='post' action='/setup'>
+<label for='deviceName'>Device Name:</label>
+<input type='text' id='deviceName' name='deviceName' value='{{deviceName}}'>
+<label for='maxBrightness'>Maximum Brightness (%):</label>
+<input type='number' id='maxBrightness' name='maxBrightness' min='1' max='{{maxBrightnessLimit}}' value='{{maxBrightness}}'>
+<label for='wifiProfile'>WiFi Profile:</label>
+<select id='wifiProfile' name='wifiProfile'>
+{{wifiProfileOptions}}</select>
+<label><input type='checkbox' name='debugEnabled' value='true'{{debugChecked}}> Enable Serial Debug Output</label><br><br>
+<input type='submit' value='Save Settings'>
+</form>
+</div>
+<div class='card'>
+<h2>Current Status</h2>
+<table>
+<tr><td>Calibrator State</td><td>{{state}}</td></tr>
+<tr><td>Current Brightness</td><td>{{brightness}}%</td></tr>
+<tr><td>Max Brightness</td><td>{{maxBrightness}}%</td></tr>
+<tr><td>Debug Enabled</td><td>{{debugEnabled}}</td></tr>
+<tr><td>WiFi Profile</td><td>{{wifiProfile}}</td></tr>
+</table>
+</div>
+<div class='card'>
+<h2>System Management</h2>
+<div class='button-row'>
+<button onclick='restartDevice()' class='button-danger'>Restart Device</button>
+</div>
+</div>
+</div></body></html>)HTML";
+
+// Calibrator control page
+inline const char CALIBRATOR_PAGE_TEMPLATE[] PROGMEM = R"HTML({{head}}<body>
+<div class='container'>
+<h1>Calibrator Control</h1>
+{{nav}}<div class='card'>
+<h2>Brightness Control</h2>
+<div class='center'>
+<div class='brightness-display' id='currentDisplay'>Current: {{brightness}}%</div>
+<div class='brightness-display' id='stateDisplay'>State: {{state}}</div>
+</div>
+<div class='brightness-control'>
+<label for='brightness'>Brightness:</label>
+<input type='range' id='brightness' min='0' max='{{maxBrightness}}' value='{{brightness}}' onchange='setBrightness(this.value)'>
+<div class='brightness-display center' id='brightnessValue'>{{brightness}}%</div>
+</div>
+<div class='button-row center'>
+<button onclick='calibratorOff()' class='button-danger'>Turn OFF</button>
+<button onclick='setBrightness(25)' class='button-primary'>25%</button>
+<button onclick='setBrightness(50)' class='button-primary'>50%</button>
+<button onclick='setBrightness(75)' class='button-primary'>75%</button>
+<button onclick='calibratorOn()' class='button-success'>100%</button>
+</div>
+</div>
+<div class='card'>
+<h2>Filter Presets</h2>
+<div class='button-row center'>{{presetButtons}}</div>
+<div class='preset-form'>
+<input type='text' id='presetName' placeholder='Name' maxlength='7'>
+<input type='number' id='presetBrightness' placeholder='Brightness %' min='0' max='100'>
+<input type='number' id='presetRamp' placeholder='Ramp ms' min='0' max='60000'>
+<input type='number' id='presetExposure' placeholder='Exposure ms' min='0'>
+</div>
+<div class='button-row'>
+<button onclick='savePreset()' class='button-primary'>Save Preset</button>
+<button onclick='deletePreset()' class='button-danger'>Delete Preset</button>
+</div>
+</div>
+</div></body></html>)HTML";
+
+// WiFi configuration page
+inline const char WIFI_CONFIG_PAGE_TEMPLATE[] PROGMEM = R"HTML({{head}}<body>
+<div class='container'>
+<h1>WiFi Configuration</h1>
+{{nav}}<div class='card'>
+<h2>Available Networks</h2>
+<p>Click on a network to select it:</p>
+<div id='networkList'>{{networkList}}</div>
+</div>
+<div class='card'>
+<h2>WiFi Settings</h2>
+<form method='post' action='/wificonfig'>
+<label for='ssid'>WiFi SSID:</label>
+<input type='text' id='ssid' name='ssid' value='{{ssid}}'>
+<label for='password'>WiFi Password:</label>
+<input type='password' id='password' name='password' value=''>
+<input type='submit' value='Save & Connect'>
+</form>
+</div>
+</div></body></html>)HTML";
+
+// ASCOM setup page served on the Alpaca port
+inline const char ALPACA_SETUP_PAGE_TEMPLATE[] PROGMEM = R"HTML({{head}}<body data-api='alpaca'>
+<div class='container'>
+<h1>ESP32 Flat Panel Calibrator Setup</h1>
+<div class='card'>
+<h2>Current Status</h2>
+<p><strong>Device:</strong> {{deviceName}}</p>
+<p><strong>State:</strong> <span id='stateCell'>{{state}}</span></p>
+<p><strong>Brightness:</strong> <span id='brightnessCell'>{{brightness}}%</span></p>
+<p><strong>Max Brightness:</strong> <span id='maxBrightnessCell'>{{maxBrightness}}%</span></p>
+<p><strong>IP Address:</strong> {{ip}}</p>
+</div>
+<div class='card'>
+<h2>Manual Controls</h2>
+<button onclick='calibratorOn()'>Turn ON (Max)</button>
+<button onclick='calibratorOff()' class='button-danger'>Turn OFF</button>
+<br><br>
+<label for='brightness'>Set Brightness: </label>
+<input type='range' id='brightness' min='0' max='{{maxBrightness}}' value='{{brightness}}' onchange='setBrightness(this.value)'>
+<div class='brightness-display' id='brightnessValue'>{{brightness}}%</div>
+</div>
+<div class='card'>
+<h2>ASCOM Information</h2>
+<p><strong>Device Type:</strong> CoverCalibrator</p>
+<p><strong>API Base:</strong> {{alpacaUrl}}/api/v1/covercalibrator/0/</p>
+<p><strong>Web Interface:</strong> <a href='{{webUrl}}'>{{webUrl}}</a></p>
+</div>
+</div>
+</body></html>)HTML";
 
-// Generate the home page HTML
-inline String getHomePage() {
-  String html = getPageHeader("ESP32 Flat Panel Calibrator");
-  
-  html += "<h1>ESP32 Flat Panel Calibrator</h1>\n";
-  html += "<p>Version: " + String(DEVICE_VERSION) + "</p>\n";
-  
-  // Add navigation
-  html += getNavBar();
-  
-  // Status Card
-  html += "<div class='card'>\n";
-  html += "<h2>Current Status</h2>\n";
-  html += "<table>\n";
-  html += "<tr><td>Device Name</td><td>" + deviceName + "</td></tr>\n";
-  html += "<tr><td>Firmware Version</td><td>" + String(DEVICE_VERSION) + "</td></tr>\n";
-  html += "<tr><td>Unique ID</td><td>" + uniqueID + "</td></tr>\n";
-  html += "<tr><td>IP Address</td><td>" + WiFi.localIP().toString() + "</td></tr>\n";
-  
-  // Status with color coding
-  String statusClass = "";
-  String statusString = getCalibratorStateString();
-  if (statusString == "Ready") {
-    statusClass = "status-ready";
-  } else if (statusString == "Off") {
-    statusClass = "status-off";
-  } else if (statusString == "Error") {
-    statusClass = "status-error";
+// CSS class used to color the calibrator state
+inline const char* getCalibratorStateClass() {
+  switch (getCalibratorState()) {
+    case CALIBRATOR_READY: return "status-ready";
+    case CALIBRATOR_OFF:   return "status-off";
+    case CALIBRATOR_ERROR: return "status-error";
+    default:               return "";
   }
-  
-  html += "<tr><td>Calibrator State</td><td class='" + statusClass + "'>" + statusString + "</td></tr>\n";
-  html += "<tr><td>Current Brightness</td><td>" + String(getCurrentBrightness()) + "%</td></tr>\n";
-  html += "<tr><td>Max Brightness</td><td>" + String(getMaxBrightness()) + "%</td></tr>\n";
-  html += "<tr><td>Connected</td><td>" + String(isConnected ? "Yes" : "No") + "</td></tr>\n";
-  html += "</table>\n";
-  html += "</div>\n";
-  
-  // Quick Controls Card
-  html += "<div class='card'>\n";
-  html += "<h2>Quick Controls</h2>\n";
-  html += "<div class='button-row'>\n";
-  html += "<button onclick='calibratorOn()' class='button-success'>Turn ON</button>\n";
-  html += "<button onclick='calibratorOff()' class='button-danger'>Turn OFF</button>\n";
-  html += "</div>\n";
-  html += "<div class='brightness-control'>\n";
-  html += "<label for='brightness'>Brightness Control:</label>\n";
-  html += "<input type='range' id='brightness' min='0' max='" + String(getMaxBrightness()) + "' value='" + String(getCurrentBrightness()) + "' onchange='setBrightness(this.value)'>\n";
-  html += "<div class='brightness-display center' id='brightnessValue'>" + String(getCurrentBrightness()) + "%</div>\n";
-  html += "</div>\n";
-  html += "</div>\n";
-  
-  // Network Information Card
-  html += "<div class='card'>\n";
-  html += "<h2>Network Information</h2>\n";
-  html += "<table>\n";
-  if (WiFi.status() == WL_CONNECTED) {
-    html += "<tr><td>WiFi Status</td><td class='status-on'>Connected</td></tr>\n";
-    html += "<tr><td>SSID</td><td>" + WiFi.SSID() + "</td></tr>\n";
-    html += "<tr><td>Signal Strength</td><td>" + String(WiFi.RSSI()) + " dBm</td></tr>\n";
+}
+
+// Placeholders shared by every page
+inline bool resolveCommonField(const char* name, TemplateRenderer& out) {
+  if (strcmp(name, "head") == 0) {
+    out.render(PAGE_HEAD_TEMPLATE);
+  } else if (strcmp(name, "nav") == 0) {
+    out.render(NAV_BAR_TEMPLATE);
+  } else if (strcmp(name, "version") == 0) {
+    out.print(DEVICE_VERSION);
+  } else if (strcmp(name, "deviceName") == 0) {
+    out.printEscaped(deviceName);
+  } else if (strcmp(name, "uniqueID") == 0) {
+    out.print(uniqueID);
+  } else if (strcmp(name, "ip") == 0) {
+    out.print(WiFi.localIP().toString());
+  } else if (strcmp(name, "webUrl") == 0) {
+    out.print("http://");
+    out.print(WiFi.localIP().toString());
+  } else if (strcmp(name, "alpacaUrl") == 0) {
+    out.print("http://");
+    out.print(WiFi.localIP().toString());
+    out.print(":");
+    out.print(ALPACA_PORT);
+  } else if (strcmp(name, "state") == 0) {
+    out.print(getCalibratorStateString());
+  } else if (strcmp(name, "stateClass") == 0) {
+    out.print(getCalibratorStateClass());
+  } else if (strcmp(name, "brightness") == 0) {
+    out.print(getCurrentBrightness());
+  } else if (strcmp(name, "maxBrightness") == 0) {
+    out.print(getMaxBrightness());
+  } else if (strcmp(name, "maxBrightnessLimit") == 0) {
+    out.print(MAX_BRIGHTNESS);
+  } else if (strcmp(name, "connected") == 0) {
+    out.print(isConnected ? "Yes" : "No");
+  } else if (strcmp(name, "debugEnabled") == 0) {
+    out.print(serialDebugEnabled ? "Yes" : "No");
+  } else if (strcmp(name, "debugChecked") == 0) {
+    out.print(serialDebugEnabled ? " checked" : "");
+  } else if (strcmp(name, "macAddress") == 0) {
+    out.print(WiFi.macAddress());
+  } else if (strcmp(name, "freeHeap") == 0) {
+    out.print(ESP.getFreeHeap());
+  } else if (strcmp(name, "ssid") == 0) {
+    out.printEscaped(ssid);
   } else {
-    html += "<tr><td>WiFi Status</td><td class='status-off'>Disconnected</td></tr>\n";
+    return false;
   }
-  html += "<tr><td>MAC Address</td><td>" + WiFi.macAddress() + "</td></tr>\n";
-  html += "<tr><td>Web Interface</td><td><a href='http://" + WiFi.localIP().toString() + "'>http://" + WiFi.localIP().toString() + "</a></td></tr>\n";
-  html += "<tr><td>ASCOM Alpaca API</td><td><a href='http://" + WiFi.localIP().toString() + ":" + String(ALPACA_PORT) + "'>http://" + WiFi.localIP().toString() + ":" + String(ALPACA_PORT) + "</a></td></tr>\n";
-  html += "<tr><td>Free Heap</td><td>" + String(ESP.getFreeHeap()) + " bytes</td></tr>\n";
-  html += "</table>\n";
-  html += "</div>\n";
-  
-  // JavaScript for controls
-  html += "<script>\n";
-  html += "function updateStatus() {\n";
-  html += "  fetch('/api/status')\n";
-  html += "    .then(response => response.json())\n";
-  html += "    .then(data => {\n";
-  html += "      const brightness = data.brightness;\n";
-  html += "      document.getElementById('brightness').value = brightness;\n";
-  html += "      document.getElementById('brightnessValue').innerText = brightness + '%';\n";
-  html += "      // Update status table if it exists\n";
-  html += "      const statusRows = document.querySelectorAll('td');\n";
-  html += "      statusRows.forEach(cell => {\n";
-  html += "        if (cell.previousElementSibling && cell.previousElementSibling.innerText === 'Current Brightness') {\n";
-  html += "          cell.innerText = brightness + '%';\n";
-  html += "        }\n";
-  html += "      });\n";
-  html += "    })\n";
-  html += "    .catch(err => console.log('Status update failed:', err));\n";
-  html += "}\n";
-  html += "function calibratorOn() {\n";
-  html += "  fetch('/calibrator', { method: 'POST', headers: { 'Content-Type': 'application/x-www-form-urlencoded' }, body: 'action=on' })\n";
-  html += "    .then(response => response.text())\n";
-  html += "    .then(data => { \n";
-  html += "      setTimeout(updateStatus, 500);\n";
-  html += "      setTimeout(() => location.reload(), 1000); \n";
-  html += "    });\n";
-  html += "}\n";
-  html += "function calibratorOff() {\n";
-  html += "  fetch('/calibrator', { method: 'POST', headers: { 'Content-Type': 'application/x-www-form-urlencoded' }, body: 'action=off' })\n";
-  html += "    .then(response => response.text())\n";
-  html += "    .then(data => { \n";
-  html += "      setTimeout(updateStatus, 500);\n";
-  html += "      setTimeout(() => location.reload(), 1000); \n";
-  html += "    });\n";
-  html += "}\n";
-  html += "function setBrightness(value) {\n";
-  html += "  document.getElementById('brightnessValue').innerText = value + '%';\n";
-  html += "  // Update status table immediately\n";
-  html += "  const statusRows = document.querySelectorAll('td');\n";
-  html += "  statusRows.forEach(cell => {\n";
-  html += "    if (cell.previousElementSibling && cell.previousElementSibling.innerText === 'Current Brightness') {\n";
-  html += "      cell.innerText = value + '%';\n";
-  html += "    }\n";
-  html += "  });\n";
-  html += "  fetch('/calibrator', { method: 'POST', headers: { 'Content-Type': 'application/x-www-form-urlencoded' }, body: 'action=brightness&brightness=' + value })\n";
-  html += "    .then(response => response.text());\n";
-  html += "}\n";
-  html += "// Update status every 10 seconds\n";
-  html += "setInterval(updateStatus, 10000);\n";
-  html += "</script>\n";
-  
-  html += "</div></body></html>";
-  
-  return html;
+  return true;
 }
 
-// Generate the setup page HTML
-inline String getSetupPage() {
-  String html = getPageHeader("Device Setup");
-  
-  html += "<h1>Device Setup</h1>\n";
-  
-  // Add navigation
-  html += getNavBar();
-  
-  // Device Settings Card
-  html += "<div class='card'>\n";
-  html += "<h2>Device Settings</h2>\n";
-  html += "<form method='post' action='/setup'>\n";
-  html += "<label for='deviceName'>Device Name:</label>\n";
-  html += "<input type='text' id='deviceName' name='deviceName' value='" + deviceName + "'>\n";
-  html += "<label for='maxBrightness'>Maximum Brightness (%):</label>\n";
-  html += "<input type='number' id='maxBrightness' name='maxBrightness' min='1' max='" + String(MAX_BRIGHTNESS) + "' value='" + String(getMaxBrightness()) + "'>\n";
-  html += "<label><input type='checkbox' name='debugEnabled' value='true'" + String(serialDebugEnabled ? " checked" : "") + "> Enable Serial Debug Output</label><br><br>\n";
-  html += "<input type='submit' value='Save Settings'>\n";
-  html += "</form>\n";
-  html += "</div>\n";
-  
-  // Current Status Card
-  html += "<div class='card'>\n";
-  html += "<h2>Current Status</h2>\n";
-  html += "<table>\n";
-  html += "<tr><td>Calibrator State</td><td>" + getCalibratorStateString() + "</td></tr>\n";
-  html += "<tr><td>Current Brightness</td><td>" + String(getCurrentBrightness()) + "%</td></tr>\n";
-  html += "<tr><td>Max Brightness</td><td>" + String(getMaxBrightness()) + "%</td></tr>\n";
-  html += "<tr><td>Debug Enabled</td><td>" + String(serialDebugEnabled ? "Yes" : "No") + "</td></tr>\n";
-  html += "</table>\n";
-  html += "</div>\n";
-  
-  // System Management Card
-  html += "<div class='card'>\n";
-  html += "<h2>System Management</h2>\n";
-  html += "<div class='button-row'>\n";
-  html += "<button onclick='restartDevice()' class='button-danger'>Restart Device</button>\n";
-  html += "</div>\n";
-  html += "</div>\n";
-  
-  // JavaScript
-  html += "<script>\n";
-  html += "function restartDevice() {\n";
-  html += "  if (confirm('Are you sure you want to restart the device?')) {\n";
-  html += "    fetch('/restart', { method: 'POST' })\n";
-  html += "      .then(response => { alert('Device is restarting...'); });\n";
-  html += "  }\n";
-  html += "}\n";
-  html += "</script>\n";
-  
-  html += "</div></body></html>";
-  
-  return html;
+inline bool resolveHomePageField(const char* name, TemplateRenderer& out) {
+  if (strcmp(name, "title") == 0) {
+    out.print("ESP32 Flat Panel Calibrator");
+  } else if (strcmp(name, "wifiRows") == 0) {
+    if (WiFi.status() == WL_CONNECTED) {
+      out.print("<tr><td>WiFi Status</td><td class='status-on'>Connected</td></tr>\n");
+      out.print("<tr><td>SSID</td><td>");
+      out.printEscaped(WiFi.SSID());
+      out.print("</td></tr>\n<tr><td>Signal Strength</td><td>");
+      out.print(WiFi.RSSI());
+      out.print(" dBm</td></tr>\n");
+    } else {
+      out.print("<tr><td>WiFi Status</td><td class='status-off'>Disconnected</td></tr>\n");
+    }
+  } else {
+    return resolveCommonField(name, out);
+  }
+  return true;
 }
 
-// Generate the calibrator control page HTML
-inline String getCalibratorPage() {
-  String html = getPageHeader("Calibrator Control");
-  
-  html += "<h1>Calibrator Control</h1>\n";
-  
-  // Add navigation
-  html += getNavBar();
-  
-  // Calibrator Control Card
-  html += "<div class='card'>\n";
-  html += "<h2>Brightness Control</h2>\n";
-  html += "<div class='center'>\n";
-  html += "<div class='brightness-display'>Current: " + String(getCurrentBrightness()) + "%</div>\n";
-  html += "<div class='brightness-display'>State: " + getCalibratorStateString() + "</div>\n";
-  html += "</div>\n";
-  html += "<div class='brightness-control'>\n";
-  html += "<label for='brightness'>Brightness:</label>\n";
-  html += "<input type='range' id='brightness' min='0' max='" + String(getMaxBrightness()) + "' value='" + String(getCurrentBrightness()) + "' onchange='setBrightness(this.value)'>\n";
-  html += "<div class='brightness-display center' id='brightnessValue'>" + String(getCurrentBrightness()) + "%</div>\n";
-  html += "</div>\n";
-  html += "<div class='button-row center'>\n";
-  html += "<button onclick='calibratorOff()' class='button-danger'>Turn OFF</button>\n";
-  html += "<button onclick='setBrightness(25)' class='button-primary'>25%</button>\n";
-  html += "<button onclick='setBrightness(50)' class='button-primary'>50%</button>\n";
-  html += "<button onclick='setBrightness(75)' class='button-primary'>75%</button>\n";
-  html += "<button onclick='calibratorOn()' class='button-success'>100%</button>\n";
-  html += "</div>\n";
-  html += "</div>\n";
-  
-  // JavaScript for controls
-  html += "<script>\n";
-  html += "function updateDisplay() {\n";
-  html += "  fetch('/api/v1/covercalibrator/0/brightness?ClientID=1&ClientTransactionID=1')\n";
-  html += "    .then(response => response.json())\n";
-  html += "    .then(data => {\n";
-  html += "      if (data.ErrorNumber === 0) {\n";
-  html += "        const brightness = data.Value;\n";
-  html += "        document.getElementById('brightness').value = brightness;\n";
-  html += "        document.getElementById('brightnessValue').innerText = brightness + '%';\n";
-  html += "        // Update the current brightness display\n";
-  html += "        const currentDisplay = document.querySelector('.brightness-display');\n";
-  html += "        if (currentDisplay) {\n";
-  html += "          currentDisplay.innerHTML = 'Current: ' + brightness + '%';\n";
-  html += "        }\n";
-  html += "      }\n";
-  html += "    });\n";
-  html += "}\n";
-  html += "function calibratorOn() {\n";
-  html += "  fetch('/calibrator', { method: 'POST', headers: { 'Content-Type': 'application/x-www-form-urlencoded' }, body: 'action=on' })\n";
-  html += "    .then(response => response.text())\n";
-  html += "    .then(data => { updateDisplay(); setTimeout(() => location.reload(), 500); });\n";
-  html += "}\n";
-  html += "function calibratorOff() {\n";
-  html += "  fetch('/calibrator', { method: 'POST', headers: { 'Content-Type': 'application/x-www-form-urlencoded' }, body: 'action=off' })\n";
-  html += "    .then(response => response.text())\n";
-  html += "    .then(data => { updateDisplay(); setTimeout(() => location.reload(), 500); });\n";
-  html += "}\n";
-  html += "function setBrightness(value) {\n";
-  html += "  document.getElementById('brightness').value = value;\n";
-  html += "  document.getElementById('brightnessValue').innerText = value + '%';\n";
-  html += "  // Update current brightness display immediately\n";
-  html += "  const currentDisplay = document.querySelector('.brightness-display');\n";
-  html += "  if (currentDisplay) {\n";
-  html += "    currentDisplay.innerHTML = 'Current: ' + value + '%';\n";
-  html += "  }\n";
-  html += "  fetch('/calibrator', { method: 'POST', headers: { 'Content-Type': 'application/x-www-form-urlencoded' }, body: 'action=brightness&brightness=' + value })\n";
-  html += "    .then(response => response.text());\n";
-  html += "}\n";
-  html += "// Update display every 5 seconds\n";
-  html += "setInterval(updateDisplay, 5000);\n";
-  html += "</script>\n";
-  
-  html += "</div></body></html>";
-  
-  return html;
+inline bool resolveSetupPageField(const char* name, TemplateRenderer& out) {
+  if (strcmp(name, "title") == 0) {
+    out.print("Device Setup");
+  } else if (strcmp(name, "wifiProfile") == 0) {
+    out.print(getWiFiProfileName(getWiFiProfile()));
+  } else if (strcmp(name, "wifiProfileOptions") == 0) {
+    static const char* const descriptions[WIFI_PROFILE_COUNT] = {
+      "Lowest latency - no power saving",
+      "Balanced - ESP32 default",
+      "Low power - slower responses",
+    };
+    for (int i = 0; i < WIFI_PROFILE_COUNT; i++) {
+      out.printf("<option value='%s'%s>%s</option>\n", getWiFiProfileName((WiFiProfile)i),
+                 i == getWiFiProfile() ? " selected" : "", descriptions[i]);
+    }
+  } else {
+    return resolveCommonField(name, out);
+  }
+  return true;
 }
 
-// Generate the WiFi configuration page HTML
-inline String getWifiConfigPage() {
-  String html = getPageHeader("WiFi Configuration");
-  
-  html += "<h1>WiFi Configuration</h1>\n";
-  
-  // Add navigation
-  html += getNavBar();
-  
-  // Network scanning
-  html += "<div class='card'>\n";
-  html += "<h2>Available Networks</h2>\n";
-  html += "<p>Click on a network to select it:</p>\n";
-  
-  int numNetworks = WiFi.scanNetworks();
-  if (numNetworks == 0) {
-    html += "<p>No WiFi networks found</p>\n";
+inline bool resolveCalibratorPageField(const char* name, TemplateRenderer& out) {
+  if (strcmp(name, "title") == 0) {
+    out.print("Calibrator Control");
+  } else if (strcmp(name, "presetButtons") == 0) {
+    // Preset names are limited to letters, digits, '-' and '_', so they need no escaping
+    if (getPresetCount() == 0) {
+      out.print("<p>No presets saved</p>");
+    }
+    for (size_t i = 0; i < getPresetCount(); i++) {
+      const CalibratorPreset& preset = getPreset(i);
+      out.printf("<button onclick='applyPreset(\"%s\")' title='%u%%, ramp %u ms, exposure %lu ms'>%s</button>\n",
+                 preset.name, preset.brightness, preset.rampMs, (unsigned long)preset.exposureMs, preset.name);
+    }
   } else {
-    html += "<div style='max-height: 200px; overflow-y: auto; border: 1px solid #ddd; padding: 10px; border-radius: 4px;'>\n";
+    return resolveCommonField(name, out);
+  }
+  return true;
+}
+
+inline bool resolveWifiConfigPageField(const char* name, TemplateRenderer& out) {
+  if (strcmp(name, "title") == 0) {
+    out.print("WiFi Configuration");
+  } else if (strcmp(name, "networkList") == 0) {
+    // Rendered from the cached scan; the page refreshes it from /api/scan
+    int numNetworks = getWifiScanCount();
+    if (numNetworks == 0) {
+      out.print(isWifiScanRunning() ? "<p>Scanning...</p>\n" : "<p>No WiFi networks found</p>\n");
+      return true;
+    }
+    out.print("<div class='network-list'>\n");
     for (int i = 0; i < numNetworks; i++) {
-      html += "<div style='padding: 8px; margin: 2px 0; border: 1px solid #eee; border-radius: 4px; cursor: pointer;' onclick='selectNetwork(\"" + WiFi.SSID(i) + "\")'>\n";
-      html += "<strong>" + WiFi.SSID(i) + "</strong><br>\n";
-      html += "Signal: " + String(WiFi.RSSI(i)) + " dBm, ";
-      html += "Security: " + String(WiFi.encryptionType(i) == WIFI_AUTH_OPEN ? "Open" : "Secured") + "\n";
-      html += "</div>\n";
+      const WifiScanResult& network = getWifiScanResult(i);
+      // The SSID only ever goes into HTML; the handler reads it back from the
+      // attribute, so no SSID can turn into script
+      out.print("<div class='network-item' data-ssid='");
+      out.printEscaped(network.ssid);
+      out.print("' onclick='selectNetwork(this.dataset.ssid)'>\n<strong>");
+      out.printEscaped(network.ssid);
+      out.print("</strong><br>\nSignal: ");
+      out.print(network.rssi);
+      out.print(" dBm, Security: ");
+      out.print(network.secured ? "Secured" : "Open");
+      out.print("\n</div>\n");
     }
-    html += "</div>\n";
+    out.print("</div>\n");
+  } else {
+    return resolveCommonField(name, out);
+  }
+  return true;
+}
+
+inline bool resolveAlpacaSetupPageField(const char* name, TemplateRenderer& out) {
+  if (strcmp(name, "title") == 0) {
+    out.print("Flat Panel Calibrator Setup");
+    return true;
   }
-  html += "</div>\n";
-  
-  // WiFi Configuration Form
-  html += "<div class='card'>\n";
-  html += "<h2>WiFi Settings</h2>\n";
-  html += "<form method='post' action='/wificonfig'>\n";
-  html += "<label for='ssid'>WiFi SSID:</label>\n";
-  html += "<input type='text' id='ssid' name='ssid' value='" + String(ssid) + "'>\n";
-  html += "<label for='password'>WiFi Password:</label>\n";
-  html += "<input type='password' id='password' name='password' value=''>\n";
-  html += "<input type='submit' value='Save & Connect'>\n";
-  html += "</form>\n";
-  html += "</div>\n";
-  
-  // JavaScript
-  html += "<script>\n";
-  html += "function selectNetwork(name) {\n";
-  html += "  document.getElementById('ssid').value = name;\n";
-  html += "  document.getElementById('password').focus();\n";
-  html += "}\n";
-  html += "</script>\n";
-  
-  html += "</div></body></html>";
-  
-  return html;
+  return resolveCommonField(name, out);
 }
 
-#endif // HTML_TEMPLATES_H
\ No newline at end of file
+#endif // HTML_TEMPLATES_H
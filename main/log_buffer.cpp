@@ -0,0 +1,313 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Deferred Log Buffer Implementation
+ */
+
+#include "log_buffer.h"
+#include <atomic>
+
+struct LogRecord {
+  uint32_t timeUs;
+  const char* format;
+  uint8_t level;
+  uint8_t argLength;
+  bool truncated;
+  uint8_t args[LOG_RECORD_ARG_BYTES];
+};
+
+struct LogSlot {
+  std::atomic<uint32_t> sequence;       // Ring index + 1 once published, 0 while being written
+  LogRecord record;
+};
+
+static LogSlot logSlots[LOG_BUFFER_RECORDS];
+static std::atomic<uint32_t> writeIndex(0);
+static std::atomic<uint32_t> readIndex(0);
+static std::atomic<uint32_t> droppedCount(0);
+static std::atomic<uint32_t> truncatedCount(0);
+static uint32_t reportedDropped = 0;
+
+static_assert(LOG_RECORD_ARG_BYTES <= 255, "Record argument length is stored in one byte");
+static_assert(LOG_LINE_SIZE <= LOG_SERIAL_TX_BUFFER_SIZE,
+              "A formatted line must fit the serial TX buffer or draining stalls");
+
+void LogArgWriter::putString(const char* text) {
+  if (text == nullptr) {
+    text = "(null)";
+  }
+  if (used + 2 > capacity) {
+    overflow = true;
+    return;
+  }
+
+  data[used++] = LOG_ARG_STRING;
+  size_t room = capacity - used - 1;
+  size_t length = strnlen(text, room + 1);
+  if (length > room) {
+    length = room;
+    overflow = true;
+  }
+  memcpy(data + used, text, length);
+  used += length;
+  data[used++] = '\0';
+}
+
+// Claim a slot, copy the record in and publish it; never waits
+void commitLogRecord(uint8_t level, const char* format, const uint8_t* args, size_t length, bool truncated) {
+  uint32_t index = writeIndex.load(std::memory_order_relaxed);
+  do {
+    if (index - readIndex.load(std::memory_order_acquire) >= LOG_BUFFER_RECORDS) {
+      droppedCount.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+  } while (!writeIndex.compare_exchange_weak(index, index + 1, std::memory_order_acq_rel,
+                                             std::memory_order_relaxed));
+
+  LogSlot& slot = logSlots[index % LOG_BUFFER_RECORDS];
+  slot.sequence.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  slot.record.timeUs = micros();
+  slot.record.format = format;
+  slot.record.level = level;
+  slot.record.argLength = length;
+  slot.record.truncated = truncated;
+  memcpy(slot.record.args, args, length);
+  if (truncated) {
+    truncatedCount.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  slot.sequence.store(index + 1, std::memory_order_release);
+}
+
+// Walks the packed arguments in the order they were added
+class LogArgReader {
+public:
+  LogArgReader(const uint8_t* data, size_t length) : data(data), length(length) {}
+
+  bool next(LogArgType& type) {
+    if (position >= length) {
+      return false;
+    }
+    type = (LogArgType)data[position++];
+    return true;
+  }
+
+  template <typename V>
+  V value() {
+    V result;
+    memcpy(&result, data + position, sizeof(V));
+    position += sizeof(V);
+    return result;
+  }
+
+  const char* string() {
+    const char* text = (const char*)data + position;
+    position += strlen(text) + 1;
+    return text;
+  }
+
+private:
+  const uint8_t* data;
+  size_t length;
+  size_t position = 0;
+};
+
+// Format one conversion from the stored argument. Length modifiers in the
+// format are replaced by the stored type, so a mismatched call site prints a
+// wrong number rather than reading past the argument.
+static int formatLogArg(char* out, size_t size, char* spec, size_t specLength, char conversion,
+                        LogArgReader& reader) {
+  LogArgType type;
+  if (!reader.next(type)) {
+    return snprintf(out, size, "?");
+  }
+
+  switch (type) {
+    case LOG_ARG_INT:
+    case LOG_ARG_LONG_LONG: {
+      long long value = type == LOG_ARG_INT ? reader.value<int>() : reader.value<long long>();
+      if (strchr("diouxXc", conversion) == nullptr) {
+        return snprintf(out, size, "?");
+      }
+      if (conversion == 'c' || type == LOG_ARG_INT) {
+        spec[specLength] = conversion;
+        spec[specLength + 1] = '\0';
+        return snprintf(out, size, spec, (int)value);
+      }
+      spec[specLength] = 'l';
+      spec[specLength + 1] = 'l';
+      spec[specLength + 2] = conversion;
+      spec[specLength + 3] = '\0';
+      return snprintf(out, size, spec, value);
+    }
+    case LOG_ARG_DOUBLE: {
+      double value = reader.value<double>();
+      if (strchr("fFeEgGaA", conversion) == nullptr) {
+        return snprintf(out, size, "?");
+      }
+      spec[specLength] = conversion;
+      spec[specLength + 1] = '\0';
+      return snprintf(out, size, spec, value);
+    }
+    case LOG_ARG_STRING: {
+      const char* value = reader.string();
+      if (conversion != 's') {
+        return snprintf(out, size, "?");
+      }
+      spec[specLength] = 's';
+      spec[specLength + 1] = '\0';
+      return snprintf(out, size, spec, value);
+    }
+    case LOG_ARG_POINTER:
+      return snprintf(out, size, "%p", reader.value<const void*>());
+  }
+  return snprintf(out, size, "?");
+}
+
+// Expand a record into text; returns the length written to line
+static size_t formatLogRecord(const LogRecord& record, char* line, size_t size) {
+  LogArgReader reader(record.args, record.argLength);
+  const char* format = record.format;
+  size_t length = 0;
+
+  while (*format != '\0' && length < size - 1) {
+    if (*format != '%') {
+      line[length++] = *format++;
+      continue;
+    }
+    if (format[1] == '%') {
+      line[length++] = '%';
+      format += 2;
+      continue;
+    }
+
+    // Keep flags, width and precision, drop the length modifier
+    char spec[16];
+    size_t specLength = 0;
+    spec[specLength++] = *format++;
+    while (*format != '\0' && strchr("-+ #0123456789.", *format) != nullptr &&
+           specLength < sizeof(spec) - 4) {
+      spec[specLength++] = *format++;
+    }
+    while (*format != '\0' && strchr("hlLqjzt", *format) != nullptr) {
+      format++;
+    }
+    char conversion = *format;
+    if (conversion == '\0') {
+      break;
+    }
+    format++;
+
+    int written = formatLogArg(line + length, size - length, spec, specLength, conversion, reader);
+    if (written > 0) {
+      length += min((size_t)written, size - 1 - length);
+    }
+  }
+
+  if (record.truncated && length + 3 < size) {
+    // Mark the cut before a trailing newline so the line still ends cleanly
+    bool newline = length > 0 && line[length - 1] == '\n';
+    if (newline) {
+      length--;
+    }
+    memcpy(line + length, "...", 3);
+    length += 3;
+    if (newline) {
+      line[length++] = '\n';
+    }
+  }
+
+  line[length] = '\0';
+  return length;
+}
+
+// Format queued records into out, stopping before budget bytes are exceeded
+size_t drainLogRecords(Print& out, size_t budget) {
+  char line[LOG_LINE_SIZE];
+  size_t written = 0;
+
+  uint32_t dropped = droppedCount.load(std::memory_order_relaxed);
+  if (dropped != reportedDropped) {
+    int length = snprintf(line, sizeof(line), "[log: %lu records dropped]\n",
+                          (unsigned long)(dropped - reportedDropped));
+    if ((size_t)length > budget) {
+      return 0;
+    }
+    out.write((const uint8_t*)line, length);
+    written += length;
+    reportedDropped = dropped;
+  }
+
+  uint32_t index = readIndex.load(std::memory_order_relaxed);
+  while (true) {
+    LogSlot& slot = logSlots[index % LOG_BUFFER_RECORDS];
+    if (slot.sequence.load(std::memory_order_acquire) != index + 1) {
+      break;                            // Empty, or a producer is still writing it
+    }
+
+    size_t length = formatLogRecord(slot.record, line, sizeof(line));
+    if (written + length > budget) {
+      break;
+    }
+    out.write((const uint8_t*)line, length);
+    written += length;
+
+    index++;
+    readIndex.store(index, std::memory_order_release);
+  }
+
+  return written;
+}
+
+uint32_t getLogWriteIndex() {
+  return writeIndex.load(std::memory_order_acquire);
+}
+
+// Print the records in [since, until) still held in the ring, with timestamps.
+// Returns the index to pass as since on the next call.
+uint32_t printLogHistory(Print& out, uint32_t since, uint32_t until) {
+  if (until - since > LOG_BUFFER_RECORDS) {
+    since = until - LOG_BUFFER_RECORDS;
+  }
+
+  char line[LOG_LINE_SIZE];
+  bool lineStart = true;
+  for (uint32_t index = since; index != until; index++) {
+    LogSlot& slot = logSlots[index % LOG_BUFFER_RECORDS];
+
+    // Copy, then check that no producer reused the slot meanwhile. Early on
+    // the window starts before record 0, whose index + 1 is the unwritten 0.
+    if (index + 1 == 0 || slot.sequence.load(std::memory_order_acquire) != index + 1) {
+      continue;
+    }
+    LogRecord record = slot.record;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) != index + 1) {
+      continue;
+    }
+
+    size_t length = formatLogRecord(record, line, sizeof(line));
+    if (lineStart) {
+      out.printf("[%lu.%06lu] ", (unsigned long)(record.timeUs / 1000000),
+                 (unsigned long)(record.timeUs % 1000000));
+    }
+    out.write((const uint8_t*)line, length);
+    lineStart = length > 0 && line[length - 1] == '\n';
+  }
+  if (!lineStart) {
+    out.println();
+  }
+
+  return until;
+}
+
+LogBufferStats getLogBufferStats() {
+  LogBufferStats stats;
+  uint32_t written = writeIndex.load(std::memory_order_acquire);
+  stats.recorded = written;
+  stats.dropped = droppedCount.load(std::memory_order_relaxed);
+  stats.truncated = truncatedCount.load(std::memory_order_relaxed);
+  stats.pending = written - readIndex.load(std::memory_order_acquire);
+  return stats;
+}
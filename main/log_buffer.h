@@ -0,0 +1,142 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Deferred Log Buffer Header
+ *
+ * Debug calls do not format anything. They store the format string pointer, a
+ * micros() timestamp and the raw arguments in a fixed ring of records, which
+ * takes a few microseconds and never waits for the UART. The main loop formats
+ * queued records when it is idle and writes only as much as the serial TX
+ * buffer can take; /log formats the records still held in the ring.
+ *
+ * Producers claim slots with a compare-and-swap, so WiFi event callbacks on
+ * other tasks can log too. When the ring is full new records are dropped and
+ * counted rather than blocking the caller.
+ *
+ * Format strings must be literals (they are read again when the record is
+ * formatted). String arguments are copied into the record, truncated if the
+ * record runs out of room.
+ */
+
+#ifndef LOG_BUFFER_H
+#define LOG_BUFFER_H
+
+#include <Arduino.h>
+#include <type_traits>
+#include "config.h"
+
+enum LogArgType : uint8_t {
+  LOG_ARG_INT,                          // Anything up to int size, including char and bool
+  LOG_ARG_LONG_LONG,                    // 64-bit integers
+  LOG_ARG_DOUBLE,
+  LOG_ARG_STRING,                       // Copied inline, NUL terminated
+  LOG_ARG_POINTER
+};
+
+// Arrangement of a Debug.print()/println() value, see logValueFormat()
+enum LogValueLayout {
+  LOG_LAYOUT_PRINT,
+  LOG_LAYOUT_PRINTLN,
+  LOG_LAYOUT_PREFIX_PRINT,
+  LOG_LAYOUT_PREFIX_PRINTLN
+};
+
+struct LogBufferStats {
+  uint32_t recorded;                    // Records accepted since boot
+  uint32_t dropped;                     // Records lost because the ring was full
+  uint32_t truncated;                   // Records whose arguments did not fit
+  uint32_t pending;                     // Accepted but not yet written to serial
+};
+
+// Packs printf arguments into a record's argument area
+class LogArgWriter {
+public:
+  LogArgWriter(uint8_t* data, size_t capacity) : data(data), capacity(capacity) {}
+
+  template <typename T>
+  void add(T value) {
+    if constexpr (std::is_floating_point<T>::value) {
+      put(LOG_ARG_DOUBLE, (double)value);
+    } else if constexpr (std::is_integral<T>::value || std::is_enum<T>::value) {
+      if constexpr (sizeof(T) <= sizeof(int)) {
+        put(LOG_ARG_INT, (int)value);
+      } else {
+        put(LOG_ARG_LONG_LONG, (long long)value);
+      }
+    } else if constexpr (std::is_convertible<T, const char*>::value) {
+      putString(value);
+    } else if constexpr (std::is_same<T, String>::value) {
+      putString(value.c_str());
+    } else {
+      static_assert(std::is_pointer<T>::value, "Unsupported Debug.printf argument type");
+      put(LOG_ARG_POINTER, (const void*)value);
+    }
+  }
+
+  size_t length() const { return used; }
+  bool truncated() const { return overflow; }
+
+private:
+  template <typename V>
+  void put(LogArgType type, V value) {
+    if (used + 1 + sizeof(V) > capacity) {
+      overflow = true;
+      return;
+    }
+    data[used++] = type;
+    memcpy(data + used, &value, sizeof(V));
+    used += sizeof(V);
+  }
+
+  void putString(const char* text);
+
+  uint8_t* data;
+  size_t capacity;
+  size_t used = 0;
+  bool overflow = false;
+};
+
+// Function prototypes
+void commitLogRecord(uint8_t level, const char* format, const uint8_t* args, size_t length, bool truncated);
+size_t drainLogRecords(Print& out, size_t budget);
+uint32_t getLogWriteIndex();
+uint32_t printLogHistory(Print& out, uint32_t since, uint32_t until);
+LogBufferStats getLogBufferStats();
+
+// Queue one printf-style record; the format pointer must outlive the record
+template <typename... Args>
+void recordLog(uint8_t level, const char* format, Args... args) {
+  uint8_t data[LOG_RECORD_ARG_BYTES];
+  LogArgWriter writer(data, sizeof(data));
+  (writer.add(args), ...);
+  commitLogRecord(level, format, data, writer.length(), writer.truncated());
+}
+
+// Format literal that prints a single value the way Print would, \r\n included
+template <typename T>
+const char* logValueFormat(LogValueLayout layout) {
+  static const char* const textFormats[] = { "%s", "%s\r\n", "%s: %s", "%s: %s\r\n" };
+  static const char* const signedFormats[] = { "%d", "%d\r\n", "%s: %d", "%s: %d\r\n" };
+  static const char* const unsignedFormats[] = { "%u", "%u\r\n", "%s: %u", "%s: %u\r\n" };
+  static const char* const charFormats[] = { "%c", "%c\r\n", "%s: %c", "%s: %c\r\n" };
+  static const char* const floatFormats[] = { "%.2f", "%.2f\r\n", "%s: %.2f", "%s: %.2f\r\n" };
+
+  if constexpr (std::is_floating_point<T>::value) {
+    return floatFormats[layout];
+  } else if constexpr (std::is_same<T, char>::value) {
+    return charFormats[layout];
+  } else if constexpr (std::is_integral<T>::value && std::is_signed<T>::value) {
+    return signedFormats[layout];
+  } else if constexpr (std::is_integral<T>::value) {
+    return unsignedFormats[layout];
+  } else {
+    return textFormats[layout];
+  }
+}
+
+// Flash strings are memory mapped on the ESP32 and can be read directly
+inline const char* logValue(const __FlashStringHelper* value) { return reinterpret_cast<const char*>(value); }
+inline const char* logValue(const String& value) { return value.c_str(); }
+template <typename T>
+T logValue(T value) { return value; }
+
+#endif // LOG_BUFFER_H
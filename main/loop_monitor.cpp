@@ -0,0 +1,135 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Loop Latency Monitor Implementation
+ */
+
+#include "loop_monitor.h"
+#include "Debug.h"
+
+static const char* const stageNames[LOOP_STAGE_COUNT] = {
+  "wifi", "boot", "discovery", "alpaca", "web", "scan", "serial",
+  "events", "calibrator", "housekeeping", "log", "pass"
+};
+
+static LoopStageStats stageStats[LOOP_STAGE_COUNT];
+static LoopOverrun overrunHistory[LOOP_OVERRUN_HISTORY];
+static size_t overrunTotal = 0;
+static uint32_t passStart = 0;
+static uint32_t cyclesPerUs = 0;
+static const char* currentRoute = nullptr;
+
+// Bucket 0 is below 16 us, bucket n >= 1 starts at 2^(n+3) us
+static int histogramBucket(uint32_t durationUs) {
+  if (durationUs < 16) {
+    return 0;
+  }
+  int bucket = 31 - __builtin_clz(durationUs) - 3;
+  return bucket < LOOP_HISTOGRAM_BUCKETS ? bucket : LOOP_HISTOGRAM_BUCKETS - 1;
+}
+
+static void recordStage(LoopStage stage, uint32_t durationUs) {
+  LoopStageStats& stats = stageStats[stage];
+  stats.count++;
+  stats.totalUs += durationUs;
+  stats.histogram[histogramBucket(durationUs)]++;
+  if (durationUs > stats.maxUs) {
+    stats.maxUs = durationUs;
+    stats.maxAtMs = millis();
+    stats.maxRoute = currentRoute;
+  }
+
+  if (stats.budgetUs == 0 || durationUs <= stats.budgetUs) {
+    return;
+  }
+  stats.overruns++;
+  LoopOverrun& overrun = overrunHistory[overrunTotal % LOOP_OVERRUN_HISTORY];
+  overrunTotal++;
+  overrun.stage = stage;
+  overrun.durationUs = durationUs;
+  overrun.atMs = millis();
+  overrun.route = currentRoute;
+  LOG_INFO(LOG_CAT_SYSTEM, "Loop overrun: %s took %lu us (budget %lu us)%s%s\n", stageNames[stage],
+           (unsigned long)durationUs, (unsigned long)stats.budgetUs,
+           currentRoute != nullptr ? ", route " : "", currentRoute != nullptr ? currentRoute : "");
+}
+
+// Starts the pass; returns the start mark of the first stage
+uint32_t beginLoopPass() {
+  if (cyclesPerUs == 0) {
+    cyclesPerUs = ESP.getCpuFreqMHz();
+    for (int i = 0; i < LOOP_STAGE_COUNT; i++) {
+      stageStats[i].budgetUs = i == LOOP_STAGE_PASS ? LOOP_PASS_BUDGET_US : LOOP_STAGE_BUDGET_US;
+    }
+  }
+  passStart = ESP.getCycleCount();
+  return passStart;
+}
+
+// Closes the stage that began at start; the result is the next stage's start.
+// The cycle counter wraps after about 17 s at 240 MHz, far beyond any stage.
+uint32_t endLoopStage(LoopStage stage, uint32_t start) {
+  uint32_t now = ESP.getCycleCount();
+  recordStage(stage, (now - start) / cyclesPerUs);
+  currentRoute = nullptr;
+  return now;
+}
+
+void endLoopPass() {
+  recordStage(LOOP_STAGE_PASS, (ESP.getCycleCount() - passStart) / cyclesPerUs);
+}
+
+// Called by route handlers so an overrun can name the request behind it.
+// route must outlive the monitor, as route paths registered with the servers do.
+void setLoopRoute(const char* route) {
+  currentRoute = route;
+}
+
+const LoopStageStats& getLoopStageStats(LoopStage stage) {
+  return stageStats[stage];
+}
+
+const char* getLoopStageName(LoopStage stage) {
+  return stageNames[stage];
+}
+
+// Returns LOOP_STAGE_COUNT for an unknown name
+LoopStage findLoopStage(const char* name) {
+  for (int i = 0; i < LOOP_STAGE_COUNT; i++) {
+    if (strcasecmp(name, stageNames[i]) == 0) {
+      return (LoopStage)i;
+    }
+  }
+  return LOOP_STAGE_COUNT;
+}
+
+bool setLoopStageBudget(LoopStage stage, uint32_t budgetUs) {
+  if (stage >= LOOP_STAGE_COUNT) {
+    return false;
+  }
+  stageStats[stage].budgetUs = budgetUs;
+  return true;
+}
+
+// Clears the measurements; budgets are kept
+void resetLoopStats() {
+  for (int i = 0; i < LOOP_STAGE_COUNT; i++) {
+    uint32_t budgetUs = stageStats[i].budgetUs;
+    stageStats[i] = LoopStageStats();
+    stageStats[i].budgetUs = budgetUs;
+  }
+  overrunTotal = 0;
+}
+
+uint32_t getLoopHistogramBucketUs(int bucket) {
+  return bucket == 0 ? 0 : 1UL << (bucket + 3);
+}
+
+// Overruns still held, at most LOOP_OVERRUN_HISTORY
+size_t getLoopOverrunCount() {
+  return overrunTotal < LOOP_OVERRUN_HISTORY ? overrunTotal : LOOP_OVERRUN_HISTORY;
+}
+
+// index 0 is the most recent
+const LoopOverrun& getLoopOverrun(size_t index) {
+  return overrunHistory[(overrunTotal - 1 - index) % LOOP_OVERRUN_HISTORY];
+}
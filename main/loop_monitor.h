@@ -0,0 +1,69 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Loop Latency Monitor Header
+ *
+ * Times every stage of loop() with the CPU cycle counter. One counter read
+ * closes a stage and opens the next, so the cost is a few instructions per
+ * stage and the monitor stays on in normal builds. Each stage keeps a
+ * log2 histogram, its average and its worst case. A stage that runs over its
+ * budget is logged with the HTTP route it was serving, and the most recent
+ * overruns are kept for /api/loop and the LOOP serial command.
+ */
+
+#ifndef LOOP_MONITOR_H
+#define LOOP_MONITOR_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Order matches the calls in loop()
+enum LoopStage {
+  LOOP_STAGE_WIFI,
+  LOOP_STAGE_BOOT,
+  LOOP_STAGE_DISCOVERY,
+  LOOP_STAGE_ALPACA,
+  LOOP_STAGE_WEB,
+  LOOP_STAGE_SCAN,
+  LOOP_STAGE_SERIAL,
+  LOOP_STAGE_EVENTS,
+  LOOP_STAGE_CALIBRATOR,
+  LOOP_STAGE_HOUSEKEEPING,
+  LOOP_STAGE_LOG,
+  LOOP_STAGE_PASS,                      // The whole pass, excluding the closing delay()
+  LOOP_STAGE_COUNT
+};
+
+struct LoopStageStats {
+  uint32_t count;
+  uint64_t totalUs;
+  uint32_t maxUs;
+  uint32_t maxAtMs;                     // millis() of the worst case
+  const char* maxRoute;                 // Route served during the worst case, nullptr if none
+  uint32_t budgetUs;                    // 0 = no budget
+  uint32_t overruns;
+  uint32_t histogram[LOOP_HISTOGRAM_BUCKETS];
+};
+
+struct LoopOverrun {
+  LoopStage stage;
+  uint32_t durationUs;
+  uint32_t atMs;
+  const char* route;
+};
+
+// Function prototypes
+uint32_t beginLoopPass();
+uint32_t endLoopStage(LoopStage stage, uint32_t start);
+void endLoopPass();
+void setLoopRoute(const char* route);
+
+const LoopStageStats& getLoopStageStats(LoopStage stage);
+const char* getLoopStageName(LoopStage stage);
+LoopStage findLoopStage(const char* name);
+bool setLoopStageBudget(LoopStage stage, uint32_t budgetUs);
+void resetLoopStats();
+uint32_t getLoopHistogramBucketUs(int bucket);
+size_t getLoopOverrunCount();
+const LoopOverrun& getLoopOverrun(size_t index);
+
+#endif // LOOP_MONITOR_H
@@ -39,148 +39,129 @@
 #include "alpaca_handler.h"
 #include "web_ui_handler.h"
 #include "serial_handler.h"
+#include "event_stream.h"
+#include "wifi_scan.h"
+#include "wifi_manager.h"
+#include "boot_sequencer.h"
+#include "heap_monitor.h"
+#include "loop_monitor.h"
+#include "preset_manager.h"
 
 // WiFi credentials and configuration
 char ssid[SSID_SIZE] = DEFAULT_WIFI_SSID;
 char password[PASSWORD_SIZE] = DEFAULT_WIFI_PASSWORD;
 bool apMode = false;
-unsigned long apStartTime = 0;
 
 // Timing variables
 unsigned long lastStatusUpdate = 0;
 
+// Boot graph - each phase starts once the phases in its after-mask are done.
+// Order must match BootPhaseId.
+enum BootPhaseId {
+  BOOT_CONFIG,
+  BOOT_CALIBRATOR,
+  BOOT_PRESETS,
+  BOOT_SERIAL,
+  BOOT_WIFI,
+  BOOT_ALPACA,
+  BOOT_WEB_UI,
+  BOOT_EVENTS,
+  BOOT_NETWORK,
+  BOOT_MDNS,
+  BOOT_PHASE_COUNT
+};
+
+static const BootPhase bootPhases[] = {
+  // name         start                            ready              after
+  { "config",     loadConfiguration,               nullptr,           0 },
+  { "calibrator", initializeCalibratorController,  nullptr,           BOOT_AFTER(BOOT_CONFIG) },
+  { "presets",    initPresets,                     nullptr,           0 },
+  { "serial",     initSerialHandler,               nullptr,           0 },
+  { "wifi",       initWiFi,                        nullptr,           BOOT_AFTER(BOOT_CONFIG) },
+  { "alpaca",     setupAlpacaAPI,                  nullptr,           BOOT_AFTER(BOOT_WIFI) },
+  { "webui",      initWebUI,                       nullptr,           BOOT_AFTER(BOOT_WIFI) | BOOT_AFTER(BOOT_CALIBRATOR) },
+  { "events",     initEventStream,                 nullptr,           BOOT_AFTER(BOOT_CALIBRATOR) },
+  { "network",    nullptr,                         isWiFiNetworkUp,   BOOT_AFTER(BOOT_WIFI) },
+  { "mdns",       initAlpacaMDNS,                  nullptr,           BOOT_AFTER(BOOT_NETWORK) | BOOT_AFTER(BOOT_ALPACA) },
+};
+
+static_assert(sizeof(bootPhases) / sizeof(bootPhases[0]) == BOOT_PHASE_COUNT,
+              "bootPhases must have one entry per BootPhaseId");
+
 void setup() {
   // Initialize debug output (disabled by default)
   Debug.begin(115200);
-  Debug.println("ESP32 ASCOM Alpaca Flat Panel Calibrator");
-  Debug.println("Version: " + String(DEVICE_VERSION));
-  Debug.println("Manufacturer: " + String(DEVICE_MANUFACTURER));
-  
-  // Load configuration from preferences
-  loadConfiguration();
-  
-  // Initialize calibrator hardware
-  initializeCalibratorController();
-  
-  // Initialize serial command handler
-  initSerialHandler();
-  
-  // Initialize WiFi
-  initWiFi();
-  
-  // Initialize Alpaca API
-  setupAlpacaAPI();
-  
-  // Initialize Web UI
-  initWebUI();
-  
-  Debug.println("Setup complete!");
-  Debug.println("Available interfaces:");
-  Debug.printf("  Web UI: http://%s/\n", WiFi.localIP().toString().c_str());
-  Debug.printf("  ASCOM Alpaca API: http://%s:%d/\n", WiFi.localIP().toString().c_str(), ALPACA_PORT);
-  Debug.println("  Serial commands: Available via USB");
-  Debug.println();
+  initHeapMonitor();
+  LOG_INFO(LOG_CAT_SYSTEM, "ESP32 ASCOM Alpaca Flat Panel Calibrator\n");
+  LOG_INFO(LOG_CAT_SYSTEM, "Version: " DEVICE_VERSION "\n");
+  LOG_INFO(LOG_CAT_SYSTEM, "Manufacturer: " DEVICE_MANUFACTURER "\n");
+  
+  // Everything that does not wait for the network completes here; the WiFi
+  // connection and mDNS finish from loop()
+  startBootSequence(bootPhases, BOOT_PHASE_COUNT);
+  
+  LOG_INFO(LOG_CAT_SYSTEM, "Setup complete in %lu ms\n", millis());
+  LOG_INFO(LOG_CAT_SYSTEM, "  Serial commands: Available via USB\n");
+  LOG_INFO(LOG_CAT_SYSTEM, "  Web UI and ASCOM Alpaca API: listed once WiFi connects\n");
+  LOG_INFO(LOG_CAT_SYSTEM, "\n");
 }
 
 void loop() {
+  // Each stage is timed from the end of the previous one, see loop_monitor.h
+  uint32_t stageStart = beginLoopPass();
+  
   // Handle WiFi connection management
   handleWiFiConnection();
+  stageStart = endLoopStage(LOOP_STAGE_WIFI, stageStart);
+  
+  // Start boot phases that were waiting for the network
+  handleBootSequence();
+  stageStart = endLoopStage(LOOP_STAGE_BOOT, stageStart);
   
   // Handle Alpaca discovery and API requests
   handleAlpacaDiscovery();
+  stageStart = endLoopStage(LOOP_STAGE_DISCOVERY, stageStart);
   handleAlpacaAPI();
+  stageStart = endLoopStage(LOOP_STAGE_ALPACA, stageStart);
   
   // Handle Web UI requests
   handleWebUI();
+  stageStart = endLoopStage(LOOP_STAGE_WEB, stageStart);
+  
+  // Collect background WiFi scan results
+  handleWifiScan();
+  stageStart = endLoopStage(LOOP_STAGE_SCAN, stageStart);
   
   // Handle serial commands
   handleSerialCommands();
+  stageStart = endLoopStage(LOOP_STAGE_SERIAL, stageStart);
+  
+  // Push pending state events and heartbeats
+  handleEventStream();
+  stageStart = endLoopStage(LOOP_STAGE_EVENTS, stageStart);
   
   // Update calibrator status
   updateCalibratorStatus();
+  stageStart = endLoopStage(LOOP_STAGE_CALIBRATOR, stageStart);
+  
+  // Track the largest free block for fragmentation
+  handleHeapMonitor();
   
   // Periodic status updates
   if (millis() - lastStatusUpdate > 30000) { // Every 30 seconds
     lastStatusUpdate = millis();
-    Debug.printf(2, "Status: %s, Brightness: %d%%, WiFi: %s\n", 
-                 getCalibratorStateString().c_str(), 
-                 getCurrentBrightness(),
-                 WiFi.isConnected() ? "Connected" : (apMode ? "AP Mode" : "Disconnected"));
+    LOG_VERBOSE(LOG_CAT_SYSTEM, "Status: %s, Brightness: %d%%, WiFi: %s\n", 
+                getCalibratorStateString().c_str(), 
+                getCurrentBrightness(),
+                WiFi.isConnected() ? "Connected" : (apMode ? "AP Mode" : "Disconnected"));
   }
+  stageStart = endLoopStage(LOOP_STAGE_HOUSEKEEPING, stageStart);
+  
+  // Write queued debug output while there is nothing else to do
+  Debug.drain();
+  endLoopStage(LOOP_STAGE_LOG, stageStart);
+  endLoopPass();
   
   // Small delay to prevent watchdog issues
   delay(10);
 }
-
-void initWiFi() {
-  Debug.println("Initializing WiFi...");
-  
-  // Set WiFi mode
-  WiFi.mode(WIFI_STA);
-  
-  // Check if we have valid credentials
-  if (strlen(ssid) == 0 || strcmp(ssid, DEFAULT_WIFI_SSID) == 0) {
-    Debug.println("No WiFi credentials configured, starting AP mode");
-    startAPMode();
-    return;
-  }
-  
-  // Try to connect to WiFi
-  Debug.printf("Connecting to WiFi network: %s\n", ssid);
-  WiFi.begin(ssid, password);
-  
-  // Wait for connection with timeout
-  unsigned long startTime = millis();
-  while (WiFi.status() != WL_CONNECTED && (millis() - startTime) < 30000) {
-    delay(500);
-    Debug.print(".");
-  }
-  Debug.println();
-  
-  if (WiFi.status() == WL_CONNECTED) {
-    Debug.printf("WiFi connected successfully!\n");
-    Debug.printf("IP address: %s\n", WiFi.localIP().toString().c_str());
-    Debug.printf("Signal strength: %d dBm\n", WiFi.RSSI());
-    apMode = false;
-  } else {
-    Debug.println("Failed to connect to WiFi, starting AP mode");
-    startAPMode();
-  }
-}
-
-void startAPMode() {
-  Debug.println("Starting Access Point mode...");
-  
-  WiFi.mode(WIFI_AP);
-  WiFi.softAP(AP_SSID, AP_PASSWORD);
-  
-  IPAddress IP = WiFi.softAPIP();
-  Debug.printf("AP started successfully!\n");
-  Debug.printf("SSID: %s\n", AP_SSID);
-  Debug.printf("Password: %s\n", AP_PASSWORD);
-  Debug.printf("IP address: %s\n", IP.toString().c_str());
-  
-  apMode = true;
-  apStartTime = millis();
-}
-
-void handleWiFiConnection() {
-  if (apMode) {
-    // In AP mode, check if we should try to connect to WiFi again
-    if (millis() - apStartTime > AP_TIMEOUT) {
-      Debug.println("AP mode timeout, attempting WiFi connection...");
-      apMode = false;
-      initWiFi();
-    }
-  } else {
-    // In STA mode, check if connection is lost
-    if (WiFi.status() != WL_CONNECTED) {
-      static unsigned long lastReconnectAttempt = 0;
-      if (millis() - lastReconnectAttempt > 30000) { // Try reconnect every 30 seconds
-        Debug.println("WiFi connection lost, attempting reconnection...");
-        WiFi.reconnect();
-        lastReconnectAttempt = millis();
-      }
-    }
-  }
-}
\ No newline at end of file
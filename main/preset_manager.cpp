@@ -0,0 +1,139 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Filter Preset Manager Implementation
+ */
+
+#include "preset_manager.h"
+#include "Debug.h"
+#include <Preferences.h>
+
+// Blob layout: version, count, then count packed entries
+#define PRESET_BLOB_VERSION 1
+#define PRESET_BLOB_HEADER 2
+
+static CalibratorPreset presets[PRESET_MAX_COUNT];
+static size_t presetCount = 0;
+
+static void storePresets() {
+  uint8_t blob[PRESET_BLOB_HEADER + sizeof(presets)];
+  blob[0] = PRESET_BLOB_VERSION;
+  blob[1] = presetCount;
+  memcpy(&blob[PRESET_BLOB_HEADER], presets, presetCount * sizeof(CalibratorPreset));
+  
+  Preferences prefs;
+  prefs.begin(PREFERENCES_NAMESPACE, false);
+  prefs.putBytes(PREF_PRESETS, blob, PRESET_BLOB_HEADER + presetCount * sizeof(CalibratorPreset));
+  prefs.end();
+}
+
+void initPresets() {
+  uint8_t blob[PRESET_BLOB_HEADER + sizeof(presets)];
+  Preferences prefs;
+  prefs.begin(PREFERENCES_NAMESPACE, true);
+  size_t length = prefs.getBytesLength(PREF_PRESETS);
+  if (length >= PRESET_BLOB_HEADER && length <= sizeof(blob)) {
+    length = prefs.getBytes(PREF_PRESETS, blob, length);
+  } else {
+    length = 0;
+  }
+  prefs.end();
+  
+  presetCount = 0;
+  if (length >= PRESET_BLOB_HEADER && blob[0] == PRESET_BLOB_VERSION && blob[1] <= PRESET_MAX_COUNT &&
+      length == PRESET_BLOB_HEADER + blob[1] * sizeof(CalibratorPreset)) {
+    presetCount = blob[1];
+    memcpy(presets, &blob[PRESET_BLOB_HEADER], presetCount * sizeof(CalibratorPreset));
+  }
+  LOG_INFO(LOG_CAT_CALIBRATOR, "Loaded %u filter presets\n", (unsigned)presetCount);
+}
+
+size_t getPresetCount() {
+  return presetCount;
+}
+
+const CalibratorPreset& getPreset(size_t index) {
+  return presets[index];
+}
+
+const CalibratorPreset* findPreset(const char* name) {
+  for (size_t i = 0; i < presetCount; i++) {
+    if (strcasecmp(presets[i].name, name) == 0) {
+      return &presets[i];
+    }
+  }
+  return nullptr;
+}
+
+// Names end up in URLs, HTML and serial commands, so keep them plain
+static bool validPresetName(const char* name) {
+  size_t length = strlen(name);
+  if (length == 0 || length >= PRESET_NAME_SIZE) {
+    return false;
+  }
+  for (size_t i = 0; i < length; i++) {
+    if (!isalnum((unsigned char)name[i]) && name[i] != '-' && name[i] != '_') {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Adds the preset or replaces the one with the same name
+PresetSaveResult savePreset(const char* name, int brightness, long rampMs, long exposureMs) {
+  if (!validPresetName(name)) {
+    return PRESET_BAD_NAME;
+  }
+  if (brightness < MIN_BRIGHTNESS || brightness > MAX_BRIGHTNESS || rampMs < 0 || rampMs > PRESET_MAX_RAMP_MS ||
+      exposureMs < 0) {
+    return PRESET_BAD_VALUE;
+  }
+  
+  CalibratorPreset* preset = (CalibratorPreset*)findPreset(name);
+  if (preset == nullptr) {
+    if (presetCount >= PRESET_MAX_COUNT) {
+      return PRESET_TABLE_FULL;
+    }
+    preset = &presets[presetCount++];
+  }
+  *preset = CalibratorPreset();
+  strncpy(preset->name, name, sizeof(preset->name) - 1);
+  preset->brightness = brightness;
+  preset->rampMs = rampMs;
+  preset->exposureMs = exposureMs;
+  
+  storePresets();
+  LOG_INFO(LOG_CAT_CALIBRATOR, "Preset %s saved: %d%%, ramp %ld ms, exposure %ld ms\n", preset->name, brightness,
+           rampMs, exposureMs);
+  return PRESET_SAVED;
+}
+
+bool deletePreset(const char* name) {
+  const CalibratorPreset* preset = findPreset(name);
+  if (preset == nullptr) {
+    return false;
+  }
+  size_t index = preset - presets;
+  memmove(&presets[index], &presets[index + 1], (presetCount - index - 1) * sizeof(CalibratorPreset));
+  presetCount--;
+  storePresets();
+  LOG_INFO(LOG_CAT_CALIBRATOR, "Preset %s deleted\n", name);
+  return true;
+}
+
+const char* getPresetSaveResultString(PresetSaveResult result) {
+  switch (result) {
+    case PRESET_SAVED:
+      return "Saved";
+    case PRESET_BAD_NAME: {
+      static char message[64];
+      snprintf(message, sizeof(message), "Invalid name: up to %d letters, digits, '-' or '_'", PRESET_NAME_SIZE - 1);
+      return message;
+    }
+    case PRESET_BAD_VALUE:
+      return "Brightness or ramp out of range";
+    case PRESET_TABLE_FULL:
+      return "Preset table is full";
+    default:
+      return "Unknown";
+  }
+}
@@ -0,0 +1,41 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Filter Preset Manager Header
+ *
+ * Named presets (L, R, G, B, Ha, ...) hold the brightness, an optional ramp
+ * and the suggested exposure for one filter, so a sequencer can switch the
+ * panel with one Alpaca Action instead of keeping its own table. The table
+ * is stored as a single NVS blob holding only the entries in use.
+ */
+
+#ifndef PRESET_MANAGER_H
+#define PRESET_MANAGER_H
+
+#include <Arduino.h>
+#include "config.h"
+
+struct CalibratorPreset {
+  char name[PRESET_NAME_SIZE];          // Matched case-insensitively
+  uint8_t brightness;                   // Percent
+  uint8_t reserved;
+  uint16_t rampMs;                      // 0 = switch at once
+  uint32_t exposureMs;                  // Suggested flat exposure, 0 = none
+};
+
+enum PresetSaveResult {
+  PRESET_SAVED,
+  PRESET_BAD_NAME,                      // Empty, too long or not letters, digits, '-' and '_'
+  PRESET_BAD_VALUE,                     // Brightness or ramp out of range
+  PRESET_TABLE_FULL
+};
+
+// Function prototypes
+void initPresets();
+size_t getPresetCount();
+const CalibratorPreset& getPreset(size_t index);
+const CalibratorPreset* findPreset(const char* name);
+PresetSaveResult savePreset(const char* name, int brightness, long rampMs, long exposureMs);
+bool deletePreset(const char* name);
+const char* getPresetSaveResultString(PresetSaveResult result);
+
+#endif // PRESET_MANAGER_H
@@ -0,0 +1,137 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * HTTP Rate Limiter Implementation
+ */
+
+#include "rate_limiter.h"
+#include "Debug.h"
+
+static RateLimitClient clients[RATE_LIMIT_CLIENTS];
+static RateLimitStats stats;
+static uint32_t perSecond = RATE_LIMIT_PER_SECOND;
+static uint32_t burst = RATE_LIMIT_BURST;
+static bool refused = false;
+
+static String formatIP(uint32_t ip) {
+  return IPAddress(ip).toString();
+}
+
+// Bucket for ip, starting a full one in the least recently seen slot if needed
+static RateLimitClient& findClient(uint32_t ip, uint32_t now) {
+  RateLimitClient* oldest = &clients[0];
+  for (int i = 0; i < RATE_LIMIT_CLIENTS; i++) {
+    if (clients[i].ip == ip) {
+      return clients[i];
+    }
+    if (clients[i].ip == 0 || (oldest->ip != 0 && now - clients[i].lastSeenMs > now - oldest->lastSeenMs)) {
+      oldest = &clients[i];
+    }
+  }
+  if (oldest->ip != 0) {
+    stats.evicted++;
+  }
+  *oldest = RateLimitClient();
+  oldest->ip = ip;
+  oldest->tokensMilli = burst * 1000;
+  oldest->refilledAtMs = now;
+  return *oldest;
+}
+
+// Takes a token for a request from ip. Returns false when the bucket is empty;
+// retryAfterMs is then how long until the next token.
+bool admitHttpRequest(uint32_t ip, uint32_t& retryAfterMs) {
+  // 0 is a peer the socket could not name; it is not worth a shared bucket
+  if (perSecond == 0 || ip == 0) {
+    return true;
+  }
+
+  uint32_t now = millis();
+  RateLimitClient& client = findClient(ip, now);
+  client.lastSeenMs = now;
+
+  // perSecond tokens a second is perSecond thousandths a millisecond. The cap
+  // on elapsed keeps the product in range after a long quiet spell.
+  uint32_t elapsed = min(now - client.refilledAtMs, (uint32_t)60000);
+  client.tokensMilli = min(client.tokensMilli + elapsed * perSecond, burst * 1000);
+  client.refilledAtMs = now;
+
+  if (client.tokensMilli >= 1000) {
+    client.tokensMilli -= 1000;
+    client.allowed++;
+    client.limiting = false;
+    return true;
+  }
+
+  refused = true;
+  client.limited++;
+  client.lastLimitedAtMs = now;
+  stats.limited++;
+  retryAfterMs = (1000 - client.tokensMilli + perSecond - 1) / perSecond;
+  if (!client.limiting) {
+    client.limiting = true;
+    LOG_INFO(LOG_CAT_WEB, "Rate limiting %s (%lu refused so far)\n", formatIP(ip).c_str(),
+             (unsigned long)client.limited);
+  }
+  return false;
+}
+
+// True once after a request was refused, so the server can be polled again
+bool takeRefusedRequest() {
+  bool result = refused;
+  refused = false;
+  return result;
+}
+
+// perSecond 0 turns limiting off. Buckets are refilled to the new burst size.
+bool setRateLimit(uint32_t newPerSecond, uint32_t newBurst) {
+  if (newPerSecond > 1000 || (newPerSecond > 0 && newBurst == 0) || newBurst > 1000) {
+    return false;
+  }
+  perSecond = newPerSecond;
+  burst = newBurst;
+  for (int i = 0; i < RATE_LIMIT_CLIENTS; i++) {
+    clients[i].tokensMilli = burst * 1000;
+    clients[i].limiting = false;
+  }
+  return true;
+}
+
+uint32_t getRateLimitPerSecond() {
+  return perSecond;
+}
+
+uint32_t getRateLimitBurst() {
+  return burst;
+}
+
+// Clients in the table, in slot order; free slots are skipped
+size_t getRateLimitClientCount() {
+  size_t count = 0;
+  for (int i = 0; i < RATE_LIMIT_CLIENTS; i++) {
+    if (clients[i].ip != 0) {
+      count++;
+    }
+  }
+  return count;
+}
+
+const RateLimitClient& getRateLimitClient(size_t index) {
+  for (int i = 0; i < RATE_LIMIT_CLIENTS; i++) {
+    if (clients[i].ip != 0 && index-- == 0) {
+      return clients[i];
+    }
+  }
+  return clients[0];
+}
+
+const RateLimitStats& getRateLimitStats() {
+  return stats;
+}
+
+// Forgets every client and clears the counters; the limits are kept
+void resetRateLimitStats() {
+  for (int i = 0; i < RATE_LIMIT_CLIENTS; i++) {
+    clients[i] = RateLimitClient();
+  }
+  stats = RateLimitStats();
+}
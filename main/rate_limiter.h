@@ -0,0 +1,49 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * HTTP Rate Limiter Header
+ *
+ * Both HTTP servers are served from the one loop(), so a client polling in a
+ * tight loop starves every other client and the serial console. Each remote
+ * IP gets a token bucket that refills at the configured rate up to the burst
+ * size, and every routed request takes one token. A request that finds the
+ * bucket empty is answered with 429 and Retry-After before its handler runs.
+ * Buckets live in a small fixed table; when it is full the least recently
+ * seen client is replaced, which only ever forgives a client, never blocks one.
+ * The servers serve one request per loop pass, so a refused request does not
+ * use up the pass: the loop serves the next one waiting straight away.
+ */
+
+#ifndef RATE_LIMITER_H
+#define RATE_LIMITER_H
+
+#include <Arduino.h>
+#include "config.h"
+
+struct RateLimitClient {
+  uint32_t ip;                          // As IPAddress stores it, 0 = free slot
+  uint32_t tokensMilli;                 // Thousandths of a request
+  uint32_t refilledAtMs;
+  uint32_t lastSeenMs;
+  uint32_t allowed;
+  uint32_t limited;                     // Requests answered with 429
+  uint32_t lastLimitedAtMs;
+  bool limiting;                        // Last request was refused, so the next refusal is not logged
+};
+
+struct RateLimitStats {
+  uint32_t limited;                     // All clients, including replaced ones
+  uint32_t evicted;                     // Clients replaced to make room
+};
+
+// Function prototypes
+bool admitHttpRequest(uint32_t ip, uint32_t& retryAfterMs);
+bool takeRefusedRequest();
+bool setRateLimit(uint32_t perSecond, uint32_t burst);
+uint32_t getRateLimitPerSecond();
+uint32_t getRateLimitBurst();
+size_t getRateLimitClientCount();
+const RateLimitClient& getRateLimitClient(size_t index);
+const RateLimitStats& getRateLimitStats();
+void resetRateLimitStats();
+
+#endif // RATE_LIMITER_H
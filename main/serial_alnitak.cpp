@@ -0,0 +1,100 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Alnitak (Optec) Flat-Man Serial Protocol Emulation
+ */
+
+#include "serial_alnitak.h"
+#include "calibrator_controller.h"
+#include "command_gateway.h"
+#include "Debug.h"
+
+// Level applied by the next light-on command; Alnitak keeps it while the light is off
+static int alnitakLevel = 255;
+
+int alnitakLevelToBrightness(int level) {
+  return (level * getMaxBrightness() + 127) / 255;
+}
+
+int brightnessToAlnitakLevel(int brightness) {
+  int maxBright = getMaxBrightness();
+  if (maxBright <= 0) return 0;
+  return constrain((brightness * 255 + maxBright / 2) / maxBright, 0, 255);
+}
+
+static void sendAlnitakResponse(char command, int value) {
+  Serial.printf("*%c%02d%03d\n", command, ALNITAK_PRODUCT_ID, value);
+}
+
+// Parse the three digit argument of ">XNNN"
+static bool parseAlnitakValue(const char* digits, int& value) {
+  value = 0;
+  for (int i = 0; i < 3; i++) {
+    if (!isDigit(digits[i])) return false;
+    value = value * 10 + (digits[i] - '0');
+  }
+  return true;
+}
+
+// Dispatch one ">XNNN" command; command points at "XNNN". Only B has an
+// argument: drivers fill the others with "000" or "OOO", so any three
+// characters are accepted there.
+void processAlnitakCommand(const char* command) {
+  bool lightOn = getCurrentBrightness() > 0;
+  
+  switch (command[0]) {
+    case 'P':  // Ping
+      sendAlnitakResponse('P', 0);
+      break;
+      
+    case 'O':  // Open cover - no cover on a Flat-Man, acknowledge only
+    case 'C':  // Close cover
+    case 'H':  // Halt cover
+      sendAlnitakResponse(command[0], 0);
+      break;
+      
+    case 'L':  // Light on at the stored level; the reply has no error field, a refusal is only logged
+      commandBrightness(COMMAND_SOURCE_SERIAL, 0, alnitakLevelToBrightness(alnitakLevel));
+      sendAlnitakResponse('L', 0);
+      break;
+      
+    case 'D':  // Light off, level is kept
+      commandCalibratorOff(COMMAND_SOURCE_SERIAL, 0);
+      sendAlnitakResponse('D', 0);
+      break;
+      
+    case 'B': {  // Set brightness, applied immediately if the light is on
+      int value;
+      if (!parseAlnitakValue(&command[1], value)) {
+        LOG_VERBOSE(LOG_CAT_SERIAL, "Alnitak: malformed command >%s\n", command);
+        break;
+      }
+      alnitakLevel = constrain(value, 0, 255);
+      if (lightOn) {
+        commandBrightness(COMMAND_SOURCE_SERIAL, 0, alnitakLevelToBrightness(alnitakLevel));
+      }
+      sendAlnitakResponse('B', alnitakLevel);
+      break;
+    }
+      
+    case 'J': {  // Get brightness
+      // Percent steps are coarser than 0-255, so while the panel is still at
+      // the stored level that level is reported, not one converted back
+      int brightness = getCurrentBrightness();
+      bool atLevel = !lightOn || brightness == alnitakLevelToBrightness(alnitakLevel);
+      sendAlnitakResponse('J', atLevel ? alnitakLevel : brightnessToAlnitakLevel(brightness));
+      break;
+    }
+      
+    case 'S':  // State: motor stopped, light on/off, cover not open/closed
+      sendAlnitakResponse('S', lightOn ? 10 : 0);
+      break;
+      
+    case 'V':  // Firmware version
+      sendAlnitakResponse('V', ALNITAK_FIRMWARE_VERSION);
+      break;
+      
+    default:
+      LOG_VERBOSE(LOG_CAT_SERIAL, "Alnitak: unknown command >%s\n", command);
+      break;
+  }
+}
@@ -0,0 +1,23 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Alnitak (Optec) Flat-Man Serial Protocol Emulation Header
+ *
+ * Commands are ">XNNN" followed by CR; replies are "*XIINNN" followed by LF,
+ * where II is the product ID. Brightness uses the Alnitak 0-255 scale,
+ * mapped linearly onto 0..max brightness percent.
+ */
+
+#ifndef SERIAL_ALNITAK_H
+#define SERIAL_ALNITAK_H
+
+#include "config.h"
+
+// Command body length after the '>' prefix, e.g. "B128"
+#define ALNITAK_COMMAND_LENGTH 4
+
+// Function prototypes
+void processAlnitakCommand(const char* command);
+int alnitakLevelToBrightness(int level);
+int brightnessToAlnitakLevel(int brightness);
+
+#endif // SERIAL_ALNITAK_H
@@ -0,0 +1,296 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Binary Framed Serial Protocol Implementation
+ */
+
+#include "serial_binary.h"
+#include "calibrator_controller.h"
+#include "command_gateway.h"
+#include "Debug.h"
+#include <WiFi.h>
+
+// Encoded frame accumulator (COBS adds one byte per 254 plus the code byte)
+#define BINARY_MAX_ENCODED (BINARY_MAX_FRAME + BINARY_MAX_FRAME / 254 + 2)
+
+static bool binaryMode = false;
+static uint8_t frameBuffer[BINARY_MAX_ENCODED];
+static size_t frameLength = 0;
+static bool frameOverflow = false;
+
+// The text parser dispatches BINARY on the first line ending byte, so the \n
+// of a CRLF host arrives after the switch. Line endings before the first
+// frame byte are dropped rather than taken as the start of a frame.
+static bool skipLineEnding = false;
+
+// Collects debug output and forwards each line as a log channel frame
+class BinaryLogPrint : public Print {
+public:
+  size_t write(uint8_t c) override {
+    line[length++] = c;
+    if (c == '\n' || length >= sizeof(line)) {
+      flushLine();
+    }
+    return 1;
+  }
+
+  void flushLine() {
+    if (length > 0) {
+      sendBinaryFrame(BINARY_CHANNEL_LOG, 0, 0, BINARY_STATUS_OK, line, length);
+      length = 0;
+    }
+  }
+
+private:
+  uint8_t line[BINARY_MAX_PAYLOAD];
+  size_t length = 0;
+};
+
+static BinaryLogPrint binaryLog;
+
+void enterSerialBinaryMode() {
+  frameLength = 0;
+  frameOverflow = false;
+  skipLineEnding = true;
+  binaryMode = true;
+  Debug.setOutput(binaryLog);
+}
+
+void exitSerialBinaryMode() {
+  binaryLog.flushLine();
+  binaryMode = false;
+  Debug.setOutput(Serial);
+}
+
+bool isSerialBinaryMode() {
+  return binaryMode;
+}
+
+uint16_t crc16Ccitt(const uint8_t* data, size_t length) {
+  uint16_t crc = 0xFFFF;
+  for (size_t i = 0; i < length; i++) {
+    crc ^= (uint16_t)data[i] << 8;
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+  }
+  return crc;
+}
+
+// COBS encode; output must hold length + length / 254 + 1 bytes
+static size_t cobsEncode(const uint8_t* input, size_t length, uint8_t* output) {
+  size_t codeIndex = 0;
+  size_t outIndex = 1;
+  uint8_t code = 1;
+
+  for (size_t i = 0; i < length; i++) {
+    if (input[i] == 0) {
+      output[codeIndex] = code;
+      codeIndex = outIndex++;
+      code = 1;
+    } else {
+      output[outIndex++] = input[i];
+      if (++code == 0xFF) {
+        output[codeIndex] = code;
+        codeIndex = outIndex++;
+        code = 1;
+      }
+    }
+  }
+  output[codeIndex] = code;
+  return outIndex;
+}
+
+// COBS decode in place; returns the decoded length or 0 if malformed
+static size_t cobsDecode(uint8_t* buffer, size_t length) {
+  size_t inIndex = 0;
+  size_t outIndex = 0;
+
+  while (inIndex < length) {
+    uint8_t code = buffer[inIndex++];
+    if (code == 0 || inIndex + code - 1 > length) {
+      return 0;
+    }
+    for (uint8_t i = 1; i < code; i++) {
+      buffer[outIndex++] = buffer[inIndex++];
+    }
+    if (code != 0xFF && inIndex < length) {
+      buffer[outIndex++] = 0;
+    }
+  }
+  return outIndex;
+}
+
+void sendBinaryFrame(uint8_t channel, uint16_t requestId, uint8_t opcode, uint8_t status,
+                     const uint8_t* payload, size_t payloadLength) {
+  if (payloadLength > BINARY_MAX_PAYLOAD) {
+    payloadLength = BINARY_MAX_PAYLOAD;
+  }
+
+  uint8_t frame[BINARY_MAX_FRAME];
+  frame[0] = channel;
+  frame[1] = requestId & 0xFF;
+  frame[2] = requestId >> 8;
+  frame[3] = opcode;
+  frame[4] = status;
+  memcpy(&frame[BINARY_HEADER_SIZE], payload, payloadLength);
+
+  size_t length = BINARY_HEADER_SIZE + payloadLength;
+  uint16_t crc = crc16Ccitt(frame, length);
+  frame[length++] = crc & 0xFF;
+  frame[length++] = crc >> 8;
+
+  uint8_t encoded[BINARY_MAX_ENCODED];
+  size_t encodedLength = cobsEncode(frame, length, encoded);
+  encoded[encodedLength++] = 0x00;
+  Serial.write(encoded, encodedLength);
+}
+
+static void sendBinaryResponse(uint16_t requestId, uint8_t opcode, uint8_t status,
+                               const uint8_t* payload = nullptr, size_t payloadLength = 0) {
+  sendBinaryFrame(BINARY_CHANNEL_COMMAND, requestId, opcode, status, payload, payloadLength);
+}
+
+static void sendBinaryByte(uint16_t requestId, uint8_t opcode, uint8_t value) {
+  sendBinaryResponse(requestId, opcode, BINARY_STATUS_OK, &value, 1);
+}
+
+// Bulk status payload:
+//   [brightness u8][maxBrightness u8][calibratorState u8][coverState u8]
+//   [flags u8: bit0 connected, bit1 WiFi connected][freeHeap u32 LE]
+static void handleBinaryStatus(uint16_t requestId, uint8_t opcode) {
+  uint8_t payload[9];
+  uint32_t freeHeap = ESP.getFreeHeap();
+
+  payload[0] = getCurrentBrightness();
+  payload[1] = getMaxBrightness();
+  payload[2] = getCalibratorState();
+  payload[3] = getCoverState();
+  payload[4] = (isConnected ? 0x01 : 0) | (WiFi.status() == WL_CONNECTED ? 0x02 : 0);
+  payload[5] = freeHeap & 0xFF;
+  payload[6] = (freeHeap >> 8) & 0xFF;
+  payload[7] = (freeHeap >> 16) & 0xFF;
+  payload[8] = freeHeap >> 24;
+
+  sendBinaryResponse(requestId, opcode, BINARY_STATUS_OK, payload, sizeof(payload));
+}
+
+static BinaryStatus binaryStatus(CommandResult result) {
+  switch (result) {
+    case COMMAND_OK: return BINARY_STATUS_OK;
+    case COMMAND_INVALID_VALUE: return BINARY_STATUS_OUT_OF_RANGE;
+    case COMMAND_BUSY: return BINARY_STATUS_BUSY;
+    default: return BINARY_STATUS_FAILED;
+  }
+}
+
+static void dispatchBinaryRequest(uint16_t requestId, uint8_t opcode,
+                                  const uint8_t* payload, size_t payloadLength) {
+  // Opcodes that take a single byte argument
+  bool needsByte = opcode == BINARY_OP_SET_BRIGHTNESS || opcode == BINARY_OP_SET_MAX_BRIGHTNESS;
+  if (needsByte ? payloadLength != 1 : payloadLength != 0) {
+    sendBinaryResponse(requestId, opcode, BINARY_STATUS_BAD_LENGTH);
+    return;
+  }
+
+  switch (opcode) {
+    case BINARY_OP_PING:
+      sendBinaryResponse(requestId, opcode, BINARY_STATUS_OK);
+      break;
+
+    case BINARY_OP_GET_BRIGHTNESS:
+      sendBinaryByte(requestId, opcode, getCurrentBrightness());
+      break;
+
+    case BINARY_OP_SET_BRIGHTNESS:
+      sendBinaryResponse(requestId, opcode, binaryStatus(commandBrightness(COMMAND_SOURCE_SERIAL, 0, payload[0])));
+      break;
+
+    case BINARY_OP_GET_STATE:
+      sendBinaryByte(requestId, opcode, getCalibratorState());
+      break;
+
+    case BINARY_OP_GET_MAX_BRIGHTNESS:
+      sendBinaryByte(requestId, opcode, getMaxBrightness());
+      break;
+
+    case BINARY_OP_SET_MAX_BRIGHTNESS:
+      sendBinaryResponse(requestId, opcode, binaryStatus(commandMaxBrightness(COMMAND_SOURCE_SERIAL, 0, payload[0])));
+      break;
+
+    case BINARY_OP_GET_STATUS:
+      handleBinaryStatus(requestId, opcode);
+      break;
+
+    case BINARY_OP_CALIBRATOR_ON:
+      sendBinaryResponse(requestId, opcode, binaryStatus(commandCalibratorOn(COMMAND_SOURCE_SERIAL, 0)));
+      break;
+
+    case BINARY_OP_CALIBRATOR_OFF:
+      sendBinaryResponse(requestId, opcode, binaryStatus(commandCalibratorOff(COMMAND_SOURCE_SERIAL, 0)));
+      break;
+
+    case BINARY_OP_EXIT:
+      sendBinaryResponse(requestId, opcode, BINARY_STATUS_OK);
+      exitSerialBinaryMode();
+      Serial.println("Text mode");
+      break;
+
+    default:
+      sendBinaryResponse(requestId, opcode, BINARY_STATUS_UNKNOWN_OPCODE);
+      break;
+  }
+}
+
+// Validate and dispatch one complete (still encoded) frame
+static bool processBinaryFrame() {
+  size_t length = cobsDecode(frameBuffer, frameLength);
+  if (length < BINARY_HEADER_SIZE + BINARY_CRC_SIZE) {
+    return false;  // Too short to carry a request ID - nothing to answer
+  }
+
+  uint16_t requestId = frameBuffer[1] | (frameBuffer[2] << 8);
+  uint8_t opcode = frameBuffer[3];
+  size_t crcOffset = length - BINARY_CRC_SIZE;
+  uint16_t received = frameBuffer[crcOffset] | (frameBuffer[crcOffset + 1] << 8);
+
+  if (crc16Ccitt(frameBuffer, crcOffset) != received) {
+    sendBinaryResponse(requestId, opcode, BINARY_STATUS_BAD_CRC);
+    return true;
+  }
+
+  if (frameBuffer[0] != BINARY_CHANNEL_COMMAND) {
+    return false;  // Hosts only send on the command channel
+  }
+
+  dispatchBinaryRequest(requestId, opcode, &frameBuffer[BINARY_HEADER_SIZE],
+                        crcOffset - BINARY_HEADER_SIZE);
+  return true;
+}
+
+// Feed one byte; returns true when a request was answered
+bool parseBinaryByte(uint8_t c) {
+  if (skipLineEnding) {
+    if (c == '\r' || c == '\n') {
+      return false;
+    }
+    skipLineEnding = false;
+  }
+
+  if (c != 0x00) {
+    if (frameLength < sizeof(frameBuffer)) {
+      frameBuffer[frameLength++] = c;
+    } else {
+      frameOverflow = true;
+    }
+    return false;
+  }
+
+  // Delimiter - an overflowed frame is dropped without a reply
+  bool answered = false;
+  if (frameLength > 0 && !frameOverflow) {
+    answered = processBinaryFrame();
+  }
+  frameLength = 0;
+  frameOverflow = false;
+  return answered;
+}
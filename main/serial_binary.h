@@ -0,0 +1,64 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Binary Framed Serial Protocol Header
+ *
+ * Frames are COBS encoded and terminated by a 0x00 byte. Decoded layout:
+ *   [channel u8][requestId u16 LE][opcode u8][status u8][payload ...][crc16 u16 LE]
+ * The CRC is CRC-16/CCITT-FALSE over everything before it. Responses echo the
+ * request ID and opcode; debug output travels on its own channel.
+ * CR and LF bytes left over from the BINARY line are skipped until the first
+ * frame starts; a host may also send a lone 0x00 first, which is ignored.
+ */
+
+#ifndef SERIAL_BINARY_H
+#define SERIAL_BINARY_H
+
+#include "config.h"
+
+// Frame sizes (decoded)
+#define BINARY_HEADER_SIZE 5
+#define BINARY_CRC_SIZE 2
+#define BINARY_MAX_PAYLOAD 96
+#define BINARY_MAX_FRAME (BINARY_HEADER_SIZE + BINARY_MAX_PAYLOAD + BINARY_CRC_SIZE)
+
+// Channels
+enum BinaryChannel {
+  BINARY_CHANNEL_COMMAND = 0x00,        // Requests and their responses
+  BINARY_CHANNEL_LOG = 0x01             // Debug output, request ID 0
+};
+
+// Opcodes
+enum BinaryOpcode {
+  BINARY_OP_PING = 0x00,                // No payload, echoes an empty response
+  BINARY_OP_GET_BRIGHTNESS = 0x01,      // -> u8 brightness
+  BINARY_OP_SET_BRIGHTNESS = 0x02,      // u8 brightness ->
+  BINARY_OP_GET_STATE = 0x03,           // -> u8 CalibratorStatus
+  BINARY_OP_GET_MAX_BRIGHTNESS = 0x04,  // -> u8 max brightness
+  BINARY_OP_SET_MAX_BRIGHTNESS = 0x05,  // u8 max brightness ->
+  BINARY_OP_GET_STATUS = 0x06,          // -> bulk status, see handleBinaryStatus()
+  BINARY_OP_CALIBRATOR_ON = 0x07,       // ->
+  BINARY_OP_CALIBRATOR_OFF = 0x08,      // ->
+  BINARY_OP_EXIT = 0x7F                 // Return to the text protocol
+};
+
+// Status codes carried in every response
+enum BinaryStatus {
+  BINARY_STATUS_OK = 0x00,
+  BINARY_STATUS_BAD_CRC = 0x01,
+  BINARY_STATUS_UNKNOWN_OPCODE = 0x02,
+  BINARY_STATUS_BAD_LENGTH = 0x03,
+  BINARY_STATUS_OUT_OF_RANGE = 0x04,
+  BINARY_STATUS_FAILED = 0x05,
+  BINARY_STATUS_BUSY = 0x06             // An Alpaca client holds the calibrator lease
+};
+
+// Function prototypes
+void enterSerialBinaryMode();
+void exitSerialBinaryMode();
+bool isSerialBinaryMode();
+bool parseBinaryByte(uint8_t c);
+void sendBinaryFrame(uint8_t channel, uint16_t requestId, uint8_t opcode, uint8_t status,
+                     const uint8_t* payload, size_t payloadLength);
+uint16_t crc16Ccitt(const uint8_t* data, size_t length);
+
+#endif // SERIAL_BINARY_H
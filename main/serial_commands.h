@@ -0,0 +1,106 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Serial Command Table Types
+ *
+ * Every serial command is described once in a constexpr table (see
+ * serial_handler.cpp). The dispatcher finds commands through a perfect hash
+ * built at compile time and HELP is generated from the same entries.
+ */
+
+#ifndef SERIAL_COMMANDS_H
+#define SERIAL_COMMANDS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Argument schemas - the dispatcher validates the parameter before calling the handler
+enum SerialArgSchema {
+  SERIAL_ARGS_NONE,                     // No parameter allowed
+  SERIAL_ARGS_INT,                      // Required decimal integer
+  SERIAL_ARGS_OPTIONAL_INT,             // Decimal integer or nothing
+  SERIAL_ARGS_ON_OFF,                   // ON or OFF
+  SERIAL_ARGS_OPTIONAL_WORD,            // Single word or nothing
+  SERIAL_ARGS_OPTIONAL_TEXT             // Anything, parsed by the handler
+};
+
+// Parsed arguments handed to command handlers
+struct SerialArgs {
+  bool present;                         // A parameter was given
+  int value;                            // SERIAL_ARGS_INT / SERIAL_ARGS_OPTIONAL_INT
+  bool enabled;                         // SERIAL_ARGS_ON_OFF
+  const char* text;                     // Raw parameter, "" if none
+};
+
+typedef void (*SerialCommandHandler)(const SerialArgs& args);
+
+struct SerialCommandEntry {
+  const char* name;                     // Upper-case command token
+  bool bracketed;                       // Legacy <..> command
+  SerialArgSchema schema;
+  SerialCommandHandler handler;
+  const char* usage;                    // Left column of HELP
+  const char* help;                     // Right column of HELP
+};
+
+// Hash slots - must be a power of 2 and comfortably larger than the command count
+#define SERIAL_COMMAND_HASH_SLOTS 64
+
+// Hash seed - if the collision static_assert fires after adding a command, try another value
+#define SERIAL_COMMAND_HASH_SEED 17u
+
+// FNV-1a style hash over the command token; bracketed commands hash as "<token>"
+constexpr uint32_t serialCommandHash(const char* name, bool bracketed) {
+  uint32_t hash = SERIAL_COMMAND_HASH_SEED;
+  if (bracketed) {
+    hash = (hash ^ '<') * 16777619u;
+  }
+  for (const char* p = name; *p != '\0'; p++) {
+    hash = (hash ^ (uint8_t)*p) * 16777619u;
+  }
+  if (bracketed) {
+    hash = (hash ^ '>') * 16777619u;
+  }
+  return hash;
+}
+
+constexpr size_t serialCommandSlot(uint32_t hash) {
+  return (hash ^ (hash >> 16)) & (SERIAL_COMMAND_HASH_SLOTS - 1);
+}
+
+// Slot -> table index + 1 (0 = empty); collision is set if two commands share a slot
+struct SerialCommandIndex {
+  uint8_t slots[SERIAL_COMMAND_HASH_SLOTS];
+  bool collision;
+};
+
+template <size_t N>
+constexpr SerialCommandIndex buildSerialCommandIndex(const SerialCommandEntry (&table)[N]) {
+  SerialCommandIndex index{};
+  for (size_t i = 0; i < N; i++) {
+    size_t slot = serialCommandSlot(serialCommandHash(table[i].name, table[i].bracketed));
+    if (index.slots[slot] != 0) {
+      index.collision = true;
+    }
+    index.slots[slot] = i + 1;
+  }
+  return index;
+}
+
+// Entry for a command token, or nullptr. One comparison rejects unknown
+// tokens that land in a used slot.
+inline const SerialCommandEntry* findSerialCommandEntry(const SerialCommandEntry* table,
+                                                        const SerialCommandIndex& index,
+                                                        const char* name, bool bracketed) {
+  uint8_t slot = index.slots[serialCommandSlot(serialCommandHash(name, bracketed))];
+  if (slot == 0) {
+    return nullptr;
+  }
+  const SerialCommandEntry* entry = &table[slot - 1];
+  if (entry->bracketed != bracketed || strcmp(entry->name, name) != 0) {
+    return nullptr;
+  }
+  return entry;
+}
+
+#endif // SERIAL_COMMANDS_H
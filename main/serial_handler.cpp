@@ -4,222 +4,813 @@
  */
 
 #include "serial_handler.h"
+#include "serial_binary.h"
+#include "serial_commands.h"
+#include "serial_alnitak.h"
 #include "calibrator_controller.h"
+#include "command_gateway.h"
+#include "alpaca_handler.h"
+#include "wifi_manager.h"
+#include "boot_sequencer.h"
+#include "heap_monitor.h"
+#include "loop_monitor.h"
+#include "rate_limiter.h"
 #include "Debug.h"
 #include <Preferences.h>
 #include <WiFi.h>
 
-// Buffer for serial input
-String serialBuffer = "";
-bool commandStarted = false;
+// Raw input ring, filled from the UART and drained by the parser
+static uint8_t rxRing[SERIAL_RX_RING_SIZE];
+static uint16_t rxHead = 0;
+static uint16_t rxTail = 0;
+
+// Parser state - commands are assembled and tokenized in place
+static SerialParserState parserState = SERIAL_STATE_IDLE;
+static char commandBuffer[COMMAND_BUFFER_SIZE + 1];
+static uint8_t commandLength = 0;
+
+// Active protocol personality
+static SerialPersonality personality = SERIAL_PERSONALITY_NATIVE;
+
+// Combined response for pipelined commands
+static char batchBuffer[SERIAL_BATCH_BUFFER_SIZE];
+static size_t batchLength = 0;
+static bool batching = false;
+
+// millis() when the first command was dispatched, 0 until then
+static unsigned long firstCommandTime = 0;
+
+// State change subscription
+static bool subscribed = false;
+static bool eventBaselinePending = false;    // SUBSCRIBE seen, current state not yet reported
+static SerialEventState lastEventState;
+
+static_assert((SERIAL_RX_RING_SIZE & (SERIAL_RX_RING_SIZE - 1)) == 0,
+              "SERIAL_RX_RING_SIZE must be a power of 2");
 
 void initSerialHandler() {
-  Debug.println("Serial command handler initialized");
-  Debug.println("Available commands:");
-  Debug.println("  <00> = Turn calibrator off");
-  Debug.println("  <01> = Turn calibrator on (max brightness)");
-  Debug.println("  <02#xxx> = Set brightness (0-100)");
-  Debug.println("  DEBUG ON/OFF = Enable/disable debug output");
-  Debug.println("  STATUS = Show current status");
-  Debug.println("  HELP = Show this help");
-  Debug.println("");
+  // Debug.begin() only opens the port when debug output is compiled in
+  Serial.begin(SERIAL_BAUD_RATE);
+  
+  Preferences prefs;
+  prefs.begin(PREFERENCES_NAMESPACE, true);
+  personality = (SerialPersonality)prefs.getUChar(PREF_SERIAL_PERSONALITY, SERIAL_PERSONALITY_NATIVE);
+  prefs.end();
+  
+  LOG_INFO(LOG_CAT_SERIAL, "Serial command handler initialized\n");
+  if (personality == SERIAL_PERSONALITY_ALNITAK) {
+    LOG_INFO(LOG_CAT_SERIAL, "Alnitak protocol personality active\n");
+  }
+  LOG_INFO(LOG_CAT_SERIAL, "Type HELP for available commands\n");
+  LOG_INFO(LOG_CAT_SERIAL, "\n");
 }
 
-void handleSerialCommands() {
-  while (Serial.available()) {
-    char inChar = Serial.read();
+// Move everything the UART has into the ring without blocking
+static void fillSerialRing() {
+  int available = Serial.available();
+  while (available > 0) {
+    uint16_t used = rxHead - rxTail;
+    uint16_t space = SERIAL_RX_RING_SIZE - used;
+    if (space == 0) {
+      return;  // Leave the rest in the UART buffer until the next pass
+    }
     
-    if (inChar == '<') {
-      // Start of bracketed command
-      serialBuffer = "";
-      commandStarted = true;
-    } else if (inChar == '>') {
-      // End of bracketed command
-      if (commandStarted) {
-        processSerialCommand("<" + serialBuffer + ">");
-        commandStarted = false;
-        serialBuffer = "";
+    // Read up to the physical end of the ring in one call
+    uint16_t head = rxHead & (SERIAL_RX_RING_SIZE - 1);
+    uint16_t chunk = SERIAL_RX_RING_SIZE - head;
+    if (chunk > space) chunk = space;
+    if (chunk > available) chunk = available;
+    
+    size_t got = Serial.read(&rxRing[head], chunk);
+    if (got == 0) {
+      return;
+    }
+    rxHead += got;
+    available -= got;
+  }
+}
+
+static void beginCommand(SerialParserState state) {
+  parserState = state;
+  commandLength = 0;
+}
+
+// Append one byte to the current command, switching to discard on overflow
+static void appendCommandByte(char c) {
+  if (commandLength >= COMMAND_BUFFER_SIZE) {
+    parserState = SERIAL_STATE_DISCARD;
+    sendSerialResponse("Error: Command too long");
+    return;
+  }
+  commandBuffer[commandLength++] = toupper((unsigned char)c);
+}
+
+// Terminate the current command and dispatch it
+static void finishCommand(bool bracketed) {
+  commandBuffer[commandLength] = '\0';
+  parserState = SERIAL_STATE_IDLE;
+  commandLength = 0;
+  processSerialCommand(commandBuffer, bracketed);
+}
+
+// Feed one byte to the state machine; returns true when a command was dispatched
+static bool parseSerialByte(char c) {
+  switch (parserState) {
+    case SERIAL_STATE_IDLE:
+      if (c == '<') {
+        beginCommand(SERIAL_STATE_BRACKETED);
+      } else if (c == '>' && personality == SERIAL_PERSONALITY_ALNITAK) {
+        beginCommand(SERIAL_STATE_ALNITAK);
+      } else if (c != ' ' && c != '\t' && c != '\r' && c != '\n' && c != '>') {
+        beginCommand(SERIAL_STATE_TEXT);
+        appendCommandByte(c);
       }
-    } else if (inChar == '\n' || inChar == '\r') {
-      // End of line command
-      if (!commandStarted && serialBuffer.length() > 0) {
-        processSerialCommand(serialBuffer);
-        serialBuffer = "";
+      return false;
+      
+    case SERIAL_STATE_TEXT:
+      if (c == '\r' || c == '\n') {
+        finishCommand(false);
+        return true;
       }
-    } else {
-      // Add character to buffer
-      if (commandStarted) {
-        serialBuffer += inChar;
+      if (c == '<') {
+        // A bracketed command always starts fresh
+        beginCommand(SERIAL_STATE_BRACKETED);
       } else {
-        if (inChar != ' ' || serialBuffer.length() > 0) {  // Skip leading spaces
-          serialBuffer += inChar;
-        }
+        appendCommandByte(c);
       }
+      return false;
       
-      // Prevent buffer overflow
-      if (serialBuffer.length() > COMMAND_BUFFER_SIZE) {
-        serialBuffer = "";
-        commandStarted = false;
-        sendSerialResponse("Error: Command too long");
+    case SERIAL_STATE_BRACKETED:
+      if (c == '>') {
+        finishCommand(true);
+        return true;
+      }
+      if (c == '<') {
+        beginCommand(SERIAL_STATE_BRACKETED);
+      } else if (c != '\r' && c != '\n') {
+        appendCommandByte(c);
+      }
+      return false;
+      
+    case SERIAL_STATE_ALNITAK:
+      // Fixed length commands - dispatch as soon as the body is complete
+      if (c == '\r' || c == '\n') {
+        parserState = SERIAL_STATE_IDLE;  // Truncated command, ignore it
+        return false;
+      }
+      appendCommandByte(c);
+      if (commandLength == ALNITAK_COMMAND_LENGTH) {
+        commandBuffer[commandLength] = '\0';
+        parserState = SERIAL_STATE_IDLE;
+        processAlnitakCommand(commandBuffer);
+        return true;
+      }
+      return false;
+      
+    case SERIAL_STATE_DISCARD:
+      // Only the overlong command is lost - resync on the next terminator
+      if (c == '\r' || c == '\n' || c == '>') {
+        parserState = SERIAL_STATE_IDLE;
+      } else if (c == '<') {
+        beginCommand(SERIAL_STATE_BRACKETED);
+      }
+      return false;
+  }
+  return false;
+}
+
+void handleSerialCommands() {
+  HeapScope heapScope(HEAP_IF_SERIAL);
+  fillSerialRing();
+  
+  int dispatched = 0;
+  while (rxTail != rxHead && dispatched < SERIAL_MAX_COMMANDS_PER_PASS) {
+    char c = rxRing[rxTail & (SERIAL_RX_RING_SIZE - 1)];
+    rxTail++;
+    unsigned long now = millis();
+    bool handled = isSerialBinaryMode() ? parseBinaryByte(c) : parseSerialByte(c);
+    if (handled) {
+      dispatched++;
+      if (firstCommandTime == 0) {
+        firstCommandTime = now;
+        LOG_INFO(LOG_CAT_SERIAL, "First serial command %lu ms after boot\n", firstCommandTime);
       }
     }
   }
+  
+  if (subscribed) {
+    publishSerialEvents();
+  }
+}
+
+static SerialEventState captureEventState() {
+  SerialEventState state;
+  state.brightness = getCurrentBrightness();
+  state.maxBrightness = getMaxBrightness();
+  state.calibratorState = getCalibratorState();
+  state.wifiConnected = WiFi.status() == WL_CONNECTED;
+  return state;
+}
+
+static void sendSerialEvent(const SerialEventState& state) {
+  Serial.printf("EVENT BRIGHTNESS=%d MAXBRIGHTNESS=%d STATE=%s WIFI=%d\n",
+                state.brightness, state.maxBrightness,
+                getCalibratorStateString(state.calibratorState).c_str(),
+                state.wifiConnected ? 1 : 0);
 }
 
-void processSerialCommand(const String& command) {
-  String cmd = command;
-  cmd.trim();
-  cmd.toUpperCase();
+// Emit one event line when any subscribed value has changed since the last one.
+// Runs after the pass's commands, so a batch's reply line goes out first.
+void publishSerialEvents() {
+  SerialEventState state = captureEventState();
+  if (eventBaselinePending) {
+    eventBaselinePending = false;
+  } else if (state.brightness == lastEventState.brightness &&
+             state.maxBrightness == lastEventState.maxBrightness &&
+             state.calibratorState == lastEventState.calibratorState &&
+             state.wifiConnected == lastEventState.wifiConnected) {
+    return;
+  }
+  lastEventState = state;
+  sendSerialEvent(state);
+}
+
+// Split a command into name and parameter without copying
+SerialCommand parseSerialCommand(char* input, bool bracketed) {
+  SerialCommand cmd;
+  cmd.command = input;
+  cmd.parameter = "";
+  cmd.bracketed = bracketed;
   
-  Debug.printf(2, "Processing serial command: %s\n", cmd.c_str());
+  // Trim trailing whitespace
+  size_t len = strlen(input);
+  while (len > 0 && (input[len - 1] == ' ' || input[len - 1] == '\t')) {
+    input[--len] = '\0';
+  }
   
-  // Handle bracketed commands (legacy format from original sketch)
-  if (cmd.startsWith("<") && cmd.endsWith(">")) {
-    String innerCmd = cmd.substring(1, cmd.length() - 1);
-    
-    if (innerCmd == "00") {
-      handleOffCommand();
-    } else if (innerCmd == "01") {
-      handleOnCommand();
-    } else if (innerCmd.startsWith("02#")) {
-      String brightnessStr = innerCmd.substring(3);
-      handleBrightnessCommand(brightnessStr);
-    } else {
-      sendSerialResponse("Error: Unknown bracketed command: " + cmd);
+  // Legacy commands separate the parameter with '#', text commands with spaces
+  char* separator = strchr(input, bracketed ? '#' : ' ');
+  if (separator != nullptr) {
+    *separator++ = '\0';
+    while (*separator == ' ' || *separator == '\t') {
+      separator++;
     }
+    cmd.parameter = separator;
+  }
+  
+  return cmd;
+}
+
+// Parse a whole decimal integer, rejecting empty input and trailing garbage
+static bool parseSerialInt(const char* text, int& value) {
+  if (*text == '\0') {
+    return false;
+  }
+  char* end;
+  long parsed = strtol(text, &end, 10);
+  if (*end != '\0') {
+    return false;
+  }
+  value = (int)parsed;
+  return true;
+}
+
+static void processSingleCommand(char* command, bool bracketed);
+
+// Text lines may carry several commands separated by ';', answered on one line
+void processSerialCommand(char* command, bool bracketed) {
+  if (bracketed || strchr(command, ';') == nullptr) {
+    processSingleCommand(command, bracketed);
     return;
   }
   
-  // Handle text commands
-  if (cmd.startsWith("DEBUG ")) {
-    String param = cmd.substring(6);
-    handleDebugCommand(param);
-  } else if (cmd == "DEBUG ON") {
-    handleDebugCommand("ON");
-  } else if (cmd == "DEBUG OFF") {
-    handleDebugCommand("OFF");
-  } else if (cmd == "STATUS") {
-    handleStatusCommand();
-  } else if (cmd == "HELP") {
-    handleHelpCommand();
-  } else if (cmd.startsWith("BRIGHTNESS ")) {
-    String param = cmd.substring(11);
-    handleBrightnessCommand(param);
-  } else if (cmd.startsWith("MAXBRIGHTNESS ")) {
-    String param = cmd.substring(14);
-    handleMaxBrightnessCommand(param);
-  } else if (cmd == "ON") {
-    handleOnCommand();
-  } else if (cmd == "OFF") {
-    handleOffCommand();
-  } else {
-    sendSerialResponse("Error: Unknown command: " + cmd);
-    sendSerialResponse("Type HELP for available commands");
+  batching = true;
+  batchLength = 0;
+  
+  char* segment = command;
+  while (segment != nullptr) {
+    char* next = strchr(segment, ';');
+    if (next != nullptr) {
+      *next++ = '\0';
+    }
+    while (*segment == ' ' || *segment == '\t') {
+      segment++;
+    }
+    if (*segment != '\0') {
+      processSingleCommand(segment, false);
+    }
+    segment = next;
+  }
+  
+  batching = false;
+  if (batchLength > 0) {
+    Serial.println(batchBuffer);
+  }
+}
+
+// Command table - the single source for dispatch and HELP
+static constexpr SerialCommandEntry serialCommands[] = {
+  // Bracketed commands (legacy format from original sketch)
+  { "00", true, SERIAL_ARGS_NONE, handleOffCommand, "<00>", "Turn calibrator OFF" },
+  { "01", true, SERIAL_ARGS_NONE, handleOnCommand, "<01>", "Turn calibrator ON (max brightness)" },
+  { "02", true, SERIAL_ARGS_INT, handleBrightnessCommand, "<02#xxx>", "Set brightness (0-max)" },
+  
+  // Text commands
+  { "ON", false, SERIAL_ARGS_NONE, handleOnCommand, "ON", "Turn calibrator ON" },
+  { "OFF", false, SERIAL_ARGS_NONE, handleOffCommand, "OFF", "Turn calibrator OFF" },
+  { "BRIGHTNESS", false, SERIAL_ARGS_INT, handleBrightnessCommand, "BRIGHTNESS x", "Set brightness (0-max)" },
+  { "MAXBRIGHTNESS", false, SERIAL_ARGS_OPTIONAL_INT, handleMaxBrightnessCommand, "MAXBRIGHTNESS [x]", "Show or set maximum brightness (1-100)" },
+  { "DEBUG", false, SERIAL_ARGS_ON_OFF, handleDebugCommand, "DEBUG ON/OFF", "Enable/disable debug output" },
+  { "BINARY", false, SERIAL_ARGS_NONE, handleBinaryCommand, "BINARY", "Switch to the binary framed protocol" },
+  { "SUBSCRIBE", false, SERIAL_ARGS_NONE, handleSubscribeCommand, "SUBSCRIBE", "Report state changes as EVENT lines" },
+  { "UNSUBSCRIBE", false, SERIAL_ARGS_NONE, handleUnsubscribeCommand, "UNSUBSCRIBE", "Stop state change events" },
+  { "PERSONALITY", false, SERIAL_ARGS_OPTIONAL_WORD, handlePersonalityCommand, "PERSONALITY [x]", "Show or set protocol: NATIVE or ALNITAK" },
+  { "WIFIPROFILE", false, SERIAL_ARGS_OPTIONAL_WORD, handleWiFiProfileCommand, "WIFIPROFILE [x]", "Show or set WiFi profile: LATENCY, BALANCED or LOWPOWER" },
+  { "STATUS", false, SERIAL_ARGS_NONE, handleStatusCommand, "STATUS", "Show current status" },
+  { "BOOT", false, SERIAL_ARGS_NONE, handleBootCommand, "BOOT", "Show boot phase timings" },
+  { "HEAP", false, SERIAL_ARGS_NONE, handleHeapCommand, "HEAP", "Show heap and fragmentation per interface" },
+  { "PRESET", false, SERIAL_ARGS_OPTIONAL_TEXT, handlePresetCommand, "PRESET [name]", "List presets or apply one; PRESET SAVE name b [rampMs [expMs]], PRESET DELETE name" },
+  { "LEASE", false, SERIAL_ARGS_OPTIONAL_WORD, handleLeaseCommand, "LEASE [RELEASE]", "Show or release Alpaca client control" },
+  { "LOOP", false, SERIAL_ARGS_OPTIONAL_WORD, handleLoopCommand, "LOOP [RESET]", "Show or clear loop stage timings" },
+  { "THROTTLE", false, SERIAL_ARGS_OPTIONAL_WORD, handleThrottleCommand, "THROTTLE [RESET]", "Show or clear per-client HTTP rate limiting" },
+  { "HELP", false, SERIAL_ARGS_NONE, handleHelpCommand, "HELP", "Show this help" },
+};
+
+static constexpr SerialCommandIndex serialCommandIndex = buildSerialCommandIndex(serialCommands);
+static_assert(!serialCommandIndex.collision,
+              "Serial command hash collision - change SERIAL_COMMAND_HASH_SEED");
+
+static const SerialCommandEntry* findSerialCommand(const char* name, bool bracketed) {
+  return findSerialCommandEntry(serialCommands, serialCommandIndex, name, bracketed);
+}
+
+// Validate the parameter against the entry's schema
+static bool parseSerialArgs(const SerialCommandEntry* entry, const char* parameter, SerialArgs& args) {
+  args.present = *parameter != '\0';
+  args.value = 0;
+  args.enabled = false;
+  args.text = parameter;
+  
+  switch (entry->schema) {
+    case SERIAL_ARGS_NONE:
+      return !args.present;
+    case SERIAL_ARGS_INT:
+      return parseSerialInt(parameter, args.value);
+    case SERIAL_ARGS_OPTIONAL_INT:
+      return !args.present || parseSerialInt(parameter, args.value);
+    case SERIAL_ARGS_ON_OFF:
+      args.enabled = strcmp(parameter, "ON") == 0;
+      return args.enabled || strcmp(parameter, "OFF") == 0;
+    case SERIAL_ARGS_OPTIONAL_WORD:
+      return strchr(parameter, ' ') == nullptr;
+    case SERIAL_ARGS_OPTIONAL_TEXT:
+      return true;
   }
+  return false;
 }
 
-void handleBrightnessCommand(const String& parameter) {
-  int brightness = parameter.toInt();
+static void processSingleCommand(char* command, bool bracketed) {
+  SerialCommand cmd = parseSerialCommand(command, bracketed);
   
-  if (parameter.length() == 0) {
-    sendSerialResponse("Error: Missing brightness value");
+  LOG_VERBOSE(LOG_CAT_SERIAL, "Processing serial command: %s%s %s%s\n", bracketed ? "<" : "",
+              cmd.command, cmd.parameter, bracketed ? ">" : "");
+  
+  const SerialCommandEntry* entry = findSerialCommand(cmd.command, cmd.bracketed);
+  if (entry == nullptr) {
+    if (cmd.bracketed) {
+      sendSerialResponsef("Error: Unknown bracketed command: <%s>", cmd.command);
+    } else {
+      sendSerialResponsef("Error: Unknown command: %s", cmd.command);
+      sendSerialResponse("Type HELP for available commands");
+    }
     return;
   }
   
-  if (brightness < 0 || brightness > getMaxBrightness()) {
-    sendSerialResponse("Error: Brightness out of range (0-" + String(getMaxBrightness()) + ")");
+  SerialArgs args;
+  if (!parseSerialArgs(entry, cmd.parameter, args)) {
+    sendSerialResponsef("Usage: %s", entry->usage);
     return;
   }
   
-  if (setCalibratorBrightness(brightness)) {
-    sendSerialResponse("Brightness set to " + String(brightness) + "%");
-  } else {
-    sendSerialResponse("Error: Failed to set brightness");
+  entry->handler(args);
+}
+
+void handleBrightnessCommand(const SerialArgs& args) {
+  int brightness = args.value;
+  
+  switch (commandBrightness(COMMAND_SOURCE_SERIAL, 0, brightness)) {
+    case COMMAND_OK:
+      sendSerialResponsef("Brightness set to %d%%", brightness);
+      break;
+    case COMMAND_INVALID_VALUE:
+      sendSerialResponsef("Error: Brightness out of range (0-%d)", getMaxBrightness());
+      break;
+    case COMMAND_BUSY:
+      sendSerialResponsef("Error: %s", getCommandBusyMessage().c_str());
+      break;
+    default:
+      sendSerialResponse("Error: Failed to set brightness");
+      break;
   }
 }
 
-void handleOnCommand() {
-  if (turnCalibratorOn()) {
-    sendSerialResponse("Calibrator turned ON (brightness: " + String(getCurrentBrightness()) + "%)");
+void handleOnCommand(const SerialArgs& args) {
+  CommandResult result = commandCalibratorOn(COMMAND_SOURCE_SERIAL, 0);
+  if (result == COMMAND_OK) {
+    sendSerialResponsef("Calibrator turned ON (brightness: %d%%)", getCurrentBrightness());
+  } else if (result == COMMAND_BUSY) {
+    sendSerialResponsef("Error: %s", getCommandBusyMessage().c_str());
   } else {
     sendSerialResponse("Error: Failed to turn on calibrator");
   }
 }
 
-void handleOffCommand() {
-  if (turnCalibratorOff()) {
+void handleOffCommand(const SerialArgs& args) {
+  CommandResult result = commandCalibratorOff(COMMAND_SOURCE_SERIAL, 0);
+  if (result == COMMAND_OK) {
     sendSerialResponse("Calibrator turned OFF");
+  } else if (result == COMMAND_BUSY) {
+    sendSerialResponsef("Error: %s", getCommandBusyMessage().c_str());
   } else {
     sendSerialResponse("Error: Failed to turn off calibrator");
   }
 }
 
-void handleMaxBrightnessCommand(const String& parameter) {
-  int maxBright = parameter.toInt();
+void handleMaxBrightnessCommand(const SerialArgs& args) {
+  int maxBright = args.value;
   
-  if (parameter.length() == 0) {
-    sendSerialResponse("Current max brightness: " + String(getMaxBrightness()) + "%");
+  if (!args.present) {
+    sendSerialResponsef("Current max brightness: %d%%", getMaxBrightness());
     return;
   }
   
-  if (maxBright < 1 || maxBright > MAX_BRIGHTNESS) {
-    sendSerialResponse("Error: Max brightness out of range (1-" + String(MAX_BRIGHTNESS) + ")");
-    return;
+  switch (commandMaxBrightness(COMMAND_SOURCE_SERIAL, 0, maxBright)) {
+    case COMMAND_OK:
+      sendSerialResponsef("Max brightness set to %d%%", maxBright);
+      break;
+    case COMMAND_BUSY:
+      sendSerialResponsef("Error: %s", getCommandBusyMessage().c_str());
+      break;
+    default:
+      sendSerialResponsef("Error: Max brightness out of range (1-%d)", MAX_BRIGHTNESS);
+      break;
   }
+}
+
+void handleDebugCommand(const SerialArgs& args) {
+  enableDebug(args.enabled);
+  sendSerialResponse(args.enabled ? "Debug output ENABLED" : "Debug output DISABLED");
+}
+
+// Text EVENT lines would corrupt the frame stream, so the subscription ends here
+void handleBinaryCommand(const SerialArgs& args) {
+  sendSerialResponse("Binary mode");
+  Serial.flush();
+  parserState = SERIAL_STATE_IDLE;
+  subscribed = false;
+  eventBaselinePending = false;
+  enterSerialBinaryMode();
+}
+
+void handleSubscribeCommand(const SerialArgs& args) {
+  subscribed = true;
+  sendSerialResponse("Subscribed to state change events");
   
-  setMaxBrightness(maxBright);
-  sendSerialResponse("Max brightness set to " + String(maxBright) + "%");
+  // Report the current state so the host starts from a known baseline; sent
+  // by publishSerialEvents() once any batch reply is out
+  eventBaselinePending = true;
+}
+
+void handleUnsubscribeCommand(const SerialArgs& args) {
+  subscribed = false;
+  eventBaselinePending = false;
+  sendSerialResponse("Unsubscribed from state change events");
 }
 
-void handleDebugCommand(const String& parameter) {
-  if (parameter == "ON") {
-    enableDebug(true);
-    sendSerialResponse("Debug output ENABLED");
-  } else if (parameter == "OFF") {
-    enableDebug(false);
-    sendSerialResponse("Debug output DISABLED");
+void handlePersonalityCommand(const SerialArgs& args) {
+  if (!args.present) {
+    // Fall through to report the current personality
+  } else if (strcmp(args.text, "NATIVE") == 0) {
+    setSerialPersonality(SERIAL_PERSONALITY_NATIVE);
+  } else if (strcmp(args.text, "ALNITAK") == 0) {
+    setSerialPersonality(SERIAL_PERSONALITY_ALNITAK);
   } else {
-    sendSerialResponse("Usage: DEBUG ON/OFF");
+    sendSerialResponse("Usage: PERSONALITY NATIVE/ALNITAK");
+    return;
   }
+  sendSerialResponsef("Personality: %s",
+                      personality == SERIAL_PERSONALITY_ALNITAK ? "ALNITAK" : "NATIVE");
 }
 
-void handleStatusCommand() {
+void handleWiFiProfileCommand(const SerialArgs& args) {
+  WiFiProfile profile = getWiFiProfile();
+  if (args.present) {
+    if (!parseWiFiProfile(args.text, profile)) {
+      sendSerialResponse("Usage: WIFIPROFILE LATENCY/BALANCED/LOWPOWER");
+      return;
+    }
+    setWiFiProfile(profile);
+  }
+  sendSerialResponsef("WiFi profile: %s", getWiFiProfileName(profile));
+}
+
+void handleStatusCommand(const SerialArgs& args) {
+  if (batching) {
+    // Compact form so a pipelined poll stays on one line
+    sendSerialResponsef("State: %s, Brightness: %d%%, Max: %d%%, WiFi: %s",
+                        getCalibratorStateString().c_str(), getCurrentBrightness(), getMaxBrightness(),
+                        WiFi.status() == WL_CONNECTED ? "Connected" : "Disconnected");
+    return;
+  }
   printSerialStatus();
 }
 
-void handleHelpCommand() {
-  printSerialHelp();
+void handleBootCommand(const SerialArgs& args) {
+  if (batching) {
+    sendSerialResponsef("Boot: %s, %lu us", isBootComplete() ? "complete" : "in progress",
+                        (unsigned long)getBootCompleteUs());
+    return;
+  }
+  
+  Serial.println();
+  Serial.println("Boot Phases (firmware " DEVICE_VERSION "):");
+  for (size_t i = 0; i < getBootPhaseCount(); i++) {
+    const BootPhaseTiming& timing = getBootPhaseTiming(i);
+    if (timing.state == BOOT_PHASE_DONE) {
+      Serial.printf("  %-12s %9lu us -> %9lu us  (%lu us)\n", getBootPhase(i).name,
+                    (unsigned long)timing.startUs, (unsigned long)timing.endUs,
+                    (unsigned long)(timing.endUs - timing.startUs));
+    } else {
+      Serial.printf("  %-12s %s\n", getBootPhase(i).name, getBootPhaseStateString(timing.state));
+    }
+  }
+  if (isBootComplete()) {
+    Serial.printf("Boot complete: %lu us\n", (unsigned long)getBootCompleteUs());
+  }
+  Serial.println();
 }
 
-void sendSerialResponse(const String& response) {
-  Serial.println(response);
+void handleHeapCommand(const SerialArgs& args) {
+  HeapStats stats = getHeapStats();
+  if (batching) {
+    sendSerialResponsef("Heap: %lu free, %lu largest block", (unsigned long)stats.freeBytes,
+                        (unsigned long)stats.largestFreeBlock);
+    return;
+  }
+  
+  Serial.println();
+  Serial.printf("Heap: %lu free (min %lu), largest block %lu (min %lu)\n",
+                (unsigned long)stats.freeBytes, (unsigned long)stats.minFreeBytes,
+                (unsigned long)stats.largestFreeBlock, (unsigned long)stats.minLargestFreeBlock);
+  Serial.printf("Blocks: %lu allocated, %lu free\n",
+                (unsigned long)stats.allocatedBlocks, (unsigned long)stats.freeBlocks);
+  Serial.println("  Interface   Retained  Allocs     Frees   Low marks");
+  for (int i = 0; i < HEAP_IF_COUNT; i++) {
+    const HeapInterfaceStats& interfaceStats = getHeapInterfaceStats((HeapInterface)i);
+    Serial.printf("  %-10s %9ld %8lu %9lu %11lu\n", getHeapInterfaceName((HeapInterface)i),
+                  (long)interfaceStats.retainedBytes, (unsigned long)interfaceStats.allocations,
+                  (unsigned long)interfaceStats.frees, (unsigned long)interfaceStats.lowWaterMarks);
+  }
+  if (!HEAP_ALLOC_TAGGING) {
+    Serial.println("(allocation counts need HEAP_ALLOC_TAGGING)");
+  }
+  Serial.println();
 }
 
-void printSerialHelp() {
+void handlePresetCommand(const SerialArgs& args) {
+  char name[24];
+  int brightness = 0;
+  long rampMs = 0;
+  long exposureMs = 0;
+  
+  if (!args.present) {
+    if (getPresetCount() == 0) {
+      sendSerialResponse("No presets");
+      return;
+    }
+    if (batching) {
+      sendSerialResponsef("Presets: %u", (unsigned)getPresetCount());
+      return;
+    }
+    Serial.println("  Name     Brightness  Ramp ms  Exposure ms");
+    for (size_t i = 0; i < getPresetCount(); i++) {
+      const CalibratorPreset& preset = getPreset(i);
+      Serial.printf("  %-8s %9u%% %8u %12lu\n", preset.name, preset.brightness, preset.rampMs,
+                    (unsigned long)preset.exposureMs);
+    }
+    return;
+  }
+  
+  // A name longer than PRESET_NAME_SIZE allows is read whole and rejected by savePreset()
+  if (strncmp(args.text, "SAVE ", 5) == 0) {
+    int fields = sscanf(args.text + 5, "%23s %d %ld %ld", name, &brightness, &rampMs, &exposureMs);
+    if (fields < 2) {
+      sendSerialResponse("Usage: PRESET SAVE name brightness [rampMs [exposureMs]]");
+      return;
+    }
+    PresetSaveResult result = savePreset(name, brightness, rampMs, exposureMs);
+    if (result == PRESET_SAVED) {
+      sendSerialResponsef("Preset %s saved", name);
+    } else {
+      sendSerialResponsef("Error: %s", getPresetSaveResultString(result));
+    }
+    return;
+  }
+  if (strncmp(args.text, "DELETE ", 7) == 0) {
+    sendSerialResponse(deletePreset(args.text + 7) ? "Preset deleted" : "Error: Unknown preset");
+    return;
+  }
+  
+  const CalibratorPreset* preset = findPreset(args.text);
+  if (preset == nullptr) {
+    sendSerialResponsef("Error: Unknown preset: %s", args.text);
+    return;
+  }
+  switch (commandPreset(COMMAND_SOURCE_SERIAL, 0, *preset)) {
+    case COMMAND_OK:
+      sendSerialResponsef("Preset %s: brightness %u%%, ramp %u ms, exposure %lu ms", preset->name,
+                          preset->brightness, preset->rampMs, (unsigned long)preset->exposureMs);
+      break;
+    case COMMAND_INVALID_VALUE:
+      sendSerialResponsef("Error: Preset brightness above max brightness (%d%%)", getMaxBrightness());
+      break;
+    case COMMAND_BUSY:
+      sendSerialResponsef("Error: %s", getCommandBusyMessage().c_str());
+      break;
+    default:
+      sendSerialResponse("Error: Failed to apply preset");
+      break;
+  }
+}
+
+void handleLeaseCommand(const SerialArgs& args) {
+  if (args.present) {
+    if (strcmp(args.text, "RELEASE") != 0) {
+      sendSerialResponse("Usage: LEASE or LEASE RELEASE");
+      return;
+    }
+    sendSerialResponse(breakCalibratorLease(COMMAND_SOURCE_SERIAL) ? "Lease released" : "No lease held");
+    return;
+  }
+  
+  CalibratorLease lease = getCalibratorLease();
+  if (lease.held) {
+    sendSerialResponsef("Lease: Alpaca client %lu, %lu ms left", (unsigned long)lease.clientID,
+                        (unsigned long)lease.remainingMs);
+  } else {
+    sendSerialResponse("Lease: none");
+  }
+}
+
+void handleLoopCommand(const SerialArgs& args) {
+  if (args.present) {
+    if (strcmp(args.text, "RESET") != 0) {
+      sendSerialResponse("Error: Expected LOOP or LOOP RESET");
+      return;
+    }
+    resetLoopStats();
+    sendSerialResponse("Loop statistics cleared");
+    return;
+  }
+  
+  const LoopStageStats& pass = getLoopStageStats(LOOP_STAGE_PASS);
+  if (batching) {
+    sendSerialResponsef("Loop: max %lu us, %lu overruns", (unsigned long)pass.maxUs,
+                        (unsigned long)pass.overruns);
+    return;
+  }
+  
   Serial.println();
-  Serial.println("ESP32 Flat Panel Calibrator - Serial Commands");
-  Serial.println("=============================================");
-  Serial.println("Bracketed Commands (legacy format):");
-  Serial.println("  <00>         = Turn calibrator OFF");
-  Serial.println("  <01>         = Turn calibrator ON (max brightness)");
-  Serial.println("  <02#xxx>     = Set brightness (0-" + String(getMaxBrightness()) + ")");
+  Serial.println("  Stage            Count    Avg us    Max us  Budget us  Overruns  Worst route");
+  for (int i = 0; i < LOOP_STAGE_COUNT; i++) {
+    const LoopStageStats& stats = getLoopStageStats((LoopStage)i);
+    Serial.printf("  %-12s %9lu %9lu %9lu %10lu %9lu  %s\n", getLoopStageName((LoopStage)i),
+                  (unsigned long)stats.count,
+                  (unsigned long)(stats.count > 0 ? stats.totalUs / stats.count : 0),
+                  (unsigned long)stats.maxUs, (unsigned long)stats.budgetUs, (unsigned long)stats.overruns,
+                  stats.maxRoute != nullptr ? stats.maxRoute : "-");
+  }
+  if (getLoopOverrunCount() > 0) {
+    Serial.println("Recent overruns:");
+    for (size_t i = 0; i < getLoopOverrunCount(); i++) {
+      const LoopOverrun& overrun = getLoopOverrun(i);
+      Serial.printf("  %10lu ms  %-12s %9lu us  %s\n", (unsigned long)overrun.atMs,
+                    getLoopStageName(overrun.stage), (unsigned long)overrun.durationUs,
+                    overrun.route != nullptr ? overrun.route : "-");
+    }
+  }
   Serial.println();
-  Serial.println("Text Commands:");
-  Serial.println("  ON           = Turn calibrator ON");
-  Serial.println("  OFF          = Turn calibrator OFF");
-  Serial.println("  BRIGHTNESS x = Set brightness (0-" + String(getMaxBrightness()) + ")");
-  Serial.println("  MAXBRIGHTNESS x = Set maximum brightness (1-" + String(MAX_BRIGHTNESS) + ")");
-  Serial.println("  DEBUG ON/OFF = Enable/disable debug output");
-  Serial.println("  STATUS       = Show current status");
-  Serial.println("  HELP         = Show this help");
+}
+
+void handleThrottleCommand(const SerialArgs& args) {
+  if (args.present) {
+    if (strcmp(args.text, "RESET") != 0) {
+      sendSerialResponse("Error: Expected THROTTLE or THROTTLE RESET");
+      return;
+    }
+    resetRateLimitStats();
+    sendSerialResponse("Rate limit clients cleared");
+    return;
+  }
+  
+  const RateLimitStats& stats = getRateLimitStats();
+  if (batching) {
+    sendSerialResponsef("Throttle: %lu/s burst %lu, %lu refused", (unsigned long)getRateLimitPerSecond(),
+                        (unsigned long)getRateLimitBurst(), (unsigned long)stats.limited);
+    return;
+  }
+  
   Serial.println();
-  Serial.println("Examples:");
-  Serial.println("  <02#50>      = Set 50% brightness");
-  Serial.println("  BRIGHTNESS 75 = Set 75% brightness");
-  Serial.println("  DEBUG ON     = Enable debug messages");
+  if (getRateLimitPerSecond() == 0) {
+    Serial.println("Rate limit: off");
+  } else {
+    Serial.printf("Rate limit: %lu requests/s, burst %lu\n", (unsigned long)getRateLimitPerSecond(),
+                  (unsigned long)getRateLimitBurst());
+  }
+  Serial.printf("Refused: %lu, clients replaced: %lu\n", (unsigned long)stats.limited, (unsigned long)stats.evicted);
+  if (getRateLimitClientCount() > 0) {
+    Serial.println("  Client            Tokens    Allowed    Refused    Idle ms");
+    uint32_t now = millis();
+    for (size_t i = 0; i < getRateLimitClientCount(); i++) {
+      const RateLimitClient& client = getRateLimitClient(i);
+      Serial.printf("  %-15s %8lu %10lu %10lu %10lu\n", IPAddress(client.ip).toString().c_str(),
+                    (unsigned long)(client.tokensMilli / 1000), (unsigned long)client.allowed,
+                    (unsigned long)client.limited, (unsigned long)(now - client.lastSeenMs));
+    }
+  }
   Serial.println();
 }
 
+void handleHelpCommand(const SerialArgs& args) {
+  printSerialHelp();
+}
+
+void sendSerialResponse(const char* response) {
+  if (!batching) {
+    Serial.println(response);
+    return;
+  }
+  
+  // Join pipelined responses with "; ", flushing early if the buffer fills
+  size_t length = strlen(response);
+  if (batchLength > 0 && batchLength + 2 + length >= sizeof(batchBuffer)) {
+    Serial.println(batchBuffer);
+    batchLength = 0;
+  }
+  if (batchLength > 0) {
+    batchBuffer[batchLength++] = ';';
+    batchBuffer[batchLength++] = ' ';
+  }
+  size_t copy = min(length, sizeof(batchBuffer) - 1 - batchLength);
+  memcpy(&batchBuffer[batchLength], response, copy);
+  batchLength += copy;
+  batchBuffer[batchLength] = '\0';
+}
+
+void sendSerialResponsef(const char* format, ...) {
+  char buffer[128];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(buffer, sizeof(buffer), format, args);
+  va_end(args);
+  sendSerialResponse(buffer);
+}
+
+// Render HELP from the command table and send it in a single write
+void printSerialHelp() {
+  static char help[SERIAL_HELP_BUFFER_SIZE];
+  size_t length = 0;
+  
+  auto append = [&](const char* format, ...) {
+    if (length >= sizeof(help)) return;
+    va_list args;
+    va_start(args, format);
+    int written = vsnprintf(&help[length], sizeof(help) - length, format, args);
+    va_end(args);
+    if (written > 0) {
+      length = min(length + (size_t)written, sizeof(help) - 1);
+    }
+  };
+  
+  append("\r\nESP32 Flat Panel Calibrator - Serial Commands\r\n");
+  append("=============================================\r\n");
+  
+  bool bracketed = true;
+  append("Bracketed Commands (legacy format):\r\n");
+  for (const SerialCommandEntry& entry : serialCommands) {
+    if (entry.bracketed != bracketed) {
+      bracketed = entry.bracketed;
+      append("\r\nText Commands:\r\n");
+    }
+    append("  %-18s= %s\r\n", entry.usage, entry.help);
+  }
+  
+  append("\r\nCurrent max brightness: %d%%\r\n", getMaxBrightness());
+  append("Several text commands may be separated by ';', e.g. ON; STATUS\r\n\r\n");
+  
+  Serial.write((const uint8_t*)help, length);
+}
+
 void printSerialStatus() {
   Serial.println();
   Serial.println("Current Status:");
@@ -231,6 +822,11 @@ void printSerialStatus() {
   Serial.println("Current Brightness: " + String(getCurrentBrightness()) + "%");
   Serial.println("Max Brightness: " + String(getMaxBrightness()) + "%");
   Serial.println("Connected: " + String(isConnected ? "Yes" : "No"));
+  CalibratorLease lease = getCalibratorLease();
+  if (lease.held) {
+    Serial.println("Controlled By: Alpaca client " + String((unsigned long)lease.clientID) +
+                   " (" + String((unsigned long)(lease.remainingMs / 1000)) + " s left)");
+  }
   Serial.println("Debug Enabled: " + String(serialDebugEnabled ? "Yes" : "No"));
   
   if (WiFi.status() == WL_CONNECTED) {
@@ -238,11 +834,28 @@ void printSerialStatus() {
     Serial.println("IP Address: " + WiFi.localIP().toString());
     Serial.println("Web Interface: http://" + WiFi.localIP().toString());
     Serial.println("ASCOM Alpaca: http://" + WiFi.localIP().toString() + ":" + String(ALPACA_PORT));
+    Serial.println("mDNS Name: " + mdnsHostname + ".local");
   } else {
-    Serial.println("WiFi: Not connected");
+    Serial.println("WiFi: " + String(getWiFiStateString()));
   }
   
+  Serial.println("WiFi Profile: " + String(getWiFiProfileName(getWiFiProfile())));
   Serial.println("Free Heap: " + String(ESP.getFreeHeap()) + " bytes");
+  Serial.println("First Command: " + String(firstCommandTime) + " ms after boot");
+  
+  const WiFiConnectStats& wifiStats = getWiFiConnectStats();
+  Serial.println("Alpaca Ready: " + String(wifiStats.bootToReadyMs) + " ms after boot");
+  Serial.println("Last WiFi Connect: " + String(wifiStats.lastConnectMs) + " ms" +
+                 (wifiStats.lastConnectFast ? " (fast)" : "") + ", IP usable after " +
+                 String(wifiStats.lastAddressMs) + " ms");
+  Serial.println("Last Reconnect: " + String(wifiStats.lastReconnectMs) + " ms, " +
+                 String(wifiStats.reconnectCount) + " total, " +
+                 String(wifiStats.fastConnectFailures) + " fast connect fallbacks");
+  
+  LogBufferStats logStats = getLogBufferStats();
+  Serial.println("Log Records: " + String(logStats.recorded) + " recorded, " +
+                 String(logStats.dropped) + " dropped, " + String(logStats.truncated) + " truncated, " +
+                 String(logStats.pending) + " pending");
   Serial.println();
 }
 
@@ -261,4 +874,22 @@ void enableDebug(bool enable) {
   } else {
     Debug.setLevel(0);  // Off
   }
-}
\ No newline at end of file
+}
+
+void setSerialPersonality(SerialPersonality newPersonality) {
+  personality = newPersonality;
+  
+  Preferences prefs;
+  prefs.begin(PREFERENCES_NAMESPACE, false);
+  prefs.putUChar(PREF_SERIAL_PERSONALITY, personality);
+  prefs.end();
+}
+
+// millis() at the first dispatched command, 0 if none yet
+unsigned long getFirstSerialCommandTime() {
+  return firstCommandTime;
+}
+
+SerialPersonality getSerialPersonality() {
+  return personality;
+}
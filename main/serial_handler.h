@@ -7,31 +7,71 @@
 #define SERIAL_HANDLER_H
 
 #include "config.h"
+#include "serial_commands.h"
 
-// Serial command structure
+// Parser states - input is consumed one byte at a time
+enum SerialParserState {
+  SERIAL_STATE_IDLE,                    // Between commands, skipping whitespace
+  SERIAL_STATE_TEXT,                    // Inside a newline terminated text command
+  SERIAL_STATE_BRACKETED,               // Inside a <...> legacy command
+  SERIAL_STATE_ALNITAK,                 // Inside a >XNNN Alnitak command
+  SERIAL_STATE_DISCARD                  // Dropping the rest of an overlong command
+};
+
+// Serial protocol personalities, persisted in preferences
+enum SerialPersonality {
+  SERIAL_PERSONALITY_NATIVE = 0,        // Text, bracketed and binary commands
+  SERIAL_PERSONALITY_ALNITAK = 1        // Adds Alnitak Flat-Man ">XNNN" commands
+};
+
+// Serial command structure - fields point into the parser's command buffer
 struct SerialCommand {
-  String command;
-  String parameter;
-  bool isValid;
+  const char* command;                  // First token, upper-cased
+  const char* parameter;                // Remainder of the command, "" if none
+  bool bracketed;                       // True for <..> legacy commands
+};
+
+// Snapshot of the values reported by SUBSCRIBE events
+struct SerialEventState {
+  int brightness;
+  int maxBrightness;
+  CalibratorStatus calibratorState;
+  bool wifiConnected;
 };
 
 // Function prototypes
 void initSerialHandler();
 void handleSerialCommands();
-void processSerialCommand(const String& command);
-SerialCommand parseSerialCommand(const String& input);
-void sendSerialResponse(const String& response);
+void processSerialCommand(char* command, bool bracketed);
+SerialCommand parseSerialCommand(char* input, bool bracketed);
+void sendSerialResponse(const char* response);
+void sendSerialResponsef(const char* format, ...);
 void printSerialHelp();
 void printSerialStatus();
+void publishSerialEvents();
 void enableDebug(bool enable);
+void setSerialPersonality(SerialPersonality newPersonality);
+SerialPersonality getSerialPersonality();
+unsigned long getFirstSerialCommandTime();
 
-// Command handlers
-void handleBrightnessCommand(const String& parameter);
-void handleOnCommand();
-void handleOffCommand();
-void handleMaxBrightnessCommand(const String& parameter);
-void handleDebugCommand(const String& parameter);
-void handleStatusCommand();
-void handleHelpCommand();
+// Command handlers - referenced from the command table
+void handleBrightnessCommand(const SerialArgs& args);
+void handleOnCommand(const SerialArgs& args);
+void handleOffCommand(const SerialArgs& args);
+void handleMaxBrightnessCommand(const SerialArgs& args);
+void handleDebugCommand(const SerialArgs& args);
+void handleBinaryCommand(const SerialArgs& args);
+void handleSubscribeCommand(const SerialArgs& args);
+void handleUnsubscribeCommand(const SerialArgs& args);
+void handlePersonalityCommand(const SerialArgs& args);
+void handleWiFiProfileCommand(const SerialArgs& args);
+void handleStatusCommand(const SerialArgs& args);
+void handleBootCommand(const SerialArgs& args);
+void handleHeapCommand(const SerialArgs& args);
+void handlePresetCommand(const SerialArgs& args);
+void handleLeaseCommand(const SerialArgs& args);
+void handleLoopCommand(const SerialArgs& args);
+void handleThrottleCommand(const SerialArgs& args);
+void handleHelpCommand(const SerialArgs& args);
 
-#endif // SERIAL_HANDLER_H
\ No newline at end of file
+#endif // SERIAL_HANDLER_H
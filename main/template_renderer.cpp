@@ -0,0 +1,131 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Streaming Template Renderer Implementation
+ */
+
+#include "template_renderer.h"
+#include "Debug.h"
+
+TemplateRenderer::TemplateRenderer(WebServer& server, TemplateResolver resolver)
+  : server(server), resolver(resolver) {
+}
+
+void TemplateRenderer::begin(int code, const char* contentType) {
+  length = 0;
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(code, contentType, String());
+}
+
+void TemplateRenderer::render(PGM_P templateText) {
+  char name[TEMPLATE_MAX_PLACEHOLDER];
+  PGM_P literal = templateText;
+  PGM_P p = templateText;
+
+  while (pgm_read_byte(p) != '\0') {
+    if (pgm_read_byte(p) != '{' || pgm_read_byte(p + 1) != '{') {
+      p++;
+      continue;
+    }
+
+    // Collect the placeholder name up to the closing braces
+    PGM_P q = p + 2;
+    size_t nameLength = 0;
+    bool closed = false;
+    while (nameLength < sizeof(name) - 1) {
+      char c = pgm_read_byte(q);
+      if (c == '\0') {
+        break;
+      }
+      if (c == '}' && pgm_read_byte(q + 1) == '}') {
+        closed = true;
+        break;
+      }
+      name[nameLength++] = c;
+      q++;
+    }
+
+    if (!closed) {
+      p++;  // Not a placeholder - leave the braces in the output
+      continue;
+    }
+    name[nameLength] = '\0';
+
+    writeFlash(literal, p - literal);
+    if (!resolver(name, *this)) {
+      LOG_VERBOSE(LOG_CAT_WEB, "Template: unknown placeholder %s\n", name);
+    }
+    p = q + 2;
+    literal = p;
+  }
+
+  writeFlash(literal, p - literal);
+}
+
+void TemplateRenderer::end() {
+  sendChunk();
+  server.sendContent("");
+}
+
+void TemplateRenderer::printEscaped(const char* text) {
+  for (const char* p = text; *p != '\0'; p++) {
+    switch (*p) {
+      case '&':  print("&amp;");  break;
+      case '<':  print("&lt;");   break;
+      case '>':  print("&gt;");   break;
+      case '"':  print("&quot;"); break;
+      case '\'': print("&#39;");  break;
+      default:   write((uint8_t)*p); break;
+    }
+  }
+}
+
+size_t TemplateRenderer::write(uint8_t c) {
+  if (length >= sizeof(buffer)) {
+    sendChunk();
+  }
+  buffer[length++] = c;
+  return 1;
+}
+
+size_t TemplateRenderer::write(const uint8_t* data, size_t size) {
+  size_t remaining = size;
+  while (remaining > 0) {
+    if (length >= sizeof(buffer)) {
+      sendChunk();
+    }
+    size_t count = min(remaining, sizeof(buffer) - length);
+    memcpy(&buffer[length], data, count);
+    length += count;
+    data += count;
+    remaining -= count;
+  }
+  return size;
+}
+
+// Same as write() but reads the source with the flash accessors
+void TemplateRenderer::writeFlash(PGM_P data, size_t size) {
+  while (size > 0) {
+    if (length >= sizeof(buffer)) {
+      sendChunk();
+    }
+    size_t count = min(size, sizeof(buffer) - length);
+    memcpy_P(&buffer[length], data, count);
+    length += count;
+    data += count;
+    size -= count;
+  }
+}
+
+void TemplateRenderer::sendChunk() {
+  if (length > 0) {
+    server.sendContent(buffer, length);
+    length = 0;
+  }
+}
+
+void sendTemplatePage(WebServer& server, PGM_P templateText, TemplateResolver resolver) {
+  TemplateRenderer renderer(server, resolver);
+  renderer.begin(200, "text/html");
+  renderer.render(templateText);
+  renderer.end();
+}
@@ -0,0 +1,57 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Streaming Template Renderer Header
+ *
+ * Pages live in flash as templates with {{name}} placeholders. The renderer
+ * copies the literal text into a fixed buffer, asks a resolver to print each
+ * placeholder, and sends the buffer as an HTTP chunk whenever it fills, so a
+ * page is never assembled in heap.
+ */
+
+#ifndef TEMPLATE_RENDERER_H
+#define TEMPLATE_RENDERER_H
+
+#include <Arduino.h>
+#include <WebServer.h>
+#include "config.h"
+
+class TemplateRenderer;
+
+// Prints the value of one placeholder; returns false if the name is unknown
+typedef bool (*TemplateResolver)(const char* name, TemplateRenderer& out);
+
+class TemplateRenderer : public Print {
+public:
+  TemplateRenderer(WebServer& server, TemplateResolver resolver);
+
+  // Send the status line and headers for a chunked response
+  void begin(int code, const char* contentType);
+
+  // Render a flash template; may be called again from a resolver for partials
+  void render(PGM_P templateText);
+
+  // Send any buffered output and the terminating chunk
+  void end();
+
+  // Print text with HTML special characters escaped
+  void printEscaped(const char* text);
+  void printEscaped(const String& text) { printEscaped(text.c_str()); }
+
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* data, size_t length) override;
+  using Print::write;
+
+private:
+  void writeFlash(PGM_P data, size_t length);
+  void sendChunk();
+
+  WebServer& server;
+  TemplateResolver resolver;
+  char buffer[TEMPLATE_BUFFER_SIZE];
+  size_t length = 0;
+};
+
+// Render a complete page as a 200 text/html response
+void sendTemplatePage(WebServer& server, PGM_P templateText, TemplateResolver resolver);
+
+#endif // TEMPLATE_RENDERER_H
@@ -0,0 +1,179 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Embedded Web Assets - GENERATED by tools/embed_web_assets.py, do not edit
+ */
+
+#ifndef WEB_ASSETS_H
+#define WEB_ASSETS_H
+
+#include <Arduino.h>
+
+struct WebAsset {
+  const char* path;                     // Content-hashed URL
+  const char* contentType;
+  const uint8_t* data;                  // Gzip compressed
+  size_t length;
+};
+
+#define WEB_ASSET_APP_CSS_PATH "/static/app.ec7d68a4.css"
+#define WEB_ASSET_APP_JS_PATH "/static/app.aef63e4e.js"
+
+// /static/app.ec7d68a4.css: 2517 bytes minified, 827 bytes gzipped
+inline const uint8_t WEB_ASSET_APP_CSS_DATA[] PROGMEM = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x95, 0x56, 0x6d, 0x8b, 0xdb, 0x30,
+  0x0c, 0xfe, 0x2b, 0x86, 0x31, 0xd8, 0x41, 0x7d, 0x24, 0xb9, 0x1e, 0xeb, 0x0b, 0xfb, 0xb0, 0xdf,
+  0x31, 0xf6, 0xc1, 0x89, 0x95, 0xc4, 0x9c, 0x63, 0x07, 0xdb, 0xb9, 0xf4, 0x36, 0xfa, 0xdf, 0x27,
+  0x3b, 0xef, 0x6d, 0xd2, 0x6d, 0x94, 0x86, 0x54, 0x96, 0xa5, 0x47, 0xd2, 0x23, 0xa9, 0xa9, 0xe6,
+  0x1f, 0xe4, 0x37, 0xc9, 0xb5, 0x72, 0x34, 0x67, 0x95, 0x90, 0x1f, 0x27, 0xf2, 0xdd, 0x08, 0x26,
+  0x77, 0xc4, 0x32, 0x65, 0xa9, 0x05, 0x23, 0xf2, 0x33, 0xa9, 0x98, 0x29, 0x84, 0x3a, 0x91, 0x24,
+  0xaa, 0x2f, 0x67, 0x92, 0xb2, 0xec, 0xad, 0x30, 0xba, 0x51, 0x9c, 0x66, 0x5a, 0x6a, 0x73, 0x22,
+  0x9f, 0xf2, 0x28, 0x3f, 0xe4, 0xa8, 0x78, 0x2d, 0xe3, 0x1d, 0x29, 0x13, 0x34, 0x39, 0x9c, 0x24,
+  0xd9, 0x0b, 0xbc, 0x46, 0x78, 0xc2, 0x66, 0xc2, 0x97, 0xfd, 0xf1, 0xc0, 0xd3, 0x33, 0x71, 0x70,
+  0x71, 0x94, 0x43, 0xa6, 0x0d, 0x73, 0x42, 0xa3, 0x03, 0xa5, 0x15, 0x78, 0xdd, 0x53, 0xa9, 0xdf,
+  0xc1, 0xe0, 0x8d, 0x3b, 0x0d, 0xf4, 0x0a, 0x46, 0x8a, 0xa0, 0xf6, 0x9c, 0x21, 0x6e, 0x86, 0xef,
+  0x5e, 0xb3, 0x62, 0x17, 0xda, 0x0a, 0xee, 0xca, 0x13, 0x39, 0x44, 0x01, 0xe7, 0x80, 0x3a, 0x22,
+  0xac, 0x71, 0x7a, 0x0d, 0x77, 0x5b, 0x0a, 0x87, 0x86, 0x6a, 0xc6, 0xb9, 0x50, 0xc5, 0x18, 0x9f,
+  0x36, 0xe8, 0x83, 0x1a, 0xc6, 0x45, 0x63, 0x4f, 0x24, 0xee, 0x85, 0x17, 0x6a, 0x4b, 0xc6, 0x75,
+  0xeb, 0x0d, 0x26, 0xf5, 0x25, 0xc8, 0x89, 0x29, 0x52, 0xf6, 0x25, 0xda, 0x85, 0xcf, 0x73, 0xfc,
+  0x14, 0x40, 0x31, 0xc3, 0x11, 0xcf, 0xe4, 0xcd, 0xe7, 0xe7, 0x90, 0x1f, 0x73, 0x76, 0x67, 0x7a,
+  0xef, 0x2d, 0x8f, 0xde, 0xe3, 0xd7, 0x09, 0x35, 0x4d, 0xb5, 0x73, 0xba, 0x9a, 0x20, 0xdd, 0x7a,
+  0xdf, 0xaf, 0x3b, 0x57, 0xec, 0x9d, 0xa6, 0xac, 0xcb, 0xc7, 0x8a, 0x9d, 0xc9, 0xd7, 0x66, 0x25,
+  0x1f, 0x20, 0xfd, 0x3f, 0x14, 0x0d, 0x3a, 0x56, 0x08, 0x84, 0x0b, 0x5b, 0x4b, 0x86, 0xc4, 0x12,
+  0xca, 0xd7, 0x8d, 0xa6, 0x52, 0x67, 0x6f, 0x53, 0x75, 0x5e, 0x17, 0xb8, 0x0e, 0x3e, 0xb1, 0xaf,
+  0x1b, 0xd8, 0x06, 0xda, 0x2c, 0xab, 0xb7, 0x86, 0x74, 0x8b, 0x58, 0x33, 0x64, 0x23, 0xc5, 0x56,
+  0x1c, 0x25, 0xc7, 0x43, 0x94, 0x1e, 0x37, 0xcd, 0x2c, 0xfd, 0x5f, 0x25, 0x4b, 0x41, 0xce, 0x03,
+  0x5d, 0x44, 0x38, 0x56, 0x20, 0x44, 0x15, 0x3a, 0xad, 0x05, 0x51, 0x94, 0x0e, 0xf5, 0xb4, 0xe4,
+  0x78, 0x5f, 0xa8, 0xba, 0x71, 0x3f, 0xdc, 0x47, 0x0d, 0xdf, 0xbc, 0xc3, 0x9f, 0x3b, 0x32, 0x93,
+  0xd4, 0xcc, 0xda, 0x16, 0x23, 0x5c, 0x4a, 0x55, 0x53, 0xa5, 0x60, 0x50, 0x66, 0x41, 0x42, 0xe6,
+  0xd0, 0x79, 0x4f, 0xfd, 0x38, 0x8a, 0x3e, 0x2f, 0xd3, 0x79, 0x87, 0xa3, 0x4f, 0x6f, 0xc8, 0x1a,
+  0xfe, 0xc2, 0x84, 0x5b, 0x2d, 0x05, 0x27, 0x9f, 0x38, 0xe7, 0x0f, 0xea, 0x2e, 0x7e, 0x05, 0x8b,
+  0xfd, 0x39, 0x8a, 0x96, 0xc8, 0x0d, 0x53, 0x05, 0xfc, 0xbc, 0x05, 0x32, 0x14, 0x39, 0xf4, 0x4a,
+  0xb4, 0xbc, 0x61, 0x9b, 0xb4, 0x12, 0x3e, 0xda, 0x91, 0x29, 0x8b, 0x96, 0x79, 0x54, 0xec, 0xa1,
+  0x10, 0x0b, 0x3a, 0x2f, 0x02, 0x5b, 0x06, 0x90, 0x35, 0xc6, 0x7a, 0x23, 0xb5, 0x16, 0xca, 0x81,
+  0xb9, 0x21, 0xdf, 0x0a, 0xa8, 0x8e, 0x1c, 0x03, 0xb4, 0x15, 0xaa, 0xcc, 0x48, 0x72, 0x75, 0x2c,
+  0x95, 0xe0, 0x4f, 0x3b, 0xcf, 0x08, 0x58, 0xb2, 0xda, 0xc2, 0x89, 0x0c, 0x6f, 0xe7, 0x65, 0x52,
+  0xba, 0x0b, 0x3b, 0xe2, 0x4a, 0xfc, 0xf2, 0xf1, 0xe2, 0x7d, 0x2d, 0xae, 0xa3, 0xc6, 0xb2, 0xa0,
+  0x81, 0x96, 0x4c, 0x8a, 0x02, 0x23, 0x90, 0x90, 0xbb, 0xa0, 0xb9, 0xce, 0xe4, 0x3c, 0xf1, 0x1f,
+  0xcf, 0x7c, 0xeb, 0x98, 0x6b, 0x2c, 0x0d, 0x89, 0xee, 0x4f, 0x0b, 0x03, 0xa0, 0xd6, 0x39, 0x39,
+  0xaa, 0xe7, 0xf9, 0xa4, 0x6f, 0x80, 0x3f, 0xd6, 0x36, 0xc0, 0xc2, 0x3e, 0xe9, 0xf5, 0x53, 0xd9,
+  0xc0, 0xe3, 0x0b, 0x60, 0x8c, 0x36, 0xd3, 0x05, 0xce, 0xcc, 0xdb, 0xb6, 0x93, 0xae, 0x18, 0xd4,
+  0xe8, 0x76, 0xde, 0x6c, 0xb9, 0x04, 0xdf, 0x57, 0xf8, 0xa4, 0xad, 0x61, 0x35, 0x32, 0x05, 0x9f,
+  0x67, 0x52, 0xf8, 0xd7, 0x78, 0xb6, 0x07, 0xa8, 0xd3, 0xf5, 0x40, 0xfe, 0xd1, 0x56, 0x6d, 0x04,
+  0x9e, 0x7e, 0xac, 0xe7, 0x6e, 0x60, 0xe0, 0xa8, 0x6d, 0x9b, 0x2c, 0x03, 0x6b, 0x37, 0x66, 0x06,
+  0x64, 0xd9, 0xd7, 0x78, 0xa6, 0xdd, 0x32, 0xa3, 0xb0, 0x66, 0x1b, 0x75, 0x79, 0x39, 0x66, 0x71,
+  0x32, 0xd3, 0xe6, 0xbe, 0x7f, 0x36, 0xc6, 0x11, 0x7c, 0xdd, 0x67, 0x2f, 0x59, 0x50, 0x36, 0x3e,
+  0x25, 0x0a, 0x41, 0x50, 0xbf, 0xfb, 0x8c, 0x96, 0xe3, 0xa4, 0xef, 0x46, 0x7c, 0x68, 0xb2, 0xb9,
+  0x5a, 0x9f, 0xa7, 0x61, 0xc9, 0x63, 0x1b, 0x23, 0x31, 0x93, 0xfd, 0xc6, 0x2c, 0xba, 0xeb, 0xd7,
+  0xe7, 0x29, 0xe6, 0x7f, 0x20, 0xcd, 0x4d, 0x39, 0xb7, 0x4b, 0x99, 0x81, 0xef, 0xc3, 0x61, 0xbf,
+  0xf7, 0x54, 0xee, 0x84, 0x61, 0x4a, 0x83, 0xc3, 0x99, 0xf7, 0x46, 0xa5, 0xb0, 0xae, 0x5f, 0xed,
+  0x65, 0x6f, 0x21, 0xe9, 0x76, 0xbb, 0x6f, 0xc8, 0x5c, 0xea, 0x96, 0x22, 0x03, 0xfa, 0xed, 0xbe,
+  0xd1, 0x44, 0xb7, 0x2b, 0x6f, 0x65, 0x3c, 0x4c, 0x0e, 0x71, 0xc6, 0x54, 0x77, 0xed, 0x36, 0xe6,
+  0xb7, 0xcb, 0xc9, 0x8a, 0x23, 0x00, 0xf8, 0xc7, 0xc1, 0x73, 0x7d, 0xae, 0x0d, 0x58, 0xc0, 0x7f,
+  0x5b, 0xda, 0x54, 0x73, 0x1a, 0x17, 0x46, 0x20, 0x58, 0xff, 0xa4, 0x88, 0x01, 0x65, 0x0e, 0x7c,
+  0xfd, 0x9b, 0x4a, 0x59, 0x9f, 0xc8, 0x1a, 0x98, 0xfb, 0xb2, 0xdf, 0x91, 0x38, 0x37, 0x4f, 0x7f,
+  0x23, 0xf7, 0x1f, 0x09, 0x93, 0x1d, 0x9c, 0xd5, 0x09, 0x00, 0x00,
+};
+
+// /static/app.aef63e4e.js: 4430 bytes minified, 1480 bytes gzipped
+inline const uint8_t WEB_ASSET_APP_JS_DATA[] PROGMEM = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xb5, 0x58, 0x5b, 0x6f, 0xdb, 0x36,
+  0x14, 0x7e, 0xf7, 0xaf, 0xe0, 0x1e, 0x16, 0x4a, 0xa8, 0x23, 0xbb, 0xc3, 0x5e, 0x16, 0xd7, 0x29,
+  0x1a, 0x37, 0x45, 0x5b, 0xb4, 0x4e, 0x50, 0xbb, 0x1b, 0x86, 0x61, 0x0f, 0xb4, 0x44, 0xdb, 0x5c,
+  0x65, 0x52, 0x20, 0x29, 0x3b, 0x46, 0x9a, 0xff, 0xbe, 0x73, 0x48, 0xea, 0x62, 0xc7, 0x76, 0x52,
+  0x60, 0x7b, 0x89, 0x25, 0xf2, 0x3b, 0x57, 0x9e, 0x73, 0xf8, 0x29, 0xa9, 0x92, 0xc6, 0x12, 0x63,
+  0x99, 0xe5, 0xa3, 0x9c, 0x19, 0xc3, 0x0d, 0x19, 0x92, 0x7b, 0xf2, 0x85, 0xb3, 0x6c, 0x7b, 0x41,
+  0x28, 0x6e, 0x94, 0xe6, 0x5c, 0xe3, 0x2b, 0xed, 0x92, 0x9b, 0xf9, 0xbc, 0x59, 0x54, 0xf3, 0x39,
+  0x2c, 0x5d, 0x6b, 0xad, 0x74, 0xb3, 0xc8, 0xf1, 0x95, 0x92, 0x87, 0x41, 0x27, 0x75, 0x9a, 0xe7,
+  0x4a, 0xaf, 0xde, 0x83, 0x34, 0xd7, 0x5e, 0x31, 0x1d, 0x29, 0x69, 0xb9, 0xb4, 0xe7, 0xd3, 0x6d,
+  0xc1, 0x29, 0xc8, 0xb1, 0xa2, 0xc8, 0x45, 0xca, 0xac, 0x50, 0xb2, 0x77, 0x77, 0xbe, 0xd9, 0x6c,
+  0xce, 0x51, 0xe4, 0xbc, 0xd4, 0x39, 0x97, 0xa9, 0xca, 0x78, 0xe6, 0x94, 0xcd, 0x4b, 0x99, 0x22,
+  0x84, 0xb0, 0xbc, 0x60, 0x29, 0xbb, 0x65, 0x0b, 0x1e, 0xc5, 0xe4, 0xbe, 0xa3, 0xb9, 0x2d, 0xb5,
+  0x24, 0x99, 0x4a, 0xcb, 0x15, 0x68, 0x4d, 0x66, 0x2a, 0xdb, 0x26, 0x19, 0xb3, 0xcc, 0x70, 0x9b,
+  0xb0, 0x42, 0x90, 0xe1, 0x70, 0x08, 0x36, 0x9c, 0x10, 0x1d, 0x74, 0x1e, 0x1a, 0x45, 0x00, 0x98,
+  0xf2, 0x3b, 0x1b, 0x89, 0xac, 0x4b, 0x2c, 0x3c, 0xa0, 0x36, 0xef, 0x32, 0xcf, 0x39, 0xea, 0x02,
+  0x77, 0x6b, 0xb5, 0x0b, 0x6e, 0xaf, 0xfd, 0xea, 0xd5, 0xf6, 0x43, 0x06, 0x32, 0xf1, 0xa0, 0x23,
+  0xe6, 0x24, 0x0a, 0xd0, 0xb8, 0x92, 0x49, 0x84, 0x94, 0x5c, 0xa3, 0x5e, 0x90, 0x46, 0xad, 0x3b,
+  0x26, 0x0b, 0x65, 0x6c, 0x04, 0x81, 0x75, 0x09, 0xba, 0xd9, 0x25, 0x2b, 0x6e, 0x97, 0x2a, 0x6b,
+  0x85, 0x31, 0xe7, 0x36, 0x5d, 0x7a, 0xc4, 0x7d, 0xd8, 0xbd, 0x08, 0xbf, 0xe4, 0xfb, 0x77, 0x42,
+  0x6f, 0x6f, 0x26, 0x53, 0x48, 0xf9, 0xd2, 0xe7, 0xf3, 0xa2, 0x9d, 0x5c, 0xaf, 0xf3, 0xc2, 0xfd,
+  0x25, 0x0f, 0xf1, 0x23, 0xbb, 0x23, 0x96, 0x8b, 0x99, 0x66, 0x56, 0xe9, 0x08, 0x21, 0x68, 0xd4,
+  0xb9, 0x43, 0x7b, 0x69, 0xbd, 0x43, 0xbd, 0x92, 0x38, 0xb1, 0x4b, 0x2e, 0x23, 0xcd, 0x4d, 0x01,
+  0xf9, 0xe0, 0x64, 0x78, 0x09, 0x60, 0x8c, 0xb6, 0x5a, 0x49, 0xfc, 0x59, 0x93, 0x9f, 0x20, 0xb7,
+  0xbf, 0xf6, 0x7f, 0x8b, 0x89, 0x77, 0x7f, 0xd0, 0xa9, 0x01, 0x18, 0x7a, 0x14, 0xf4, 0xac, 0xb8,
+  0x31, 0x70, 0x5c, 0x8d, 0x1a, 0xc8, 0xf2, 0x5c, 0xe8, 0x55, 0xbd, 0xf1, 0x82, 0xd0, 0x84, 0x4c,
+  0xd9, 0x37, 0x4e, 0x60, 0xc7, 0x6a, 0x95, 0xbf, 0xa6, 0xf1, 0x31, 0xff, 0x28, 0x73, 0x21, 0x0d,
+  0x35, 0x24, 0x1c, 0xce, 0x98, 0x06, 0x1b, 0x50, 0x0b, 0xa0, 0xfe, 0x68, 0x40, 0x2e, 0x1d, 0x2e,
+  0x29, 0x7b, 0x89, 0x29, 0xed, 0x1b, 0x57, 0x1a, 0x91, 0x4f, 0x72, 0x97, 0x14, 0x4c, 0x33, 0x78,
+  0x86, 0x84, 0xb6, 0x3c, 0x80, 0x3a, 0xea, 0xad, 0x5f, 0xf6, 0x52, 0xb5, 0xe6, 0xba, 0x51, 0xde,
+  0xeb, 0xf7, 0x28, 0xf8, 0x5e, 0x49, 0xd2, 0x51, 0x2e, 0xa0, 0x02, 0x3e, 0xbc, 0x1d, 0xf6, 0xcf,
+  0xfc, 0xe3, 0x54, 0x33, 0x69, 0xbc, 0xbf, 0xb0, 0xfa, 0x12, 0xc1, 0x8d, 0x7a, 0x10, 0xb8, 0xfd,
+  0x3a, 0xa5, 0x71, 0xe7, 0x71, 0xb2, 0xeb, 0x2c, 0xfe, 0x63, 0x94, 0x8c, 0xe2, 0x06, 0x52, 0xe4,
+  0xdb, 0xf6, 0x61, 0xc0, 0x6b, 0xe2, 0xba, 0x6f, 0x5c, 0xae, 0x66, 0x5c, 0xbb, 0xe3, 0xe8, 0xc7,
+  0xd0, 0x21, 0x5c, 0xdb, 0xf6, 0xf6, 0x67, 0x9f, 0xe7, 0xc7, 0xe1, 0x37, 0xb1, 0xdc, 0x48, 0xd7,
+  0x4d, 0xa8, 0xb7, 0xdd, 0x60, 0x2e, 0x07, 0x75, 0x8e, 0x68, 0x83, 0x57, 0x12, 0xcf, 0x82, 0xa2,
+  0x3a, 0x28, 0x7d, 0x70, 0xdb, 0xe7, 0xaa, 0x55, 0x64, 0xd5, 0x41, 0x01, 0xd2, 0x67, 0xff, 0xa0,
+  0xd9, 0xf9, 0xfc, 0x07, 0xed, 0xba, 0x91, 0xf3, 0x3c, 0xc3, 0x00, 0xdd, 0xb7, 0x0c, 0x3d, 0x7f,
+  0xa5, 0xc5, 0x62, 0x69, 0x25, 0xa4, 0x24, 0x5a, 0xb3, 0xbc, 0xe4, 0x4d, 0xdb, 0x9b, 0x5c, 0x40,
+  0x23, 0x9d, 0xe8, 0x7a, 0x3a, 0xab, 0x65, 0x69, 0xe8, 0x7f, 0x2f, 0x13, 0x07, 0xd9, 0xc4, 0x69,
+  0x04, 0x0d, 0xee, 0x77, 0xd0, 0xa9, 0x46, 0x4c, 0x4b, 0xf0, 0x77, 0xdc, 0x81, 0x10, 0x3c, 0x12,
+  0x2a, 0xff, 0xe7, 0x4a, 0xd5, 0x0f, 0xe4, 0xfd, 0xac, 0x09, 0x62, 0x88, 0x55, 0xe5, 0x03, 0x79,
+  0x3a, 0x25, 0x8d, 0x1b, 0x67, 0xb3, 0x23, 0x1a, 0xda, 0xd9, 0xc2, 0xc9, 0xbc, 0xbd, 0x85, 0x6a,
+  0xe4, 0x36, 0x92, 0x50, 0xb6, 0xf1, 0x71, 0xcd, 0x85, 0x43, 0x9d, 0x21, 0xca, 0xe9, 0xf3, 0xa3,
+  0xfb, 0xeb, 0x97, 0x0f, 0x23, 0xb5, 0x82, 0x5a, 0x86, 0x0c, 0x7a, 0x0d, 0x7b, 0xed, 0xe7, 0xa4,
+  0xde, 0x09, 0x9e, 0xbb, 0x91, 0xda, 0xcc, 0xc1, 0x03, 0xe2, 0x27, 0x46, 0x71, 0xd2, 0x78, 0xdf,
+  0x9c, 0x34, 0x5b, 0xf3, 0xe0, 0xfa, 0x5e, 0x23, 0x7b, 0xa3, 0x06, 0xf3, 0x58, 0xbb, 0xdb, 0x76,
+  0x84, 0xfa, 0x97, 0x31, 0xec, 0xd1, 0x18, 0x4f, 0x68, 0x3f, 0x57, 0x07, 0xc0, 0x57, 0xad, 0xc2,
+  0x20, 0x2f, 0x3a, 0xf4, 0x0c, 0xba, 0xbc, 0xf8, 0x7c, 0x14, 0xfe, 0x05, 0x76, 0x83, 0x6e, 0x7e,
+  0x07, 0xae, 0x95, 0x9a, 0x1f, 0x07, 0x5f, 0x07, 0x04, 0x8d, 0x4f, 0xce, 0x0a, 0xf5, 0x8d, 0xbc,
+  0x26, 0xb9, 0xf2, 0x17, 0x69, 0x02, 0xe3, 0x51, 0xb1, 0x0c, 0x42, 0xbf, 0x20, 0x07, 0x67, 0xb2,
+  0x9b, 0x11, 0x7b, 0xa7, 0x91, 0xc1, 0x48, 0xb5, 0x4f, 0x27, 0xcd, 0xc3, 0x86, 0x2f, 0xcf, 0x9e,
+  0xce, 0xde, 0xff, 0xec, 0xb0, 0x01, 0x4f, 0x52, 0x3b, 0xe6, 0x76, 0xa3, 0xf4, 0xb7, 0xba, 0x42,
+  0x8f, 0x76, 0xaf, 0x31, 0x22, 0xa3, 0x71, 0xdd, 0xa3, 0x88, 0x1f, 0x1c, 0x47, 0x17, 0xc0, 0x85,
+  0x40, 0x2f, 0x4a, 0xcc, 0x01, 0x63, 0xa2, 0x3d, 0xdb, 0x4b, 0xb5, 0x09, 0x96, 0x4d, 0x24, 0xc3,
+  0x43, 0x33, 0x4b, 0x72, 0x61, 0x4e, 0xf1, 0x07, 0x1a, 0x24, 0x3e, 0x01, 0x0c, 0xfb, 0x1f, 0xe1,
+  0x9e, 0x3a, 0xbc, 0x9f, 0x7e, 0xfe, 0x04, 0x82, 0x94, 0xfa, 0xa1, 0x50, 0x69, 0x4e, 0x80, 0x0c,
+  0x2d, 0xec, 0xd2, 0xb1, 0x99, 0x3e, 0x9a, 0x79, 0x2c, 0xf1, 0xaa, 0xb8, 0x1c, 0x2b, 0xf2, 0x87,
+  0x78, 0x27, 0x48, 0x25, 0x05, 0xfc, 0xa0, 0x94, 0xd9, 0xab, 0x5e, 0x71, 0x49, 0x07, 0x9d, 0xea,
+  0x8e, 0x7e, 0x08, 0x2e, 0xe2, 0x5d, 0xcb, 0x84, 0xdc, 0x9d, 0x78, 0x29, 0x10, 0x3d, 0xcb, 0x83,
+  0xab, 0x11, 0xcd, 0xc4, 0x1a, 0xdd, 0xab, 0xa1, 0x49, 0x8a, 0x14, 0x11, 0x0f, 0x17, 0x2d, 0x06,
+  0x33, 0xe7, 0xe8, 0x0b, 0x18, 0xa8, 0x7d, 0x05, 0x56, 0x72, 0xcd, 0x80, 0xc7, 0x84, 0x05, 0x7f,
+  0x65, 0x79, 0xa3, 0xc2, 0xf2, 0xd5, 0xd3, 0xf6, 0x10, 0x75, 0xd8, 0x14, 0xee, 0xd0, 0x00, 0x50,
+  0x32, 0x05, 0xe2, 0x08, 0xea, 0x89, 0xbf, 0xfd, 0xf7, 0xca, 0xc1, 0xff, 0x26, 0x78, 0xea, 0x71,
+  0x45, 0x46, 0xa5, 0x57, 0x77, 0xcc, 0xbc, 0x01, 0xf2, 0x21, 0x17, 0xe8, 0x01, 0x02, 0x77, 0xb8,
+  0x5c, 0x5b, 0x5d, 0xb0, 0x0f, 0xe3, 0x91, 0xcb, 0x6c, 0xb4, 0x14, 0x50, 0xf6, 0xae, 0xf8, 0x0e,
+  0xac, 0x1f, 0xb3, 0x34, 0xd3, 0x34, 0x7e, 0x06, 0x1e, 0x8d, 0x8f, 0x61, 0x12, 0x46, 0x74, 0x22,
+  0x16, 0x92, 0xe5, 0x40, 0x97, 0xa1, 0xdf, 0x2a, 0x5f, 0x34, 0x38, 0x83, 0x43, 0x84, 0x64, 0x57,
+  0xab, 0x2e, 0x99, 0xf0, 0xb4, 0xd4, 0xc2, 0x6e, 0x1d, 0xa6, 0xd3, 0xc4, 0x8f, 0xcb, 0x3c, 0x83,
+  0x5e, 0xa3, 0x13, 0xff, 0x48, 0xa1, 0xc7, 0xe8, 0x0d, 0xd8, 0x04, 0x17, 0x76, 0x0e, 0xb7, 0xed,
+  0x08, 0x7a, 0x16, 0x08, 0x83, 0x2b, 0xb5, 0xf6, 0x5e, 0x2d, 0xb1, 0xdb, 0x12, 0x9a, 0xcf, 0xa1,
+  0x75, 0x97, 0x75, 0x57, 0x60, 0x99, 0x7a, 0x42, 0xeb, 0x67, 0x88, 0x49, 0x99, 0xfc, 0x11, 0xbe,
+  0x83, 0x2c, 0xbe, 0xa1, 0x3b, 0xf8, 0x96, 0x20, 0x5b, 0xbc, 0x74, 0x1d, 0xb0, 0xd3, 0x7f, 0x6e,
+  0xaf, 0x6e, 0xc2, 0x41, 0x83, 0x47, 0x93, 0x52, 0xc8, 0x45, 0xec, 0xd8, 0xbe, 0x58, 0x71, 0x55,
+  0x22, 0x33, 0xda, 0xf1, 0xb3, 0x4b, 0x7e, 0xe9, 0xf7, 0xfb, 0x8f, 0xc9, 0x11, 0x60, 0x2c, 0xd3,
+  0xf6, 0x2d, 0x5f, 0x8b, 0x94, 0xd7, 0x2c, 0xa5, 0xe2, 0xae, 0xf4, 0x8d, 0xe6, 0x64, 0xab, 0x4a,
+  0x82, 0xa3, 0xd9, 0x3d, 0x6c, 0x18, 0x7c, 0x32, 0x58, 0x55, 0xc9, 0x11, 0x88, 0x01, 0x46, 0x2a,
+  0x0a, 0x07, 0x3a, 0x5b, 0xe5, 0x22, 0x00, 0x68, 0x9b, 0xe3, 0x7b, 0x66, 0x0f, 0xbc, 0xfd, 0x40,
+  0x7a, 0xee, 0x03, 0xa3, 0xa3, 0xde, 0x15, 0x22, 0x4c, 0x65, 0x03, 0x22, 0x4b, 0x92, 0x04, 0xea,
+  0x35, 0x10, 0xfe, 0xbd, 0xf9, 0x34, 0xc1, 0x8f, 0x3a, 0x97, 0x88, 0xff, 0x86, 0xe4, 0xdc, 0x77,
+  0x02, 0xcd, 0x59, 0xb1, 0x3b, 0xd4, 0x80, 0x19, 0x86, 0xc7, 0xe6, 0xf2, 0x1b, 0x74, 0xf6, 0x78,
+  0x90, 0x83, 0xcc, 0x5a, 0xfb, 0x0f, 0xa7, 0x38, 0xd1, 0x1e, 0xba, 0x66, 0x47, 0x07, 0x44, 0x46,
+  0x3c, 0xcf, 0x9f, 0x23, 0xb1, 0xe3, 0x5e, 0x5b, 0x68, 0x67, 0xe3, 0xb1, 0x1c, 0x24, 0x4b, 0xc2,
+  0x30, 0xe1, 0x59, 0x5b, 0xa6, 0x5e, 0xc4, 0x66, 0xfa, 0x93, 0x1b, 0xd7, 0x48, 0x63, 0xb5, 0x2b,
+  0x58, 0x6a, 0x0d, 0xa9, 0x7c, 0x2b, 0x4c, 0x91, 0x33, 0xfc, 0x62, 0xa6, 0x23, 0xbf, 0xe2, 0x5b,
+  0xf7, 0x49, 0x87, 0xdd, 0x87, 0x78, 0x4b, 0xda, 0x9d, 0x61, 0x4b, 0xd6, 0xed, 0xd7, 0xf3, 0xcc,
+  0x7f, 0xb6, 0x83, 0x8b, 0xa7, 0x0e, 0xb4, 0x06, 0xd5, 0xe7, 0x59, 0x2d, 0xb8, 0x23, 0xad, 0x5e,
+  0x76, 0xc6, 0x5d, 0x63, 0x6b, 0xd0, 0x42, 0xb4, 0x47, 0x72, 0xfb, 0x3f, 0x06, 0x7f, 0x35, 0xf0,
+  0xbf, 0xdd, 0x77, 0x2a, 0xf5, 0xd5, 0xe8, 0xfa, 0xf0, 0x39, 0x75, 0xd6, 0xfa, 0xf6, 0x5e, 0x03,
+  0xc0, 0xb8, 0x81, 0xbb, 0x21, 0xd7, 0xf8, 0x32, 0x51, 0xa5, 0x86, 0x06, 0xa4, 0x3d, 0xbf, 0x85,
+  0x41, 0xf8, 0xa7, 0x84, 0x65, 0x99, 0x43, 0xe0, 0x2d, 0xca, 0xc1, 0xf7, 0x10, 0x2a, 0xa4, 0xcd,
+  0xf5, 0x4d, 0xd3, 0x02, 0x1f, 0x27, 0x37, 0xe3, 0x04, 0x3e, 0xbd, 0x0c, 0x8f, 0xb8, 0xfb, 0xe7,
+  0x40, 0xec, 0x99, 0xc4, 0x49, 0xff, 0x76, 0xae, 0x68, 0x97, 0xa9, 0x67, 0x8c, 0x90, 0x7f, 0x01,
+  0x9c, 0x1f, 0xc3, 0x07, 0x4e, 0x11, 0x00, 0x00,
+};
+
+inline const WebAsset webAssets[] = {
+  { WEB_ASSET_APP_CSS_PATH, "text/css", WEB_ASSET_APP_CSS_DATA, sizeof(WEB_ASSET_APP_CSS_DATA) },
+  { WEB_ASSET_APP_JS_PATH, "application/javascript", WEB_ASSET_APP_JS_DATA, sizeof(WEB_ASSET_APP_JS_DATA) },
+};
+
+#endif // WEB_ASSETS_H
@@ -6,12 +6,27 @@
 #include "web_ui_handler.h"
 #include <ArduinoJson.h>  // MISSING INCLUDE - THIS FIXES THE COMPILATION ERROR
 #include "calibrator_controller.h"
+#include "command_gateway.h"
+#include "alpaca_handler.h"
 #include "html_templates.h"
+#include "template_renderer.h"
+#include "event_stream.h"
+#include "wifi_scan.h"
+#include "wifi_manager.h"
+#include "dhcp_lease.h"
+#include "boot_sequencer.h"
+#include "heap_monitor.h"
+#include "loop_monitor.h"
+#include "rate_limiter.h"
 #include "Debug.h"
 
 // Web server instance
 WebServer webUiServer(WEB_UI_PORT);
 
+// Restart requested over HTTP, performed from the main loop
+static bool restartPending = false;
+static unsigned long restartRequestTime = 0;
+
 // Load configuration from preferences
 void loadConfiguration() {
   Preferences preferences;
@@ -30,7 +45,7 @@ void loadConfiguration() {
   
   preferences.end();
   
-  Debug.println("Configuration loaded from preferences");
+  LOG_INFO(LOG_CAT_WEB, "Configuration loaded from preferences\n");
 }
 
 // Save configuration to preferences
@@ -48,67 +63,205 @@ void saveConfiguration() {
   
   preferences.end();
   
-  Debug.println("Configuration saved to preferences");
+  LOG_INFO(LOG_CAT_WEB, "Configuration saved to preferences\n");
 }
 
 // Initialize Web UI
 void initWebUI() {
   // Handle root page
-  webUiServer.on("/", HTTP_GET, handleRoot);
+  onRoute(webUiServer, "/", HTTP_GET, handleRoot);
   
   // Handle setup page
-  webUiServer.on("/setup", HTTP_GET, handleSetup);
-  webUiServer.on("/setup", HTTP_POST, handleSetupPost);
+  onRoute(webUiServer, "/setup", HTTP_GET, handleSetup);
+  onRoute(webUiServer, "/setup", HTTP_POST, handleSetupPost);
   
   // Handle calibrator control
-  webUiServer.on("/calibrator", HTTP_GET, handleCalibrator);
-  webUiServer.on("/calibrator", HTTP_POST, handleCalibratorPost);
+  onRoute(webUiServer, "/calibrator", HTTP_GET, handleCalibrator);
+  onRoute(webUiServer, "/calibrator", HTTP_POST, handleCalibratorPost);
   
   // Add status API for JavaScript updates - FIXED WITH ARDUINOJSON INCLUDE
-  webUiServer.on("/api/status", HTTP_GET, []() {
-    DynamicJsonDocument doc(200);
+  onRoute(webUiServer, "/api/status", HTTP_GET, []() {
+    DynamicJsonDocument doc(1024);
     doc["brightness"] = getCurrentBrightness();
     doc["state"] = getCalibratorStateString();
     doc["maxBrightness"] = getMaxBrightness();
     doc["connected"] = isConnected;
     
+    // Connection timing, to compare fast and full connects
+    const WiFiConnectStats& wifiStats = getWiFiConnectStats();
+    JsonObject wifi = doc.createNestedObject("wifi");
+    wifi["state"] = getWiFiStateString();
+    wifi["ip"] = WiFi.localIP().toString();
+    wifi["leaseSeconds"] = getDhcpLeaseSeconds();
+    wifi["bootToReadyMs"] = wifiStats.bootToReadyMs;
+    wifi["lastConnectMs"] = wifiStats.lastConnectMs;
+    wifi["lastAddressMs"] = wifiStats.lastAddressMs;
+    wifi["lastConnectFast"] = wifiStats.lastConnectFast;
+    wifi["lastReconnectMs"] = wifiStats.lastReconnectMs;
+    wifi["reconnectCount"] = wifiStats.reconnectCount;
+    wifi["fastConnectFailures"] = wifiStats.fastConnectFailures;
+    wifi["reconfigure"] = getWiFiReconfigureResultString();
+    
+    // Brightness requests merged into one PWM update
+    const BrightnessCoalescingStats& coalescing = getBrightnessCoalescingStats();
+    JsonObject brightnessSlot = doc.createNestedObject("coalescing");
+    brightnessSlot["requests"] = coalescing.requests;
+    brightnessSlot["applied"] = coalescing.applied;
+    brightnessSlot["merged"] = coalescing.merged;
+    
+    // Exclusive control by an Alpaca client, see command_gateway.h
+    CalibratorLease lease = getCalibratorLease();
+    const CommandGatewayStats& gatewayStats = getCommandGatewayStats();
+    JsonObject owner = doc.createNestedObject("lease");
+    if (lease.held) {
+      owner["clientID"] = lease.clientID;
+      owner["remainingMs"] = lease.remainingMs;
+    } else {
+      owner["clientID"] = nullptr;
+    }
+    JsonObject rejected = owner.createNestedObject("rejected");
+    for (int i = 0; i < COMMAND_SOURCE_COUNT; i++) {
+      rejected[getCommandSourceName((CommandSource)i)] = gatewayStats.rejected[i];
+    }
+    
+    // Deferred debug output, see /log
+    LogBufferStats logStats = getLogBufferStats();
+    JsonObject log = doc.createNestedObject("log");
+    log["recorded"] = logStats.recorded;
+    log["dropped"] = logStats.dropped;
+    log["truncated"] = logStats.truncated;
+    log["pending"] = logStats.pending;
+    
     String response;
     serializeJson(doc, response);
     webUiServer.send(200, "application/json", response);
   });
   
+  // Round-trip probe for comparing WiFi profiles
+  onRoute(webUiServer, "/api/echo", HTTP_GET, []() {
+    handleEchoRequest(webUiServer);
+  });
+  
+  // Per-phase boot timing, to track cold start across firmware versions
+  onRoute(webUiServer, "/api/boot", HTTP_GET, handleBootApi);
+  
+  // Heap and fragmentation, per interface (tools/heap_soak.py polls this)
+  onRoute(webUiServer, "/api/heap", HTTP_GET, handleHeapApi);
+  
+  // Filter presets; POST saves one or, with delete=1, removes it
+  onRoute(webUiServer, "/api/presets", HTTP_GET, handlePresetsApi);
+  onRoute(webUiServer, "/api/presets", HTTP_POST, handlePresetsApiPost);
+  
+  // Per-stage loop() timing; POST sets a budget or resets the statistics
+  onRoute(webUiServer, "/api/loop", HTTP_GET, handleLoopApi);
+  onRoute(webUiServer, "/api/loop", HTTP_POST, handleLoopApiPost);
+  
+  // Per-client rate limiting; POST sets the limits or forgets the clients
+  onRoute(webUiServer, "/api/ratelimit", HTTP_GET, handleRateLimitApi);
+  onRoute(webUiServer, "/api/ratelimit", HTTP_POST, handleRateLimitApiPost);
+  
+  // Recent debug output from the log buffer
+  onRoute(webUiServer, "/log", HTTP_GET, handleLogApi);
+  
+  // Cached WiFi scan results; also starts a new background scan when allowed
+  onRoute(webUiServer, "/api/scan", HTTP_GET, handleScanApi);
+  
+  // Live state push, replaces status polling
+  onRoute(webUiServer, "/events", HTTP_GET, []() {
+    handleEventStreamRequest(webUiServer);
+  });
+  
+  // Gzipped CSS/JS from flash
+  registerWebAssets(webUiServer);
+  
   // Add WiFi configuration routes
-  webUiServer.on("/wificonfig", HTTP_GET, handleWifiConfig);
-  webUiServer.on("/wificonfig", HTTP_POST, handleWifiConfigPost);
+  onRoute(webUiServer, "/wificonfig", HTTP_GET, handleWifiConfig);
+  onRoute(webUiServer, "/wificonfig", HTTP_POST, handleWifiConfigPost);
   
   // Restart handler
-  webUiServer.on("/restart", HTTP_POST, handleRestart);
+  onRoute(webUiServer, "/restart", HTTP_POST, handleRestart);
   
   // Start server
   webUiServer.begin();
-  Debug.printf("Web UI server started on port %d\n", WEB_UI_PORT);
+  LOG_INFO(LOG_CAT_WEB, "Web UI server started on port %d\n", WEB_UI_PORT);
+}
+
+// Register a route on either server. The handler is wrapped so the loop
+// monitor can name the route when a request overruns its budget, and so a
+// client over its rate limit is refused before the handler runs. Alpaca API
+// routes refuse with an ASCOM error body, everything else with plain text.
+void onRoute(WebServer& server, const char* path, HTTPMethod method, WebServer::THandlerFunction handler) {
+  WebServer* target = &server;
+  bool ascom = target == &alpacaServer && (strncmp(path, "/api/", 5) == 0 || strncmp(path, "/management/", 12) == 0);
+  server.on(path, method, [target, path, ascom, handler]() {
+    setLoopRoute(path);
+    uint32_t retryAfterMs;
+    if (!admitHttpRequest(target->client().remoteIP(), retryAfterMs)) {
+      if (ascom) {
+        sendAlpacaRateLimited(retryAfterMs);
+      } else {
+        target->sendHeader("Retry-After", String((retryAfterMs + 999) / 1000));
+        target->send(429, "text/plain", "Too many requests");
+      }
+      return;
+    }
+    handler();
+  });
+}
+
+// Serve the embedded assets. Their URLs carry a content hash, so browsers may
+// cache them forever and a firmware update simply links to new names.
+void registerWebAssets(WebServer& server) {
+  WebServer* target = &server;
+  for (const WebAsset& entry : webAssets) {
+    const WebAsset* asset = &entry;
+    onRoute(server, asset->path, HTTP_GET, [target, asset]() {
+      target->sendHeader("Content-Encoding", "gzip");
+      target->sendHeader("Cache-Control", "public, max-age=31536000, immutable");
+      target->send_P(200, asset->contentType, (PGM_P)asset->data, asset->length);
+    });
+  }
+}
+
+// Minimal reply for round-trip measurements (tools/measure_rtt.py). Served on
+// both ports; it does no work beyond echoing the sequence number back.
+void handleEchoRequest(WebServer& server) {
+  char response[64];
+  snprintf(response, sizeof(response), "{\"seq\":%lu,\"uptimeUs\":%lu}",
+           (unsigned long)server.arg("seq").toInt(), (unsigned long)micros());
+  server.sendHeader("Cache-Control", "no-store");
+  server.send(200, "application/json", response);
 }
 
 // Handle Web UI requests in the main loop
 void handleWebUI() {
-  webUiServer.handleClient();
+  HeapScope heapScope(HEAP_IF_WEB);
+  for (int i = 0; i <= RATE_LIMIT_DRAIN; i++) {
+    webUiServer.handleClient();
+    if (!takeRefusedRequest()) {
+      break;
+    }
+  }
+  
+  if (restartPending && millis() - restartRequestTime > RESTART_DELAY_MS) {
+    ESP.restart();
+  }
 }
 
 // Handle the root page - shows device status and controls
 void handleRoot() {
-  String html = getHomePage();
-  webUiServer.send(200, "text/html", html);
+  sendTemplatePage(webUiServer, HOME_PAGE_TEMPLATE, resolveHomePageField);
 }
 
 // Handle setup page
 void handleSetup() {
-  String html = getSetupPage();
-  webUiServer.send(200, "text/html", html);
+  sendTemplatePage(webUiServer, SETUP_PAGE_TEMPLATE, resolveSetupPageField);
 }
 
 // Handle setup form submission
 void handleSetupPost() {
   bool settingsChanged = false;
+  String notice;
   
   // Process device name
   if (webUiServer.hasArg("deviceName")) {
@@ -116,17 +269,22 @@ void handleSetupPost() {
     if (newDeviceName.length() > 0 && newDeviceName != deviceName) {
       deviceName = newDeviceName;
       settingsChanged = true;
-      Debug.println("Device name changed");
+      updateAlpacaMDNS();
+      LOG_INFO(LOG_CAT_WEB, "Device name changed\n");
     }
   }
   
   // Process max brightness
   if (webUiServer.hasArg("maxBrightness")) {
     int newMaxBrightness = webUiServer.arg("maxBrightness").toInt();
-    if (newMaxBrightness > 0 && newMaxBrightness <= MAX_BRIGHTNESS && newMaxBrightness != getMaxBrightness()) {
-      setMaxBrightness(newMaxBrightness);
-      settingsChanged = true;
-      Debug.println("Max brightness changed");
+    if (newMaxBrightness != getMaxBrightness()) {
+      CommandResult result = commandMaxBrightness(COMMAND_SOURCE_WEB, 0, newMaxBrightness);
+      if (result == COMMAND_OK) {
+        settingsChanged = true;
+        LOG_INFO(LOG_CAT_WEB, "Max brightness changed\n");
+      } else if (result == COMMAND_BUSY) {
+        notice = "Max brightness not changed: " + getCommandBusyMessage() + ".<br>";
+      }
     }
   }
   
@@ -136,7 +294,16 @@ void handleSetupPost() {
     if (newDebugEnabled != serialDebugEnabled) {
       serialDebugEnabled = newDebugEnabled;
       settingsChanged = true;
-      Debug.println("Debug setting changed");
+      LOG_INFO(LOG_CAT_WEB, "Debug setting changed\n");
+    }
+  }
+  
+  // WiFi profile is applied and persisted immediately by the WiFi manager
+  if (webUiServer.hasArg("wifiProfile")) {
+    WiFiProfile newProfile;
+    if (parseWiFiProfile(webUiServer.arg("wifiProfile").c_str(), newProfile) && newProfile != getWiFiProfile()) {
+      setWiFiProfile(newProfile);
+      settingsChanged = true;
     }
   }
   
@@ -149,15 +316,32 @@ void handleSetupPost() {
   if (!settingsChanged) {
     message = "No changes detected.";
   }
-  message += "<br><a href='/setup'>Back to setup page</a>";
+  message = notice + message + "<br><a href='/setup'>Back to setup page</a>";
   
   webUiServer.send(200, "text/html", message);
 }
 
 // Handle calibrator control page
 void handleCalibrator() {
-  String html = getCalibratorPage();
-  webUiServer.send(200, "text/html", html);
+  sendTemplatePage(webUiServer, CALIBRATOR_PAGE_TEMPLATE, resolveCalibratorPageField);
+}
+
+// A lease refusal is 409 Conflict so the page can offer to take control
+static void sendCalibratorCommandResult(CommandResult result, const String& message) {
+  switch (result) {
+    case COMMAND_OK:
+      webUiServer.send(200, "text/plain", message);
+      break;
+    case COMMAND_BUSY:
+      webUiServer.send(409, "text/plain", getCommandBusyMessage());
+      break;
+    case COMMAND_INVALID_VALUE:
+      webUiServer.send(400, "text/plain", "Invalid brightness value");
+      break;
+    default:
+      webUiServer.send(500, "text/plain", "Calibrator command failed");
+      break;
+  }
 }
 
 // Handle calibrator control form submission
@@ -166,18 +350,25 @@ void handleCalibratorPost() {
     String action = webUiServer.arg("action");
     
     if (action == "on") {
-      turnCalibratorOn();
-      webUiServer.send(200, "text/plain", "Calibrator turned ON");
+      sendCalibratorCommandResult(commandCalibratorOn(COMMAND_SOURCE_WEB, 0), "Calibrator turned ON");
     } else if (action == "off") {
-      turnCalibratorOff();
-      webUiServer.send(200, "text/plain", "Calibrator turned OFF");
+      sendCalibratorCommandResult(commandCalibratorOff(COMMAND_SOURCE_WEB, 0), "Calibrator turned OFF");
     } else if (action == "brightness" && webUiServer.hasArg("brightness")) {
       int brightness = webUiServer.arg("brightness").toInt();
-      if (setCalibratorBrightness(brightness)) {
-        webUiServer.send(200, "text/plain", "Brightness set to " + String(brightness) + "%");
+      sendCalibratorCommandResult(commandBrightness(COMMAND_SOURCE_WEB, 0, brightness),
+                                  "Brightness set to " + String(brightness) + "%");
+    } else if (action == "preset") {
+      const CalibratorPreset* preset = findPreset(webUiServer.arg("name").c_str());
+      if (preset == nullptr) {
+        webUiServer.send(404, "text/plain", "Unknown preset");
       } else {
-        webUiServer.send(400, "text/plain", "Invalid brightness value");
+        sendCalibratorCommandResult(commandPreset(COMMAND_SOURCE_WEB, 0, *preset),
+                                    "Preset " + String(preset->name) + " applied");
       }
+    } else if (action == "release") {
+      // Operator override: take control back from an Alpaca client
+      bool released = breakCalibratorLease(COMMAND_SOURCE_WEB);
+      webUiServer.send(200, "text/plain", released ? "Lease released" : "No lease held");
     } else {
       webUiServer.send(400, "text/plain", "Invalid action");
     }
@@ -186,56 +377,300 @@ void handleCalibratorPost() {
   }
 }
 
-// Handle WiFi configuration page
+// Handle WiFi configuration page - renders the cached scan and starts a fresh one
 void handleWifiConfig() {
-  String html = getWifiConfigPage();
-  webUiServer.send(200, "text/html", html);
+  requestWifiScan();
+  sendTemplatePage(webUiServer, WIFI_CONFIG_PAGE_TEMPLATE, resolveWifiConfigPageField);
 }
 
-// Handle WiFi configuration form submission
-void handleWifiConfigPost() {
-  bool wifiChanged = false;
+// Handle WiFi scan API - never waits for the scan to finish
+void handleScanApi() {
+  bool scanning = requestWifiScan();
   
-  if (webUiServer.hasArg("ssid") && webUiServer.hasArg("password")) {
-    String newSSID = webUiServer.arg("ssid");
-    String newPassword = webUiServer.arg("password");
-    
-    if (newSSID.length() > 0 && newSSID != String(ssid)) {
-      newSSID.toCharArray(ssid, SSID_SIZE);
-      wifiChanged = true;
+  DynamicJsonDocument doc(2048);
+  doc["scanning"] = scanning;
+  doc["age"] = hasWifiScanResults() ? (long)getWifiScanAge() : -1;
+  JsonArray networks = doc.createNestedArray("networks");
+  for (int i = 0; i < getWifiScanCount(); i++) {
+    const WifiScanResult& result = getWifiScanResult(i);
+    JsonObject network = networks.createNestedObject();
+    network["ssid"] = result.ssid;
+    network["rssi"] = result.rssi;
+    network["channel"] = result.channel;
+    network["secured"] = result.secured;
+  }
+  
+  String response;
+  serializeJson(doc, response);
+  webUiServer.send(200, "application/json", response);
+}
+
+// Handle boot timing API
+void handleBootApi() {
+  DynamicJsonDocument doc(1536);
+  doc["firmware"] = DEVICE_VERSION;
+  doc["complete"] = isBootComplete();
+  doc["completeUs"] = getBootCompleteUs();
+  JsonArray phases = doc.createNestedArray("phases");
+  for (size_t i = 0; i < getBootPhaseCount(); i++) {
+    const BootPhaseTiming& timing = getBootPhaseTiming(i);
+    JsonObject phase = phases.createNestedObject();
+    phase["name"] = getBootPhase(i).name;
+    phase["state"] = getBootPhaseStateString(timing.state);
+    phase["startUs"] = timing.startUs;
+    phase["endUs"] = timing.endUs;
+  }
+  
+  String response;
+  serializeJson(doc, response);
+  webUiServer.send(200, "application/json", response);
+}
+
+// Handle heap API. Computed before the JSON document is allocated, so the
+// numbers do not include this request.
+void handleHeapApi() {
+  HeapStats stats = getHeapStats();
+  DynamicJsonDocument doc(1024);
+  doc["uptimeMs"] = millis();
+  doc["freeBytes"] = stats.freeBytes;
+  doc["largestFreeBlock"] = stats.largestFreeBlock;
+  doc["minFreeBytes"] = stats.minFreeBytes;
+  doc["minLargestFreeBlock"] = stats.minLargestFreeBlock;
+  doc["allocatedBlocks"] = stats.allocatedBlocks;
+  doc["freeBlocks"] = stats.freeBlocks;
+  doc["allocTagging"] = HEAP_ALLOC_TAGGING != 0;
+  JsonObject interfaces = doc.createNestedObject("interfaces");
+  for (int i = 0; i < HEAP_IF_COUNT; i++) {
+    const HeapInterfaceStats& interfaceStats = getHeapInterfaceStats((HeapInterface)i);
+    JsonObject entry = interfaces.createNestedObject(getHeapInterfaceName((HeapInterface)i));
+    entry["retainedBytes"] = interfaceStats.retainedBytes;
+    entry["allocations"] = interfaceStats.allocations;
+    entry["frees"] = interfaceStats.frees;
+    entry["lowWaterMarks"] = interfaceStats.lowWaterMarks;
+  }
+  
+  String response;
+  serializeJson(doc, response);
+  webUiServer.sendHeader("Cache-Control", "no-store");
+  webUiServer.send(200, "application/json", response);
+}
+
+// Handle filter preset API
+void handlePresetsApi() {
+  DynamicJsonDocument doc(96 + PRESET_MAX_COUNT * 96);
+  JsonArray list = doc.to<JsonArray>();
+  for (size_t i = 0; i < getPresetCount(); i++) {
+    const CalibratorPreset& preset = getPreset(i);
+    JsonObject entry = list.createNestedObject();
+    entry["name"] = (const char*)preset.name;
+    entry["brightness"] = preset.brightness;
+    entry["rampMs"] = preset.rampMs;
+    entry["exposureMs"] = preset.exposureMs;
+  }
+  
+  String response;
+  serializeJson(doc, response);
+  webUiServer.send(200, "application/json", response);
+}
+
+void handlePresetsApiPost() {
+  String name = webUiServer.arg("name");
+  if (webUiServer.hasArg("delete")) {
+    if (deletePreset(name.c_str())) {
+      webUiServer.send(200, "text/plain", "Preset deleted");
+    } else {
+      webUiServer.send(404, "text/plain", "Unknown preset");
     }
-    
-    if (newPassword != String(password)) {
-      newPassword.toCharArray(password, PASSWORD_SIZE);
-      wifiChanged = true;
+    return;
+  }
+  
+  if (!webUiServer.hasArg("brightness") || webUiServer.arg("brightness").length() == 0) {
+    webUiServer.send(400, "text/plain", "Brightness is required");
+    return;
+  }
+  PresetSaveResult result = savePreset(name.c_str(), webUiServer.arg("brightness").toInt(),
+                                       webUiServer.arg("rampMs").toInt(), webUiServer.arg("exposureMs").toInt());
+  if (result == PRESET_SAVED) {
+    webUiServer.send(200, "text/plain", "Preset saved");
+  } else {
+    webUiServer.send(400, "text/plain", getPresetSaveResultString(result));
+  }
+}
+
+// Handle loop timing API. About 5 KB of JSON, so it is streamed in chunks
+// rather than built in a JsonDocument.
+void handleLoopApi() {
+  webUiServer.sendHeader("Cache-Control", "no-store");
+  TemplateRenderer out(webUiServer, nullptr);
+  out.begin(200, "application/json");
+  
+  out.printf("{\"cpuMHz\":%lu,\"bucketsUs\":[", (unsigned long)ESP.getCpuFreqMHz());
+  for (int bucket = 0; bucket < LOOP_HISTOGRAM_BUCKETS; bucket++) {
+    out.printf("%s%lu", bucket > 0 ? "," : "", (unsigned long)getLoopHistogramBucketUs(bucket));
+  }
+  out.print("],\"stages\":[");
+  for (int i = 0; i < LOOP_STAGE_COUNT; i++) {
+    const LoopStageStats& stats = getLoopStageStats((LoopStage)i);
+    out.printf("%s{\"name\":\"%s\",\"count\":%lu,\"avgUs\":%lu,\"maxUs\":%lu,\"maxAtMs\":%lu,",
+               i > 0 ? "," : "", getLoopStageName((LoopStage)i), (unsigned long)stats.count,
+               (unsigned long)(stats.count > 0 ? stats.totalUs / stats.count : 0),
+               (unsigned long)stats.maxUs, (unsigned long)stats.maxAtMs);
+    if (stats.maxRoute != nullptr) {
+      out.printf("\"maxRoute\":\"%s\",", stats.maxRoute);
+    } else {
+      out.print("\"maxRoute\":null,");
     }
-    
-    if (wifiChanged) {
-      saveConfiguration();
-      
-      String html = "<!DOCTYPE html><html><head><title>WiFi Updated</title>";
-      html += "<meta http-equiv='refresh' content='5;url=/'></head><body>";
-      html += "<h1>WiFi Settings Updated</h1>";
-      html += "<p>The device will restart to apply new WiFi settings...</p>";
-      html += "<p>You will be redirected to the main page in 5 seconds.</p>";
-      html += "</body></html>";
-      
-      webUiServer.send(200, "text/html", html);
-      
-      delay(2000);
-      ESP.restart();
+    out.printf("\"budgetUs\":%lu,\"overruns\":%lu,\"histogram\":[",
+               (unsigned long)stats.budgetUs, (unsigned long)stats.overruns);
+    for (int bucket = 0; bucket < LOOP_HISTOGRAM_BUCKETS; bucket++) {
+      out.printf("%s%lu", bucket > 0 ? "," : "", (unsigned long)stats.histogram[bucket]);
+    }
+    out.print("]}");
+  }
+  out.print("],\"overruns\":[");
+  for (size_t i = 0; i < getLoopOverrunCount(); i++) {
+    const LoopOverrun& overrun = getLoopOverrun(i);
+    out.printf("%s{\"stage\":\"%s\",\"us\":%lu,\"atMs\":%lu,\"route\":", i > 0 ? "," : "",
+               getLoopStageName(overrun.stage), (unsigned long)overrun.durationUs, (unsigned long)overrun.atMs);
+    if (overrun.route != nullptr) {
+      out.printf("\"%s\"}", overrun.route);
     } else {
-      String html = "<!DOCTYPE html><html><head><title>No Changes</title>";
-      html += "<meta http-equiv='refresh' content='3;url=/wificonfig'></head><body>";
-      html += "<h1>No Changes Detected</h1>";
-      html += "<p>Redirecting back to WiFi configuration...</p>";
-      html += "</body></html>";
-      
-      webUiServer.send(200, "text/html", html);
+      out.print("null}");
     }
-  } else {
+  }
+  out.print("]}");
+  out.end();
+}
+
+// Set a stage budget (stage=web&budgetUs=5000, 0 = none) or clear the statistics (reset=1)
+void handleLoopApiPost() {
+  if (webUiServer.hasArg("reset")) {
+    resetLoopStats();
+    webUiServer.send(200, "application/json", "{\"reset\":true}");
+    return;
+  }
+  
+  LoopStage stage = findLoopStage(webUiServer.arg("stage").c_str());
+  if (stage == LOOP_STAGE_COUNT || !webUiServer.hasArg("budgetUs")) {
+    webUiServer.send(400, "text/plain", "Expected stage and budgetUs, or reset");
+    return;
+  }
+  uint32_t budgetUs = strtoul(webUiServer.arg("budgetUs").c_str(), nullptr, 10);
+  setLoopStageBudget(stage, budgetUs);
+  LOG_INFO(LOG_CAT_WEB, "Loop budget for %s set to %lu us\n", getLoopStageName(stage), (unsigned long)budgetUs);
+  
+  char response[64];
+  snprintf(response, sizeof(response), "{\"stage\":\"%s\",\"budgetUs\":%lu}",
+           getLoopStageName(stage), (unsigned long)budgetUs);
+  webUiServer.send(200, "application/json", response);
+}
+
+void handleRateLimitApi() {
+  const RateLimitStats& stats = getRateLimitStats();
+  webUiServer.sendHeader("Cache-Control", "no-store");
+  TemplateRenderer out(webUiServer, nullptr);
+  out.begin(200, "application/json");
+  
+  out.printf("{\"perSecond\":%lu,\"burst\":%lu,\"limited\":%lu,\"evicted\":%lu,\"clients\":[",
+             (unsigned long)getRateLimitPerSecond(), (unsigned long)getRateLimitBurst(),
+             (unsigned long)stats.limited, (unsigned long)stats.evicted);
+  uint32_t now = millis();
+  for (size_t i = 0; i < getRateLimitClientCount(); i++) {
+    const RateLimitClient& client = getRateLimitClient(i);
+    out.printf("%s{\"ip\":\"%s\",\"tokens\":%lu,\"allowed\":%lu,\"limited\":%lu,"
+               "\"idleMs\":%lu,\"lastLimitedAtMs\":",
+               i > 0 ? "," : "", IPAddress(client.ip).toString().c_str(), (unsigned long)(client.tokensMilli / 1000),
+               (unsigned long)client.allowed, (unsigned long)client.limited, (unsigned long)(now - client.lastSeenMs));
+    if (client.limited > 0) {
+      out.printf("%lu}", (unsigned long)client.lastLimitedAtMs);
+    } else {
+      out.print("null}");
+    }
+  }
+  out.print("]}");
+  out.end();
+}
+
+// Set the limits (perSecond=30&burst=60, perSecond=0 = off) or forget the clients (reset=1)
+void handleRateLimitApiPost() {
+  if (webUiServer.hasArg("reset")) {
+    resetRateLimitStats();
+    webUiServer.send(200, "application/json", "{\"reset\":true}");
+    return;
+  }
+  
+  if (!webUiServer.hasArg("perSecond")) {
+    webUiServer.send(400, "text/plain", "Expected perSecond and burst, or reset");
+    return;
+  }
+  uint32_t perSecond = strtoul(webUiServer.arg("perSecond").c_str(), nullptr, 10);
+  uint32_t burst = webUiServer.hasArg("burst") ? strtoul(webUiServer.arg("burst").c_str(), nullptr, 10)
+                                               : getRateLimitBurst();
+  if (!setRateLimit(perSecond, burst)) {
+    webUiServer.send(400, "text/plain", "perSecond and burst must be 0-1000, burst at least 1");
+    return;
+  }
+  LOG_INFO(LOG_CAT_WEB, "Rate limit set to %lu/s, burst %lu\n", (unsigned long)perSecond, (unsigned long)burst);
+  
+  char response[64];
+  snprintf(response, sizeof(response), "{\"perSecond\":%lu,\"burst\":%lu}",
+           (unsigned long)perSecond, (unsigned long)burst);
+  webUiServer.send(200, "application/json", response);
+}
+
+// Serve the debug records still held in the log buffer as text. Pass the
+// X-Log-Next header of the previous response as ?since= to fetch only new ones.
+void handleLogApi() {
+  uint32_t until = getLogWriteIndex();
+  uint32_t since = webUiServer.hasArg("since") ? strtoul(webUiServer.arg("since").c_str(), nullptr, 10)
+                                                : until - LOG_BUFFER_RECORDS;
+  LogBufferStats stats = getLogBufferStats();
+  
+  webUiServer.sendHeader("Cache-Control", "no-store");
+  webUiServer.sendHeader("X-Log-Next", String(until));
+  webUiServer.sendHeader("X-Log-Dropped", String(stats.dropped));
+  TemplateRenderer out(webUiServer, nullptr);
+  out.begin(200, "text/plain");
+  printLogHistory(out, since, until);
+  out.end();
+}
+
+// Handle WiFi configuration form submission
+void handleWifiConfigPost() {
+  if (!webUiServer.hasArg("ssid") || !webUiServer.hasArg("password")) {
     webUiServer.send(400, "text/plain", "Missing SSID or password");
+    return;
+  }
+  
+  String newSSID = webUiServer.arg("ssid");
+  String newPassword = webUiServer.arg("password");
+  if (newSSID.length() == 0) {
+    newSSID = ssid;
   }
+  
+  if (newSSID == String(ssid) && newPassword == String(password)) {
+    String html = "<!DOCTYPE html><html><head><title>No Changes</title>";
+    html += "<meta http-equiv='refresh' content='3;url=/wificonfig'></head><body>";
+    html += "<h1>No Changes Detected</h1>";
+    html += "<p>Redirecting back to WiFi configuration...</p>";
+    html += "</body></html>";
+    
+    webUiServer.send(200, "text/html", html);
+    return;
+  }
+  
+  // Applied from loop() after this response is sent, and saved only if the
+  // new network works - the calibrator keeps running throughout
+  requestWiFiReconfigure(newSSID.c_str(), newPassword.c_str());
+  
+  String html = "<!DOCTYPE html><html><head><title>WiFi Updated</title></head><body>";
+  html += "<h1>Switching WiFi Network</h1>";
+  html += "<p>The device is joining the new network without restarting. While it connects it can ";
+  html += "also be reached through its access point <strong>" AP_SSID "</strong> at 192.168.4.1.</p>";
+  html += "<p>If the new network cannot be joined within 30 seconds the previous settings are restored.</p>";
+  html += "</body></html>";
+  
+  webUiServer.send(200, "text/html", html);
 }
 
 // Handle restart request
@@ -249,6 +684,7 @@ void handleRestart() {
   
   webUiServer.send(200, "text/html", html);
   
-  delay(1000);
-  ESP.restart();
+  // Restart from handleWebUI() once the response has gone out
+  restartPending = true;
+  restartRequestTime = millis();
 }
\ No newline at end of file
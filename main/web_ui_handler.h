@@ -28,8 +28,21 @@ void handleSetup();
 void handleSetupPost();
 void handleWifiConfig();
 void handleWifiConfigPost();
+void handleScanApi();
+void handleBootApi();
+void handleHeapApi();
+void handlePresetsApi();
+void handlePresetsApiPost();
+void handleLoopApi();
+void handleLoopApiPost();
+void handleRateLimitApi();
+void handleRateLimitApiPost();
+void handleLogApi();
 void handleCalibrator();
 void handleCalibratorPost();
 void handleRestart();
+void onRoute(WebServer& server, const char* path, HTTPMethod method, WebServer::THandlerFunction handler);
+void registerWebAssets(WebServer& server);
+void handleEchoRequest(WebServer& server);
 
 #endif // WEB_UI_HANDLER_H
\ No newline at end of file
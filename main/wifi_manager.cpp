@@ -0,0 +1,565 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * WiFi Connection Manager Implementation
+ */
+
+#include "wifi_manager.h"
+#include "web_ui_handler.h"
+#include "dhcp_lease.h"
+#include "Debug.h"
+#include <WiFi.h>
+#include <Preferences.h>
+#include <esp_wifi.h>
+
+// Last successful connection, stored as one NVS blob
+struct WiFiFastConnectCache {
+  char ssid[SSID_SIZE];                 // Network the entry belongs to
+  uint8_t bssid[6];
+  uint8_t channel;
+  uint32_t localIP;
+  uint32_t gateway;
+  uint32_t subnet;
+  uint32_t dns;
+};
+
+// Radio settings for each WiFiProfile
+struct WiFiProfileSettings {
+  const char* name;
+  wifi_ps_type_t powerSave;
+  wifi_power_t txPower;
+  uint16_t listenInterval;              // Beacon intervals between wake-ups in modem sleep
+};
+
+static const WiFiProfileSettings wifiProfiles[WIFI_PROFILE_COUNT] = {
+  { "LATENCY",  WIFI_PS_NONE,      WIFI_POWER_19_5dBm, 3 },
+  { "BALANCED", WIFI_PS_MIN_MODEM, WIFI_POWER_19_5dBm, 3 },
+  { "LOWPOWER", WIFI_PS_MAX_MODEM, WIFI_POWER_11dBm,   10 },
+};
+
+static WiFiConnectionState wifiState = WIFI_STATE_IDLE;
+static unsigned long stateStartTime = 0;
+static unsigned long connectStartTime = 0;   // First attempt of the current connect
+static unsigned long lastReconnectAttempt = 0;
+static bool eventHandlerRegistered = false;
+static bool connectFast = false;             // Current attempt is the directed one
+static bool cachedAddressActive = false;     // Station runs on the cached address, leased by dhcp_lease.cpp
+static bool dhcpLeasePending = false;        // Cached address given up, waiting for the DHCP client's lease
+static bool readyPending = false;            // Connect timing waits for the lease to be confirmed
+static bool readyAfterReconnect = false;     // ... and counts as a reconnect
+
+static WiFiFastConnectCache fastConnectCache;
+static bool fastConnectCacheValid = false;
+static bool preferencesLoaded = false;
+static WiFiProfile wifiProfile = WIFI_PROFILE_BALANCED;
+static WiFiConnectStats connectStats = {};
+
+// Live credential change - applied from loop() once the HTTP response is out
+static char pendingSsid[SSID_SIZE];
+static char pendingPassword[PASSWORD_SIZE];
+static bool reconfigurePending = false;
+static unsigned long reconfigureRequestTime = 0;
+static char rollbackSsid[SSID_SIZE];
+static char rollbackPassword[PASSWORD_SIZE];
+static WiFiReconfigureResult reconfigureResult = WIFI_RECONFIGURE_NONE;
+
+// Access point kept up next to the station during and after a switch
+static bool apOverlapActive = false;
+static unsigned long apOverlapStart = 0;
+
+// Set from the WiFi event task, consumed by handleWiFiConnection()
+static volatile bool staGotIp = false;
+static volatile bool staDisconnected = false;
+
+static void onWiFiEvent(arduino_event_id_t event, arduino_event_info_t info) {
+  switch (event) {
+    case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+      staGotIp = true;
+      break;
+    case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+      // Our own WiFi.disconnect() before a new attempt is reported after the
+      // attempt has started; it must not count against it
+      if (info.wifi_sta_disconnected.reason != WIFI_REASON_ASSOC_LEAVE) {
+        staDisconnected = true;
+      }
+      break;
+    case ARDUINO_EVENT_WIFI_STA_LOST_IP:
+      staDisconnected = true;
+      break;
+    default:
+      break;
+  }
+}
+
+static void setWiFiState(WiFiConnectionState newState) {
+  wifiState = newState;
+  stateStartTime = millis();
+}
+
+static void loadWiFiPreferences() {
+  Preferences prefs;
+  prefs.begin(PREFERENCES_NAMESPACE, true);
+  wifiProfile = (WiFiProfile)prefs.getUChar(PREF_WIFI_PROFILE, WIFI_PROFILE_BALANCED);
+  if (wifiProfile >= WIFI_PROFILE_COUNT) {
+    wifiProfile = WIFI_PROFILE_BALANCED;
+  }
+  fastConnectCacheValid = prefs.getBytesLength(PREF_WIFI_FAST_CONNECT) == sizeof(fastConnectCache) &&
+                          prefs.getBytes(PREF_WIFI_FAST_CONNECT, &fastConnectCache, sizeof(fastConnectCache)) ==
+                            sizeof(fastConnectCache);
+  prefs.end();
+  preferencesLoaded = true;
+}
+
+// Power save and TX power take effect immediately. Modem sleep is
+// station-only, so this runs again whenever the mode drops back to WIFI_STA.
+static void applyWiFiRadioSettings() {
+  const WiFiProfileSettings& settings = wifiProfiles[wifiProfile];
+  if (WiFi.getMode() == WIFI_STA) {
+    WiFi.setSleep(settings.powerSave);
+  }
+  WiFi.setTxPower(settings.txPower);
+}
+
+// Issue the connect with the profile's listen interval, which is part of the
+// station config and only takes effect at association
+static void connectStation(int32_t channel, const uint8_t* bssid) {
+  WiFi.begin(ssid, password, channel, bssid, false);
+
+  wifi_config_t config;
+  if (esp_wifi_get_config(WIFI_IF_STA, &config) == ESP_OK) {
+    config.sta.listen_interval = wifiProfiles[wifiProfile].listenInterval;
+    esp_wifi_set_config(WIFI_IF_STA, &config);
+  }
+  esp_wifi_connect();
+}
+
+// Remember the current connection; NVS is only written when something changed
+static void saveFastConnectCache() {
+  WiFiFastConnectCache current = {};
+  strncpy(current.ssid, ssid, sizeof(current.ssid) - 1);
+  memcpy(current.bssid, WiFi.BSSID(), sizeof(current.bssid));
+  current.channel = WiFi.channel();
+  current.localIP = WiFi.localIP();
+  current.gateway = WiFi.gatewayIP();
+  current.subnet = WiFi.subnetMask();
+  current.dns = WiFi.dnsIP();
+
+  if (fastConnectCacheValid && memcmp(&current, &fastConnectCache, sizeof(current)) == 0) {
+    return;
+  }
+
+  fastConnectCache = current;
+  fastConnectCacheValid = true;
+
+  Preferences prefs;
+  prefs.begin(PREFERENCES_NAMESPACE, false);
+  prefs.putBytes(PREF_WIFI_FAST_CONNECT, &fastConnectCache, sizeof(fastConnectCache));
+  prefs.end();
+  LOG_VERBOSE(LOG_CAT_WIFI, "Cached WiFi BSSID, channel %d and IP for fast connect\n", current.channel);
+}
+
+static bool hasWiFiCredentials() {
+  return strlen(ssid) > 0 && strcmp(ssid, DEFAULT_WIFI_SSID) != 0;
+}
+
+// Normal connect: scan for the SSID and use DHCP
+static void beginFullConnect() {
+  LOG_INFO(LOG_CAT_WIFI, "Connecting to WiFi network: %s\n", ssid);
+  connectFast = false;
+  staGotIp = false;
+  staDisconnected = false;
+  dhcpLeasePending = false;
+  cachedAddressActive = false;
+  stopDhcpLease();
+  WiFi.config(IPAddress(), IPAddress(), IPAddress());
+  connectStation(0, nullptr);
+}
+
+// Directed connect to the cached AP with the cached address; false if no usable entry.
+// The address stays once associated, with a lease requested for it.
+static bool beginFastConnect() {
+  if (!fastConnectCacheValid || strncmp(fastConnectCache.ssid, ssid, sizeof(fastConnectCache.ssid)) != 0) {
+    return false;
+  }
+
+  LOG_INFO(LOG_CAT_WIFI, "Fast connecting to WiFi network: %s (channel %d)\n", ssid, fastConnectCache.channel);
+  connectFast = true;
+  staGotIp = false;
+  staDisconnected = false;
+  dhcpLeasePending = false;
+  cachedAddressActive = true;
+  stopDhcpLease();
+  WiFi.config(IPAddress(fastConnectCache.localIP), IPAddress(fastConnectCache.gateway),
+              IPAddress(fastConnectCache.subnet), IPAddress(fastConnectCache.dns));
+  connectStation(fastConnectCache.channel, fastConnectCache.bssid);
+  return true;
+}
+
+static void fallBackToFullConnect() {
+  LOG_INFO(LOG_CAT_WIFI, "Fast connect failed, falling back to a full scan\n");
+  connectStats.fastConnectFailures++;
+  WiFi.disconnect();
+  beginFullConnect();
+}
+
+// Start connecting in station mode; completion is picked up by handleWiFiConnection()
+void initWiFi() {
+  LOG_INFO(LOG_CAT_WIFI, "Initializing WiFi...\n");
+
+  if (!eventHandlerRegistered) {
+    WiFi.onEvent(onWiFiEvent);
+    eventHandlerRegistered = true;
+  }
+  if (!preferencesLoaded) {
+    loadWiFiPreferences();
+  }
+
+  // Set WiFi mode
+  WiFi.mode(WIFI_STA);
+  apOverlapActive = false;
+  applyWiFiRadioSettings();
+
+  // Check if we have valid credentials
+  if (!hasWiFiCredentials()) {
+    LOG_INFO(LOG_CAT_WIFI, "No WiFi credentials configured, starting AP mode\n");
+    startAPMode();
+    return;
+  }
+
+  connectStartTime = millis();
+  if (!beginFastConnect()) {
+    beginFullConnect();
+  }
+  setWiFiState(WIFI_STATE_CONNECTING);
+}
+
+void startAPMode() {
+  LOG_INFO(LOG_CAT_WIFI, "Starting Access Point mode...\n");
+
+  stopDhcpLease();
+  WiFi.mode(WIFI_AP);
+  WiFi.softAP(AP_SSID, AP_PASSWORD);
+  apOverlapActive = false;
+  applyWiFiRadioSettings();
+
+  IPAddress IP = WiFi.softAPIP();
+  LOG_INFO(LOG_CAT_WIFI, "AP started successfully!\n");
+  LOG_INFO(LOG_CAT_WIFI, "SSID: %s\n", AP_SSID);
+  LOG_INFO(LOG_CAT_WIFI, "Password: %s\n", AP_PASSWORD);
+  LOG_INFO(LOG_CAT_WIFI, "IP address: %s\n", IP.toString().c_str());
+
+  apMode = true;
+  setWiFiState(WIFI_STATE_AP_MODE);
+}
+
+// Record the connect timing once the address has a lease behind it
+static void onLeaseInPlace() {
+  if (readyPending) {
+    readyPending = false;
+    unsigned long now = millis();
+    if (readyAfterReconnect) {
+      connectStats.lastReconnectMs = now - connectStartTime;
+      connectStats.reconnectCount++;
+      LOG_INFO(LOG_CAT_WIFI, "WiFi reconnected in %lu ms\n", connectStats.lastReconnectMs);
+    } else {
+      connectStats.lastConnectMs = now - connectStartTime;
+      LOG_INFO(LOG_CAT_WIFI, "WiFi connected in %lu ms%s\n", connectStats.lastConnectMs, connectFast ? " (fast)" : "");
+    }
+    if (connectStats.bootToReadyMs == 0) {
+      connectStats.bootToReadyMs = now;
+    }
+  }
+  saveFastConnectCache();
+}
+
+static void onStationConnected() {
+  connectStats.lastAddressMs = millis() - connectStartTime;
+  connectStats.lastConnectFast = connectFast;
+  readyPending = true;
+  readyAfterReconnect = wifiState == WIFI_STATE_RECONNECTING;
+
+  LOG_INFO(LOG_CAT_WIFI, "IP address: %s\n", WiFi.localIP().toString().c_str());
+  LOG_INFO(LOG_CAT_WIFI, "Signal strength: %d dBm\n", WiFi.RSSI());
+  LOG_INFO(LOG_CAT_WIFI, "  Web UI: http://%s/\n", WiFi.localIP().toString().c_str());
+  LOG_INFO(LOG_CAT_WIFI, "  ASCOM Alpaca API: http://%s:%d/\n", WiFi.localIP().toString().c_str(), ALPACA_PORT);
+
+  // Keep serving on the cached address while the DHCP server confirms it;
+  // the cache is refreshed from a lease, never from the cached address alone
+  dhcpLeasePending = false;
+  if (cachedAddressActive) {
+    startDhcpLease(WiFi.localIP());
+  } else {
+    onLeaseInPlace();
+  }
+  applyWiFiRadioSettings();
+  apMode = false;
+  setWiFiState(WIFI_STATE_CONNECTED);
+}
+
+// The cached address was refused, went unanswered or expired: hand the
+// interface to the DHCP client, which may well assign another address
+static void dropCachedAddress() {
+  LOG_INFO(LOG_CAT_WIFI, "Cached IP address not leased, switching to DHCP\n");
+  stopDhcpLease();
+  cachedAddressActive = false;
+  dhcpLeasePending = true;
+  WiFi.config(IPAddress(), IPAddress(), IPAddress());
+  setWiFiState(WIFI_STATE_CONNECTED);
+}
+
+// The DHCP client answered after the cached address was given up
+static void onDhcpLease() {
+  dhcpLeasePending = false;
+  if ((uint32_t)WiFi.localIP() != fastConnectCache.localIP) {
+    LOG_INFO(LOG_CAT_WIFI, "DHCP assigned a new IP address: %s\n", WiFi.localIP().toString().c_str());
+  }
+  onLeaseInPlace();
+}
+
+// Bring the AP up next to the station (a no-op if it is already running)
+static void startAPOverlap() {
+  bool apRunning = apOverlapActive || wifiState == WIFI_STATE_AP_MODE;
+  WiFi.mode(WIFI_AP_STA);
+  if (!apRunning) {
+    WiFi.softAP(AP_SSID, AP_PASSWORD);
+    LOG_INFO(LOG_CAT_WIFI, "AP %s kept up during the WiFi switch\n", AP_SSID);
+  }
+  apOverlapActive = true;
+  apOverlapStart = millis();
+}
+
+// Switch profile and persist it; the listen interval applies from the next association
+void setWiFiProfile(WiFiProfile profile) {
+  if (profile >= WIFI_PROFILE_COUNT) {
+    return;
+  }
+  wifiProfile = profile;
+  applyWiFiRadioSettings();
+
+  Preferences prefs;
+  prefs.begin(PREFERENCES_NAMESPACE, false);
+  prefs.putUChar(PREF_WIFI_PROFILE, profile);
+  prefs.end();
+  LOG_INFO(LOG_CAT_WIFI, "WiFi profile set to %s\n", wifiProfiles[profile].name);
+}
+
+WiFiProfile getWiFiProfile() {
+  return wifiProfile;
+}
+
+const char* getWiFiProfileName(WiFiProfile profile) {
+  return profile < WIFI_PROFILE_COUNT ? wifiProfiles[profile].name : "UNKNOWN";
+}
+
+// Case-sensitive match against the upper-case profile names
+bool parseWiFiProfile(const char* name, WiFiProfile& profile) {
+  for (int i = 0; i < WIFI_PROFILE_COUNT; i++) {
+    if (strcmp(name, wifiProfiles[i].name) == 0) {
+      profile = (WiFiProfile)i;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Queue new credentials; the switch starts after WIFI_RECONFIGURE_DELAY_MS
+void requestWiFiReconfigure(const char* newSsid, const char* newPassword) {
+  strncpy(pendingSsid, newSsid, sizeof(pendingSsid) - 1);
+  pendingSsid[sizeof(pendingSsid) - 1] = '\0';
+  strncpy(pendingPassword, newPassword, sizeof(pendingPassword) - 1);
+  pendingPassword[sizeof(pendingPassword) - 1] = '\0';
+  reconfigurePending = true;
+  reconfigureRequestTime = millis();
+  reconfigureResult = WIFI_RECONFIGURE_PENDING;
+}
+
+static void beginReconfigure() {
+  reconfigurePending = false;
+  memcpy(rollbackSsid, ssid, sizeof(rollbackSsid));
+  memcpy(rollbackPassword, password, sizeof(rollbackPassword));
+  memcpy(ssid, pendingSsid, sizeof(pendingSsid));
+  memcpy(password, pendingPassword, sizeof(pendingPassword));
+
+  LOG_INFO(LOG_CAT_WIFI, "Switching to WiFi network: %s\n", ssid);
+  startAPOverlap();
+  apMode = false;
+  WiFi.disconnect();
+  connectStartTime = millis();
+  if (!beginFastConnect()) {
+    beginFullConnect();
+  }
+  setWiFiState(WIFI_STATE_SWITCHING);
+}
+
+// The new network did not work - go back to the previous one, still unsaved
+static void rollBackReconfigure() {
+  LOG_INFO(LOG_CAT_WIFI, "Could not join %s, restoring previous WiFi settings\n", ssid);
+  memcpy(ssid, rollbackSsid, sizeof(rollbackSsid));
+  memcpy(password, rollbackPassword, sizeof(rollbackPassword));
+  reconfigureResult = WIFI_RECONFIGURE_ROLLED_BACK;
+  WiFi.disconnect();
+
+  if (!hasWiFiCredentials()) {
+    startAPMode();
+    return;
+  }
+  apOverlapStart = millis();
+  connectStartTime = millis();
+  if (!beginFastConnect()) {
+    beginFullConnect();
+  }
+  setWiFiState(WIFI_STATE_CONNECTING);
+}
+
+// Advance the connection state machine; call from loop()
+void handleWiFiConnection() {
+  unsigned long now = millis();
+
+  if (reconfigurePending && now - reconfigureRequestTime >= WIFI_RECONFIGURE_DELAY_MS) {
+    beginReconfigure();
+  }
+
+  // Drop the overlap AP once clients had time to move to the new address
+  if (apOverlapActive && wifiState == WIFI_STATE_CONNECTED &&
+      now - apOverlapStart > WIFI_RECONFIGURE_OVERLAP_MS) {
+    WiFi.softAPdisconnect(true);
+    apOverlapActive = false;
+    applyWiFiRadioSettings();
+    LOG_INFO(LOG_CAT_WIFI, "Overlap AP stopped\n");
+  }
+
+  switch (wifiState) {
+    case WIFI_STATE_IDLE:
+      break;
+
+    case WIFI_STATE_CONNECTING:
+      if (staGotIp) {
+        staGotIp = false;
+        onStationConnected();
+      } else if (connectFast && (staDisconnected || now - stateStartTime > WIFI_FAST_CONNECT_TIMEOUT_MS)) {
+        fallBackToFullConnect();
+        setWiFiState(WIFI_STATE_CONNECTING);
+      } else if (now - stateStartTime > WIFI_CONNECT_TIMEOUT_MS) {
+        LOG_INFO(LOG_CAT_WIFI, "Failed to connect to WiFi, starting AP mode\n");
+        startAPMode();
+      }
+      break;
+
+    case WIFI_STATE_CONNECTED:
+      if (cachedAddressActive) {
+        DhcpLeaseState lease = handleDhcpLease();
+        if (lease == DHCP_LEASE_BOUND && readyPending) {
+          onLeaseInPlace();
+        } else if (lease == DHCP_LEASE_FAILED) {
+          dropCachedAddress();
+        }
+      }
+      if (staGotIp) {
+        staGotIp = false;
+        if (dhcpLeasePending) {
+          onDhcpLease();
+        }
+      } else if (dhcpLeasePending && now - stateStartTime > WIFI_CONNECT_TIMEOUT_MS) {
+        // The cached network is no good without a DHCP server behind it
+        LOG_INFO(LOG_CAT_WIFI, "No DHCP lease after fast connect, reconnecting with a full scan\n");
+        fastConnectCacheValid = false;
+        WiFi.disconnect();
+        connectStartTime = now;
+        beginFullConnect();
+        setWiFiState(WIFI_STATE_CONNECTING);
+        break;
+      }
+      if (staDisconnected) {
+        staDisconnected = false;
+        if (!WiFi.isConnected()) {
+          // After a fast connect the station config still pins the BSSID and channel
+          LOG_INFO(LOG_CAT_WIFI, "WiFi connection lost, attempting reconnection...\n");
+          stopDhcpLease();
+          connectStartTime = now;
+          connectFast = connectStats.lastConnectFast;
+          setWiFiState(WIFI_STATE_RECONNECTING);
+          WiFi.reconnect();
+          lastReconnectAttempt = now;
+        }
+      }
+      break;
+
+    case WIFI_STATE_RECONNECTING:
+      if (staGotIp) {
+        staGotIp = false;
+        onStationConnected();
+      } else if (connectFast && now - stateStartTime > WIFI_FAST_CONNECT_TIMEOUT_MS) {
+        // Stay in this state so the outage is measured from the link loss
+        fallBackToFullConnect();
+        lastReconnectAttempt = now;
+      } else if (now - lastReconnectAttempt > WIFI_RECONNECT_INTERVAL_MS) {
+        LOG_INFO(LOG_CAT_WIFI, "Still disconnected, retrying WiFi connection...\n");
+        WiFi.reconnect();
+        lastReconnectAttempt = now;
+      }
+      break;
+
+    case WIFI_STATE_AP_MODE:
+      // Periodically leave AP mode to see if the configured network is back
+      if (now - stateStartTime > AP_TIMEOUT) {
+        LOG_INFO(LOG_CAT_WIFI, "AP mode timeout, attempting WiFi connection...\n");
+        apMode = false;
+        initWiFi();
+      }
+      break;
+
+    case WIFI_STATE_SWITCHING:
+      if (staGotIp) {
+        staGotIp = false;
+        onStationConnected();
+        saveConfiguration();
+        reconfigureResult = WIFI_RECONFIGURE_APPLIED;
+        apOverlapStart = now;
+        LOG_INFO(LOG_CAT_WIFI, "New WiFi settings applied and saved\n");
+      } else if (connectFast && (staDisconnected || now - stateStartTime > WIFI_FAST_CONNECT_TIMEOUT_MS)) {
+        fallBackToFullConnect();
+        setWiFiState(WIFI_STATE_SWITCHING);
+      } else if (now - stateStartTime > WIFI_CONNECT_TIMEOUT_MS) {
+        rollBackReconfigure();
+      }
+      break;
+  }
+}
+
+WiFiConnectionState getWiFiState() {
+  return wifiState;
+}
+
+// True once the device is reachable, either as a station or through its own AP
+bool isWiFiNetworkUp() {
+  return wifiState == WIFI_STATE_CONNECTED || wifiState == WIFI_STATE_AP_MODE;
+}
+
+const char* getWiFiStateString() {
+  switch (wifiState) {
+    case WIFI_STATE_IDLE:         return "Idle";
+    case WIFI_STATE_CONNECTING:   return "Connecting";
+    case WIFI_STATE_CONNECTED:    return "Connected";
+    case WIFI_STATE_RECONNECTING: return "Reconnecting";
+    case WIFI_STATE_AP_MODE:      return "AP Mode";
+    case WIFI_STATE_SWITCHING:    return "Switching";
+  }
+  return "Unknown";
+}
+
+const WiFiConnectStats& getWiFiConnectStats() {
+  return connectStats;
+}
+
+WiFiReconfigureResult getWiFiReconfigureResult() {
+  return reconfigureResult;
+}
+
+const char* getWiFiReconfigureResultString() {
+  switch (reconfigureResult) {
+    case WIFI_RECONFIGURE_NONE:        return "None";
+    case WIFI_RECONFIGURE_PENDING:     return "Pending";
+    case WIFI_RECONFIGURE_APPLIED:     return "Applied";
+    case WIFI_RECONFIGURE_ROLLED_BACK: return "Rolled back";
+  }
+  return "Unknown";
+}
@@ -0,0 +1,79 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * WiFi Connection Manager Header
+ *
+ * Station connect, AP fallback and reconnection run as a state machine that is
+ * advanced from loop() and fed by WiFi events, so setup() returns immediately
+ * and serial control and the panel work while the network comes up.
+ *
+ * The BSSID, channel and IP configuration of the last successful connection
+ * are kept in NVS. The next connect goes straight to that AP with the old
+ * address and skips the scan and the wait for DHCP; if it fails, a normal
+ * connect follows. Once associated the address stays while dhcp_lease.h gets
+ * the DHCP server to confirm it. Only if the server refuses it does the
+ * interface go back to DHCP. The cache is refreshed from a confirmed lease.
+ *
+ * New credentials are applied live: the AP comes up next to the station while
+ * the new network is tried, and the old settings are restored if it fails.
+ * They are only saved once the new connection works.
+ */
+
+#ifndef WIFI_MANAGER_H
+#define WIFI_MANAGER_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Connection timing, exposed over serial STATUS and /api/status
+struct WiFiConnectStats {
+  unsigned long bootToReadyMs;          // millis() when the station first had a leased IP, 0 = not yet
+  unsigned long lastConnectMs;          // WiFi.begin() to a leased IP for the latest connect
+  unsigned long lastAddressMs;          // WiFi.begin() or link loss to a usable IP, cached or leased
+  unsigned long lastReconnectMs;        // Link loss to a leased IP for the latest reconnect
+  bool lastConnectFast;                 // Latest connect used the cached BSSID/channel/IP
+  uint16_t reconnectCount;
+  uint16_t fastConnectFailures;         // Directed attempts that fell back to a full scan
+};
+
+enum WiFiConnectionState {
+  WIFI_STATE_IDLE,                      // Not started
+  WIFI_STATE_CONNECTING,                // WiFi.begin() issued, waiting for an IP
+  WIFI_STATE_CONNECTED,                 // Station has an IP
+  WIFI_STATE_RECONNECTING,              // Connection lost, retrying periodically
+  WIFI_STATE_AP_MODE,                   // Access point for configuration
+  WIFI_STATE_SWITCHING                  // Trying new credentials, AP kept up alongside
+};
+
+// Latency vs power trade-off, persisted in preferences
+enum WiFiProfile {
+  WIFI_PROFILE_LATENCY = 0,             // No modem sleep, full TX power
+  WIFI_PROFILE_BALANCED = 1,            // ESP32 default modem sleep
+  WIFI_PROFILE_LOW_POWER = 2,           // Max modem sleep, reduced TX power, long listen interval
+  WIFI_PROFILE_COUNT
+};
+
+// Outcome of the latest live credential change
+enum WiFiReconfigureResult {
+  WIFI_RECONFIGURE_NONE,
+  WIFI_RECONFIGURE_PENDING,
+  WIFI_RECONFIGURE_APPLIED,             // Joined the new network and saved it
+  WIFI_RECONFIGURE_ROLLED_BACK          // New network failed, previous settings restored
+};
+
+// Function prototypes
+void initWiFi();
+void startAPMode();
+void handleWiFiConnection();
+WiFiConnectionState getWiFiState();
+bool isWiFiNetworkUp();
+const char* getWiFiStateString();
+const WiFiConnectStats& getWiFiConnectStats();
+void setWiFiProfile(WiFiProfile profile);
+WiFiProfile getWiFiProfile();
+const char* getWiFiProfileName(WiFiProfile profile);
+bool parseWiFiProfile(const char* name, WiFiProfile& profile);
+void requestWiFiReconfigure(const char* newSsid, const char* newPassword);
+WiFiReconfigureResult getWiFiReconfigureResult();
+const char* getWiFiReconfigureResultString();
+
+#endif // WIFI_MANAGER_H
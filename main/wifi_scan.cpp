@@ -0,0 +1,141 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Background WiFi Scan Implementation
+ */
+
+#include "wifi_scan.h"
+#include "Debug.h"
+#include <WiFi.h>
+
+static WifiScanResult scanResults[WIFI_SCAN_MAX_RESULTS];
+static int scanResultCount = 0;
+static bool scanRunning = false;
+static bool scanStarted = false;        // At least one scan has been requested
+static unsigned long scanStartTime = 0;
+static unsigned long scanCompleteTime = 0;
+static bool scanHasResults = false;
+
+// Start a scan unless one is running or the last one started too recently.
+// Returns true if a scan is in progress afterwards.
+bool requestWifiScan() {
+  if (scanRunning) {
+    return true;
+  }
+  if (scanStarted && millis() - scanStartTime < WIFI_SCAN_MIN_INTERVAL_MS) {
+    return false;
+  }
+
+  int16_t result = WiFi.scanNetworks(true);
+  scanStarted = true;
+  scanStartTime = millis();
+  if (result == WIFI_SCAN_FAILED) {
+    LOG_INFO(LOG_CAT_WIFI, "WiFi scan failed to start\n");
+    return false;
+  }
+
+  scanRunning = true;
+  LOG_VERBOSE(LOG_CAT_WIFI, "WiFi scan started\n");
+  return true;
+}
+
+// Add one network, keeping the strongest entry per SSID and, when the table
+// is full, dropping the weakest network
+static void addScanResult(const String& networkSsid, int32_t rssi, uint8_t channel, bool secured) {
+  if (networkSsid.length() == 0) {
+    return;  // Hidden network
+  }
+
+  int slot = -1;
+  for (int i = 0; i < scanResultCount; i++) {
+    if (strcmp(scanResults[i].ssid, networkSsid.c_str()) == 0) {
+      if (rssi <= scanResults[i].rssi) {
+        return;
+      }
+      slot = i;
+      break;
+    }
+  }
+
+  if (slot < 0) {
+    if (scanResultCount < WIFI_SCAN_MAX_RESULTS) {
+      slot = scanResultCount++;
+    } else {
+      slot = 0;
+      for (int i = 1; i < scanResultCount; i++) {
+        if (scanResults[i].rssi < scanResults[slot].rssi) {
+          slot = i;
+        }
+      }
+      if (rssi <= scanResults[slot].rssi) {
+        return;
+      }
+    }
+  }
+
+  WifiScanResult& entry = scanResults[slot];
+  networkSsid.toCharArray(entry.ssid, sizeof(entry.ssid));
+  entry.rssi = rssi;
+  entry.channel = channel;
+  entry.secured = secured;
+}
+
+// Collect the results of a finished scan; call from the main loop
+void handleWifiScan() {
+  if (!scanRunning) {
+    return;
+  }
+
+  int16_t count = WiFi.scanComplete();
+  if (count == WIFI_SCAN_RUNNING) {
+    return;
+  }
+  scanRunning = false;
+
+  if (count < 0) {
+    LOG_INFO(LOG_CAT_WIFI, "WiFi scan failed\n");
+    return;
+  }
+
+  scanResultCount = 0;
+  for (int i = 0; i < count; i++) {
+    addScanResult(WiFi.SSID(i), WiFi.RSSI(i), WiFi.channel(i),
+                  WiFi.encryptionType(i) != WIFI_AUTH_OPEN);
+  }
+  WiFi.scanDelete();
+
+  // Strongest first - the table is small, insertion sort is fine
+  for (int i = 1; i < scanResultCount; i++) {
+    WifiScanResult entry = scanResults[i];
+    int j = i - 1;
+    while (j >= 0 && scanResults[j].rssi < entry.rssi) {
+      scanResults[j + 1] = scanResults[j];
+      j--;
+    }
+    scanResults[j + 1] = entry;
+  }
+
+  scanHasResults = true;
+  scanCompleteTime = millis();
+  LOG_VERBOSE(LOG_CAT_WIFI, "WiFi scan complete: %d networks, %d distinct\n", count, scanResultCount);
+}
+
+bool isWifiScanRunning() {
+  return scanRunning;
+}
+
+bool hasWifiScanResults() {
+  return scanHasResults;
+}
+
+// Milliseconds since the cached results were collected
+unsigned long getWifiScanAge() {
+  return millis() - scanCompleteTime;
+}
+
+int getWifiScanCount() {
+  return scanResultCount;
+}
+
+const WifiScanResult& getWifiScanResult(int index) {
+  return scanResults[index];
+}
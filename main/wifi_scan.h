@@ -0,0 +1,32 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Background WiFi Scan Header
+ *
+ * Scans run asynchronously and are collected from the main loop, so web,
+ * Alpaca and serial requests keep being served while the radio is scanning.
+ * Results are kept in a fixed table, one entry per SSID, strongest first.
+ */
+
+#ifndef WIFI_SCAN_H
+#define WIFI_SCAN_H
+
+#include <Arduino.h>
+#include "config.h"
+
+struct WifiScanResult {
+  char ssid[SSID_SIZE + 1];
+  int32_t rssi;                         // Strongest signal seen for this SSID, dBm
+  uint8_t channel;
+  bool secured;
+};
+
+// Function prototypes
+bool requestWifiScan();
+void handleWifiScan();
+bool isWifiScanRunning();
+bool hasWifiScanResults();
+unsigned long getWifiScanAge();
+int getWifiScanCount();
+const WifiScanResult& getWifiScanResult(int index);
+
+#endif // WIFI_SCAN_H
@@ -0,0 +1,131 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Serial Dispatch Benchmark
+ *
+ * Times the command lookup from serial_commands.h as the table grows, next
+ * to the strcmp chain it replaced. Tables of synthetic commands are indexed
+ * with the firmware's own hash; names that would collide are skipped, as a
+ * real command would be renamed or the seed changed. Each lookup cycles
+ * through the known names plus one unknown token in four.
+ *
+ *   ./build/sim/dispatch-bench [--iterations N]
+ *
+ * Exits non-zero if the hashed lookup slows down with the table size the way
+ * the chain does.
+ */
+
+#include "serial_commands.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const size_t TABLE_SIZES[] = { 4, 8, 16, 24, 32, 48 };
+static const size_t MAX_COMMANDS = 48;
+static const size_t UNKNOWN_TOKENS = 4;
+
+static char names[MAX_COMMANDS][12];
+static const char* unknownTokens[UNKNOWN_TOKENS] = { "BRIGTNESS", "FOO", "STAT", "PRESETS" };
+static volatile uintptr_t sink;
+
+static void noopHandler(const SerialArgs& args) {
+}
+
+// Collision-free synthetic names, shortest first
+static void generateNames() {
+  bool used[SERIAL_COMMAND_HASH_SLOTS] = {};
+  size_t count = 0;
+  for (unsigned candidate = 0; count < MAX_COMMANDS; candidate++) {
+    char name[12];
+    snprintf(name, sizeof(name), "CMD%u", candidate);
+    size_t slot = serialCommandSlot(serialCommandHash(name, false));
+    if (used[slot]) {
+      continue;
+    }
+    used[slot] = true;
+    strcpy(names[count++], name);
+  }
+}
+
+// The if/else chain the table replaced, one strcmp per command until a match
+static const SerialCommandEntry* findLinear(const SerialCommandEntry* table, size_t count, const char* name) {
+  for (size_t i = 0; i < count; i++) {
+    if (strcmp(table[i].name, name) == 0) {
+      return &table[i];
+    }
+  }
+  return nullptr;
+}
+
+template <size_t N>
+static void runTable(unsigned long iterations, double& hashNs, double& linearNs) {
+  SerialCommandEntry table[N];
+  for (size_t i = 0; i < N; i++) {
+    table[i] = { names[i], false, SERIAL_ARGS_NONE, noopHandler, names[i], "" };
+  }
+  SerialCommandIndex index = buildSerialCommandIndex(table);
+  if (index.collision) {
+    fprintf(stderr, "collision in the %zu command table\n", N);
+    exit(2);
+  }
+
+  // Known names, with an unknown token after every third
+  const char* tokens[N + N / 3 + 1];
+  size_t tokenCount = 0;
+  for (size_t i = 0; i < N; i++) {
+    tokens[tokenCount++] = names[i];
+    if (i % 3 == 2) {
+      tokens[tokenCount++] = unknownTokens[(i / 3) % UNKNOWN_TOKENS];
+    }
+  }
+
+  typedef std::chrono::steady_clock Clock;
+  Clock::time_point start = Clock::now();
+  for (unsigned long i = 0; i < iterations; i++) {
+    sink = (uintptr_t)findSerialCommandEntry(table, index, tokens[i % tokenCount], false);
+  }
+  hashNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / iterations;
+
+  start = Clock::now();
+  for (unsigned long i = 0; i < iterations; i++) {
+    sink = (uintptr_t)findLinear(table, N, tokens[i % tokenCount]);
+  }
+  linearNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / iterations;
+}
+
+int main(int argc, char** argv) {
+  unsigned long iterations = 2000000;
+  if (argc == 3 && strcmp(argv[1], "--iterations") == 0) {
+    iterations = strtoul(argv[2], nullptr, 10);
+  } else if (argc != 1) {
+    fprintf(stderr, "Usage: %s [--iterations N]\n", argv[0]);
+    return 2;
+  }
+
+  generateNames();
+
+  double hashNs[6];
+  double linearNs[6];
+  runTable<4>(iterations, hashNs[0], linearNs[0]);
+  runTable<8>(iterations, hashNs[1], linearNs[1]);
+  runTable<16>(iterations, hashNs[2], linearNs[2]);
+  runTable<24>(iterations, hashNs[3], linearNs[3]);
+  runTable<32>(iterations, hashNs[4], linearNs[4]);
+  runTable<48>(iterations, hashNs[5], linearNs[5]);
+
+  printf("commands  hashed ns/lookup  strcmp chain ns/lookup\n");
+  for (size_t i = 0; i < sizeof(TABLE_SIZES) / sizeof(TABLE_SIZES[0]); i++) {
+    printf("%8zu  %16.1f  %22.1f\n", TABLE_SIZES[i], hashNs[i], linearNs[i]);
+  }
+
+  // The hashed lookup should stay flat; allow for timer noise on small figures
+  double hashGrowth = hashNs[5] / hashNs[0];
+  double linearGrowth = linearNs[5] / linearNs[0];
+  printf("growth from 4 to 48 commands: hashed %.2fx, strcmp chain %.2fx\n", hashGrowth, linearGrowth);
+  if (hashGrowth > 2.0 && hashNs[5] - hashNs[0] > 5.0) {
+    printf("FAIL: hashed lookup grows with the table\n");
+    return 1;
+  }
+  printf("PASS\n");
+  return 0;
+}
@@ -0,0 +1,214 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Log Benchmark
+ *
+ * Times the LOG_ macros from Debug.h per call: a message whose level is
+ * compiled out, a compiled-in message while the runtime level is off, the
+ * same message through Debug.printf(), which builds its String argument
+ * before looking at the level, and a message recorded into the log ring.
+ * This file is built with DEBUG_LEVEL 1, so LOG_VERBOSE is the compiled-out
+ * case. Flash cost is read from log_sites.cpp built once per DEBUG_LEVEL and
+ * passed in as object files: code and constant data of each build, and
+ * whether it still calls into the log buffer.
+ *
+ *   ./build/sim/log-bench [--iterations N] [LEVEL=OBJECT ...]
+ *
+ * Exits non-zero if a message that is off still pays for its arguments, or
+ * if the DEBUG_LEVEL 0 build keeps any call into the log buffer.
+ */
+
+#include "Debug.h"
+#include "IPAddress.h"
+#include <chrono>
+#include <elf.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+static const size_t RING_BATCH = LOG_BUFFER_RECORDS / 2;
+static const size_t MAX_OBJECTS = 4;
+
+static volatile unsigned long sink;
+
+// Swallows drained records
+class NullPrint : public Print {
+public:
+  size_t write(uint8_t c) override { return 1; }
+  size_t write(const uint8_t* buffer, size_t size) override { return size; }
+};
+
+struct ObjectSize {
+  int level;
+  size_t codeBytes;
+  size_t constBytes;
+  bool callsLogBuffer;                  // References commitLogRecord()
+};
+
+typedef std::chrono::steady_clock Clock;
+
+static double elapsedNs(Clock::time_point start, unsigned long iterations) {
+  return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / iterations;
+}
+
+static double timeCompiledOut(unsigned long iterations) {
+  Clock::time_point start = Clock::now();
+  for (unsigned long i = 0; i < iterations; i++) {
+    IPAddress address(10, 0, 0, (uint8_t)i);
+    LOG_VERBOSE(LOG_CAT_WIFI, "IP address: %s\n", address.toString().c_str());
+    sink = i;
+  }
+  return elapsedNs(start, iterations);
+}
+
+static double timeRuntimeOff(unsigned long iterations) {
+  Clock::time_point start = Clock::now();
+  for (unsigned long i = 0; i < iterations; i++) {
+    IPAddress address(10, 0, 0, (uint8_t)i);
+    LOG_INFO(LOG_CAT_WIFI, "IP address: %s\n", address.toString().c_str());
+    sink = i;
+  }
+  return elapsedNs(start, iterations);
+}
+
+static double timeEagerOff(unsigned long iterations) {
+  Clock::time_point start = Clock::now();
+  for (unsigned long i = 0; i < iterations; i++) {
+    IPAddress address(10, 0, 0, (uint8_t)i);
+    Debug.printf(1, "IP address: %s\n", address.toString().c_str());
+    sink = i;
+  }
+  return elapsedNs(start, iterations);
+}
+
+// Drained every RING_BATCH records, outside the timed part, so none is dropped
+static double timeRecorded(unsigned long iterations) {
+  NullPrint null;
+  double totalNs = 0;
+  unsigned long done = 0;
+  while (done < iterations) {
+    unsigned long batch = iterations - done < RING_BATCH ? iterations - done : RING_BATCH;
+    Clock::time_point start = Clock::now();
+    for (unsigned long i = 0; i < batch; i++) {
+      IPAddress address(10, 0, 0, (uint8_t)i);
+      LOG_INFO(LOG_CAT_WIFI, "IP address: %s\n", address.toString().c_str());
+      sink = i;
+    }
+    totalNs += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    done += batch;
+    while (drainLogRecords(null, LOG_SERIAL_TX_BUFFER_SIZE) > 0) {
+    }
+  }
+  return totalNs / iterations;
+}
+
+// Allocated sections of a relocatable ELF object, debug info and unwind tables left out
+static bool readObjectSize(const char* path, ObjectSize& size) {
+  FILE* file = fopen(path, "rb");
+  if (file == nullptr) {
+    perror(path);
+    return false;
+  }
+  std::vector<char> data;
+  char chunk[4096];
+  size_t length;
+  while ((length = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+    data.insert(data.end(), chunk, chunk + length);
+  }
+  fclose(file);
+
+  const Elf64_Ehdr* header = (const Elf64_Ehdr*)data.data();
+  if (data.size() < sizeof(Elf64_Ehdr) || memcmp(header->e_ident, ELFMAG, SELFMAG) != 0 ||
+      header->e_ident[EI_CLASS] != ELFCLASS64 || header->e_shoff + header->e_shnum * sizeof(Elf64_Shdr) > data.size()) {
+    fprintf(stderr, "%s: not a 64-bit ELF object\n", path);
+    return false;
+  }
+  const Elf64_Shdr* sections = (const Elf64_Shdr*)(data.data() + header->e_shoff);
+  const char* sectionNames = data.data() + sections[header->e_shstrndx].sh_offset;
+
+  size.codeBytes = 0;
+  size.constBytes = 0;
+  size.callsLogBuffer = false;
+  for (int i = 0; i < header->e_shnum; i++) {
+    const Elf64_Shdr& section = sections[i];
+    const char* name = sectionNames + section.sh_name;
+    if (section.sh_type == SHT_SYMTAB) {
+      const Elf64_Sym* symbols = (const Elf64_Sym*)(data.data() + section.sh_offset);
+      const char* symbolNames = data.data() + sections[section.sh_link].sh_offset;
+      for (size_t s = 0; s < section.sh_size / sizeof(Elf64_Sym); s++) {
+        if (symbols[s].st_shndx == SHN_UNDEF && strstr(symbolNames + symbols[s].st_name, "commitLogRecord")) {
+          size.callsLogBuffer = true;
+        }
+      }
+    }
+    if (!(section.sh_flags & SHF_ALLOC) || section.sh_type == SHT_NOBITS || (section.sh_flags & SHF_WRITE) ||
+        strcmp(name, ".eh_frame") == 0 || strcmp(name, ".gcc_except_table") == 0) {
+      continue;
+    }
+    if (section.sh_flags & SHF_EXECINSTR) {
+      size.codeBytes += section.sh_size;
+    } else {
+      size.constBytes += section.sh_size;
+    }
+  }
+  return true;
+}
+
+int main(int argc, char** argv) {
+  unsigned long iterations = 2000000;
+  ObjectSize objects[MAX_OBJECTS];
+  size_t objectCount = 0;
+  for (int i = 1; i < argc; i++) {
+    const char* separator = strchr(argv[i], '=');
+    if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+      iterations = strtoul(argv[++i], nullptr, 10);
+    } else if (separator != nullptr && objectCount < MAX_OBJECTS) {
+      objects[objectCount].level = atoi(argv[i]);
+      if (!readObjectSize(separator + 1, objects[objectCount])) {
+        return 2;
+      }
+      objectCount++;
+    } else {
+      fprintf(stderr, "Usage: %s [--iterations N] [LEVEL=OBJECT ...]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  Debug.begin(115200);
+  Debug.setLevel(0);
+  double compiledOutNs = timeCompiledOut(iterations);
+  double runtimeOffNs = timeRuntimeOff(iterations);
+  double eagerOffNs = timeEagerOff(iterations);
+  Debug.setLevel(1);
+  double recordedNs = timeRecorded(iterations);
+
+  printf("call                                        ns/call\n");
+  printf("LOG_VERBOSE, compiled out                  %8.1f\n", compiledOutNs);
+  printf("LOG_INFO, runtime level off                %8.1f\n", runtimeOffNs);
+  printf("Debug.printf(), runtime level off          %8.1f\n", eagerOffNs);
+  printf("LOG_INFO, recorded                         %8.1f\n", recordedNs);
+
+  bool failed = false;
+  if (objectCount > 0) {
+    printf("\nlog_sites.cpp  code bytes  const bytes  calls log buffer\n");
+    for (size_t i = 0; i < objectCount; i++) {
+      printf("DEBUG_LEVEL %d  %10zu  %11zu  %s\n", objects[i].level, objects[i].codeBytes, objects[i].constBytes,
+             objects[i].callsLogBuffer ? "yes" : "no");
+      if (objects[i].level == 0 && objects[i].callsLogBuffer) {
+        printf("FAIL: DEBUG_LEVEL 0 still calls into the log buffer\n");
+        failed = true;
+      }
+    }
+  }
+
+  // The skipped message should not build its String; allow for timer noise
+  if (runtimeOffNs * 2 > eagerOffNs && eagerOffNs - runtimeOffNs < 5.0) {
+    printf("FAIL: a message that is off still evaluates its arguments\n");
+    failed = true;
+  }
+  if (failed) {
+    return 1;
+  }
+  printf("PASS\n");
+  return 0;
+}
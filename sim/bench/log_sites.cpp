@@ -0,0 +1,27 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Log Benchmark Call Sites
+ *
+ * A dozen LOG_INFO/LOG_VERBOSE calls shaped like the firmware's own, with
+ * integer, C string and String temporary arguments. CMake compiles this file
+ * once per DEBUG_LEVEL and log-bench reports how much code and constant data
+ * each build leaves behind.
+ */
+
+#include "Debug.h"
+#include "IPAddress.h"
+
+void logSites(const String& name, IPAddress address, int brightness, unsigned long elapsedUs) {
+  LOG_INFO(LOG_CAT_WIFI, "IP address: %s\n", address.toString().c_str());
+  LOG_INFO(LOG_CAT_WIFI, "  Web UI: http://%s/\n", address.toString().c_str());
+  LOG_VERBOSE(LOG_CAT_WIFI, "Cached WiFi BSSID, channel %d and IP for fast connect\n", brightness);
+  LOG_INFO(LOG_CAT_ALPACA, "MDNS responder started as %s.local\n", name.c_str());
+  LOG_VERBOSE(LOG_CAT_ALPACA, "Response: %s\n", (name + " " + String(brightness)).c_str());
+  LOG_INFO(LOG_CAT_WEB, "Web UI server started on port %d\n", brightness);
+  LOG_VERBOSE(LOG_CAT_SERIAL, "Serial command: %s\n", name.c_str());
+  LOG_VERBOSE(LOG_CAT_SYSTEM, "Boot: %s done in %lu us\n", name.c_str(), elapsedUs);
+  LOG_INFO(LOG_CAT_SYSTEM, "Boot complete in %lu ms\n", elapsedUs / 1000);
+  LOG_INFO(LOG_CAT_CALIBRATOR, "Brightness set to %d%% (PWM: %d), State: READY\n", brightness, brightness * 10);
+  LOG_VERBOSE(LOG_CAT_CALIBRATOR, "Ramp at %d%% (PWM: %d)\n", brightness, brightness * 10);
+  LOG_INFO(LOG_CAT_CALIBRATOR, "Device Name: %s\n", name.c_str());
+}
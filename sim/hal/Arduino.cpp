@@ -0,0 +1,151 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Simulator Arduino Core Implementation
+ */
+
+#include "Arduino.h"
+#include "sim.h"
+#include "esp_heap_caps.h"
+#include <time.h>
+#include <unistd.h>
+#include <map>
+
+EspClass ESP;
+
+struct SimPwmChannel {
+  uint32_t frequency;
+  uint8_t resolution;
+  uint32_t duty;
+};
+
+static std::map<uint8_t, SimPwmChannel> pwmChannels;
+static FILE* pwmTrace = nullptr;
+static uint64_t virtualMicros = 0;
+
+uint64_t simHostMicros64() {
+  static struct timespec start = {};
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  if (start.tv_sec == 0 && start.tv_nsec == 0) {
+    start = now;
+  }
+  return (uint64_t)(now.tv_sec - start.tv_sec) * 1000000ULL + (now.tv_nsec - start.tv_nsec) / 1000;
+}
+
+uint64_t simMicros64() {
+  return simOptions.clockMode == SIM_CLOCK_VIRTUAL ? virtualMicros : simHostMicros64();
+}
+
+unsigned long millis() {
+  return (unsigned long)(simMicros64() / 1000);
+}
+
+unsigned long micros() {
+  return (unsigned long)simMicros64();
+}
+
+void delay(uint32_t ms) {
+  delayMicroseconds(ms * 1000);
+}
+
+void delayMicroseconds(uint32_t us) {
+  if (simOptions.clockMode == SIM_CLOCK_VIRTUAL) {
+    virtualMicros += us;
+  } else {
+    usleep(us);
+  }
+}
+
+void yield() {
+}
+
+long random(long howBig) {
+  return howBig > 0 ? ::random() % howBig : 0;
+}
+
+long random(long howSmall, long howBig) {
+  return howBig > howSmall ? howSmall + random(howBig - howSmall) : howSmall;
+}
+
+void randomSeed(unsigned long seed) {
+  srandom(seed);
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+}
+
+int digitalRead(uint8_t pin) {
+  return LOW;
+}
+
+bool ledcAttach(uint8_t pin, uint32_t frequency, uint8_t resolution) {
+  if (resolution == 0 || resolution > 20) {
+    return false;
+  }
+  pwmChannels[pin] = { frequency, resolution, 0 };
+  if (pwmTrace == nullptr && !simOptions.pwmTraceFile.empty()) {
+    pwmTrace = fopen(simOptions.pwmTraceFile.c_str(), "w");
+    if (pwmTrace != nullptr) {
+      fprintf(pwmTrace, "time_us,pin,duty,max\n");
+    }
+  }
+  return true;
+}
+
+// Every write goes to the trace, so repeated identical writes show up too
+bool ledcWrite(uint8_t pin, uint32_t duty) {
+  auto channel = pwmChannels.find(pin);
+  if (channel == pwmChannels.end()) {
+    return false;
+  }
+  channel->second.duty = duty;
+  if (pwmTrace != nullptr) {
+    fprintf(pwmTrace, "%llu,%u,%u,%u\n", (unsigned long long)simMicros64(), pin, duty,
+            (1U << channel->second.resolution) - 1);
+  }
+  return true;
+}
+
+uint32_t ledcRead(uint8_t pin) {
+  auto channel = pwmChannels.find(pin);
+  return channel != pwmChannels.end() ? channel->second.duty : 0;
+}
+
+int32_t simGetPwmDuty(uint8_t pin) {
+  auto channel = pwmChannels.find(pin);
+  return channel != pwmChannels.end() ? (int32_t)channel->second.duty : -1;
+}
+
+void simPwmClose() {
+  if (pwmTrace != nullptr) {
+    fclose(pwmTrace);
+    pwmTrace = nullptr;
+  }
+}
+
+uint32_t EspClass::getHeapSize() {
+  return simOptions.heapSize;
+}
+
+uint32_t EspClass::getFreeHeap() {
+  return heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+}
+
+uint32_t EspClass::getMinFreeHeap() {
+  return heap_caps_get_minimum_free_size(MALLOC_CAP_DEFAULT);
+}
+
+uint32_t EspClass::getMaxAllocHeap() {
+  return heap_caps_get_largest_free_block(MALLOC_CAP_DEFAULT);
+}
+
+uint32_t EspClass::getCycleCount() {
+  return (uint32_t)(simMicros64() * getCpuFreqMHz());
+}
+
+void EspClass::restart() {
+  simRestart();
+}
@@ -0,0 +1,111 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Simulator Arduino Core Header
+ *
+ * The subset of the ESP32 Arduino core the firmware uses, implemented on
+ * Linux: time, GPIO/LEDC, pgmspace, String, Print/Stream, Serial and ESP.
+ */
+
+#ifndef SIM_ARDUINO_H
+#define SIM_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <stdarg.h>
+#include <ctype.h>
+#include <math.h>
+#include <algorithm>
+
+#include "WString.h"
+#include "Print.h"
+#include "Stream.h"
+#include "IPAddress.h"
+#include "HardwareSerial.h"
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x01
+#define OUTPUT 0x03
+
+// Flash is ordinary memory in the simulator
+#define PROGMEM
+#define PGM_P const char*
+#define PSTR(s) (s)
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+#define pgm_read_word(addr) (*(const uint16_t*)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t*)(addr))
+#define pgm_read_float(addr) (*(const float*)(addr))
+#define pgm_read_ptr(addr) (*(void* const*)(addr))
+#define memcpy_P memcpy
+#define strlen_P strlen
+#define strcmp_P strcmp
+#define strncmp_P strncmp
+#define strcasecmp_P strcasecmp
+#define strcpy_P strcpy
+#define strncpy_P strncpy
+
+using std::min;
+using std::max;
+
+template <typename T, typename L, typename H>
+T constrain(T value, L low, H high) {
+  return value < (T)low ? (T)low : (value > (T)high ? (T)high : value);
+}
+
+inline long map(long x, long inMin, long inMax, long outMin, long outMax) {
+  return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+inline bool isDigit(int c) { return isdigit(c) != 0; }
+inline bool isAlpha(int c) { return isalpha(c) != 0; }
+inline bool isAlphaNumeric(int c) { return isalnum(c) != 0; }
+inline bool isSpace(int c) { return isspace(c) != 0; }
+inline bool isUpperCase(int c) { return isupper(c) != 0; }
+
+long random(long howBig);
+long random(long howSmall, long howBig);
+void randomSeed(unsigned long seed);
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+
+bool ledcAttach(uint8_t pin, uint32_t frequency, uint8_t resolution);
+bool ledcWrite(uint8_t pin, uint32_t duty);
+uint32_t ledcRead(uint8_t pin);
+
+// FreeRTOS, which the ESP32 core makes visible to every sketch. The simulator
+// runs loop() on the only task.
+typedef void* TaskHandle_t;
+inline TaskHandle_t xTaskGetCurrentTaskHandle() { return nullptr; }
+
+// Host heap standing in for the ESP32 heap, see esp_heap_caps.h
+class EspClass {
+public:
+  uint32_t getHeapSize();
+  uint32_t getFreeHeap();
+  uint32_t getMinFreeHeap();
+  uint32_t getMaxAllocHeap();
+  uint32_t getCpuFreqMHz() { return 240; }
+  uint32_t getCycleCount();
+  uint32_t getSketchSize() { return 0; }
+  const char* getSdkVersion() { return "sim"; }
+  [[noreturn]] void restart();
+};
+
+extern EspClass ESP;
+
+#endif // SIM_ARDUINO_H
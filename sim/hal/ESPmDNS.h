@@ -0,0 +1,39 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Simulator mDNS Header
+ *
+ * Nothing is announced on the network; calls are echoed to stderr so the
+ * advertised names and TXT records can be checked.
+ */
+
+#ifndef SIM_ESPMDNS_H
+#define SIM_ESPMDNS_H
+
+#include "Arduino.h"
+
+class MDNSResponder {
+public:
+  bool begin(const char* hostname) {
+    fprintf(stderr, "sim: mDNS hostname %s.local\n", hostname);
+    return true;
+  }
+  void end() {}
+  void setInstanceName(const String& name) {
+    fprintf(stderr, "sim: mDNS instance name %s\n", name.c_str());
+  }
+  bool addService(const char* service, const char* protocol, uint16_t port) {
+    fprintf(stderr, "sim: mDNS service _%s._%s port %u\n", service, protocol, port);
+    return true;
+  }
+  bool addServiceTxt(const char* service, const char* protocol, const char* key, const char* value) {
+    fprintf(stderr, "sim: mDNS TXT _%s._%s %s=%s\n", service, protocol, key, value);
+    return true;
+  }
+  bool addServiceTxt(const char* service, const char* protocol, const String& key, const String& value) {
+    return addServiceTxt(service, protocol, key.c_str(), value.c_str());
+  }
+};
+
+extern MDNSResponder MDNS;
+
+#endif // SIM_ESPMDNS_H
@@ -0,0 +1,117 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Simulator Serial Implementation
+ */
+
+#include "Arduino.h"
+#include "sim.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+HardwareSerial Serial;
+
+static int ptySlaveFd = -1;
+
+static void setNonBlocking(int fd) {
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+}
+
+void simSerialInit() {
+  switch (simOptions.serialMode) {
+    case SIM_SERIAL_PTY: {
+      int master = posix_openpt(O_RDWR | O_NOCTTY);
+      if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+        perror("sim: pseudo terminal");
+        exit(1);
+      }
+
+      // Hold the slave open in raw mode, so the terminal does not echo our
+      // output back as input and survives clients coming and going
+      const char* path = ptsname(master);
+      ptySlaveFd = open(path, O_RDWR | O_NOCTTY);
+      struct termios settings;
+      if (ptySlaveFd >= 0 && tcgetattr(ptySlaveFd, &settings) == 0) {
+        cfmakeraw(&settings);
+        tcsetattr(ptySlaveFd, TCSANOW, &settings);
+      }
+
+      setNonBlocking(master);
+      Serial.inputFd = master;
+      Serial.outputFd = master;
+      fprintf(stderr, "sim: Serial on %s\n", path);
+      break;
+    }
+    case SIM_SERIAL_STDIO:
+      setNonBlocking(STDIN_FILENO);
+      Serial.inputFd = STDIN_FILENO;
+      Serial.outputFd = STDOUT_FILENO;
+      break;
+    case SIM_SERIAL_NONE:
+      break;
+  }
+}
+
+// Move whatever the host has sent into the receive buffer
+void HardwareSerial::fill() {
+  if (inputFd < 0) {
+    return;
+  }
+  if (rxHead == rxTail) {
+    rxHead = rxTail = 0;
+  }
+  if (rxTail < sizeof(rxBuffer)) {
+    ssize_t count = ::read(inputFd, rxBuffer + rxTail, sizeof(rxBuffer) - rxTail);
+    if (count > 0) {
+      rxTail += count;
+    }
+  }
+}
+
+int HardwareSerial::available() {
+  fill();
+  return rxTail - rxHead;
+}
+
+int HardwareSerial::read() {
+  fill();
+  return rxHead < rxTail ? rxBuffer[rxHead++] : -1;
+}
+
+int HardwareSerial::peek() {
+  fill();
+  return rxHead < rxTail ? rxBuffer[rxHead] : -1;
+}
+
+size_t HardwareSerial::read(uint8_t* buffer, size_t size) {
+  fill();
+  size_t count = std::min(size, rxTail - rxHead);
+  memcpy(buffer, rxBuffer + rxHead, count);
+  rxHead += count;
+  return count;
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+  if (outputFd < 0) {
+    return size;
+  }
+  size_t offset = 0;
+  while (offset < size) {
+    ssize_t count = ::write(outputFd, buffer + offset, size - offset);
+    if (count <= 0) {
+      break;                            // Terminal full or closed: drop the rest
+    }
+    offset += count;
+  }
+  return size;
+}
+
+int HardwareSerial::availableForWrite() {
+  if (outputFd < 0) {
+    return txBufferSize;
+  }
+  struct pollfd descriptor = { outputFd, POLLOUT, 0 };
+  return poll(&descriptor, 1, 0) == 1 && (descriptor.revents & POLLOUT) ? txBufferSize : 0;
+}
@@ -0,0 +1,51 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Simulator Serial Header
+ *
+ * Serial is a pseudo terminal by default, so a terminal program or a serial
+ * automation script can open it like a USB port. Output never blocks: when
+ * nobody drains the terminal, bytes are dropped as a full UART would.
+ */
+
+#ifndef SIM_HARDWARESERIAL_H
+#define SIM_HARDWARESERIAL_H
+
+#include "Stream.h"
+
+class HardwareSerial : public Stream {
+public:
+  void begin(unsigned long baud) { baudRate = baud; }
+  void end() {}
+  size_t setRxBufferSize(size_t size) { return size; }
+  size_t setTxBufferSize(size_t size) { txBufferSize = size; return size; }
+  operator bool() const { return true; }
+
+  int available() override;
+  int read() override;
+  int peek() override;
+  size_t read(uint8_t* buffer, size_t size);
+  size_t read(char* buffer, size_t size) { return read((uint8_t*)buffer, size); }
+
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t* buffer, size_t size) override;
+  using Print::write;
+  int availableForWrite() override;
+  void flush() override {}
+
+  // Descriptors set up by simSerialInit()
+  int inputFd = -1;
+  int outputFd = -1;
+
+private:
+  void fill();
+
+  unsigned long baudRate = 115200;
+  size_t txBufferSize = 128;
+  uint8_t rxBuffer[256];
+  size_t rxHead = 0;
+  size_t rxTail = 0;
+};
+
+extern HardwareSerial Serial;
+
+#endif // SIM_HARDWARESERIAL_H
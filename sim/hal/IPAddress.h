@@ -0,0 +1,48 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Simulator IPAddress Header
+ */
+
+#ifndef SIM_IPADDRESS_H
+#define SIM_IPADDRESS_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include "WString.h"
+
+// IPv4 only, stored in network byte order like the ESP32 core
+class IPAddress {
+public:
+  IPAddress() : address(0) {}
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+    : address(a | (b << 8) | (c << 16) | ((uint32_t)d << 24)) {}
+  IPAddress(uint32_t value) : address(value) {}
+
+  operator uint32_t() const { return address; }
+  uint8_t operator[](int index) const { return (address >> (8 * index)) & 0xFF; }
+  bool operator==(const IPAddress& other) const { return address == other.address; }
+  bool operator!=(const IPAddress& other) const { return address != other.address; }
+
+  bool fromString(const char* text) {
+    unsigned int a, b, c, d;
+    char extra;
+    if (text == nullptr || sscanf(text, "%u.%u.%u.%u%c", &a, &b, &c, &d, &extra) != 4 ||
+        a > 255 || b > 255 || c > 255 || d > 255) {
+      return false;
+    }
+    *this = IPAddress(a, b, c, d);
+    return true;
+  }
+  bool fromString(const String& text) { return fromString(text.c_str()); }
+
+  String toString() const {
+    char buffer[16];
+    snprintf(buffer, sizeof(buffer), "%u.%u.%u.%u", (*this)[0], (*this)[1], (*this)[2], (*this)[3]);
+    return String(buffer);
+  }
+
+private:
+  uint32_t address;
+};
+
+#endif // SIM_IPADDRESS_H
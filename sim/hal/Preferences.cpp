@@ -0,0 +1,208 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Simulator Preferences Implementation
+ */
+
+#include "Preferences.h"
+#include "sim.h"
+#include <map>
+#include <vector>
+
+#define NVS_KEY_MAX_LENGTH 15
+#define NVS_SIM_ENTRIES 630             // Roughly the entries of the default 20 KB nvs partition
+
+struct NvsEntry {
+  PreferenceType type = PT_INVALID;
+  std::vector<uint8_t> data;
+};
+
+typedef std::map<std::string, NvsEntry> NvsNamespace;
+
+static std::map<std::string, NvsNamespace> nvsStore;
+static bool nvsDirty = false;
+
+// One line per entry: namespace key type hex-bytes
+void simPreferencesLoad() {
+  if (simOptions.nvsFile.empty()) {
+    return;
+  }
+  FILE* file = fopen(simOptions.nvsFile.c_str(), "r");
+  if (file == nullptr) {
+    return;
+  }
+
+  char space[32], key[32], hex[8192];
+  int type;
+  while (fscanf(file, "%31s %31s %d %8191s", space, key, &type, hex) == 4) {
+    NvsEntry entry;
+    entry.type = (PreferenceType)type;
+    for (const char* p = hex; p[0] != '\0' && p[1] != '\0' && p[0] != '-'; p += 2) {
+      unsigned int byteValue;
+      sscanf(p, "%2x", &byteValue);
+      entry.data.push_back(byteValue);
+    }
+    nvsStore[space][key] = entry;
+  }
+  fclose(file);
+}
+
+void simPreferencesSave() {
+  if (!nvsDirty || simOptions.nvsFile.empty()) {
+    return;
+  }
+  std::string temporary = simOptions.nvsFile + ".tmp";
+  FILE* file = fopen(temporary.c_str(), "w");
+  if (file == nullptr) {
+    perror("sim: nvs file");
+    return;
+  }
+  for (const auto& space : nvsStore) {
+    for (const auto& entry : space.second) {
+      fprintf(file, "%s %s %d ", space.first.c_str(), entry.first.c_str(), entry.second.type);
+      if (entry.second.data.empty()) {
+        fputc('-', file);
+      }
+      for (uint8_t byteValue : entry.second.data) {
+        fprintf(file, "%02x", byteValue);
+      }
+      fputc('\n', file);
+    }
+  }
+  fclose(file);
+  rename(temporary.c_str(), simOptions.nvsFile.c_str());
+  nvsDirty = false;
+}
+
+static bool validKey(const char* key) {
+  return key != nullptr && key[0] != '\0' && strlen(key) <= NVS_KEY_MAX_LENGTH;
+}
+
+bool Preferences::begin(const char* space, bool openReadOnly, const char* partitionLabel) {
+  if (started || !validKey(space)) {
+    return false;
+  }
+  // Like NVS, a namespace that was never written cannot be opened read-only
+  if (openReadOnly && nvsStore.find(space) == nvsStore.end()) {
+    return false;
+  }
+  name = space;
+  readOnly = openReadOnly;
+  started = true;
+  return true;
+}
+
+void Preferences::end() {
+  if (started) {
+    started = false;
+    simPreferencesSave();
+  }
+}
+
+bool Preferences::clear() {
+  if (!started || readOnly) {
+    return false;
+  }
+  nvsStore.erase(name);
+  nvsDirty = true;
+  return true;
+}
+
+bool Preferences::remove(const char* key) {
+  if (!started || readOnly || !validKey(key)) {
+    return false;
+  }
+  nvsDirty |= nvsStore[name].erase(key) > 0;
+  return true;
+}
+
+bool Preferences::isKey(const char* key) {
+  return getType(key) != PT_INVALID;
+}
+
+PreferenceType Preferences::getType(const char* key) {
+  if (!started || !validKey(key)) {
+    return PT_INVALID;
+  }
+  auto space = nvsStore.find(name);
+  if (space == nvsStore.end()) {
+    return PT_INVALID;
+  }
+  auto entry = space->second.find(key);
+  return entry != space->second.end() ? entry->second.type : PT_INVALID;
+}
+
+size_t Preferences::freeEntries() {
+  size_t used = 0;
+  for (const auto& space : nvsStore) {
+    for (const auto& entry : space.second) {
+      used += 1 + (entry.second.data.size() + 31) / 32;   // NVS stores 32 byte spans
+    }
+  }
+  return used < NVS_SIM_ENTRIES ? NVS_SIM_ENTRIES - used : 0;
+}
+
+size_t Preferences::putValue(const char* key, PreferenceType type, const void* value, size_t length) {
+  if (!started || readOnly || !validKey(key)) {
+    return 0;
+  }
+  NvsEntry& entry = nvsStore[name][key];
+  const uint8_t* bytes = (const uint8_t*)value;
+  if (entry.type != type || entry.data.size() != length || memcmp(entry.data.data(), bytes, length) != 0) {
+    entry.type = type;
+    entry.data.assign(bytes, bytes + length);
+    nvsDirty = true;
+  }
+  return length;
+}
+
+bool Preferences::readValue(const char* key, PreferenceType type, void* value, size_t length) {
+  if (getType(key) != type) {
+    return false;
+  }
+  const NvsEntry& entry = nvsStore[name][key];
+  if (entry.data.size() != length) {
+    return false;
+  }
+  memcpy(value, entry.data.data(), length);
+  return true;
+}
+
+size_t Preferences::putString(const char* key, const char* value) {
+  size_t length = strlen(value);
+  return putValue(key, PT_STR, value, length + 1) > 0 ? length : 0;
+}
+
+size_t Preferences::getString(const char* key, char* value, size_t maxLength) {
+  if (getType(key) != PT_STR) {
+    return 0;
+  }
+  const NvsEntry& entry = nvsStore[name][key];
+  if (value == nullptr) {
+    return entry.data.size();
+  }
+  if (entry.data.size() > maxLength) {
+    return 0;
+  }
+  memcpy(value, entry.data.data(), entry.data.size());
+  return entry.data.size();
+}
+
+String Preferences::getString(const char* key, String defaultValue) {
+  if (getType(key) != PT_STR) {
+    return defaultValue;
+  }
+  return String((const char*)nvsStore[name][key].data.data());
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+  return getType(key) == PT_BLOB ? nvsStore[name][key].data.size() : 0;
+}
+
+size_t Preferences::getBytes(const char* key, void* buffer, size_t maxLength) {
+  size_t length = getBytesLength(key);
+  if (length == 0 || buffer == nullptr || length > maxLength) {
+    return 0;
+  }
+  memcpy(buffer, nvsStore[name][key].data.data(), length);
+  return length;
+}
@@ -0,0 +1,85 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Simulator Preferences Header
+ *
+ * NVS stand-in. Values are typed like NVS entries (a get with the wrong type
+ * returns the default) and keys are limited to 15 characters. The store is
+ * kept in memory and, with --nvs FILE, written to that file on every end().
+ */
+
+#ifndef SIM_PREFERENCES_H
+#define SIM_PREFERENCES_H
+
+#include "Arduino.h"
+#include <string>
+
+typedef enum {
+  PT_I8, PT_U8, PT_I16, PT_U16, PT_I32, PT_U32, PT_I64, PT_U64, PT_STR, PT_BLOB, PT_INVALID
+} PreferenceType;
+
+class Preferences {
+public:
+  ~Preferences() { end(); }
+
+  bool begin(const char* name, bool readOnly = false, const char* partitionLabel = nullptr);
+  void end();
+
+  bool clear();
+  bool remove(const char* key);
+  bool isKey(const char* key);
+  PreferenceType getType(const char* key);
+  size_t freeEntries();
+
+  size_t putChar(const char* key, int8_t value) { return putValue(key, PT_I8, &value, sizeof(value)); }
+  size_t putUChar(const char* key, uint8_t value) { return putValue(key, PT_U8, &value, sizeof(value)); }
+  size_t putShort(const char* key, int16_t value) { return putValue(key, PT_I16, &value, sizeof(value)); }
+  size_t putUShort(const char* key, uint16_t value) { return putValue(key, PT_U16, &value, sizeof(value)); }
+  size_t putInt(const char* key, int32_t value) { return putValue(key, PT_I32, &value, sizeof(value)); }
+  size_t putUInt(const char* key, uint32_t value) { return putValue(key, PT_U32, &value, sizeof(value)); }
+  size_t putLong(const char* key, int32_t value) { return putInt(key, value); }
+  size_t putULong(const char* key, uint32_t value) { return putUInt(key, value); }
+  size_t putLong64(const char* key, int64_t value) { return putValue(key, PT_I64, &value, sizeof(value)); }
+  size_t putULong64(const char* key, uint64_t value) { return putValue(key, PT_U64, &value, sizeof(value)); }
+  size_t putFloat(const char* key, float value) { return putValue(key, PT_BLOB, &value, sizeof(value)); }
+  size_t putDouble(const char* key, double value) { return putValue(key, PT_BLOB, &value, sizeof(value)); }
+  size_t putBool(const char* key, bool value) { return putUChar(key, value ? 1 : 0); }
+  size_t putString(const char* key, const char* value);
+  size_t putString(const char* key, const String& value) { return putString(key, value.c_str()); }
+  size_t putBytes(const char* key, const void* value, size_t length) {
+    return putValue(key, PT_BLOB, value, length);
+  }
+
+  int8_t getChar(const char* key, int8_t defaultValue = 0) { return getValue(key, PT_I8, defaultValue); }
+  uint8_t getUChar(const char* key, uint8_t defaultValue = 0) { return getValue(key, PT_U8, defaultValue); }
+  int16_t getShort(const char* key, int16_t defaultValue = 0) { return getValue(key, PT_I16, defaultValue); }
+  uint16_t getUShort(const char* key, uint16_t defaultValue = 0) { return getValue(key, PT_U16, defaultValue); }
+  int32_t getInt(const char* key, int32_t defaultValue = 0) { return getValue(key, PT_I32, defaultValue); }
+  uint32_t getUInt(const char* key, uint32_t defaultValue = 0) { return getValue(key, PT_U32, defaultValue); }
+  int32_t getLong(const char* key, int32_t defaultValue = 0) { return getInt(key, defaultValue); }
+  uint32_t getULong(const char* key, uint32_t defaultValue = 0) { return getUInt(key, defaultValue); }
+  int64_t getLong64(const char* key, int64_t defaultValue = 0) { return getValue(key, PT_I64, defaultValue); }
+  uint64_t getULong64(const char* key, uint64_t defaultValue = 0) { return getValue(key, PT_U64, defaultValue); }
+  float getFloat(const char* key, float defaultValue = NAN) { return getValue(key, PT_BLOB, defaultValue); }
+  double getDouble(const char* key, double defaultValue = NAN) { return getValue(key, PT_BLOB, defaultValue); }
+  bool getBool(const char* key, bool defaultValue = false) { return getUChar(key, defaultValue ? 1 : 0) != 0; }
+  size_t getString(const char* key, char* value, size_t maxLength);
+  String getString(const char* key, String defaultValue = String());
+  size_t getBytesLength(const char* key);
+  size_t getBytes(const char* key, void* buffer, size_t maxLength);
+
+private:
+  size_t putValue(const char* key, PreferenceType type, const void* value, size_t length);
+  bool readValue(const char* key, PreferenceType type, void* value, size_t length);
+
+  template <typename T>
+  T getValue(const char* key, PreferenceType type, T defaultValue) {
+    T value;
+    return readValue(key, type, &value, sizeof(value)) ? value : defaultValue;
+  }
+
+  std::string name;
+  bool started = false;
+  bool readOnly = false;
+};
+
+#endif // SIM_PREFERENCES_H
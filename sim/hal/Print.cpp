@@ -0,0 +1,63 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Simulator Print Implementation
+ */
+
+#include "Print.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+  size_t written = 0;
+  while (size-- > 0) {
+    written += write(*buffer++);
+  }
+  return written;
+}
+
+// Same as the ESP32 core: small messages on the stack, longer ones on the heap
+size_t Print::printf(const char* format, ...) {
+  char small[64];
+  va_list args;
+  va_start(args, format);
+  int length = vsnprintf(small, sizeof(small), format, args);
+  va_end(args);
+  if (length < 0) {
+    return 0;
+  }
+  if ((size_t)length < sizeof(small)) {
+    return write((const uint8_t*)small, length);
+  }
+
+  char* large = (char*)malloc(length + 1);
+  if (large == nullptr) {
+    return 0;
+  }
+  va_start(args, format);
+  vsnprintf(large, length + 1, format, args);
+  va_end(args);
+  size_t written = write((const uint8_t*)large, length);
+  free(large);
+  return written;
+}
+
+size_t Print::print(long number, int base) {
+  return print(String(number, (unsigned char)base));
+}
+
+size_t Print::print(unsigned long number, int base) {
+  return print(String(number, (unsigned char)base));
+}
+
+size_t Print::print(long long number, int base) {
+  return print(String(number, (unsigned char)base));
+}
+
+size_t Print::print(unsigned long long number, int base) {
+  return print(String(number, (unsigned char)base));
+}
+
+size_t Print::print(double number, int digits) {
+  return print(String(number, (unsigned int)digits));
+}
@@ -0,0 +1,60 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Simulator Stream Implementation
+ */
+
+#include "Arduino.h"
+
+int Stream::timedRead() {
+  unsigned long start = millis();
+  do {
+    int c = read();
+    if (c >= 0) {
+      return c;
+    }
+    delay(1);
+  } while (millis() - start < timeoutMs);
+  return -1;
+}
+
+size_t Stream::readBytes(char* buffer, size_t length) {
+  size_t count = 0;
+  while (count < length) {
+    int c = timedRead();
+    if (c < 0) {
+      break;
+    }
+    buffer[count++] = (char)c;
+  }
+  return count;
+}
+
+size_t Stream::readBytesUntil(char terminator, char* buffer, size_t length) {
+  size_t count = 0;
+  while (count < length) {
+    int c = timedRead();
+    if (c < 0 || c == terminator) {
+      break;
+    }
+    buffer[count++] = (char)c;
+  }
+  return count;
+}
+
+String Stream::readString() {
+  String result;
+  int c;
+  while ((c = timedRead()) >= 0) {
+    result += (char)c;
+  }
+  return result;
+}
+
+String Stream::readStringUntil(char terminator) {
+  String result;
+  int c;
+  while ((c = timedRead()) >= 0 && c != terminator) {
+    result += (char)c;
+  }
+  return result;
+}
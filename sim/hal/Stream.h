@@ -0,0 +1,31 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Simulator Stream Header
+ */
+
+#ifndef SIM_STREAM_H
+#define SIM_STREAM_H
+
+#include "Print.h"
+
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+
+  void setTimeout(unsigned long timeout) { timeoutMs = timeout; }
+  unsigned long getTimeout() const { return timeoutMs; }
+
+  size_t readBytes(char* buffer, size_t length);
+  size_t readBytes(uint8_t* buffer, size_t length) { return readBytes((char*)buffer, length); }
+  size_t readBytesUntil(char terminator, char* buffer, size_t length);
+  String readString();
+  String readStringUntil(char terminator);
+
+protected:
+  int timedRead();
+  unsigned long timeoutMs = 1000;
+};
+
+#endif // SIM_STREAM_H
@@ -0,0 +1,151 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Simulator String Implementation
+ */
+
+#include "WString.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+static std::string formatUnsigned(unsigned long long number, unsigned char base) {
+  if (base < 2 || base > 36) {
+    base = 10;
+  }
+  char digits[65];
+  int position = sizeof(digits) - 1;
+  digits[position] = '\0';
+  do {
+    int digit = number % base;
+    digits[--position] = digit < 10 ? '0' + digit : 'a' + digit - 10;
+    number /= base;
+  } while (number > 0);
+  return std::string(&digits[position]);
+}
+
+static std::string formatSigned(long long number, unsigned char base) {
+  if (number < 0 && base == 10) {
+    return "-" + formatUnsigned(-(unsigned long long)number, base);
+  }
+  return formatUnsigned((unsigned long long)number, base);
+}
+
+static std::string formatFloat(double number, unsigned int decimals) {
+  char buffer[64];
+  snprintf(buffer, sizeof(buffer), "%.*f", decimals, number);
+  return buffer;
+}
+
+String::String(unsigned char number, unsigned char base) : value(formatUnsigned(number, base)) {}
+String::String(int number, unsigned char base) : value(formatSigned(number, base)) {}
+String::String(unsigned int number, unsigned char base) : value(formatUnsigned(number, base)) {}
+String::String(long number, unsigned char base) : value(formatSigned(number, base)) {}
+String::String(unsigned long number, unsigned char base) : value(formatUnsigned(number, base)) {}
+String::String(long long number, unsigned char base) : value(formatSigned(number, base)) {}
+String::String(unsigned long long number, unsigned char base) : value(formatUnsigned(number, base)) {}
+String::String(float number, unsigned int decimals) : value(formatFloat(number, decimals)) {}
+String::String(double number, unsigned int decimals) : value(formatFloat(number, decimals)) {}
+
+bool String::equalsIgnoreCase(const String& other) const {
+  return value.size() == other.value.size() && strcasecmp(value.c_str(), other.value.c_str()) == 0;
+}
+
+bool String::endsWith(const String& suffix) const {
+  return value.size() >= suffix.value.size() &&
+         value.compare(value.size() - suffix.value.size(), suffix.value.size(), suffix.value) == 0;
+}
+
+void String::getBytes(unsigned char* buffer, unsigned int size, unsigned int index) const {
+  if (size == 0 || buffer == nullptr) {
+    return;
+  }
+  if (index >= value.size()) {
+    buffer[0] = '\0';
+    return;
+  }
+  size_t count = std::min<size_t>(size - 1, value.size() - index);
+  memcpy(buffer, value.data() + index, count);
+  buffer[count] = '\0';
+}
+
+int String::indexOf(char c, unsigned int from) const {
+  size_t position = value.find(c, from);
+  return position == std::string::npos ? -1 : (int)position;
+}
+
+int String::indexOf(const String& text, unsigned int from) const {
+  size_t position = value.find(text.value, from);
+  return position == std::string::npos ? -1 : (int)position;
+}
+
+int String::lastIndexOf(char c) const {
+  size_t position = value.rfind(c);
+  return position == std::string::npos ? -1 : (int)position;
+}
+
+int String::lastIndexOf(const String& text) const {
+  size_t position = value.rfind(text.value);
+  return position == std::string::npos ? -1 : (int)position;
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+  if (from > to) {
+    std::swap(from, to);
+  }
+  if (from >= value.size()) {
+    return String();
+  }
+  to = std::min<unsigned int>(to, value.size());
+  return String(value.data() + from, to - from);
+}
+
+void String::replace(char find, char replacement) {
+  for (char& c : value) {
+    if (c == find) {
+      c = replacement;
+    }
+  }
+}
+
+void String::replace(const String& find, const String& replacement) {
+  if (find.value.empty()) {
+    return;
+  }
+  size_t position = 0;
+  while ((position = value.find(find.value, position)) != std::string::npos) {
+    value.replace(position, find.value.size(), replacement.value);
+    position += replacement.value.size();
+  }
+}
+
+void String::remove(unsigned int index, unsigned int count) {
+  if (index < value.size()) {
+    value.erase(index, count);
+  }
+}
+
+void String::toLowerCase() {
+  for (char& c : value) {
+    c = tolower((unsigned char)c);
+  }
+}
+
+void String::toUpperCase() {
+  for (char& c : value) {
+    c = toupper((unsigned char)c);
+  }
+}
+
+void String::trim() {
+  size_t start = 0;
+  while (start < value.size() && isspace((unsigned char)value[start])) {
+    start++;
+  }
+  size_t end = value.size();
+  while (end > start && isspace((unsigned char)value[end - 1])) {
+    end--;
+  }
+  value = value.substr(start, end - start);
+}
@@ -0,0 +1,128 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Simulator String Header
+ *
+ * Arduino String on top of std::string. Every instance allocates from the
+ * host heap like the real one does from the ESP32 heap, so heap profilers see
+ * the same allocation pattern.
+ */
+
+#ifndef SIM_WSTRING_H
+#define SIM_WSTRING_H
+
+#include <stdint.h>
+#include <string>
+
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper*>(s))
+
+class String {
+public:
+  String(const char* text = "") : value(text != nullptr ? text : "") {}
+  String(const char* text, unsigned int length) : value(text, length) {}
+  String(const __FlashStringHelper* text) : String(reinterpret_cast<const char*>(text)) {}
+  String(const String& other) = default;
+  String(String&& other) = default;
+  explicit String(char c) : value(1, c) {}
+  explicit String(unsigned char number, unsigned char base = 10);
+  explicit String(int number, unsigned char base = 10);
+  explicit String(unsigned int number, unsigned char base = 10);
+  explicit String(long number, unsigned char base = 10);
+  explicit String(unsigned long number, unsigned char base = 10);
+  explicit String(long long number, unsigned char base = 10);
+  explicit String(unsigned long long number, unsigned char base = 10);
+  explicit String(float number, unsigned int decimals = 2);
+  explicit String(double number, unsigned int decimals = 2);
+
+  String& operator=(const String& other) = default;
+  String& operator=(String&& other) = default;
+  String& operator=(const char* text) { value = text != nullptr ? text : ""; return *this; }
+
+  const char* c_str() const { return value.c_str(); }
+  unsigned int length() const { return value.size(); }
+  bool isEmpty() const { return value.empty(); }
+  bool reserve(unsigned int size) { value.reserve(size); return true; }
+
+  bool concat(const String& other) { value += other.value; return true; }
+  bool concat(const char* text) { if (text != nullptr) value += text; return text != nullptr; }
+  bool concat(const char* text, unsigned int length) { value.append(text, length); return true; }
+  bool concat(const __FlashStringHelper* text) { return concat(reinterpret_cast<const char*>(text)); }
+  bool concat(char c) { value += c; return true; }
+  bool concat(unsigned char number) { return concat(String(number)); }
+  bool concat(int number) { return concat(String(number)); }
+  bool concat(unsigned int number) { return concat(String(number)); }
+  bool concat(long number) { return concat(String(number)); }
+  bool concat(unsigned long number) { return concat(String(number)); }
+  bool concat(long long number) { return concat(String(number)); }
+  bool concat(unsigned long long number) { return concat(String(number)); }
+  bool concat(float number) { return concat(String(number)); }
+  bool concat(double number) { return concat(String(number)); }
+
+  template <typename T>
+  String& operator+=(const T& other) { concat(other); return *this; }
+
+  int compareTo(const String& other) const { return value.compare(other.value); }
+  bool equals(const String& other) const { return value == other.value; }
+  bool equals(const char* text) const { return value == (text != nullptr ? text : ""); }
+  bool equalsIgnoreCase(const String& other) const;
+  bool operator==(const String& other) const { return equals(other); }
+  bool operator==(const char* text) const { return equals(text); }
+  bool operator!=(const String& other) const { return !equals(other); }
+  bool operator!=(const char* text) const { return !equals(text); }
+  bool operator<(const String& other) const { return value < other.value; }
+  bool operator>(const String& other) const { return value > other.value; }
+  bool startsWith(const String& prefix) const { return value.compare(0, prefix.value.size(), prefix.value) == 0; }
+  bool endsWith(const String& suffix) const;
+
+  char charAt(unsigned int index) const { return index < value.size() ? value[index] : 0; }
+  void setCharAt(unsigned int index, char c) { if (index < value.size()) value[index] = c; }
+  char operator[](unsigned int index) const { return charAt(index); }
+  char& operator[](unsigned int index) { return value[index]; }
+  void getBytes(unsigned char* buffer, unsigned int size, unsigned int index = 0) const;
+  void toCharArray(char* buffer, unsigned int size, unsigned int index = 0) const {
+    getBytes(reinterpret_cast<unsigned char*>(buffer), size, index);
+  }
+
+  int indexOf(char c, unsigned int from = 0) const;
+  int indexOf(const String& text, unsigned int from = 0) const;
+  int lastIndexOf(char c) const;
+  int lastIndexOf(const String& text) const;
+  String substring(unsigned int from) const { return substring(from, value.size()); }
+  String substring(unsigned int from, unsigned int to) const;
+
+  void replace(char find, char replacement);
+  void replace(const String& find, const String& replacement);
+  void remove(unsigned int index) { remove(index, value.size()); }
+  void remove(unsigned int index, unsigned int count);
+  void toLowerCase();
+  void toUpperCase();
+  void trim();
+
+  long toInt() const { return strtol(value.c_str(), nullptr, 10); }
+  float toFloat() const { return strtof(value.c_str(), nullptr); }
+  double toDouble() const { return strtod(value.c_str(), nullptr); }
+
+private:
+  std::string value;
+};
+
+template <typename T>
+String operator+(const String& left, const T& right) {
+  String result(left);
+  result.concat(right);
+  return result;
+}
+
+inline String operator+(const char* left, const String& right) {
+  String result(left);
+  result.concat(right);
+  return result;
+}
+
+inline String operator+(char left, const String& right) {
+  String result(left);
+  result.concat(right);
+  return result;
+}
+
+#endif // SIM_WSTRING_H
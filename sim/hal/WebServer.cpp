@@ -0,0 +1,372 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Simulator WebServer Implementation
+ */
+
+#include "WebServer.h"
+#include "sim.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define SIM_HTTP_REQUEST_TIMEOUT_MS 2000 // Same as the core's HTTP_MAX_DATA_WAIT
+#define SIM_HTTP_CLOSE_WAIT_MS 2000      // Same as the core's HTTP_MAX_CLOSE_WAIT
+#define SIM_HTTP_MAX_REQUEST 16384       // Larger requests are refused
+
+static const char* statusText(int code) {
+  switch (code) {
+    case 200: return "OK";
+    case 204: return "No Content";
+    case 301: return "Moved Permanently";
+    case 302: return "Found";
+    case 303: return "See Other";
+    case 304: return "Not Modified";
+    case 400: return "Bad Request";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 409: return "Conflict";
+    case 413: return "Payload Too Large";
+    case 429: return "Too Many Requests";
+    case 500: return "Internal Server Error";
+    case 503: return "Service Unavailable";
+    default: return "";
+  }
+}
+
+static HTTPMethod parseMethod(const std::string& text) {
+  if (text == "GET") return HTTP_GET;
+  if (text == "HEAD") return HTTP_HEAD;
+  if (text == "POST") return HTTP_POST;
+  if (text == "PUT") return HTTP_PUT;
+  if (text == "PATCH") return HTTP_PATCH;
+  if (text == "DELETE") return HTTP_DELETE;
+  if (text == "OPTIONS") return HTTP_OPTIONS;
+  return HTTP_ANY;
+}
+
+static String urlDecode(const std::string& text) {
+  String result;
+  for (size_t i = 0; i < text.size(); i++) {
+    char c = text[i];
+    if (c == '+') {
+      c = ' ';
+    } else if (c == '%' && i + 2 < text.size() && isxdigit(text[i + 1]) && isxdigit(text[i + 2])) {
+      c = (char)strtol(text.substr(i + 1, 2).c_str(), nullptr, 16);
+      i += 2;
+    }
+    result.concat(c);
+  }
+  return result;
+}
+
+static void parseArguments(const std::string& text, std::vector<std::pair<String, String>>& arguments) {
+  size_t start = 0;
+  while (start < text.size()) {
+    size_t end = text.find('&', start);
+    if (end == std::string::npos) {
+      end = text.size();
+    }
+    std::string pair = text.substr(start, end - start);
+    if (!pair.empty()) {
+      size_t equals = pair.find('=');
+      if (equals == std::string::npos) {
+        arguments.push_back({ urlDecode(pair), String() });
+      } else {
+        arguments.push_back({ urlDecode(pair.substr(0, equals)), urlDecode(pair.substr(equals + 1)) });
+      }
+    }
+    start = end + 1;
+  }
+}
+
+void WebServer::begin() {
+  stop();
+  listenFd = socket(AF_INET, SOCK_STREAM, 0);
+  if (listenFd < 0) {
+    return;
+  }
+  int enable = 1;
+  setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+  fcntl(listenFd, F_SETFL, fcntl(listenFd, F_GETFL) | O_NONBLOCK);
+
+  struct sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(simMapPort(port));
+  address.sin_addr.s_addr = inet_addr(simOptions.bindAddress.c_str());
+  if (bind(listenFd, (struct sockaddr*)&address, sizeof(address)) != 0 || listen(listenFd, 8) != 0) {
+    fprintf(stderr, "sim: HTTP port %u: %s\n", simMapPort(port), strerror(errno));
+    close(listenFd);
+    listenFd = -1;
+    return;
+  }
+  fprintf(stderr, "sim: HTTP port %d listening on %s:%u\n", port, simOptions.bindAddress.c_str(), simMapPort(port));
+}
+
+void WebServer::stop() {
+  if (listenFd >= 0) {
+    close(listenFd);
+    listenFd = -1;
+  }
+  currentClient = WiFiClient();
+  waitingForClose = false;
+  resetRequest();
+}
+
+void WebServer::on(const String& uri, HTTPMethod method, THandlerFunction handler) {
+  routes.push_back({ uri.c_str(), method, handler });
+}
+
+// Serve at most one request per call, like the core server's state machine
+void WebServer::handleClient() {
+  if (listenFd < 0) {
+    return;
+  }
+
+  // The core's HC_WAIT_CLOSE: a connection left open after the handler holds
+  // the server until the peer closes it or the wait runs out
+  if (waitingForClose) {
+    if (currentClient.connected() && simHostMicros64() - closeWaitStartUs < SIM_HTTP_CLOSE_WAIT_MS * 1000ULL) {
+      return;
+    }
+    waitingForClose = false;
+    currentClient = WiFiClient();
+  }
+
+  if (!currentClient) {
+    int fd = accept(listenFd, nullptr, nullptr);
+    if (fd < 0) {
+      return;
+    }
+    currentClient = WiFiClient(fd);
+    clientStartUs = simHostMicros64();
+    resetRequest();
+  }
+
+  if (!readRequest()) {
+    if (!currentClient.connected() || simHostMicros64() - clientStartUs > SIM_HTTP_REQUEST_TIMEOUT_MS * 1000ULL) {
+      currentClient.stop();
+      currentClient = WiFiClient();
+    }
+    return;
+  }
+
+  if (parseRequest()) {
+    dispatchRequest();
+  } else {
+    send(400, "text/plain", "Bad request");
+  }
+
+  // A handler that wrote nothing through us either closed the connection or
+  // kept its own copy of client(); leave the socket to that copy, but wait
+  // for it to close unless the handler also reset client()
+  if (responseStarted) {
+    if (chunked) {
+      sendContent("", 0);
+    }
+    currentClient.stop();
+  } else if (currentClient.connected()) {
+    waitingForClose = true;
+    closeWaitStartUs = simHostMicros64();
+    resetRequest();
+    return;
+  }
+  currentClient = WiFiClient();
+  resetRequest();
+}
+
+// True once the request line, headers and any Content-Length body are buffered
+bool WebServer::readRequest() {
+  uint8_t buffer[1024];
+  int count;
+  while (requestBuffer.size() < SIM_HTTP_MAX_REQUEST && (count = currentClient.read(buffer, sizeof(buffer))) > 0) {
+    requestBuffer.append((const char*)buffer, count);
+  }
+
+  size_t headerEnd = requestBuffer.find("\r\n\r\n");
+  if (headerEnd == std::string::npos) {
+    return requestBuffer.size() >= SIM_HTTP_MAX_REQUEST;
+  }
+
+  size_t bodyLength = 0;
+  std::string headers = requestBuffer.substr(0, headerEnd);
+  for (char& c : headers) {
+    c = tolower(c);
+  }
+  size_t field = headers.find("\r\ncontent-length:");
+  if (field != std::string::npos) {
+    bodyLength = strtoul(headers.c_str() + field + 17, nullptr, 10);
+  }
+  return requestBuffer.size() >= headerEnd + 4 + bodyLength || requestBuffer.size() >= SIM_HTTP_MAX_REQUEST;
+}
+
+bool WebServer::parseRequest() {
+  size_t headerEnd = requestBuffer.find("\r\n\r\n");
+  if (headerEnd == std::string::npos) {
+    return false;
+  }
+  size_t lineEnd = requestBuffer.find("\r\n");
+  std::string requestLine = requestBuffer.substr(0, lineEnd);
+  size_t firstSpace = requestLine.find(' ');
+  size_t secondSpace = requestLine.find(' ', firstSpace + 1);
+  if (firstSpace == std::string::npos || secondSpace == std::string::npos) {
+    return false;
+  }
+  requestMethod = parseMethod(requestLine.substr(0, firstSpace));
+  std::string target = requestLine.substr(firstSpace + 1, secondSpace - firstSpace - 1);
+  size_t query = target.find('?');
+  requestUri = urlDecode(target.substr(0, query));
+  if (query != std::string::npos) {
+    parseArguments(target.substr(query + 1), arguments);
+  }
+
+  size_t position = lineEnd + 2;
+  while (position < headerEnd) {
+    size_t end = requestBuffer.find("\r\n", position);
+    std::string line = requestBuffer.substr(position, end - position);
+    size_t colon = line.find(':');
+    if (colon != std::string::npos) {
+      size_t valueStart = line.find_first_not_of(' ', colon + 1);
+      requestHeaders.push_back({ String(line.substr(0, colon).c_str()),
+                                 String(valueStart == std::string::npos ? "" : line.substr(valueStart).c_str()) });
+    }
+    position = end + 2;
+  }
+
+  std::string body = requestBuffer.substr(headerEnd + 4);
+  if (!body.empty()) {
+    if (header("Content-Type").startsWith("application/x-www-form-urlencoded")) {
+      parseArguments(body, arguments);
+    } else {
+      arguments.push_back({ String("plain"), String(body.c_str(), body.size()) });
+    }
+  }
+  return true;
+}
+
+void WebServer::dispatchRequest() {
+  for (const Route& route : routes) {
+    if (route.uri == requestUri.c_str() && (route.method == HTTP_ANY || route.method == requestMethod)) {
+      route.handler();
+      return;
+    }
+  }
+  if (notFoundHandler) {
+    notFoundHandler();
+  } else {
+    send(404, "text/plain", String("Not found: ") + requestUri);
+  }
+}
+
+String WebServer::arg(const String& name) const {
+  for (const auto& argument : arguments) {
+    if (argument.first == name) {
+      return argument.second;
+    }
+  }
+  return String();
+}
+
+String WebServer::arg(int index) const {
+  return index >= 0 && index < (int)arguments.size() ? arguments[index].second : String();
+}
+
+String WebServer::argName(int index) const {
+  return index >= 0 && index < (int)arguments.size() ? arguments[index].first : String();
+}
+
+bool WebServer::hasArg(const String& name) const {
+  for (const auto& argument : arguments) {
+    if (argument.first == name) {
+      return true;
+    }
+  }
+  return false;
+}
+
+String WebServer::header(const String& name) const {
+  for (const auto& field : requestHeaders) {
+    if (field.first.equalsIgnoreCase(name)) {
+      return field.second;
+    }
+  }
+  return String();
+}
+
+bool WebServer::hasHeader(const String& name) const {
+  for (const auto& field : requestHeaders) {
+    if (field.first.equalsIgnoreCase(name)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void WebServer::sendHeader(const String& name, const String& value, bool first) {
+  if (first) {
+    responseHeaders.insert(responseHeaders.begin(), { name, value });
+  } else {
+    responseHeaders.push_back({ name, value });
+  }
+}
+
+void WebServer::sendResponseHeader(int code, const char* contentType, size_t length) {
+  String head = String("HTTP/1.1 ") + String(code) + " " + statusText(code) + "\r\n";
+  head += String("Content-Type: ") + (contentType != nullptr ? contentType : "text/html") + "\r\n";
+  if (length == CONTENT_LENGTH_UNKNOWN) {
+    chunked = true;
+    head += "Transfer-Encoding: chunked\r\n";
+  } else {
+    head += String("Content-Length: ") + String((unsigned long)length) + "\r\n";
+  }
+  for (const auto& field : responseHeaders) {
+    head += field.first + ": " + field.second + "\r\n";
+  }
+  head += "Connection: close\r\n\r\n";
+  currentClient.write((const uint8_t*)head.c_str(), head.length());
+  responseStarted = true;
+  responseHeaders.clear();
+}
+
+void WebServer::send(int code, const char* contentType, const String& content) {
+  size_t length = contentLength == CONTENT_LENGTH_NOT_SET ? content.length() : contentLength;
+  sendResponseHeader(code, contentType, length);
+  if (content.length() > 0) {
+    sendContent(content);
+  }
+}
+
+void WebServer::send_P(int code, PGM_P contentType, PGM_P content, size_t length) {
+  contentLength = length;
+  sendResponseHeader(code, contentType, length);
+  sendContent(content, length);
+}
+
+void WebServer::sendContent(const char* content, size_t length) {
+  if (!chunked) {
+    currentClient.write((const uint8_t*)content, length);
+    return;
+  }
+  char size[12];
+  snprintf(size, sizeof(size), "%zx\r\n", length);
+  currentClient.write((const uint8_t*)size, strlen(size));
+  currentClient.write((const uint8_t*)content, length);
+  currentClient.write((const uint8_t*)"\r\n", 2);
+  if (length == 0) {
+    chunked = false;
+  }
+}
+
+void WebServer::resetRequest() {
+  requestBuffer.clear();
+  requestUri = String();
+  requestMethod = HTTP_ANY;
+  arguments.clear();
+  requestHeaders.clear();
+  responseHeaders.clear();
+  contentLength = CONTENT_LENGTH_NOT_SET;
+  responseStarted = false;
+  chunked = false;
+}
@@ -0,0 +1,103 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Simulator WebServer Header
+ *
+ * Same shape as the ESP32 core server: one connection is served at a time
+ * from handleClient(), routes match on exact path and method, and a response
+ * with CONTENT_LENGTH_UNKNOWN is sent chunked. Connections close after each
+ * response. A handler that keeps a copy of client() instead (the event
+ * stream) blocks the server for up to 2 s, like the core's HC_WAIT_CLOSE,
+ * unless it also resets client().
+ */
+
+#ifndef SIM_WEBSERVER_H
+#define SIM_WEBSERVER_H
+
+#include "WiFi.h"
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+typedef enum {
+  HTTP_ANY = 0, HTTP_GET, HTTP_HEAD, HTTP_POST, HTTP_PUT, HTTP_PATCH, HTTP_DELETE, HTTP_OPTIONS
+} HTTPMethod;
+
+#define CONTENT_LENGTH_UNKNOWN ((size_t)-1)
+#define CONTENT_LENGTH_NOT_SET ((size_t)-2)
+
+class WebServer {
+public:
+  typedef std::function<void(void)> THandlerFunction;
+
+  explicit WebServer(int port = 80) : port(port) {}
+  ~WebServer() { stop(); }
+
+  void begin();
+  void stop();
+  void handleClient();
+
+  void on(const String& uri, HTTPMethod method, THandlerFunction handler);
+  void on(const String& uri, THandlerFunction handler) { on(uri, HTTP_ANY, handler); }
+  void onNotFound(THandlerFunction handler) { notFoundHandler = handler; }
+
+  String uri() const { return requestUri; }
+  HTTPMethod method() const { return requestMethod; }
+  int args() const { return arguments.size(); }
+  String arg(const String& name) const;
+  String arg(int index) const;
+  String argName(int index) const;
+  bool hasArg(const String& name) const;
+  String header(const String& name) const;
+  bool hasHeader(const String& name) const;
+  void collectHeaders(const char* headerKeys[], size_t count) {}
+  WiFiClient& client() { return currentClient; }
+
+  void send(int code, const char* contentType = nullptr, const String& content = String());
+  void send(int code, const String& contentType, const String& content) {
+    send(code, contentType.c_str(), content);
+  }
+  void send(int code, const char* contentType, const char* content) { send(code, contentType, String(content)); }
+  void send_P(int code, PGM_P contentType, PGM_P content) { send(code, contentType, String(content)); }
+  void send_P(int code, PGM_P contentType, PGM_P content, size_t length);
+  void sendHeader(const String& name, const String& value, bool first = false);
+  void setContentLength(size_t length) { contentLength = length; }
+  void sendContent(const String& content) { sendContent(content.c_str(), content.length()); }
+  void sendContent(const char* content, size_t length);
+  void sendContent_P(PGM_P content) { sendContent(content, strlen(content)); }
+  void sendContent_P(PGM_P content, size_t length) { sendContent(content, length); }
+
+private:
+  struct Route {
+    std::string uri;
+    HTTPMethod method;
+    THandlerFunction handler;
+  };
+
+  bool readRequest();
+  bool parseRequest();
+  void dispatchRequest();
+  void sendResponseHeader(int code, const char* contentType, size_t length);
+  void resetRequest();
+
+  int port;
+  int listenFd = -1;
+  std::vector<Route> routes;
+  THandlerFunction notFoundHandler;
+
+  WiFiClient currentClient;
+  uint64_t clientStartUs = 0;           // Host time, peers do not follow a virtual clock
+  bool waitingForClose = false;         // Handler left currentClient open without a response
+  uint64_t closeWaitStartUs = 0;
+  std::string requestBuffer;
+  String requestUri;
+  HTTPMethod requestMethod = HTTP_ANY;
+  std::vector<std::pair<String, String>> arguments;
+  std::vector<std::pair<String, String>> requestHeaders;
+  std::vector<std::pair<String, String>> responseHeaders;
+  size_t contentLength = CONTENT_LENGTH_NOT_SET;
+  bool responseStarted = false;
+  bool chunked = false;
+};
+
+#endif // SIM_WEBSERVER_H
@@ -0,0 +1,490 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Simulator WiFi Implementation
+ */
+
+#include "WiFi.h"
+#include "esp_wifi.h"
+#include "sim.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define SIM_SCAN_DURATION_US 1500000    // Roughly an active scan of all channels
+#define SIM_CLIENT_SEND_TIMEOUT_MS 5000 // lwIP send timeout the ESP32 core uses
+
+WiFiClass WiFi;
+
+static wifi_config_t stationConfig;
+
+class SimSocket {
+public:
+  explicit SimSocket(int fd) : fd(fd) {}
+  ~SimSocket() { close(); }
+
+  void close() {
+    if (fd >= 0) {
+      ::close(fd);
+      fd = -1;
+    }
+  }
+
+  int fd;
+};
+
+WiFiClient::WiFiClient(int fd) : socket(std::make_shared<SimSocket>(fd)) {
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port) {
+  int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) {
+    return 0;
+  }
+  struct sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(port);
+  address.sin_addr.s_addr = (uint32_t)ip;
+  if (::connect(fd, (struct sockaddr*)&address, sizeof(address)) != 0) {
+    ::close(fd);
+    return 0;
+  }
+  *this = WiFiClient(fd);
+  return 1;
+}
+
+int WiFiClient::connect(const char* host, uint16_t port) {
+  IPAddress ip;
+  if (!ip.fromString(host)) {
+    struct hostent* entry = gethostbyname(host);
+    if (entry == nullptr || entry->h_addrtype != AF_INET) {
+      return 0;
+    }
+    ip = IPAddress(*(uint32_t*)entry->h_addr_list[0]);
+  }
+  return connect(ip, port);
+}
+
+// Blocks until everything is queued, up to the send timeout, like lwIP does
+size_t WiFiClient::write(const uint8_t* buffer, size_t size) {
+  if (!socket || socket->fd < 0) {
+    return 0;
+  }
+  size_t offset = 0;
+  while (offset < size) {
+    ssize_t count = send(socket->fd, buffer + offset, size - offset, MSG_NOSIGNAL);
+    if (count > 0) {
+      offset += count;
+      continue;
+    }
+    if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      struct pollfd descriptor = { socket->fd, POLLOUT, 0 };
+      if (poll(&descriptor, 1, SIM_CLIENT_SEND_TIMEOUT_MS) == 1) {
+        continue;
+      }
+    }
+    socket->close();
+    break;
+  }
+  return offset;
+}
+
+int WiFiClient::availableForWrite() {
+  if (!socket || socket->fd < 0) {
+    return 0;
+  }
+  struct pollfd descriptor = { socket->fd, POLLOUT, 0 };
+  return poll(&descriptor, 1, 0) == 1 && (descriptor.revents & POLLOUT) ? 1436 : 0;
+}
+
+int WiFiClient::available() {
+  int count = 0;
+  if (!socket || socket->fd < 0 || ioctl(socket->fd, FIONREAD, &count) != 0) {
+    return 0;
+  }
+  return count;
+}
+
+int WiFiClient::read() {
+  uint8_t c;
+  return read(&c, 1) == 1 ? c : -1;
+}
+
+int WiFiClient::read(uint8_t* buffer, size_t size) {
+  if (!socket || socket->fd < 0) {
+    return -1;
+  }
+  ssize_t count = recv(socket->fd, buffer, size, 0);
+  return count > 0 ? (int)count : -1;
+}
+
+int WiFiClient::peek() {
+  uint8_t c;
+  if (!socket || socket->fd < 0 || recv(socket->fd, &c, 1, MSG_PEEK) != 1) {
+    return -1;
+  }
+  return c;
+}
+
+uint8_t WiFiClient::connected() {
+  if (!socket || socket->fd < 0) {
+    return 0;
+  }
+  uint8_t c;
+  ssize_t count = recv(socket->fd, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+  if (count == 0 || (count < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+    socket->close();
+    return 0;
+  }
+  return 1;
+}
+
+void WiFiClient::stop() {
+  if (socket) {
+    socket->close();
+  }
+}
+
+IPAddress WiFiClient::remoteIP() const {
+  struct sockaddr_in address = {};
+  socklen_t length = sizeof(address);
+  if (!socket || getpeername(socket->fd, (struct sockaddr*)&address, &length) != 0) {
+    return IPAddress();
+  }
+  return IPAddress(address.sin_addr.s_addr);
+}
+
+uint16_t WiFiClient::remotePort() const {
+  struct sockaddr_in address = {};
+  socklen_t length = sizeof(address);
+  if (!socket || getpeername(socket->fd, (struct sockaddr*)&address, &length) != 0) {
+    return 0;
+  }
+  return ntohs(address.sin_port);
+}
+
+IPAddress WiFiClient::localIP() const {
+  struct sockaddr_in address = {};
+  socklen_t length = sizeof(address);
+  if (!socket || getsockname(socket->fd, (struct sockaddr*)&address, &length) != 0) {
+    return IPAddress();
+  }
+  return IPAddress(address.sin_addr.s_addr);
+}
+
+uint16_t WiFiClient::localPort() const {
+  struct sockaddr_in address = {};
+  socklen_t length = sizeof(address);
+  if (!socket || getsockname(socket->fd, (struct sockaddr*)&address, &length) != 0) {
+    return 0;
+  }
+  return ntohs(address.sin_port);
+}
+
+int WiFiClient::setNoDelay(bool noDelay) {
+  int value = noDelay ? 1 : 0;
+  return socket ? setsockopt(socket->fd, IPPROTO_TCP, TCP_NODELAY, &value, sizeof(value)) : -1;
+}
+
+int WiFiClient::fd() const {
+  return socket ? socket->fd : -1;
+}
+
+bool WiFiClass::mode(wifi_mode_t newMode) {
+  if (!(newMode & WIFI_STA) && (stationConnected || connectPending)) {
+    disconnect();
+  }
+  if (!(newMode & WIFI_AP) && accessPointActive) {
+    accessPointActive = false;
+    fireEvent(ARDUINO_EVENT_WIFI_AP_STOP);
+  }
+  if ((newMode & WIFI_STA) && !(currentMode & WIFI_STA)) {
+    fireEvent(ARDUINO_EVENT_WIFI_STA_START);
+  }
+  currentMode = newMode;
+  return true;
+}
+
+wl_status_t WiFiClass::begin(const char* ssid, const char* passphrase, int32_t channel,
+                             const uint8_t* bssid, bool connect) {
+  if (!(currentMode & WIFI_STA)) {
+    mode((wifi_mode_t)(currentMode | WIFI_STA));
+  }
+  if (stationConnected) {
+    disconnect();
+  }
+  stationSsid = ssid != nullptr ? ssid : "";
+  snprintf((char*)stationConfig.sta.ssid, sizeof(stationConfig.sta.ssid), "%s", stationSsid.c_str());
+  if (connect) {
+    simStartConnect();
+  }
+  return WL_DISCONNECTED;
+}
+
+// A zero address switches back to DHCP
+bool WiFiClass::config(IPAddress localIP, IPAddress gateway, IPAddress subnet, IPAddress dns1, IPAddress dns2) {
+  if ((uint32_t)localIP == 0 && staticIP != 0 && stationConnected) {
+    dhcpPending = true;
+  }
+  staticIP = localIP;
+  return true;
+}
+
+bool WiFiClass::reconnect() {
+  if (stationConnected) {
+    disconnect();
+  }
+  simStartConnect();
+  return true;
+}
+
+bool WiFiClass::disconnect(bool wifiOff, bool eraseAp) {
+  bool wasConnected = stationConnected;
+  stationConnected = false;
+  connectPending = false;
+  dhcpPending = false;
+  if (wasConnected) {
+    fireEvent(ARDUINO_EVENT_WIFI_STA_DISCONNECTED, WIFI_REASON_ASSOC_LEAVE);
+  }
+  if (wifiOff) {
+    mode(WIFI_OFF);
+  }
+  return true;
+}
+
+wl_status_t WiFiClass::status() {
+  if (stationConnected) {
+    return WL_CONNECTED;
+  }
+  return connectPending || stationSsid.empty() ? WL_DISCONNECTED : WL_NO_SSID_AVAIL;
+}
+
+IPAddress WiFiClass::localIP() {
+  IPAddress ip;
+  if (staticIP != 0) {
+    ip = stationConnected ? IPAddress(staticIP) : IPAddress();
+  } else if (stationConnected && !dhcpPending) {
+    ip.fromString(simOptions.localIP.c_str());
+  }
+  return ip;
+}
+
+IPAddress WiFiClass::gatewayIP() {
+  IPAddress ip = localIP();
+  return stationConnected ? IPAddress(ip[0], ip[1], ip[2], 1) : IPAddress();
+}
+
+IPAddress WiFiClass::subnetMask() {
+  return stationConnected ? IPAddress(255, 255, 255, 0) : IPAddress();
+}
+
+uint8_t* WiFiClass::BSSID() {
+  static uint8_t bssid[6] = { 0x02, 0x51, 0x4D, 0x00, 0x00, 0x01 };
+  return stationConnected ? bssid : nullptr;
+}
+
+uint8_t* WiFiClass::macAddress(uint8_t* mac) {
+  unsigned int bytes[6] = {};
+  sscanf(simOptions.macAddress.c_str(), "%x:%x:%x:%x:%x:%x",
+         &bytes[0], &bytes[1], &bytes[2], &bytes[3], &bytes[4], &bytes[5]);
+  for (int i = 0; i < 6; i++) {
+    mac[i] = bytes[i];
+  }
+  return mac;
+}
+
+String WiFiClass::macAddress() {
+  uint8_t mac[6];
+  macAddress(mac);
+  char text[18];
+  snprintf(text, sizeof(text), "%02X:%02X:%02X:%02X:%02X:%02X", mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+  return String(text);
+}
+
+bool WiFiClass::softAP(const char* ssid, const char* passphrase, int channel, int hidden, int maxConnections) {
+  if (passphrase != nullptr && passphrase[0] != '\0' && strlen(passphrase) < 8) {
+    return false;
+  }
+  currentMode = (wifi_mode_t)(currentMode | WIFI_AP);
+  if (!accessPointActive) {
+    accessPointActive = true;
+    fireEvent(ARDUINO_EVENT_WIFI_AP_START);
+  }
+  return true;
+}
+
+bool WiFiClass::softAPdisconnect(bool wifiOff) {
+  if (accessPointActive) {
+    accessPointActive = false;
+    fireEvent(ARDUINO_EVENT_WIFI_AP_STOP);
+  }
+  if (wifiOff) {
+    currentMode = (wifi_mode_t)(currentMode & ~WIFI_AP);
+  }
+  return true;
+}
+
+IPAddress WiFiClass::softAPIP() {
+  return accessPointActive ? IPAddress(192, 168, 4, 1) : IPAddress();
+}
+
+// The configured network plus two neighbours; results appear after a delay
+int16_t WiFiClass::scanNetworks(bool async, bool showHidden, bool passive, uint32_t maxMsPerChannel,
+                                uint8_t channel, const char* ssid, const uint8_t* bssid) {
+  scanResults.clear();
+  scanResults.push_back({ simOptions.wifiSsid.empty() ? "SimulatedAP" : simOptions.wifiSsid,
+                          -55, 6, WIFI_AUTH_WPA2_PSK });
+  scanResults.push_back({ "Neighbour", -78, 11, WIFI_AUTH_WPA2_PSK });
+  scanResults.push_back({ "Observatory-Guest", -84, 1, WIFI_AUTH_OPEN });
+
+  scanRunning = true;
+  scanDoneAtUs = simMicros64() + SIM_SCAN_DURATION_US;
+  if (async) {
+    return WIFI_SCAN_RUNNING;
+  }
+  while (scanComplete() == WIFI_SCAN_RUNNING) {
+    delay(10);
+  }
+  return scanResults.size();
+}
+
+int16_t WiFiClass::scanComplete() {
+  if (scanRunning) {
+    if (simMicros64() < scanDoneAtUs) {
+      return WIFI_SCAN_RUNNING;
+    }
+    scanRunning = false;
+    fireEvent(ARDUINO_EVENT_WIFI_SCAN_DONE);
+  }
+  return scanResults.empty() ? WIFI_SCAN_FAILED : (int16_t)scanResults.size();
+}
+
+void WiFiClass::scanDelete() {
+  scanResults.clear();
+}
+
+String WiFiClass::SSID(uint8_t index) const {
+  return index < scanResults.size() ? String(scanResults[index].ssid.c_str()) : String();
+}
+
+int32_t WiFiClass::RSSI(uint8_t index) const {
+  return index < scanResults.size() ? scanResults[index].rssi : 0;
+}
+
+int32_t WiFiClass::channel(uint8_t index) const {
+  return index < scanResults.size() ? scanResults[index].channel : 0;
+}
+
+wifi_auth_mode_t WiFiClass::encryptionType(uint8_t index) const {
+  return index < scanResults.size() ? scanResults[index].encryption : WIFI_AUTH_OPEN;
+}
+
+wifi_event_id_t WiFiClass::onEvent(WiFiEventCb callback, arduino_event_id_t event) {
+  return onEvent([callback](arduino_event_id_t id, arduino_event_info_t) { callback(id); }, event);
+}
+
+wifi_event_id_t WiFiClass::onEvent(WiFiEventFuncCb callback, arduino_event_id_t event) {
+  eventHandlers.push_back({ nextEventId, event, callback });
+  return nextEventId++;
+}
+
+void WiFiClass::removeEvent(wifi_event_id_t id) {
+  for (auto handler = eventHandlers.begin(); handler != eventHandlers.end(); ++handler) {
+    if (handler->id == id) {
+      eventHandlers.erase(handler);
+      return;
+    }
+  }
+}
+
+// Queued for the next simPoll()
+void WiFiClass::fireEvent(arduino_event_id_t event, uint8_t reason) {
+  arduino_event_t queued = {};
+  queued.event_id = event;
+  if (event == ARDUINO_EVENT_WIFI_STA_DISCONNECTED) {
+    queued.event_info.wifi_sta_disconnected.reason = reason;
+  }
+  pendingEvents.push_back(queued);
+}
+
+void WiFiClass::simStartConnect() {
+  connectPending = true;
+  connectAtUs = simMicros64() + simOptions.wifiConnectDelayMs * 1000ULL;
+}
+
+// Hand out a requested DHCP lease and finish a pending association (the
+// network exists, or the attempt fails), then deliver the queued events
+void WiFiClass::simPoll() {
+  if (dhcpPending) {
+    dhcpPending = false;
+    fireEvent(ARDUINO_EVENT_WIFI_STA_GOT_IP);
+  }
+  if (connectPending && simMicros64() >= connectAtUs) {
+    connectPending = false;
+    if (simOptions.wifiSsid.empty() || simOptions.wifiSsid == stationSsid) {
+      stationConnected = true;
+      fireEvent(ARDUINO_EVENT_WIFI_STA_CONNECTED);
+      fireEvent(ARDUINO_EVENT_WIFI_STA_GOT_IP);
+    } else {
+      fireEvent(ARDUINO_EVENT_WIFI_STA_DISCONNECTED, WIFI_REASON_NO_AP_FOUND);
+    }
+  }
+
+  std::vector<arduino_event_t> events;
+  events.swap(pendingEvents);
+  for (const arduino_event_t& queued : events) {
+    for (const EventHandler& handler : eventHandlers) {
+      if (handler.event == ARDUINO_EVENT_MAX || handler.event == queued.event_id) {
+        handler.callback(queued.event_id, queued.event_info);
+      }
+    }
+  }
+}
+
+void WiFiClass::simDropLink() {
+  if (stationConnected) {
+    stationConnected = false;
+    fireEvent(ARDUINO_EVENT_WIFI_STA_DISCONNECTED, WIFI_REASON_BEACON_TIMEOUT);
+  }
+}
+
+void simWiFiPoll() {
+  WiFi.simPoll();
+}
+
+void simWiFiDropLink() {
+  WiFi.simDropLink();
+}
+
+esp_err_t esp_wifi_get_config(wifi_interface_t interface, wifi_config_t* config) {
+  if (interface != WIFI_IF_STA || config == nullptr) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  *config = stationConfig;
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_config(wifi_interface_t interface, wifi_config_t* config) {
+  if (interface != WIFI_IF_STA || config == nullptr) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  stationConfig = *config;
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_connect() {
+  WiFi.simStartConnect();
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_disconnect() {
+  WiFi.disconnect();
+  return ESP_OK;
+}
@@ -0,0 +1,217 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Simulator WiFi Header
+ *
+ * The station "connects" a short while after esp_wifi_connect() and then
+ * reports the host as its address, or the one given to config(); going back
+ * to DHCP while connected brings a new GOT_IP on the next poll. Events are
+ * queued and delivered from simPoll() between loop() passes, so like the
+ * event task on the device they arrive after the call that caused them. WiFiClient wraps a real TCP socket.
+ */
+
+#ifndef SIM_WIFI_H
+#define SIM_WIFI_H
+
+#include "Arduino.h"
+#include "esp_wifi.h"
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+typedef enum {
+  WL_NO_SHIELD = 255,
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL = 1,
+  WL_SCAN_COMPLETED = 2,
+  WL_CONNECTED = 3,
+  WL_CONNECT_FAILED = 4,
+  WL_CONNECTION_LOST = 5,
+  WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum { WIFI_OFF = 0, WIFI_STA = 1, WIFI_AP = 2, WIFI_AP_STA = 3 } wifi_mode_t;
+typedef enum { WIFI_AUTH_OPEN = 0, WIFI_AUTH_WEP, WIFI_AUTH_WPA_PSK, WIFI_AUTH_WPA2_PSK } wifi_auth_mode_t;
+typedef enum { WIFI_PS_NONE = 0, WIFI_PS_MIN_MODEM = 1, WIFI_PS_MAX_MODEM = 2 } wifi_ps_type_t;
+
+typedef enum {
+  WIFI_POWER_19_5dBm = 78,
+  WIFI_POWER_19dBm = 76,
+  WIFI_POWER_18_5dBm = 74,
+  WIFI_POWER_17dBm = 68,
+  WIFI_POWER_15dBm = 60,
+  WIFI_POWER_13dBm = 52,
+  WIFI_POWER_11dBm = 44,
+  WIFI_POWER_8_5dBm = 34,
+  WIFI_POWER_7dBm = 28,
+  WIFI_POWER_5dBm = 20,
+  WIFI_POWER_2dBm = 8
+} wifi_power_t;
+
+#define WIFI_SCAN_RUNNING (-1)
+#define WIFI_SCAN_FAILED (-2)
+
+typedef enum {
+  ARDUINO_EVENT_WIFI_READY = 0,
+  ARDUINO_EVENT_WIFI_SCAN_DONE,
+  ARDUINO_EVENT_WIFI_STA_START,
+  ARDUINO_EVENT_WIFI_STA_STOP,
+  ARDUINO_EVENT_WIFI_STA_CONNECTED,
+  ARDUINO_EVENT_WIFI_STA_DISCONNECTED,
+  ARDUINO_EVENT_WIFI_STA_AUTHMODE_CHANGE,
+  ARDUINO_EVENT_WIFI_STA_GOT_IP,
+  ARDUINO_EVENT_WIFI_STA_LOST_IP,
+  ARDUINO_EVENT_WIFI_AP_START,
+  ARDUINO_EVENT_WIFI_AP_STOP,
+  ARDUINO_EVENT_MAX
+} arduino_event_id_t;
+
+typedef union {
+  wifi_event_sta_disconnected_t wifi_sta_disconnected;
+} arduino_event_info_t;
+
+typedef struct {
+  arduino_event_id_t event_id;
+  arduino_event_info_t event_info;
+} arduino_event_t;
+
+typedef int wifi_event_id_t;
+typedef void (*WiFiEventCb)(arduino_event_id_t event);
+typedef std::function<void(arduino_event_id_t event, arduino_event_info_t info)> WiFiEventFuncCb;
+
+class SimSocket;
+
+// TCP connection; copies share the socket, which closes with the last copy or stop()
+class WiFiClient : public Stream {
+public:
+  WiFiClient() {}
+  explicit WiFiClient(int fd);
+
+  int connect(IPAddress ip, uint16_t port);
+  int connect(const char* host, uint16_t port);
+
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t* buffer, size_t size) override;
+  using Print::write;
+  int availableForWrite() override;
+
+  int available() override;
+  int read() override;
+  int read(uint8_t* buffer, size_t size);
+  int peek() override;
+  void flush() override {}
+
+  uint8_t connected();
+  void stop();
+  operator bool() const { return socket != nullptr; }
+  bool operator==(const WiFiClient& other) const { return socket == other.socket; }
+
+  IPAddress remoteIP() const;
+  uint16_t remotePort() const;
+  IPAddress localIP() const;
+  uint16_t localPort() const;
+  int setNoDelay(bool noDelay);
+  int fd() const;
+  void setTimeout(uint32_t seconds) { Stream::setTimeout(seconds * 1000); }
+
+private:
+  std::shared_ptr<SimSocket> socket;
+};
+
+typedef WiFiClient NetworkClient;
+
+struct SimScanEntry {
+  std::string ssid;
+  int32_t rssi;
+  int32_t channel;
+  wifi_auth_mode_t encryption;
+};
+
+class WiFiClass {
+public:
+  bool mode(wifi_mode_t newMode);
+  wifi_mode_t getMode() { return currentMode; }
+
+  wl_status_t begin(const char* ssid, const char* passphrase = nullptr, int32_t channel = 0,
+                    const uint8_t* bssid = nullptr, bool connect = true);
+  bool config(IPAddress localIP, IPAddress gateway, IPAddress subnet,
+              IPAddress dns1 = IPAddress(), IPAddress dns2 = IPAddress());
+  bool reconnect();
+  bool disconnect(bool wifiOff = false, bool eraseAp = false);
+  wl_status_t status();
+  bool isConnected() { return status() == WL_CONNECTED; }
+  bool setAutoReconnect(bool autoReconnect) { return true; }
+  bool setHostname(const char* name) { hostname = name; return true; }
+  const char* getHostname() { return hostname.c_str(); }
+
+  IPAddress localIP();
+  IPAddress gatewayIP();
+  IPAddress subnetMask();
+  IPAddress dnsIP(uint8_t index = 0) { return gatewayIP(); }
+  String SSID() const { return stationConnected ? String(stationSsid.c_str()) : String(); }
+  int32_t RSSI() { return stationConnected ? -55 : 0; }
+  uint8_t* BSSID();
+  int32_t channel() { return stationConnected ? 6 : 0; }
+  uint8_t* macAddress(uint8_t* mac);
+  String macAddress();
+
+  bool softAP(const char* ssid, const char* passphrase = nullptr, int channel = 1,
+              int hidden = 0, int maxConnections = 4);
+  bool softAPdisconnect(bool wifiOff = false);
+  IPAddress softAPIP();
+  uint8_t softAPgetStationNum() { return 0; }
+
+  bool setSleep(bool enabled) { return true; }
+  bool setSleep(wifi_ps_type_t type) { return true; }
+  bool setTxPower(wifi_power_t power) { txPower = power; return true; }
+  wifi_power_t getTxPower() { return txPower; }
+
+  int16_t scanNetworks(bool async = false, bool showHidden = false, bool passive = false,
+                       uint32_t maxMsPerChannel = 300, uint8_t channel = 0,
+                       const char* ssid = nullptr, const uint8_t* bssid = nullptr);
+  int16_t scanComplete();
+  void scanDelete();
+  String SSID(uint8_t index) const;
+  int32_t RSSI(uint8_t index) const;
+  int32_t channel(uint8_t index) const;
+  wifi_auth_mode_t encryptionType(uint8_t index) const;
+
+  wifi_event_id_t onEvent(WiFiEventCb callback, arduino_event_id_t event = ARDUINO_EVENT_MAX);
+  wifi_event_id_t onEvent(WiFiEventFuncCb callback, arduino_event_id_t event = ARDUINO_EVENT_MAX);
+  void removeEvent(wifi_event_id_t id);
+
+  // Simulator side
+  void simStartConnect();
+  void simPoll();
+  void simDropLink();
+
+private:
+  struct EventHandler {
+    wifi_event_id_t id;
+    arduino_event_id_t event;
+    WiFiEventFuncCb callback;
+  };
+
+  void fireEvent(arduino_event_id_t event, uint8_t reason = 0);
+
+  wifi_mode_t currentMode = WIFI_OFF;
+  std::string stationSsid;
+  std::string hostname = "esp32";
+  bool stationConnected = false;
+  bool connectPending = false;
+  uint32_t staticIP = 0;                // From config(), 0 = DHCP
+  bool dhcpPending = false;             // Switched to DHCP while connected, lease not yet "received"
+  uint64_t connectAtUs = 0;
+  bool accessPointActive = false;
+  wifi_power_t txPower = WIFI_POWER_19_5dBm;
+  std::vector<EventHandler> eventHandlers;
+  std::vector<arduino_event_t> pendingEvents;
+  wifi_event_id_t nextEventId = 1;
+  std::vector<SimScanEntry> scanResults;
+  bool scanRunning = false;
+  uint64_t scanDoneAtUs = 0;
+};
+
+extern WiFiClass WiFi;
+
+#endif // SIM_WIFI_H
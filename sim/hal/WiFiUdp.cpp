@@ -0,0 +1,98 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Simulator UDP Implementation
+ */
+
+#include "WiFiUdp.h"
+#include "sim.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define SIM_UDP_MAX_PACKET 1460 // lwIP's default UDP receive size
+
+uint8_t WiFiUDP::begin(uint16_t port) {
+  stop();
+  fd = socket(AF_INET, SOCK_DGRAM, 0);
+  if (fd < 0) {
+    return 0;
+  }
+  int enable = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+  setsockopt(fd, SOL_SOCKET, SO_BROADCAST, &enable, sizeof(enable));
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+  struct sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(simMapPort(port));
+  address.sin_addr.s_addr = inet_addr(simOptions.bindAddress.c_str());
+  if (bind(fd, (struct sockaddr*)&address, sizeof(address)) != 0) {
+    fprintf(stderr, "sim: UDP port %u: %s\n", simMapPort(port), strerror(errno));
+    stop();
+    return 0;
+  }
+  return 1;
+}
+
+void WiFiUDP::stop() {
+  if (fd >= 0) {
+    close(fd);
+    fd = -1;
+  }
+  flush();
+}
+
+int WiFiUDP::parsePacket() {
+  flush();
+  if (fd < 0) {
+    return 0;
+  }
+  rxBuffer.resize(SIM_UDP_MAX_PACKET);
+  struct sockaddr_in address = {};
+  socklen_t length = sizeof(address);
+  ssize_t count = recvfrom(fd, rxBuffer.data(), rxBuffer.size(), 0, (struct sockaddr*)&address, &length);
+  if (count <= 0) {
+    rxBuffer.clear();
+    return 0;
+  }
+  rxBuffer.resize(count);
+  remoteAddress = IPAddress(address.sin_addr.s_addr);
+  remotePortNumber = ntohs(address.sin_port);
+  return count;
+}
+
+int WiFiUDP::read() {
+  return available() > 0 ? rxBuffer[rxOffset++] : -1;
+}
+
+int WiFiUDP::read(uint8_t* buffer, size_t size) {
+  size_t count = std::min(size, (size_t)available());
+  memcpy(buffer, rxBuffer.data() + rxOffset, count);
+  rxOffset += count;
+  return count;
+}
+
+int WiFiUDP::beginPacket(IPAddress ip, uint16_t port) {
+  txBuffer.clear();
+  txAddress = ip;
+  txPort = port;
+  return fd >= 0 ? 1 : 0;
+}
+
+size_t WiFiUDP::write(const uint8_t* buffer, size_t size) {
+  txBuffer.insert(txBuffer.end(), buffer, buffer + size);
+  return size;
+}
+
+int WiFiUDP::endPacket() {
+  struct sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(simMapPort(txPort));
+  address.sin_addr.s_addr = (uint32_t)txAddress;
+  ssize_t count = sendto(fd, txBuffer.data(), txBuffer.size(), 0, (struct sockaddr*)&address, sizeof(address));
+  txBuffer.clear();
+  return count >= 0 ? 1 : 0;
+}
@@ -0,0 +1,51 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Simulator UDP Header
+ *
+ * Real non-blocking UDP socket with broadcast enabled, so Alpaca discovery
+ * works from other hosts on the LAN. Ports below 1024 are moved by the port
+ * offset when sending as well as when binding, so a test can play the DHCP
+ * server on ports 67 and 68 without root.
+ */
+
+#ifndef SIM_WIFIUDP_H
+#define SIM_WIFIUDP_H
+
+#include "WiFi.h"
+#include <vector>
+
+class WiFiUDP : public Stream {
+public:
+  ~WiFiUDP() { stop(); }
+
+  uint8_t begin(uint16_t port);
+  void stop();
+
+  int parsePacket();
+  int available() override { return rxBuffer.size() - rxOffset; }
+  int read() override;
+  int read(uint8_t* buffer, size_t size);
+  int read(char* buffer, size_t size) { return read((uint8_t*)buffer, size); }
+  int peek() override { return available() > 0 ? rxBuffer[rxOffset] : -1; }
+  void flush() override { rxBuffer.clear(); rxOffset = 0; }
+  IPAddress remoteIP() const { return remoteAddress; }
+  uint16_t remotePort() const { return remotePortNumber; }
+
+  int beginPacket(IPAddress ip, uint16_t port);
+  int endPacket();
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t* buffer, size_t size) override;
+  using Print::write;
+
+private:
+  int fd = -1;
+  std::vector<uint8_t> rxBuffer;
+  size_t rxOffset = 0;
+  IPAddress remoteAddress;
+  uint16_t remotePortNumber = 0;
+  std::vector<uint8_t> txBuffer;
+  IPAddress txAddress;
+  uint16_t txPort = 0;
+};
+
+#endif // SIM_WIFIUDP_H
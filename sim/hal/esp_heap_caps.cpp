@@ -0,0 +1,118 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Simulator Heap Capabilities Implementation
+ */
+
+#include "esp_heap_caps.h"
+#include "sim.h"
+#include <errno.h>
+#include <malloc.h>
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void* ptr);
+}
+
+// Live allocations of the whole process, counted from before main()
+static size_t liveBytes = 0;
+static size_t liveBlocks = 0;
+static size_t peakLiveBytes = 0;
+
+static void countAllocation(void* ptr) {
+  if (ptr == nullptr) {
+    return;
+  }
+  size_t size = malloc_usable_size(ptr);
+  liveBytes += size;
+  liveBlocks++;
+  if (liveBytes > peakLiveBytes) {
+    peakLiveBytes = liveBytes;
+  }
+  if (esp_heap_trace_alloc_hook != nullptr) {
+    esp_heap_trace_alloc_hook(ptr, size, MALLOC_CAP_8BIT);
+  }
+}
+
+static void countFree(void* ptr) {
+  if (ptr == nullptr) {
+    return;
+  }
+  liveBytes -= malloc_usable_size(ptr);
+  liveBlocks--;
+  if (esp_heap_trace_free_hook != nullptr) {
+    esp_heap_trace_free_hook(ptr);
+  }
+}
+
+extern "C" void* malloc(size_t size) {
+  void* ptr = __libc_malloc(size);
+  countAllocation(ptr);
+  return ptr;
+}
+
+extern "C" void* calloc(size_t count, size_t size) {
+  void* ptr = __libc_calloc(count, size);
+  countAllocation(ptr);
+  return ptr;
+}
+
+extern "C" void* realloc(void* ptr, size_t size) {
+  countFree(ptr);
+  void* result = __libc_realloc(ptr, size);
+  // A failed realloc leaves the old block in place
+  countAllocation(result != nullptr || size == 0 ? result : ptr);
+  return result;
+}
+
+extern "C" void* memalign(size_t alignment, size_t size) {
+  void* ptr = __libc_memalign(alignment, size);
+  countAllocation(ptr);
+  return ptr;
+}
+
+extern "C" void* aligned_alloc(size_t alignment, size_t size) {
+  return memalign(alignment, size);
+}
+
+extern "C" int posix_memalign(void** result, size_t alignment, size_t size) {
+  *result = memalign(alignment, size);
+  return *result != nullptr ? 0 : ENOMEM;
+}
+
+extern "C" void free(void* ptr) {
+  countFree(ptr);
+  __libc_free(ptr);
+}
+
+static size_t freeBytes(size_t used) {
+  return used < simOptions.heapSize ? simOptions.heapSize - used : 0;
+}
+
+size_t heap_caps_get_free_size(uint32_t caps) {
+  return freeBytes(liveBytes);
+}
+
+size_t heap_caps_get_minimum_free_size(uint32_t caps) {
+  return freeBytes(peakLiveBytes);
+}
+
+size_t heap_caps_get_largest_free_block(uint32_t caps) {
+  struct mallinfo2 info = mallinfo2();
+  size_t holes = info.fordblks - info.keepcost;
+  size_t available = heap_caps_get_free_size(caps);
+  return available > holes ? available - holes : 0;
+}
+
+void heap_caps_get_info(multi_heap_info_t* info, uint32_t caps) {
+  struct mallinfo2 arena = mallinfo2();
+  info->total_free_bytes = heap_caps_get_free_size(caps);
+  info->total_allocated_bytes = liveBytes;
+  info->largest_free_block = heap_caps_get_largest_free_block(caps);
+  info->minimum_free_bytes = heap_caps_get_minimum_free_size(caps);
+  info->allocated_blocks = liveBlocks;
+  info->free_blocks = arena.ordblks + arena.smblks;
+  info->total_blocks = info->allocated_blocks + info->free_blocks;
+}
@@ -0,0 +1,39 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Simulator Heap Capabilities Header
+ *
+ * Every host malloc/free is counted and measured against the simulated heap
+ * size. glibc does not report its largest free block, so it is estimated as
+ * the free heap minus the bytes stuck in free chunks below the top of the
+ * arena - the part first-fit allocation can no longer hand out in one piece.
+ */
+
+#ifndef SIM_ESP_HEAP_CAPS_H
+#define SIM_ESP_HEAP_CAPS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MALLOC_CAP_8BIT (1 << 2)
+#define MALLOC_CAP_DEFAULT (1 << 12)
+
+typedef struct {
+  size_t total_free_bytes;
+  size_t total_allocated_bytes;
+  size_t largest_free_block;
+  size_t minimum_free_bytes;
+  size_t allocated_blocks;
+  size_t free_blocks;
+  size_t total_blocks;
+} multi_heap_info_t;
+
+size_t heap_caps_get_free_size(uint32_t caps);
+size_t heap_caps_get_minimum_free_size(uint32_t caps);
+size_t heap_caps_get_largest_free_block(uint32_t caps);
+void heap_caps_get_info(multi_heap_info_t* info, uint32_t caps);
+
+// Defined by the firmware when it wants every allocation reported
+extern "C" void esp_heap_trace_alloc_hook(void* ptr, size_t size, uint32_t caps) __attribute__((weak));
+extern "C" void esp_heap_trace_free_hook(void* ptr) __attribute__((weak));
+
+#endif // SIM_ESP_HEAP_CAPS_H
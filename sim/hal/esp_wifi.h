@@ -0,0 +1,49 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Simulator esp_wifi Header
+ */
+
+#ifndef SIM_ESP_WIFI_H
+#define SIM_ESP_WIFI_H
+
+#include <stdint.h>
+
+typedef int esp_err_t;
+#define ESP_OK 0
+#define ESP_FAIL -1
+#define ESP_ERR_INVALID_ARG 0x102
+
+typedef enum { WIFI_IF_STA = 0, WIFI_IF_AP = 1 } wifi_interface_t;
+
+typedef struct {
+  uint8_t ssid[32];
+  uint8_t password[64];
+  uint8_t channel;
+  uint16_t listen_interval;
+} wifi_sta_config_t;
+
+typedef union {
+  wifi_sta_config_t sta;
+} wifi_config_t;
+
+// Disconnect reasons the simulator reports
+typedef enum {
+  WIFI_REASON_ASSOC_LEAVE = 8,          // This station left (disconnect(), mode change)
+  WIFI_REASON_BEACON_TIMEOUT = 200,
+  WIFI_REASON_NO_AP_FOUND = 201
+} wifi_err_reason_t;
+
+typedef struct {
+  uint8_t ssid[32];
+  uint8_t ssid_len;
+  uint8_t bssid[6];
+  uint8_t reason;
+  int8_t rssi;
+} wifi_event_sta_disconnected_t;
+
+esp_err_t esp_wifi_get_config(wifi_interface_t interface, wifi_config_t* config);
+esp_err_t esp_wifi_set_config(wifi_interface_t interface, wifi_config_t* config);
+esp_err_t esp_wifi_connect();
+esp_err_t esp_wifi_disconnect();
+
+#endif // SIM_ESP_WIFI_H
@@ -0,0 +1,48 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Linux Simulator Control Implementation
+ */
+
+#include "sim.h"
+#include "ESPmDNS.h"
+#include <unistd.h>
+#include <vector>
+
+SimOptions simOptions;
+MDNSResponder MDNS;
+
+static std::vector<char*> savedArguments;
+
+void simInit(int argc, char** argv) {
+  savedArguments.assign(argv, argv + argc);
+  savedArguments.push_back(nullptr);
+  simSerialInit();
+  simPreferencesLoad();
+}
+
+void simPoll() {
+  simWiFiPoll();
+}
+
+void simShutdown() {
+  simPreferencesSave();
+  simPwmClose();
+}
+
+// Start over with the same arguments; every descriptor is closed first so
+// the new image can bind the same ports
+void simRestart() {
+  fprintf(stderr, "sim: restarting\n");
+  fflush(stdout);
+  simShutdown();
+  for (int fd = 3; fd < 1024; fd++) {
+    close(fd);
+  }
+  execv("/proc/self/exe", savedArguments.data());
+  perror("sim: restart");
+  _exit(1);
+}
+
+uint16_t simMapPort(uint16_t port) {
+  return port < 1024 ? port + simOptions.lowPortOffset : port;
+}
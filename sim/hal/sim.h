@@ -0,0 +1,77 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Linux Simulator Control Header
+ *
+ * Settings of the simulated board and the hooks sim_main.cpp drives between
+ * loop() passes. The Arduino stand-ins in this directory read their behaviour
+ * from here; the firmware itself never includes this file.
+ */
+
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdint.h>
+#include <string>
+
+enum SimClockMode {
+  SIM_CLOCK_REAL,                       // millis()/micros() follow the host clock, delay() sleeps
+  SIM_CLOCK_VIRTUAL                     // delay() advances time without sleeping
+};
+
+enum SimSerialMode {
+  SIM_SERIAL_PTY,                       // Serial is a pseudo terminal, path printed at startup
+  SIM_SERIAL_STDIO,                     // Serial is stdin/stdout
+  SIM_SERIAL_NONE                       // Output discarded, no input
+};
+
+struct SimOptions {
+  SimClockMode clockMode = SIM_CLOCK_REAL;
+  SimSerialMode serialMode = SIM_SERIAL_PTY;
+  std::string nvsFile;                  // Preferences backing file, empty = memory only
+  std::string pwmTraceFile;             // CSV of every ledcWrite(), empty = off
+  std::string bindAddress = "0.0.0.0";  // Interface the HTTP and UDP sockets listen on
+  std::string localIP = "127.0.0.1";    // Address the firmware reports as WiFi.localIP()
+  std::string wifiSsid;                 // Only this network "exists", empty = any SSID joins
+  std::string macAddress = "24:0A:C4:00:00:01";
+  uint16_t lowPortOffset = 8000;        // Added to ports below 1024 (80 -> 8080)
+  uint32_t wifiConnectDelayMs = 200;    // esp_wifi_connect() to GOT_IP
+  uint32_t heapSize = 327680;           // Reported by ESP.getHeapSize()
+};
+
+extern SimOptions simOptions;
+
+// Set up the simulated peripherals; argv is kept so ESP.restart() can re-exec
+void simInit(int argc, char** argv);
+
+// Deliver pending WiFi events and other asynchronous work; called before each loop()
+void simPoll();
+
+// Flush Preferences and the PWM trace before the process ends
+void simShutdown();
+
+// ESP.restart(): shut down and start the same binary again
+[[noreturn]] void simRestart();
+
+// Drop the simulated station link, as if the AP disappeared briefly
+void simWiFiDropLink();
+
+// Port actually bound for a firmware port number
+uint16_t simMapPort(uint16_t port);
+
+// 64-bit microseconds since start, the base of millis()/micros()
+uint64_t simMicros64();
+
+// Host monotonic microseconds, for timeouts that involve real peers
+uint64_t simHostMicros64();
+
+// Latest ledcWrite() duty on a pin, -1 if never written
+int32_t simGetPwmDuty(uint8_t pin);
+
+// Internal hooks between the stand-ins
+void simSerialInit();
+void simPreferencesLoad();
+void simPreferencesSave();
+void simWiFiPoll();
+void simPwmClose();
+
+#endif // SIM_H
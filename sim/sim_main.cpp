@@ -0,0 +1,124 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Linux Simulator Entry Point
+ *
+ * Runs the unmodified firmware against the stand-ins in sim/hal: setup()
+ * once, then loop() forever, with simulated peripherals serviced between
+ * passes the way the ESP32 core's background tasks would be.
+ *
+ *   SIGINT/SIGTERM  save Preferences and exit
+ *   SIGUSR1         drop the WiFi link once (the firmware should reconnect)
+ */
+
+#include <Arduino.h>
+#include <getopt.h>
+#include <signal.h>
+#include "hal/sim.h"
+
+void setup();
+void loop();
+
+static volatile sig_atomic_t stopRequested = 0;
+static volatile sig_atomic_t linkDropRequested = 0;
+
+static void onStopSignal(int) {
+  stopRequested = 1;
+}
+
+static void onLinkDropSignal(int) {
+  linkDropRequested = 1;
+}
+
+static void printUsage(const char* program) {
+  fprintf(stderr,
+    "Usage: %s [options]\n"
+    "  --serial pty|stdio|none   Serial console (default pty)\n"
+    "  --nvs FILE                Keep Preferences in FILE across runs\n"
+    "  --pwm-trace FILE          Write every PWM duty change to FILE as CSV\n"
+    "  --clock real|virtual      Virtual time advances only in delay()\n"
+    "  --bind ADDRESS            Listen address for HTTP and UDP (default 0.0.0.0)\n"
+    "  --ip ADDRESS              Address reported by WiFi.localIP() (default 127.0.0.1)\n"
+    "  --wifi-ssid SSID          Only this network can be joined (default any)\n"
+    "  --port-offset N           Added to ports below 1024 (default 8000)\n",
+    program);
+}
+
+static void parseOptions(int argc, char** argv) {
+  static const struct option options[] = {
+    { "serial", required_argument, nullptr, 's' },
+    { "nvs", required_argument, nullptr, 'n' },
+    { "pwm-trace", required_argument, nullptr, 'p' },
+    { "clock", required_argument, nullptr, 'c' },
+    { "bind", required_argument, nullptr, 'b' },
+    { "ip", required_argument, nullptr, 'i' },
+    { "wifi-ssid", required_argument, nullptr, 'w' },
+    { "port-offset", required_argument, nullptr, 'o' },
+    { "help", no_argument, nullptr, 'h' },
+    { nullptr, 0, nullptr, 0 }
+  };
+
+  int option;
+  while ((option = getopt_long(argc, argv, "h", options, nullptr)) != -1) {
+    switch (option) {
+      case 's':
+        if (strcmp(optarg, "pty") == 0) {
+          simOptions.serialMode = SIM_SERIAL_PTY;
+        } else if (strcmp(optarg, "stdio") == 0) {
+          simOptions.serialMode = SIM_SERIAL_STDIO;
+        } else if (strcmp(optarg, "none") == 0) {
+          simOptions.serialMode = SIM_SERIAL_NONE;
+        } else {
+          printUsage(argv[0]);
+          exit(2);
+        }
+        break;
+      case 'n':
+        simOptions.nvsFile = optarg;
+        break;
+      case 'p':
+        simOptions.pwmTraceFile = optarg;
+        break;
+      case 'c':
+        simOptions.clockMode = strcmp(optarg, "virtual") == 0 ? SIM_CLOCK_VIRTUAL : SIM_CLOCK_REAL;
+        break;
+      case 'b':
+        simOptions.bindAddress = optarg;
+        break;
+      case 'i':
+        simOptions.localIP = optarg;
+        break;
+      case 'w':
+        simOptions.wifiSsid = optarg;
+        break;
+      case 'o':
+        simOptions.lowPortOffset = atoi(optarg);
+        break;
+      default:
+        printUsage(argv[0]);
+        exit(option == 'h' ? 0 : 2);
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  parseOptions(argc, argv);
+  simInit(argc, argv);
+
+  signal(SIGINT, onStopSignal);
+  signal(SIGTERM, onStopSignal);
+  signal(SIGUSR1, onLinkDropSignal);
+  signal(SIGPIPE, SIG_IGN);
+
+  setup();
+  while (!stopRequested) {
+    if (linkDropRequested) {
+      linkDropRequested = 0;
+      simWiFiDropLink();
+    }
+    simPoll();
+    loop();
+  }
+
+  simShutdown();
+  return 0;
+}
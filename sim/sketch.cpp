@@ -0,0 +1,10 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Simulator Sketch Unit
+ *
+ * The Arduino builder compiles main.ino as C++ after prepending Arduino.h;
+ * this unit does the same for the host build.
+ */
+
+#include <Arduino.h>
+#include "../main/main.ino"
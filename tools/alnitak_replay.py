@@ -0,0 +1,136 @@
+#!/usr/bin/env python3
+"""
+ESP32 ASCOM Alpaca Flat Panel Calibrator
+Alnitak driver transcript replay
+
+Switches the serial port to the Alnitak personality and replays the driver
+transcripts in tools/transcripts against it: each "> " line is sent as is,
+each "< " line is a regular expression the next reply line must match in
+full. A command the transcript expects no reply to must get none, or the
+reply shows up against the next expectation. The personality is set back to
+NATIVE afterwards. The run fails on the first mismatch or missing reply in
+each transcript.
+
+Against the simulator's pty (see README, Development > Simulator):
+
+    python3 tools/alnitak_replay.py --sim build/sim/flatpanel-sim
+
+Against a device, optionally with one transcript:
+
+    python3 tools/alnitak_replay.py --port /dev/ttyUSB0 tools/transcripts/alnitak_indi.txt
+"""
+
+import argparse
+import codecs
+import glob
+import os
+import re
+
+from flatpanel_binary import open_port
+from sim_harness import finish, start_simulator
+
+TRANSCRIPT_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "transcripts")
+
+
+def load_transcript(path):
+    """List of ("send", bytes) and ("expect", pattern, line number) steps"""
+    steps = []
+    with open(path, encoding="utf-8") as f:
+        for number, line in enumerate(f, 1):
+            line = line.rstrip("\n")
+            if line.startswith("> "):
+                steps.append(("send", codecs.decode(line[2:], "unicode_escape").encode("latin-1"), number))
+            elif line.startswith("< "):
+                steps.append(("expect", re.compile(line[2:]), number))
+            elif line.strip() and not line.startswith("#"):
+                raise ValueError("%s:%d: not a > or < line" % (path, number))
+    return steps
+
+
+class LineReader:
+    def __init__(self, port):
+        self.port = port
+        self.pending = b""
+
+    def line(self):
+        """Next non-empty reply line without its line ending, or None on timeout"""
+        while True:
+            while b"\n" not in self.pending:
+                data = self.port.read(256)
+                if not data:
+                    return None
+                self.pending += data
+            line, self.pending = self.pending.split(b"\n", 1)
+            line = line.strip(b"\r").decode(errors="replace")
+            if line:
+                return line
+
+
+def set_personality(port, reader, name):
+    port.write(b"PERSONALITY %s\r\n" % name.encode())
+    while True:
+        line = reader.line()
+        if line is None:
+            raise TimeoutError("no reply to PERSONALITY %s" % name)
+        if line == "Personality: %s" % name:
+            return
+
+
+def replay(port, reader, path):
+    """Returns a failure description, or None if every reply matched"""
+    name = os.path.basename(path)
+    for step in load_transcript(path):
+        if step[0] == "send":
+            port.write(step[1])
+            continue
+        _, pattern, number = step
+        line = reader.line()
+        if line is None:
+            return "%s:%d: no reply, expected %s" % (name, number, pattern.pattern)
+        if not pattern.fullmatch(line):
+            return "%s:%d: reply %r does not match %s" % (name, number, line, pattern.pattern)
+    return None
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Replay Alnitak driver transcripts against the serial port")
+    target_group = parser.add_mutually_exclusive_group(required=True)
+    target_group.add_argument("--port", help="serial device of the calibrator")
+    target_group.add_argument("--sim", help="simulator binary to start and test")
+    parser.add_argument("--port-offset", type=int, default=8000, help="simulator port offset (web UI on 80 + offset)")
+    parser.add_argument("--timeout", type=float, default=2, help="wait for each reply, seconds")
+    parser.add_argument("transcripts", nargs="*", help="transcript files (default: all in tools/transcripts)")
+    args = parser.parse_args()
+    paths = args.transcripts or sorted(glob.glob(os.path.join(TRANSCRIPT_DIR, "*.txt")))
+
+    process = None
+    path = args.port
+    if args.sim:
+        process, path = start_simulator(args.sim, args.port_offset, serial="pty")
+
+    failures = []
+    try:
+        port = open_port(path, timeout=args.timeout)
+        reader = LineReader(port)
+        set_personality(port, reader, "ALNITAK")
+        try:
+            for transcript in paths:
+                failure = replay(port, reader, transcript)
+                print("%-24s %s" % (os.path.basename(transcript), failure or "ok"))
+                if failure:
+                    failures.append(failure)
+                    # Let late replies of the failed transcript drain before the next one
+                    while reader.line() is not None:
+                        pass
+        finally:
+            set_personality(port, reader, "NATIVE")
+            port.close()
+    finally:
+        if process is not None:
+            process.terminate()
+            process.wait()
+    finish(failures)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,196 @@
+#!/usr/bin/env python3
+"""
+ESP32 ASCOM Alpaca Flat Panel Calibrator
+Auto-flat solver benchmark
+
+Runs flat sequences against a simulated panel and camera and counts the test
+frames each filter needs to land within tolerance of the target ADU, once
+driven by the device's "autoflat" action and once by the brightness bisection
+auto-flat routines use without it. The simulated panel is nonlinear (flux
+rises as brightness^gamma, with some leakage at the bottom of the range) and
+the camera adds bias, shot and read noise, frame-to-frame panel drift and
+saturation, so the solver sees what it would on a real rig.
+
+Each filter is run --runs times. The model is reset before every run, which
+keeps the slope learned earlier, as a new flat session on the same night
+would. Filters the panel cannot bring to the target even at the longest
+exposure are skipped. The run fails if the solver misses the target within
+--max-frames or needs more frames on average than bisection.
+
+Against the simulator (see README, Development > Simulator):
+
+    python3 tools/autoflat_bench.py --sim build/sim/flatpanel-sim
+
+Against a device (the panel's real light is not used, only its solver):
+
+    python3 tools/autoflat_bench.py --host 192.168.1.50 --runs 20 --noise 2
+"""
+
+import argparse
+import math
+import random
+
+import sim_harness
+from sim_harness import add_target_arguments, finish, open_target
+
+CLIENT_ID = 4343
+FULL_WELL_ADU = 65535
+TOLERANCE_PCT = 3
+
+# Filter name and relative throughput: broadband filters need a few percent
+# of the panel, narrowband ones run out of brightness before the target
+FILTERS = [("L", 1.0), ("R", 0.35), ("G", 0.4), ("B", 0.3), ("Ha", 0.03), ("OIII", 0.025)]
+
+
+class Panel:
+    """Flux in ADU per second at the camera, before filter and noise"""
+
+    def __init__(self, gamma, peak):
+        self.gamma = gamma
+        self.peak = peak
+        self.leak = peak * 0.002
+
+    def flux(self, brightness):
+        if brightness <= 0:
+            return 0.0
+        return self.leak + self.peak * (brightness / 100.0) ** self.gamma
+
+
+class Camera:
+    def __init__(self, rng, bias, read_noise, gain, noise_pct, pixels):
+        self.rng = rng
+        self.bias = bias
+        self.read_noise = read_noise
+        self.gain = gain
+        self.noise_pct = noise_pct
+        self.pixels = pixels
+
+    def median(self, flux, exposure):
+        # Panel drift between frames, then the per-pixel noise averaged over
+        # the pixels the median is taken from
+        signal = flux * exposure * (1 + self.rng.gauss(0, self.noise_pct / 100.0))
+        sigma = math.sqrt(max(0.0, signal) * self.gain + self.read_noise ** 2) / self.gain
+        value = self.bias + signal + self.rng.gauss(0, 1.25 * sigma / math.sqrt(self.pixels))
+        return min(FULL_WELL_ADU, max(0.0, value))
+
+
+def alpaca(target, verb, method, body=None):
+    reply = sim_harness.alpaca(target, verb, method, CLIENT_ID, 1, body)
+    if reply.get("ErrorNumber"):
+        raise RuntimeError("%s: %s" % (method, reply.get("ErrorMessage")))
+    return reply.get("Value")
+
+
+def action(target, name, parameters):
+    return alpaca(target, "PUT", "action", "Action=%s&Parameters=%s" % (name, parameters))
+
+
+def within(median, target, bias):
+    return abs(median - target) <= (target - bias) * TOLERANCE_PCT / 100.0
+
+
+def run_solver(target, filter_name, panel, camera, throughput, args):
+    action(target, "autoflatreset", filter_name)
+    brightness, exposure = args.start, args.exposure
+    for frame in range(1, args.max_frames + 1):
+        median = camera.median(panel.flux(brightness) * throughput, exposure)
+        parameters = "filter=%s,median=%.1f,exposure=%.4f,target=%d,bias=%d,brightness=%d" % (
+            filter_name, median, exposure, args.target, camera.bias, brightness)
+        reply = dict(item.split("=") for item in action(target, "autoflat", parameters).split(","))
+        if reply["converged"] == "true":
+            return frame
+        brightness = int(reply["brightness"])
+        exposure = min(args.max_exposure, max(args.min_exposure, float(reply["exposure"])))
+    return None
+
+
+def run_bisection(filter_name, panel, camera, throughput, args, max_brightness):
+    low, high = 0, max_brightness
+    brightness, exposure = args.start, args.exposure
+    for frame in range(1, args.max_frames + 1):
+        median = camera.median(panel.flux(brightness) * throughput, exposure)
+        if within(median, args.target, camera.bias):
+            return frame
+        if median > args.target:
+            high = brightness
+        else:
+            low = brightness
+        if high - low <= 1:
+            # Out of brightness steps: scale the exposure instead
+            scale = (args.target - camera.bias) / max(1.0, median - camera.bias)
+            exposure = min(args.max_exposure, max(args.min_exposure, exposure * scale))
+        else:
+            brightness = (low + high) // 2
+    return None
+
+
+def summary(frames):
+    hits = [count for count in frames if count is not None]
+    if not hits:
+        return "never converged"
+    return "mean %.2f  max %d  missed %d" % (sum(hits) / len(hits), max(hits), len(frames) - len(hits))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare the auto-flat solver against bisection")
+    add_target_arguments(parser)
+    parser.add_argument("--runs", type=int, default=10, help="flat sequences per filter")
+    parser.add_argument("--target", type=int, default=30000, help="target median ADU")
+    parser.add_argument("--start", type=int, default=50, help="brightness of the first test frame")
+    parser.add_argument("--exposure", type=float, default=2.0, help="exposure of the first test frame, seconds")
+    parser.add_argument("--min-exposure", type=float, default=0.1, help="shortest exposure the camera takes")
+    parser.add_argument("--max-exposure", type=float, default=30, help="longest exposure a flat may use")
+    parser.add_argument("--noise", type=float, default=1.0, help="panel drift between frames, percent")
+    parser.add_argument("--max-frames", type=int, default=15, help="give up on a sequence after this many frames")
+    parser.add_argument("--seed", type=int, default=1, help="random seed for the panel and camera")
+    args = parser.parse_args()
+
+    rng = random.Random(args.seed)
+    results = {}
+    with open_target(args) as target:
+        alpaca(target, "PUT", "connected", "Connected=true")
+        max_brightness = alpaca(target, "GET", "maxbrightness")
+        panel = Panel(gamma=rng.uniform(1.3, 1.8), peak=rng.uniform(20000, 60000))
+        camera = Camera(rng, bias=rng.choice((0, 500, 1000)), read_noise=3.5, gain=1.0,
+                        noise_pct=args.noise, pixels=10000)
+        for filter_name, throughput in FILTERS:
+            # A filter the panel cannot fill even at the longest exposure is
+            # left out rather than counted against either method
+            if camera.bias + panel.flux(max_brightness) * throughput * args.max_exposure < args.target:
+                results[filter_name] = None
+                continue
+            solver, bisection = [], []
+            for _ in range(args.runs):
+                solver.append(run_solver(target, filter_name, panel, camera, throughput, args))
+                bisection.append(run_bisection(filter_name, panel, camera, throughput, args, max_brightness))
+            results[filter_name] = (solver, bisection)
+        alpaca(target, "PUT", "connected", "Connected=false")
+
+    print("panel gamma %.2f, peak %.0f ADU/s, bias %d, drift %.1f%%" % (
+        panel.gamma, panel.peak, camera.bias, args.noise))
+    solver_all, bisection_all = [], []
+    for filter_name, result in results.items():
+        if result is None:
+            print("%-5s out of reach at %d%% and %.0f s" % (filter_name, max_brightness, args.max_exposure))
+            continue
+        solver, bisection = result
+        print("%-5s solver    %s" % (filter_name, summary(solver)))
+        print("%-5s bisection %s" % ("", summary(bisection)))
+        solver_all += solver
+        bisection_all += bisection
+    print("all   solver    %s" % summary(solver_all))
+    print("all   bisection %s" % summary(bisection_all))
+
+    failures = []
+    if None in solver_all:
+        failures.append("solver missed the target %d times" % solver_all.count(None))
+    solver_hits = [count for count in solver_all if count is not None]
+    bisection_hits = [count for count in bisection_all if count is not None]
+    if solver_hits and bisection_hits and \
+            sum(solver_hits) / len(solver_hits) > sum(bisection_hits) / len(bisection_hits):
+        failures.append("solver needed more frames than bisection")
+    finish(failures)
+
+
+if __name__ == "__main__":
+    main()
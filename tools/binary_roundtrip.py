@@ -0,0 +1,143 @@
+#!/usr/bin/env python3
+"""
+ESP32 ASCOM Alpaca Flat Panel Calibrator
+Binary protocol round-trip benchmark
+
+Drives the serial port with the host client in flatpanel_binary.py and
+measures request rate three ways: text BRIGHTNESS commands waiting for each
+reply, binary requests one at a time, and binary requests pipelined --depth
+deep. The binary requests cycle through ping, get/set brightness and bulk
+status. BINARY is sent with a CRLF line ending, as terminal programs do, so
+the first request also checks that the trailing LF is not taken for frame
+data, and after SUBSCRIBE, so text EVENT lines must not leak into the frame
+stream. The run fails on any error status, lost, mismatched or corrupt
+response.
+
+Against the simulator's pty (see README, Development > Simulator):
+
+    python3 tools/binary_roundtrip.py --sim build/sim/flatpanel-sim --count 2000
+
+Against a device on a serial port:
+
+    python3 tools/binary_roundtrip.py --port /dev/ttyUSB0 --count 500
+"""
+
+import argparse
+import time
+
+from flatpanel_binary import (OP_GET_BRIGHTNESS, OP_GET_STATUS, OP_PING, OP_SET_BRIGHTNESS, BinaryClient,
+                              BinaryError, open_port)
+from sim_harness import finish, percentile, start_simulator
+
+CYCLE = [(OP_PING, b""), (OP_SET_BRIGHTNESS, b"\x28"), (OP_GET_BRIGHTNESS, b""), (OP_GET_STATUS, b"")]
+
+
+def text_round_trips(port, count):
+    """Latencies of BRIGHTNESS commands sent one at a time, milliseconds"""
+    latencies = []
+    pending = b""
+    for index in range(count):
+        started = time.perf_counter()
+        port.write(b"BRIGHTNESS %d\r\n" % (index % 101))
+        while b"\n" not in pending:
+            data = port.read(256)
+            if not data:
+                raise TimeoutError("no reply to BRIGHTNESS")
+            pending += data
+        line, pending = pending.split(b"\n", 1)
+        if not line.startswith(b"Brightness set to"):
+            raise ValueError("unexpected reply %r" % line)
+        latencies.append((time.perf_counter() - started) * 1000)
+    return latencies
+
+
+def binary_round_trips(client, count):
+    latencies = []
+    for index in range(count):
+        opcode, payload = CYCLE[index % len(CYCLE)]
+        started = time.perf_counter()
+        client.request(opcode, payload)
+        latencies.append((time.perf_counter() - started) * 1000)
+    return latencies
+
+
+def binary_pipelined(client, count, depth):
+    """Keeps depth requests in flight; returns the elapsed seconds"""
+    in_flight = {}
+    sent = 0
+    started = time.perf_counter()
+    while sent < count or in_flight:
+        while sent < count and len(in_flight) < depth:
+            opcode, payload = CYCLE[sent % len(CYCLE)]
+            in_flight[client.send(opcode, payload)] = opcode
+            sent += 1
+        request_id, opcode, status, _ = client.receive()
+        if in_flight.pop(request_id, None) != opcode:
+            raise ValueError("response to request %d was not expected" % request_id)
+        if status != 0:
+            raise BinaryError(opcode, status)
+    return time.perf_counter() - started
+
+
+def report(name, count, seconds, latencies=None):
+    line = "%-18s %6d requests  %8.0f/s" % (name, count, count / seconds)
+    if latencies:
+        line += "  p50 %6.2f ms  p95 %6.2f ms" % (percentile(latencies, 0.5), percentile(latencies, 0.95))
+    print(line)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Measure binary protocol round trips against text commands")
+    target_group = parser.add_mutually_exclusive_group(required=True)
+    target_group.add_argument("--port", help="serial device of the calibrator")
+    target_group.add_argument("--sim", help="simulator binary to start and test")
+    parser.add_argument("--port-offset", type=int, default=8000, help="simulator port offset (web UI on 80 + offset)")
+    parser.add_argument("--clock", choices=("real", "virtual"), default="real",
+                        help="simulator clock; virtual takes loop()'s delay() out of the figures")
+    parser.add_argument("--count", type=int, default=1000, help="requests per measurement")
+    parser.add_argument("--depth", type=int, default=8, help="requests in flight when pipelined")
+    parser.add_argument("--timeout", type=float, default=2, help="serial read timeout, seconds")
+    args = parser.parse_args()
+
+    process = None
+    path = args.port
+    if args.sim:
+        process, path = start_simulator(args.sim, args.port_offset, serial="pty", clock=args.clock)
+
+    failures = []
+    try:
+        port = open_port(path, timeout=args.timeout)
+        text = text_round_trips(port, args.count)
+
+        port.write(b"SUBSCRIBE\r\n")
+        client = BinaryClient(port)
+        client.enter(b"\r\n")
+        try:
+            client.ping()
+        except (BinaryError, TimeoutError) as error:
+            failures.append("first request after BINARY\\r\\n failed: %s" % error)
+        binary = binary_round_trips(client, args.count)
+        pipelined = binary_pipelined(client, args.count, args.depth)
+        status = client.status()
+        client.exit()
+        port.close()
+        if client.bad_frames:
+            failures.append("%d frames failed to decode" % client.bad_frames)
+    except (BinaryError, TimeoutError, ValueError) as error:
+        failures.append(str(error))
+        text = binary = pipelined = status = None
+    finally:
+        if process is not None:
+            process.terminate()
+            process.wait()
+
+    if text and binary:
+        report("text", len(text), sum(text) / 1000, text)
+        report("binary", len(binary), sum(binary) / 1000, binary)
+        report("binary, depth %d" % args.depth, args.count, pipelined)
+        print("status after the run: %s" % status)
+    finish(failures)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,159 @@
+#!/usr/bin/env python3
+"""
+ESP32 ASCOM Alpaca Flat Panel Calibrator
+Brightness request storm
+
+Sends brightness changes as fast as the device accepts them from several
+interfaces at once: Alpaca PUTs, web UI slider posts and, against the
+simulator, serial BRIGHTNESS commands. It prints the acknowledged requests
+per second and the coalescing counters from GET /api/status, which show how
+many requests were merged into each PWM update. The run fails if a request
+goes unacknowledged or the last request does not win.
+
+Against the simulator (see README, Development > Simulator):
+
+    python3 tools/brightness_storm.py --sim build/sim/flatpanel-sim --seconds 10
+
+Against a device:
+
+    python3 tools/brightness_storm.py --host 192.168.1.50 --alpaca 2 --web 1
+"""
+
+import argparse
+import http.client
+import random
+import threading
+import time
+
+import sim_harness
+from sim_harness import add_target_arguments, finish, get_json, open_target, post_form, rate_limit_paused
+
+
+class Counters:
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.sent = {}
+        self.failed = {}
+
+    def record(self, source, ok):
+        with self.lock:
+            table = self.sent if ok else self.failed
+            table[source] = table.get(source, 0) + 1
+
+
+# ClientID 0: a client that names itself would take the calibrator lease and
+# lock the other sources out, which is lease_contention.py's subject, not this
+def put_alpaca(target, transaction, brightness):
+    reply = sim_harness.alpaca(target, "PUT", "calibratoron", 0, transaction, "Brightness=%d" % brightness)
+    return reply.get("ErrorNumber") == 0
+
+
+def post_web(target, brightness):
+    status, _ = post_form(target, "/calibrator", "action=brightness&brightness=%d" % brightness)
+    return status == 200
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Flood the calibrator with brightness changes")
+    add_target_arguments(parser)
+    parser.add_argument("--seconds", type=float, default=10, help="length of the storm")
+    parser.add_argument("--alpaca", type=int, default=2, help="concurrent Alpaca clients")
+    parser.add_argument("--web", type=int, default=2, help="concurrent web UI sliders")
+    parser.add_argument("--serial-rate", type=float, default=200, help="serial commands per second (simulator only)")
+    args = parser.parse_args()
+    target = open_target(args, serial="stdio")
+    process = target.process
+
+    counters = Counters()
+    stop = threading.Event()
+
+    def alpaca_worker(seed):
+        rng = random.Random(seed)
+        transaction = 0
+        while not stop.is_set():
+            transaction += 1
+            try:
+                ok = put_alpaca(target, transaction, rng.randint(0, 100))
+            except (OSError, ValueError, http.client.HTTPException):
+                ok = False
+            counters.record("alpaca", ok)
+
+    def web_worker(seed):
+        rng = random.Random(1000 + seed)
+        value = rng.randint(0, 100)
+        while not stop.is_set():
+            # A dragged slider moves a step or two at a time
+            value = min(100, max(0, value + rng.choice((-2, -1, 1, 2))))
+            try:
+                ok = post_web(target, value)
+            except (OSError, http.client.HTTPException):
+                ok = False
+            counters.record("web", ok)
+
+    serial_acks = [0]
+
+    def serial_writer():
+        rng = random.Random(2000)
+        while not stop.is_set():
+            process.stdin.write(b"BRIGHTNESS %d\n" % rng.randint(0, 100))
+            process.stdin.flush()
+            counters.record("serial", True)
+            time.sleep(1.0 / args.serial_rate)
+
+    def serial_reader():
+        for line in process.stdout:
+            if line.startswith(b"Brightness set to"):
+                serial_acks[0] += 1
+
+    # The storm comes from one address and would mostly be refused with 429;
+    # it is the coalescing being measured here, so limiting is off meanwhile
+    with target, rate_limit_paused(target):
+        before = get_json(target, "/api/status")["coalescing"]
+        threads = [threading.Thread(target=alpaca_worker, args=(i + 1,)) for i in range(args.alpaca)]
+        threads += [threading.Thread(target=web_worker, args=(i,)) for i in range(args.web)]
+        if process is not None and args.serial_rate > 0:
+            threads.append(threading.Thread(target=serial_writer))
+            threading.Thread(target=serial_reader, daemon=True).start()
+
+        started = time.time()
+        for thread in threads:
+            thread.start()
+        time.sleep(args.seconds)
+        stop.set()
+        for thread in threads:
+            thread.join()
+        elapsed = time.time() - started
+
+        # The last request wins once a tick has passed
+        final = random.randint(1, 99)
+        last_ok = put_alpaca(target, 1, final)
+        time.sleep(0.5)
+        status = get_json(target, "/api/status")
+
+    after = status["coalescing"]
+    requests = after["requests"] - before["requests"]
+    applied = after["applied"] - before["applied"]
+    merged = after["merged"] - before["merged"]
+    sent = sum(counters.sent.values())
+    failed = sum(counters.failed.values())
+
+    for source in sorted(set(counters.sent) | set(counters.failed)):
+        print("%-7s %7d sent  %5d failed  %8.1f/s" % (
+            source, counters.sent.get(source, 0), counters.failed.get(source, 0),
+            counters.sent.get(source, 0) / elapsed))
+    if "serial" in counters.sent:
+        print("serial acknowledgements %d" % serial_acks[0])
+    print("total   %7d sent in %.1f s, %.1f requests/s" % (sent, elapsed, sent / elapsed))
+    print("device  %d requests, %d PWM updates, %d merged (%.1f requests per update)" % (
+        requests, applied, merged, requests / max(1, applied)))
+
+    failures = []
+    if failed:
+        failures.append("%d requests failed" % failed)
+    if not last_ok or status["brightness"] != final:
+        failures.append("brightness %d after the last request set %d" % (status["brightness"], final))
+    finish(failures)
+
+
+if __name__ == "__main__":
+    main()
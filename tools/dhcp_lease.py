@@ -0,0 +1,194 @@
+#!/usr/bin/env python3
+"""
+ESP32 ASCOM Alpaca Flat Panel Calibrator
+DHCP lease test for the fast connect
+
+Plays the DHCP server for the simulator and checks that a fast connect keeps
+its cached address while the lease is confirmed:
+- the device asks for the cached address (INIT-REBOOT) and keeps using it
+  before, during and after the answer, and renews the lease at T1
+- connect timing is only recorded once the lease is confirmed
+- a refused address is given up and the DHCP client's address used instead
+
+The simulator moves ports below 1024 by --port-offset, so the server listens
+on 67 + offset and answers on 68 + offset. A first run joins a network over
+the web UI to fill the fast connect cache; two more runs use it.
+
+    python3 tools/dhcp_lease.py --sim build/sim/flatpanel-sim
+"""
+
+import argparse
+import os
+import socket
+import struct
+import tempfile
+import threading
+import time
+
+from sim_harness import WEB_PORT, Target, finish, get_json, post_form, start_simulator
+
+CACHED_IP = "127.0.0.1"                 # Address of the first run, kept in the fast connect cache
+DHCP_CLIENT_IP = "127.0.0.2"            # What the simulator's own DHCP client hands out
+MAGIC_COOKIE = bytes([99, 130, 83, 99])
+DHCP_REQUEST, DHCP_ACK, DHCP_NAK = 3, 5, 6
+
+
+class FakeDhcpServer(threading.Thread):
+    """Answers DHCPREQUESTs with an ACK for the requested address, or a NAK"""
+
+    def __init__(self, port_offset, lease_seconds, refuse=False, first_reply_delay=0):
+        super().__init__(daemon=True)
+        self.port_offset = port_offset
+        self.lease_seconds = lease_seconds
+        self.refuse = refuse
+        self.first_reply_delay = first_reply_delay
+        self.requests = []              # (seconds since start, ciaddr, requested address)
+        self.first_reply_time = None
+        self.started = time.time()
+        self.stopping = threading.Event()
+        self.sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        self.sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+        self.sock.bind(("0.0.0.0", 67 + port_offset))
+        self.sock.settimeout(0.2)
+
+    def stop(self):
+        self.stopping.set()
+        self.join()
+        self.sock.close()
+
+    def run(self):
+        while not self.stopping.is_set():
+            try:
+                packet, _ = self.sock.recvfrom(1500)
+            except socket.timeout:
+                continue
+            if len(packet) < 240 or packet[0] != 1 or packet[236:240] != MAGIC_COOKIE:
+                continue
+            options = parse_options(packet[240:])
+            if options.get(53) != bytes([DHCP_REQUEST]):
+                continue
+            ciaddr = socket.inet_ntoa(packet[12:16])
+            requested = socket.inet_ntoa(options[50]) if 50 in options else None
+            self.requests.append((time.time() - self.started, ciaddr, requested))
+            if self.first_reply_time is None:
+                time.sleep(self.first_reply_delay)
+                self.first_reply_time = time.time()
+            self.reply(packet, requested or ciaddr)
+
+    def reply(self, request, address):
+        answer = bytearray(240)
+        answer[0:4] = bytes([2, 1, 6, 0])
+        answer[4:8] = request[4:8]
+        if not self.refuse:
+            answer[16:20] = socket.inet_aton(address)
+        answer[28:44] = request[28:44]
+        answer[236:240] = MAGIC_COOKIE
+        answer += bytes([53, 1, DHCP_NAK if self.refuse else DHCP_ACK, 54, 4]) + socket.inet_aton(CACHED_IP)
+        if not self.refuse:
+            answer += bytes([51, 4]) + struct.pack(">I", self.lease_seconds)
+            answer += bytes([1, 4]) + socket.inet_aton("255.0.0.0")
+        answer += bytes([255])
+        self.sock.sendto(bytes(answer), (CACHED_IP, 68 + self.port_offset))
+
+
+def parse_options(data):
+    options = {}
+    i = 0
+    while i < len(data) and data[i] != 255:
+        if data[i] == 0:
+            i += 1
+            continue
+        if i + 2 > len(data):
+            break
+        options[data[i]] = data[i + 2:i + 2 + data[i + 1]]
+        i += 2 + data[i + 1]
+    return options
+
+
+def wifi_status(target):
+    return get_json(target, "/api/status")["wifi"]
+
+
+def wait_for(target, condition, seconds):
+    deadline = time.time() + seconds
+    while time.time() < deadline:
+        wifi = wifi_status(target)
+        if condition(wifi):
+            return wifi
+        time.sleep(0.1)
+    return None
+
+
+def run_simulator(args, nvs_path, local_ip):
+    process, _ = start_simulator(args.sim, args.port_offset, options=["--nvs", nvs_path, "--ip", local_ip])
+    return Target("127.0.0.1", WEB_PORT + args.port_offset, args.timeout, process)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Check that a fast connect keeps its address through DHCP")
+    parser.add_argument("--sim", required=True, help="simulator binary to start and test")
+    parser.add_argument("--port-offset", type=int, default=8000, help="simulator port offset (web UI on 80 + offset)")
+    parser.add_argument("--timeout", type=float, default=5, help="per request timeout, seconds")
+    parser.add_argument("--lease", type=int, default=4, help="lease handed out, seconds; renewal comes at half")
+    args = parser.parse_args()
+
+    failures = []
+    nvs_path = os.path.join(tempfile.mkdtemp(prefix="flatpanel-dhcp-"), "nvs")
+
+    # Join a network the normal way; the lease of this run fills the cache
+    with run_simulator(args, nvs_path, CACHED_IP) as target:
+        post_form(target, "/wificonfig", "ssid=Observatory&password=darkskies")
+        if wait_for(target, lambda wifi: wifi["reconfigure"] == "Applied", 10) is None:
+            finish(["the first run never joined the network"])
+
+    # Fast connect: the cached address must hold from association on
+    server = FakeDhcpServer(args.port_offset, args.lease, first_reply_delay=1.0)
+    server.start()
+    with run_simulator(args, nvs_path, DHCP_CLIENT_IP) as target:
+        connected = wait_for(target, lambda wifi: wifi["state"] == "Connected", 10)
+        if connected is None:
+            finish(["the fast connect did not come up"])
+        if server.first_reply_time is None and connected["bootToReadyMs"] != 0:
+            failures.append("ready at %d ms before the lease was confirmed" % connected["bootToReadyMs"])
+
+        addresses = set()
+        end = time.time() + args.lease * 1.5
+        while time.time() < end:
+            wifi = wifi_status(target)
+            addresses.add(wifi["ip"])
+            time.sleep(0.1)
+        wifi = wifi_status(target)
+    server.stop()
+
+    print("fast connect: IP usable after %d ms, lease confirmed after %d ms, %d DHCP requests" %
+          (wifi["lastAddressMs"], wifi["lastConnectMs"], len(server.requests)))
+    if addresses != {CACHED_IP}:
+        failures.append("address changed during the lease: %s" % ", ".join(sorted(addresses)))
+    if not server.requests or server.requests[0][1:] != ("0.0.0.0", CACHED_IP):
+        failures.append("first request %s is not an INIT-REBOOT for %s" %
+                        (server.requests[0] if server.requests else None, CACHED_IP))
+    if not any(ciaddr == CACHED_IP for _, ciaddr, _ in server.requests):
+        failures.append("the lease was never renewed")
+    if not wifi["lastConnectFast"] or wifi["leaseSeconds"] != args.lease:
+        failures.append("lease not in place: %s" % wifi)
+    if wifi["lastConnectMs"] - wifi["lastAddressMs"] < 900:
+        failures.append("connect time %d ms does not wait for the delayed lease" % wifi["lastConnectMs"])
+
+    # A refused address is given up for whatever the DHCP client gets
+    server = FakeDhcpServer(args.port_offset, args.lease, refuse=True)
+    server.start()
+    with run_simulator(args, nvs_path, DHCP_CLIENT_IP) as target:
+        wifi = wait_for(target, lambda wifi: wifi["ip"] == DHCP_CLIENT_IP and wifi["bootToReadyMs"] > 0, 10)
+    server.stop()
+    if wifi is None:
+        failures.append("refused address was not replaced by the DHCP client's")
+    elif not server.requests:
+        failures.append("no DHCP request before the refused address was dropped")
+
+    os.remove(nvs_path)
+    os.rmdir(os.path.dirname(nvs_path))
+    finish(failures)
+
+
+if __name__ == "__main__":
+    main()
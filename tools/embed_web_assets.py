@@ -0,0 +1,110 @@
+#!/usr/bin/env python3
+"""
+ESP32 ASCOM Alpaca Flat Panel Calibrator
+Web asset embedder
+
+Minifies and gzips the files in web/ and writes main/web_assets.h, which holds
+them as PROGMEM arrays under content-hashed URLs. Run it after editing anything
+in web/ and commit the regenerated header:
+
+    python3 tools/embed_web_assets.py
+"""
+
+import gzip
+import hashlib
+import os
+import re
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+WEB_DIR = os.path.join(ROOT, "web")
+OUTPUT = os.path.join(ROOT, "main", "web_assets.h")
+
+CONTENT_TYPES = {
+    ".css": "text/css",
+    ".js": "application/javascript",
+}
+
+
+def minify(source, extension):
+    # Conservative minifier: strips block comments, line comments on their own
+    # line, indentation and blank lines. Good enough for our hand-written assets.
+    source = re.sub(r"/\*.*?\*/", "", source, flags=re.S)
+    lines = []
+    for line in source.splitlines():
+        line = line.strip()
+        if not line or (extension == ".js" and line.startswith("//")):
+            continue
+        lines.append(line)
+    joiner = "" if extension == ".css" else "\n"
+    return joiner.join(lines)
+
+
+def symbol_for(name):
+    return re.sub(r"[^A-Za-z0-9]", "_", name).upper()
+
+
+def main():
+    assets = []
+    for name in sorted(os.listdir(WEB_DIR)):
+        base, extension = os.path.splitext(name)
+        if extension not in CONTENT_TYPES:
+            continue
+        with open(os.path.join(WEB_DIR, name), encoding="utf-8") as f:
+            minified = minify(f.read(), extension).encode("utf-8")
+        digest = hashlib.sha256(minified).hexdigest()[:8]
+        # mtime=0 keeps the output byte-identical between runs
+        compressed = gzip.compress(minified, compresslevel=9, mtime=0)
+        assets.append({
+            "symbol": symbol_for(name),
+            "path": "/static/%s.%s%s" % (base, digest, extension),
+            "type": CONTENT_TYPES[extension],
+            "data": compressed,
+            "raw_size": len(minified),
+        })
+
+    out = []
+    out.append("/*")
+    out.append(" * ESP32 ASCOM Alpaca Flat Panel Calibrator")
+    out.append(" * Embedded Web Assets - GENERATED by tools/embed_web_assets.py, do not edit")
+    out.append(" */")
+    out.append("")
+    out.append("#ifndef WEB_ASSETS_H")
+    out.append("#define WEB_ASSETS_H")
+    out.append("")
+    out.append("#include <Arduino.h>")
+    out.append("")
+    out.append("struct WebAsset {")
+    out.append("  const char* path;                     // Content-hashed URL")
+    out.append("  const char* contentType;")
+    out.append("  const uint8_t* data;                  // Gzip compressed")
+    out.append("  size_t length;")
+    out.append("};")
+    out.append("")
+    for asset in assets:
+        out.append("#define WEB_ASSET_%s_PATH \"%s\"" % (asset["symbol"], asset["path"]))
+    out.append("")
+    for asset in assets:
+        data = asset["data"]
+        out.append("// %s: %d bytes minified, %d bytes gzipped" % (asset["path"], asset["raw_size"], len(data)))
+        out.append("inline const uint8_t WEB_ASSET_%s_DATA[] PROGMEM = {" % asset["symbol"])
+        for i in range(0, len(data), 16):
+            out.append("  " + ", ".join("0x%02x" % b for b in data[i:i + 16]) + ",")
+        out.append("};")
+        out.append("")
+    out.append("inline const WebAsset webAssets[] = {")
+    for asset in assets:
+        out.append("  { WEB_ASSET_%s_PATH, \"%s\", WEB_ASSET_%s_DATA, sizeof(WEB_ASSET_%s_DATA) }," %
+                   (asset["symbol"], asset["type"], asset["symbol"], asset["symbol"]))
+    out.append("};")
+    out.append("")
+    out.append("#endif // WEB_ASSETS_H")
+    out.append("")
+
+    with open(OUTPUT, "w", encoding="utf-8") as f:
+        f.write("\n".join(out))
+    for asset in assets:
+        print("%-32s %6d -> %5d bytes" % (asset["path"], asset["raw_size"], len(asset["data"])))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,106 @@
+#!/usr/bin/env python3
+"""
+ESP32 ASCOM Alpaca Flat Panel Calibrator
+Event stream test
+
+Opens /events and checks that the web server still serves other routes while
+the stream stays open:
+- each stream starts with a state event
+- requests to other routes are answered promptly with streams open
+- a brightness change reaches every open stream
+
+Against the simulator (see README, Development > Simulator):
+
+    python3 tools/event_stream.py --sim build/sim/flatpanel-sim
+
+Against a device:
+
+    python3 tools/event_stream.py --host 192.168.1.50
+"""
+
+import argparse
+import json
+import socket
+import time
+
+from sim_harness import add_target_arguments, finish, get_json, open_target, post_form
+
+
+class EventStream:
+    """A raw /events connection, read one event at a time"""
+
+    def __init__(self, target):
+        self.sock = socket.create_connection((target.host, target.web_port), timeout=target.timeout)
+        self.sock.sendall(b"GET /events HTTP/1.1\r\nHost: %s\r\nAccept: text/event-stream\r\n\r\n" %
+                          target.host.encode())
+        self.buffer = b""
+        header = self.read_block()
+        if not header.startswith(b"HTTP/1.1 200"):
+            raise RuntimeError("event stream refused: %r" % header[:40])
+
+    def read_block(self):
+        """Up to the next blank line; raises socket.timeout if none comes"""
+        while True:
+            for separator in (b"\r\n\r\n", b"\n\n"):
+                end = self.buffer.find(separator)
+                if end >= 0:
+                    block, self.buffer = self.buffer[:end], self.buffer[end + len(separator):]
+                    return block
+            data = self.sock.recv(4096)
+            if not data:
+                raise ConnectionError("event stream closed")
+            self.buffer += data
+
+    def next_state(self):
+        """Data of the next state event, skipping retry lines and heartbeats"""
+        while True:
+            lines = self.read_block().decode().split("\n")
+            if "event: state" in lines:
+                return json.loads(next(line[6:] for line in lines if line.startswith("data: ")))
+
+    def close(self):
+        self.sock.close()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Check that an open event stream does not block the web server")
+    add_target_arguments(parser)
+    parser.add_argument("--requests", type=int, default=10, help="requests to other routes with streams open")
+    parser.add_argument("--max-latency", type=float, default=0.5, help="slowest acceptable reply, seconds")
+    args = parser.parse_args()
+
+    failures = []
+    with open_target(args) as target:
+        first = EventStream(target)
+        first.next_state()
+
+        latencies = []
+        for _ in range(args.requests):
+            start = time.time()
+            get_json(target, "/api/status")
+            latencies.append(time.time() - start)
+        second = EventStream(target)
+        second.next_state()
+        start = time.time()
+        status, _ = post_form(target, "/calibrator", "action=brightness&brightness=37")
+        latencies.append(time.time() - start)
+
+        print("%d requests with /events open: slowest %.0f ms" % (len(latencies), max(latencies) * 1000))
+        if max(latencies) > args.max_latency:
+            failures.append("slowest request took %.0f ms" % (max(latencies) * 1000))
+        if status != 200:
+            failures.append("brightness change answered %d" % status)
+
+        for name, stream in (("first", first), ("second", second)):
+            try:
+                state = stream.next_state()
+                while state["brightness"] != 37:
+                    state = stream.next_state()
+            except (socket.timeout, ConnectionError) as error:
+                failures.append("%s stream missed the brightness change: %s" % (name, error))
+            stream.close()
+    finish(failures)
+
+
+if __name__ == "__main__":
+    main()
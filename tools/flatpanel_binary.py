@@ -0,0 +1,247 @@
+"""
+ESP32 ASCOM Alpaca Flat Panel Calibrator
+Binary framed serial protocol client
+
+A host side implementation of the protocol in main/serial_binary.h, for
+automation scripts and the round-trip benchmark. Frames are COBS encoded and
+end with 0x00; decoded they are
+
+    [channel u8][requestId u16 LE][opcode u8][status u8][payload ...][crc16 u16 LE]
+
+Usage, with the port as any object that has read(size) and write(data):
+
+    client = BinaryClient(port)
+    client.enter()                  # sends BINARY to the text parser
+    client.set_brightness(40)
+    print(client.status())
+    client.exit()
+
+open_port() opens a serial device or the simulator's pty raw at 115200 baud.
+"""
+
+import os
+import select
+import struct
+import termios
+import time
+import tty
+
+CHANNEL_COMMAND = 0x00
+CHANNEL_LOG = 0x01
+
+OP_PING = 0x00
+OP_GET_BRIGHTNESS = 0x01
+OP_SET_BRIGHTNESS = 0x02
+OP_GET_STATE = 0x03
+OP_GET_MAX_BRIGHTNESS = 0x04
+OP_SET_MAX_BRIGHTNESS = 0x05
+OP_GET_STATUS = 0x06
+OP_CALIBRATOR_ON = 0x07
+OP_CALIBRATOR_OFF = 0x08
+OP_EXIT = 0x7F
+
+STATUS_NAMES = {0: "ok", 1: "bad CRC", 2: "unknown opcode", 3: "bad length", 4: "out of range",
+                5: "failed", 6: "busy"}
+
+
+class BinaryError(Exception):
+    def __init__(self, opcode, status):
+        super().__init__("opcode 0x%02X: %s" % (opcode, STATUS_NAMES.get(status, "status %d" % status)))
+        self.opcode = opcode
+        self.status = status
+
+
+def crc16_ccitt(data):
+    """CRC-16/CCITT-FALSE, as crc16Ccitt() in serial_binary.cpp"""
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+        crc &= 0xFFFF
+    return crc
+
+
+def cobs_encode(data):
+    output = bytearray([0])
+    code_index, code = 0, 1
+    for byte in data:
+        if byte == 0:
+            output[code_index] = code
+            code_index, code = len(output), 1
+            output.append(0)
+        else:
+            output.append(byte)
+            code += 1
+            if code == 0xFF:
+                output[code_index] = code
+                code_index, code = len(output), 1
+                output.append(0)
+    output[code_index] = code
+    return bytes(output)
+
+
+def cobs_decode(data):
+    """Decoded bytes, or None if the frame is malformed"""
+    output = bytearray()
+    index = 0
+    while index < len(data):
+        code = data[index]
+        index += 1
+        if code == 0 or index + code - 1 > len(data):
+            return None
+        output += data[index:index + code - 1]
+        index += code - 1
+        if code != 0xFF and index < len(data):
+            output.append(0)
+    return bytes(output)
+
+
+def encode_frame(channel, request_id, opcode, status=0, payload=b""):
+    frame = struct.pack("<BHBB", channel, request_id, opcode, status) + bytes(payload)
+    return cobs_encode(frame + struct.pack("<H", crc16_ccitt(frame))) + b"\x00"
+
+
+def decode_frame(encoded):
+    """(channel, requestId, opcode, status, payload), or None if malformed or the CRC fails"""
+    frame = cobs_decode(encoded)
+    if frame is None or len(frame) < 7:
+        return None
+    if crc16_ccitt(frame[:-2]) != struct.unpack("<H", frame[-2:])[0]:
+        return None
+    channel, request_id, opcode, status = struct.unpack("<BHBB", frame[:5])
+    return channel, request_id, opcode, status, frame[5:-2]
+
+
+class RawPort:
+    """A serial device or pty opened raw, with a read timeout"""
+
+    def __init__(self, path, baud=115200, timeout=2.0):
+        self.fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+        tty.setraw(self.fd)
+        attributes = termios.tcgetattr(self.fd)
+        speed = getattr(termios, "B%d" % baud)
+        attributes[4] = attributes[5] = speed
+        termios.tcsetattr(self.fd, termios.TCSANOW, attributes)
+        self.timeout = timeout
+
+    def read(self, size):
+        """Up to size bytes; empty once the timeout passes with nothing to read"""
+        ready, _, _ = select.select([self.fd], [], [], self.timeout)
+        return os.read(self.fd, size) if ready else b""
+
+    def write(self, data):
+        os.write(self.fd, data)
+
+    def close(self):
+        os.close(self.fd)
+
+
+def open_port(path, baud=115200, timeout=2.0):
+    return RawPort(path, baud, timeout)
+
+
+class BinaryClient:
+    """Request/response client; log channel frames are collected in self.log and
+    frames that fail to decode are counted in self.bad_frames"""
+
+    def __init__(self, port):
+        self.port = port
+        self.next_id = 1
+        self.pending = bytearray()
+        self.log = []
+        self.bad_frames = 0
+
+    def enter(self, line_ending=b"\r\n"):
+        """Switches the port from the text protocol and waits for the switch"""
+        self.port.write(b"BINARY" + line_ending)
+        reply = b"Binary mode\r\n"
+        text = bytearray()
+        while reply not in text:
+            data = self.port.read(256)
+            if not data:
+                raise TimeoutError("no reply to BINARY")
+            text += data
+        # Whatever followed the reply is already binary
+        self.pending = bytearray(text[text.index(reply) + len(reply):])
+
+    def send(self, opcode, payload=b""):
+        """Sends a request without waiting; returns its request ID"""
+        request_id = self.next_id
+        self.next_id = self.next_id % 0xFFFF + 1
+        self.port.write(encode_frame(CHANNEL_COMMAND, request_id, opcode, 0, payload))
+        return request_id
+
+    def receive(self):
+        """The next command channel frame as (requestId, opcode, status, payload)"""
+        while True:
+            while b"\x00" not in self.pending:
+                data = self.port.read(4096)
+                if not data:
+                    raise TimeoutError("no binary response")
+                self.pending += data
+            end = self.pending.index(b"\x00")
+            encoded = bytes(self.pending[:end])
+            del self.pending[:end + 1]
+            if not encoded:
+                continue
+            frame = decode_frame(encoded)
+            if frame is None:
+                self.bad_frames += 1
+                continue
+            channel, request_id, opcode, status, payload = frame
+            if channel == CHANNEL_LOG:
+                self.log.append(payload.decode(errors="replace"))
+                continue
+            return request_id, opcode, status, payload
+
+    def request(self, opcode, payload=b""):
+        """Sends a request and returns its response payload, raising BinaryError on a bad status"""
+        request_id = self.send(opcode, payload)
+        while True:
+            got_id, got_opcode, status, reply = self.receive()
+            if got_id == request_id:
+                break
+        if got_opcode != opcode:
+            raise BinaryError(opcode, 5)
+        if status != 0:
+            raise BinaryError(opcode, status)
+        return reply
+
+    def ping(self):
+        self.request(OP_PING)
+
+    def brightness(self):
+        return self.request(OP_GET_BRIGHTNESS)[0]
+
+    def set_brightness(self, value):
+        self.request(OP_SET_BRIGHTNESS, bytes([value]))
+
+    def state(self):
+        return self.request(OP_GET_STATE)[0]
+
+    def max_brightness(self):
+        return self.request(OP_GET_MAX_BRIGHTNESS)[0]
+
+    def set_max_brightness(self, value):
+        self.request(OP_SET_MAX_BRIGHTNESS, bytes([value]))
+
+    def status(self):
+        brightness, maximum, state, cover, flags, free_heap = struct.unpack("<BBBBBI", self.request(OP_GET_STATUS))
+        return {"brightness": brightness, "maxBrightness": maximum, "calibratorState": state,
+                "coverState": cover, "connected": bool(flags & 1), "wifiConnected": bool(flags & 2),
+                "freeHeap": free_heap}
+
+    def on(self):
+        self.request(OP_CALIBRATOR_ON)
+
+    def off(self):
+        self.request(OP_CALIBRATOR_OFF)
+
+    def exit(self):
+        """Returns the port to the text protocol"""
+        self.request(OP_EXIT)
+        deadline = time.time() + 2
+        while b"Text mode\r\n" not in self.pending and time.time() < deadline:
+            self.pending += self.port.read(256)
+        self.pending = bytearray()
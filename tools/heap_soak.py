@@ -0,0 +1,253 @@
+#!/usr/bin/env python3
+"""
+ESP32 ASCOM Alpaca Flat Panel Calibrator
+Heap fragmentation soak test
+
+Replays days of typical traffic back to back and samples GET /api/heap
+as it goes. The traffic is an imaging client polling Alpaca all night, a
+dashboard on /api/status, some page views, event streams, scans, discovery
+and a few settings changes. The heap samples go to a CSV file and are
+charted: as PNG if matplotlib is installed, and always as text. The run fails
+if the largest free block drops below the threshold or the device stops
+answering.
+
+Against the simulator (see README, Development > Simulator):
+
+    python3 tools/heap_soak.py --sim build/sim/flatpanel-sim --days 14
+
+Against a device:
+
+    python3 tools/heap_soak.py --host 192.168.1.50 --days 2 --chart soak.png
+
+A recorded request mix can replace the built-in one with --profile FILE.
+Each line holds "COUNT_PER_DAY METHOD alpaca|web PATH [BODY]".
+"""
+
+import argparse
+import csv
+import http.client
+import random
+import socket
+import time
+
+from sim_harness import (DEVICE, DISCOVERY_PORT, add_target_arguments, finish, get_json, open_target,
+                         rate_limit_paused, request)
+
+# Requests per simulated day: a night of polling every 5 s, a dashboard left
+# open, occasional configuration
+DAY_PROFILE = [
+    (5760, "GET", "alpaca", DEVICE + "calibratorstate", None),
+    (5760, "GET", "alpaca", DEVICE + "brightness", None),
+    (2880, "GET", "alpaca", DEVICE + "connected", None),
+    (40, "PUT", "alpaca", DEVICE + "calibratoron", "Brightness={brightness}"),
+    (40, "PUT", "alpaca", DEVICE + "calibratoroff", ""),
+    (4, "PUT", "alpaca", DEVICE + "connected", "Connected=true"),
+    (20, "GET", "alpaca", "/management/v1/configureddevices", None),
+    (24, "UDP", "alpaca", "alpacadiscovery1", None),
+    (288, "GET", "web", "/api/status", None),
+    (12, "GET", "web", "/", None),
+    (6, "GET", "web", "/setup", None),
+    (6, "GET", "web", "/calibrator", None),
+    (10, "GET", "web", "/api/scan", None),
+    (12, "SSE", "web", "/events", None),
+    (10, "GET", "web", "/log", None),
+    (2, "POST", "web", "/calibrator", "action=set&brightness={brightness}"),
+]
+
+SAMPLE_FIELDS = ["requests", "day", "uptimeMs", "freeBytes", "largestFreeBlock", "minFreeBytes",
+                 "allocatedBlocks", "freeBlocks"]
+
+
+def load_profile(path):
+    profile = []
+    with open(path, encoding="utf-8") as f:
+        for line in f:
+            line = line.strip()
+            if not line or line.startswith("#"):
+                continue
+            parts = line.split(None, 4)
+            body = parts[4] if len(parts) > 4 else None
+            profile.append((int(parts[0]), parts[1].upper(), parts[2], parts[3], body))
+    return profile
+
+
+def build_day(profile, rng):
+    day = []
+    for count, method, port, path, body in profile:
+        day.extend([(method, port, path, body)] * count)
+    rng.shuffle(day)
+    return day
+
+
+class Traffic:
+    def __init__(self, target):
+        self.target = target
+        self.transaction = 0
+
+    def request(self, method, port, path, body, rng):
+        self.transaction += 1
+        if body is not None:
+            body = body.format(brightness=rng.randint(1, 100))
+        if method == "UDP":
+            return self.discovery(path)
+        if method == "SSE":
+            return self.event_stream(path)
+
+        if port == "alpaca":
+            query = "ClientID=1&ClientTransactionID=%d" % self.transaction
+            if method == "GET":
+                path += "?" + query
+            else:
+                body = query + ("&" + body if body else "")
+
+        port = self.target.alpaca_port if port == "alpaca" else self.target.web_port
+        status, _ = request(self.target.host, port, method, path, body, timeout=self.target.timeout)
+        return status
+
+    def discovery(self, payload):
+        with socket.socket(socket.AF_INET, socket.SOCK_DGRAM) as s:
+            s.settimeout(self.target.timeout)
+            s.sendto(payload.encode(), (self.target.host, DISCOVERY_PORT))
+            try:
+                s.recvfrom(256)
+            except socket.timeout:
+                pass
+        return 200
+
+    # Connect, wait for the initial state event, hang up
+    def event_stream(self, path):
+        connection = http.client.HTTPConnection(self.target.host, self.target.web_port, timeout=self.target.timeout)
+        try:
+            connection.request("GET", path)
+            response = connection.getresponse()
+            if response.status == 200:
+                response.fp.readline()
+            return response.status
+        finally:
+            connection.close()
+
+
+def text_chart(samples, field, width=72, height=12):
+    values = [sample[field] for sample in samples]
+    if not values:
+        return ""
+    step = max(1, len(values) // width)
+    columns = [min(values[i:i + step]) for i in range(0, len(values), step)]
+    low, high = min(columns), max(columns)
+    span = max(1, high - low)
+    rows = []
+    for row in range(height, -1, -1):
+        level = low + span * row / height
+        line = "".join("#" if value >= level else " " for value in columns)
+        rows.append("%9d |%s" % (level, line))
+    rows.append("%9s +%s" % ("", "-" * len(columns)))
+    return "\n".join(rows)
+
+
+def png_chart(samples, path):
+    try:
+        import matplotlib
+        matplotlib.use("Agg")
+        import matplotlib.pyplot as plt
+    except ImportError:
+        print("matplotlib not installed, no PNG chart")
+        return
+    days = [sample["day"] for sample in samples]
+    figure, axis = plt.subplots(figsize=(10, 5))
+    for field in ("freeBytes", "largestFreeBlock", "minFreeBytes"):
+        axis.plot(days, [sample[field] for sample in samples], label=field)
+    axis.set_xlabel("simulated day")
+    axis.set_ylabel("bytes")
+    axis.legend()
+    axis.grid(True)
+    figure.savefig(path, dpi=100)
+    print("Chart written to %s" % path)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Replay compressed traffic and chart heap fragmentation")
+    add_target_arguments(parser)
+    parser.add_argument("--days", type=float, default=7, help="simulated days of traffic")
+    parser.add_argument("--profile", help="request mix file instead of the built-in one")
+    parser.add_argument("--sample-every", type=int, default=500, help="requests between heap samples")
+    parser.add_argument("--min-largest-block", type=int, default=8192,
+                        help="fail if the largest free block drops below this (HEAP_LARGEST_BLOCK_WARN)")
+    parser.add_argument("--csv", default="heap_soak.csv", help="heap samples output")
+    parser.add_argument("--chart", default="heap_soak.png", help="PNG chart output (needs matplotlib)")
+    parser.add_argument("--seed", type=int, default=1, help="random seed for the request order")
+    args = parser.parse_args()
+
+    rng = random.Random(args.seed)
+    profile = load_profile(args.profile) if args.profile else DAY_PROFILE
+    day_requests = sum(entry[0] for entry in profile)
+    total = int(day_requests * args.days)
+
+    samples = []
+    errors = 0
+    failure = None
+    started = time.time()
+
+    def sample(target, done):
+        heap = get_json(target, "/api/heap")
+        entry = {field: heap[field] for field in SAMPLE_FIELDS[2:]}
+        entry["requests"] = done
+        entry["day"] = round(done / day_requests, 3)
+        samples.append(entry)
+        return entry
+
+    # Virtual time in the simulator: the loop's delay() does not sleep, so
+    # requests are served back to back. Compressed traffic from one address
+    # runs far above the rate limit, and refused requests would never reach
+    # the handlers being soaked.
+    with open_target(args, clock="virtual") as target, rate_limit_paused(target):
+        traffic = Traffic(target)
+        sample(target, 0)
+        done = 0
+        while done < total and failure is None:
+            for method, port, path, body in build_day(profile, rng):
+                if done >= total:
+                    break
+                try:
+                    status = traffic.request(method, port, path, body, rng)
+                    if status >= 500:
+                        errors += 1
+                except (OSError, http.client.HTTPException):
+                    errors += 1
+                done += 1
+                if done % args.sample_every == 0 or done == total:
+                    try:
+                        heap = sample(target, done)
+                    except (OSError, ValueError, http.client.HTTPException) as error:
+                        failure = "no heap sample after %d requests (%s)" % (done, error)
+                        break
+                    if heap["largestFreeBlock"] < args.min_largest_block:
+                        failure = "largest free block %d < %d after %d requests" % (
+                            heap["largestFreeBlock"], args.min_largest_block, done)
+                        break
+                    print("\rday %.2f  free %d  largest %d  blocks %d/%d" % (
+                        heap["day"], heap["freeBytes"], heap["largestFreeBlock"],
+                        heap["allocatedBlocks"], heap["freeBlocks"]), end="", flush=True)
+    print()
+
+    with open(args.csv, "w", newline="", encoding="utf-8") as f:
+        writer = csv.DictWriter(f, fieldnames=SAMPLE_FIELDS)
+        writer.writeheader()
+        writer.writerows(samples)
+
+    elapsed = time.time() - started
+    print("%d requests (%.1f simulated days) in %.0f s, %d errors" % (
+        samples[-1]["requests"], samples[-1]["day"], elapsed, errors))
+    print("Largest free block over the run:")
+    print(text_chart(samples, "largestFreeBlock"))
+    first, last = samples[0], samples[-1]
+    print("free %d -> %d, largest block %d -> %d (min %d), allocated blocks %d -> %d" % (
+        first["freeBytes"], last["freeBytes"], first["largestFreeBlock"], last["largestFreeBlock"],
+        min(s["largestFreeBlock"] for s in samples), first["allocatedBlocks"], last["allocatedBlocks"]))
+    print("Samples written to %s" % args.csv)
+    png_chart(samples, args.chart)
+
+    finish([failure] if failure else [])
+
+
+if __name__ == "__main__":
+    main()
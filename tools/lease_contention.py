@@ -0,0 +1,145 @@
+#!/usr/bin/env python3
+"""
+ESP32 ASCOM Alpaca Flat Panel Calibrator
+Calibrator lease contention test
+
+One Alpaca client runs a flat sequence: it takes the calibrator lease and
+steps through brightness levels. Meanwhile a second Alpaca client, web UI
+sliders and, against the simulator, a serial script all try to change the
+brightness. The run checks that:
+- every command from the owner succeeds and the panel ends at its last level
+- the second client gets ASCOM error 0x40B, the web UI HTTP 409 and serial an
+  "Error:" reply
+- the owner disconnecting frees the calibrator for everyone again
+
+Against the simulator (see README, Development > Simulator):
+
+    python3 tools/lease_contention.py --sim build/sim/flatpanel-sim
+
+Against a device:
+
+    python3 tools/lease_contention.py --host 192.168.1.50 --steps 50
+"""
+
+import argparse
+import random
+import threading
+import time
+
+import sim_harness
+from sim_harness import add_target_arguments, finish, get_json, open_target, post_form, rate_limit_paused
+
+ASCOM_INVALID_OPERATION = 0x40B
+OWNER_ID = 4242
+INTRUDER_ID = 77
+
+
+class Tally:
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.counts = {}
+
+    def add(self, key):
+        with self.lock:
+            self.counts[key] = self.counts.get(key, 0) + 1
+
+    def get(self, key):
+        return self.counts.get(key, 0)
+
+
+def alpaca_put(target, method, client_id, transaction, body):
+    return sim_harness.alpaca(target, "PUT", method, client_id, transaction, body).get("ErrorNumber")
+
+
+def web_post(target, body):
+    status, _ = post_form(target, "/calibrator", body)
+    return status
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Check that an Alpaca lease holds off the other interfaces")
+    add_target_arguments(parser)
+    parser.add_argument("--steps", type=int, default=100, help="brightness steps in the owner's flat sequence")
+    args = parser.parse_args()
+    target = open_target(args, serial="stdio")
+    process = target.process
+
+    tally = Tally()
+    owner_done = threading.Event()
+    rng = random.Random(1)
+    failures = []
+
+    def intruder_alpaca():
+        transaction = 0
+        while not owner_done.is_set():
+            transaction += 1
+            error = alpaca_put(target, "calibratoron", INTRUDER_ID, transaction,
+                               "Brightness=%d" % rng.randint(0, 100))
+            tally.add("alpaca refused" if error == ASCOM_INVALID_OPERATION else "alpaca other %s" % error)
+
+    def intruder_web():
+        while not owner_done.is_set():
+            status = web_post(target, "action=brightness&brightness=%d" % rng.randint(0, 100))
+            tally.add("web refused" if status == 409 else "web other %d" % status)
+
+    def intruder_serial():
+        while not owner_done.is_set():
+            process.stdin.write(b"BRIGHTNESS %d\n" % rng.randint(0, 100))
+            process.stdin.flush()
+            time.sleep(0.01)
+
+    def serial_reader():
+        for line in process.stdout:
+            if line.startswith(b"Error: Calibrator is controlled"):
+                tally.add("serial refused")
+            elif line.startswith(b"Brightness set to"):
+                tally.add("serial accepted")
+
+    # The intruders flood from one address; without this most of their
+    # commands would be refused with 429 before reaching the lease check
+    with target, rate_limit_paused(target):
+        # The owner's first command takes the lease before the others start
+        last_level = 0
+        if alpaca_put(target, "connected", OWNER_ID, 1, "Connected=true") != 0:
+            failures.append("owner could not connect")
+        threads = [threading.Thread(target=intruder_alpaca), threading.Thread(target=intruder_web)]
+        if process is not None:
+            threads.append(threading.Thread(target=intruder_serial))
+            threading.Thread(target=serial_reader, daemon=True).start()
+
+        for step in range(args.steps):
+            last_level = (step * 7) % 101
+            error = alpaca_put(target, "calibratoron", OWNER_ID, step + 2, "Brightness=%d" % last_level)
+            tally.add("owner ok" if error == 0 else "owner error %s" % error)
+            if step == 0:
+                for thread in threads:
+                    thread.start()
+        owner_done.set()
+        for thread in threads:
+            thread.join()
+
+        # Let queued serial commands drain while the lease is still held
+        time.sleep(0.5)
+        status = get_json(target, "/api/status")
+        if status["brightness"] != last_level:
+            failures.append("brightness %d, owner last set %d" % (status["brightness"], last_level))
+        if status["lease"]["clientID"] != OWNER_ID:
+            failures.append("lease held by %s, expected %d" % (status["lease"]["clientID"], OWNER_ID))
+
+        # Disconnecting releases the lease
+        alpaca_put(target, "connected", OWNER_ID, args.steps + 2, "Connected=false")
+        if web_post(target, "action=brightness&brightness=5") != 200:
+            failures.append("web still refused after the owner disconnected")
+
+    for key in sorted(tally.counts):
+        print("%-20s %d" % (key, tally.counts[key]))
+    if tally.get("owner ok") != args.steps:
+        failures.append("owner succeeded %d of %d times" % (tally.get("owner ok"), args.steps))
+    for key in tally.counts:
+        if " other " in key or key == "serial accepted":
+            failures.append("%d x %s during the lease" % (tally.counts[key], key))
+    finish(failures)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,67 @@
+#!/usr/bin/env python3
+"""
+ESP32 ASCOM Alpaca Flat Panel Calibrator
+Round-trip time probe
+
+Sends sequential GET /api/echo requests over one keep-alive connection and
+prints the RTT distribution. Run it once per WiFi profile (WIFIPROFILE serial
+command or the setup page) to compare them:
+
+    python3 tools/measure_rtt.py 192.168.1.50
+    python3 tools/measure_rtt.py 192.168.1.50 --port 80 --count 500
+"""
+
+import argparse
+import http.client
+import json
+import statistics
+import time
+
+
+def percentile(sorted_values, fraction):
+    index = min(len(sorted_values) - 1, int(round(fraction * (len(sorted_values) - 1))))
+    return sorted_values[index]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Measure HTTP round-trip time to the calibrator")
+    parser.add_argument("host", help="device IP address or host name")
+    parser.add_argument("--port", type=int, default=11111, help="11111 (Alpaca, default) or 80 (web UI)")
+    parser.add_argument("--count", type=int, default=200, help="number of requests")
+    parser.add_argument("--interval", type=float, default=0.05, help="pause between requests, seconds")
+    args = parser.parse_args()
+
+    connection = http.client.HTTPConnection(args.host, args.port, timeout=5)
+    samples = []
+    failures = 0
+
+    for seq in range(args.count):
+        start = time.perf_counter()
+        try:
+            connection.request("GET", "/api/echo?seq=%d" % seq)
+            response = connection.getresponse()
+            body = json.loads(response.read())
+            if body.get("seq") != seq:
+                raise ValueError("sequence mismatch")
+            samples.append((time.perf_counter() - start) * 1000.0)
+        except (OSError, ValueError, http.client.HTTPException):
+            failures += 1
+            connection.close()
+            connection = http.client.HTTPConnection(args.host, args.port, timeout=5)
+        time.sleep(args.interval)
+
+    connection.close()
+    if not samples:
+        print("No successful requests")
+        return
+
+    samples.sort()
+    print("requests %d, failures %d" % (args.count, failures))
+    print("min %.1f  median %.1f  p90 %.1f  p99 %.1f  max %.1f ms" % (
+        samples[0], statistics.median(samples), percentile(samples, 0.90),
+        percentile(samples, 0.99), samples[-1]))
+    print("stdev %.1f ms" % statistics.pstdev(samples))
+
+
+if __name__ == "__main__":
+    main()
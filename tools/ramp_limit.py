@@ -0,0 +1,77 @@
+#!/usr/bin/env python3
+"""
+ESP32 ASCOM Alpaca Flat Panel Calibrator
+Ramp limit test
+
+Starts a brightness ramp through a preset and lowers the max brightness
+halfway. Every state event from /events is recorded, and the run checks that:
+- the brightness never goes down during the ramp
+- the ramp ends Ready at the new max brightness
+
+Against the simulator (see README, Development > Simulator):
+
+    python3 tools/ramp_limit.py --sim build/sim/flatpanel-sim
+
+Against a device:
+
+    python3 tools/ramp_limit.py --host 192.168.1.50 --ramp-ms 4000
+"""
+
+import argparse
+import socket
+import time
+
+from event_stream import EventStream
+from sim_harness import add_target_arguments, finish, open_target, post_form
+
+PRESET = "RAMPTST"
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Check that lowering the max brightness never dims a ramp backwards")
+    add_target_arguments(parser)
+    parser.add_argument("--start", type=int, default=10, help="brightness before the ramp")
+    parser.add_argument("--limit", type=int, default=60, help="max brightness set halfway through the ramp")
+    parser.add_argument("--ramp-ms", type=int, default=2000, help="ramp time from the start to 100%%")
+    args = parser.parse_args()
+
+    failures = []
+    with open_target(args) as target:
+        post_form(target, "/setup", "maxBrightness=100")
+        post_form(target, "/api/presets", "name=%s&brightness=100&rampMs=%d&exposureMs=1000" % (PRESET, args.ramp_ms))
+        post_form(target, "/calibrator", "action=brightness&brightness=%d" % args.start)
+        time.sleep(0.2)
+
+        stream = EventStream(target)
+        stream.next_state()
+        post_form(target, "/calibrator", "action=preset&name=%s" % PRESET)
+        time.sleep(args.ramp_ms / 2000)
+        post_form(target, "/setup", "maxBrightness=%d" % args.limit)
+
+        levels = []
+        deadline = time.time() + args.ramp_ms / 1000 + 2
+        state = None
+        try:
+            while time.time() < deadline:
+                state = stream.next_state()
+                levels.append(state["brightness"])
+                if state["state"] == "Ready" and state["maxBrightness"] == args.limit:
+                    break
+        except (socket.timeout, ConnectionError) as error:
+            failures.append("event stream: %s" % error)
+        stream.close()
+
+        post_form(target, "/setup", "maxBrightness=100")
+        post_form(target, "/api/presets", "name=%s&delete=1" % PRESET)
+
+    print("brightness during the ramp: %s" % " ".join(str(level) for level in levels))
+    drops = [(a, b) for a, b in zip(levels, levels[1:]) if b < a]
+    if drops:
+        failures.append("brightness went down: %s" % ", ".join("%d -> %d" % drop for drop in drops))
+    if state is None or state["state"] != "Ready" or state["brightness"] != args.limit:
+        failures.append("ramp ended at %s" % (state and "%d%% %s" % (state["brightness"], state["state"])))
+    finish(failures)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,145 @@
+#!/usr/bin/env python3
+"""
+ESP32 ASCOM Alpaca Flat Panel Calibrator
+Rate limit load test
+
+A well-behaved Alpaca client polls Brightness a few times a second, first on
+its own and then while a misconfigured client floods the same endpoint from
+several connections. Polls are timed once the flood has spent its burst
+allowance. The two clients use different source addresses, so the device
+keeps a separate token bucket for each. The run prints the polling
+client's latency in each phase and the flood's 200/429 split, and fails if
+the polling client is refused or its 95th percentile latency under the flood
+rises well above its baseline. With --compare the flood is repeated with
+rate limiting off to show what the limiter saves.
+
+Against the simulator (see README, Development > Simulator), using loopback
+aliases as the two clients:
+
+    python3 tools/rate_limit_load.py --sim build/sim/flatpanel-sim --compare
+
+Against a device, the flood needs a second address on this host (an alias or
+a second interface):
+
+    python3 tools/rate_limit_load.py --host 192.168.1.50 \\
+        --client-source 192.168.1.20 --flood-source 192.168.1.21
+"""
+
+import argparse
+import http.client
+import sys
+import threading
+import time
+
+from sim_harness import (DEVICE, add_target_arguments, finish, get_rate_limit, open_target, percentile, post_form,
+                         rate_limit_paused, request)
+
+
+def get(target, path, source):
+    return request(target.host, target.alpaca_port, "GET", path, timeout=target.timeout, source=source)
+
+
+def run_phase(args, target, flood):
+    """Poll for args.seconds, flooding meanwhile if asked; returns latencies, refusals and flood counts"""
+    stop = threading.Event()
+    flood_counts = {}
+    lock = threading.Lock()
+
+    def flooder(index):
+        transaction = 0
+        while not stop.is_set():
+            transaction += 1
+            path = DEVICE + "brightness?ClientID=%d&ClientTransactionID=%d" % (900 + index, transaction)
+            try:
+                status, _ = get(target, path, args.flood_source)
+            except (OSError, http.client.HTTPException):
+                status = "error"
+            with lock:
+                flood_counts[status] = flood_counts.get(status, 0) + 1
+
+    threads = [threading.Thread(target=flooder, args=(i,)) for i in range(args.flooders if flood else 0)]
+    for thread in threads:
+        thread.start()
+    if flood:
+        # Let the flood spend its burst allowance first; the steady state is what matters
+        time.sleep(args.warmup)
+
+    latencies, refused, transaction = [], 0, 0
+    deadline = time.time() + args.seconds
+    while time.time() < deadline:
+        transaction += 1
+        started = time.time()
+        status, _ = get(target, DEVICE + "brightness?ClientID=1&ClientTransactionID=%d" % transaction,
+                        args.client_source)
+        latencies.append((time.time() - started) * 1000)
+        if status != 200:
+            refused += 1
+        time.sleep(max(0.0, 1.0 / args.poll_rate - (time.time() - started)))
+
+    stop.set()
+    for thread in threads:
+        thread.join()
+    return latencies, refused, flood_counts
+
+
+def report(name, latencies, refused, flood_counts):
+    line = "%-16s polls %4d  refused %3d  p50 %6.1f ms  p95 %6.1f ms  max %6.1f ms" % (
+        name, len(latencies), refused, percentile(latencies, 0.5), percentile(latencies, 0.95), max(latencies))
+    if flood_counts:
+        line += "  flood " + ", ".join("%s x %d" % (status, count) for status, count in sorted(
+            flood_counts.items(), key=lambda item: str(item[0])))
+    print(line)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Check that a flooding client cannot starve a polling one")
+    add_target_arguments(parser)
+    parser.add_argument("--client-source", default="127.0.0.2", help="source address of the polling client")
+    parser.add_argument("--flood-source", default="127.0.0.3", help="source address of the flooding client")
+    parser.add_argument("--seconds", type=float, default=10, help="length of each phase")
+    parser.add_argument("--poll-rate", type=float, default=5, help="polls per second of the well-behaved client")
+    parser.add_argument("--flooders", type=int, default=4, help="concurrent connections of the flooding client")
+    parser.add_argument("--warmup", type=float, default=3, help="seconds of flood before the polls are timed")
+    parser.add_argument("--compare", action="store_true", help="repeat the flood with rate limiting off")
+    parser.add_argument("--max-slowdown", type=float, default=3.0,
+                        help="fail if p95 latency under the flood exceeds this multiple of the baseline")
+    args = parser.parse_args()
+
+    with open_target(args) as target:
+        limits = get_rate_limit(target)
+        if limits["perSecond"] == 0:
+            sys.exit("Rate limiting is off on the device; enable it with POST /api/ratelimit")
+        post_form(target, "/api/ratelimit", "reset=1")
+
+        baseline = run_phase(args, target, flood=False)
+        limited = run_phase(args, target, flood=True)
+        clients = {client["ip"]: client for client in get_rate_limit(target)["clients"]}
+
+        unlimited = None
+        if args.compare:
+            with rate_limit_paused(target):
+                unlimited = run_phase(args, target, flood=True)
+
+    print("rate limit %d/s, burst %d, %d flooding connections" % (limits["perSecond"], limits["burst"], args.flooders))
+    report("alone", *baseline)
+    report("flood, limited", *limited)
+    if unlimited is not None:
+        report("flood, unlimited", *unlimited)
+    flood_client = clients.get(args.flood_source)
+    if flood_client is not None:
+        print("device counters for %s: %d allowed, %d refused" % (
+            args.flood_source, flood_client["allowed"], flood_client["limited"]))
+
+    failures = []
+    if baseline[1] or limited[1]:
+        failures.append("polling client refused %d times" % (baseline[1] + limited[1]))
+    if limited[2].get(429, 0) == 0:
+        failures.append("the flood was never refused")
+    base_p95, flood_p95 = percentile(baseline[0], 0.95), percentile(limited[0], 0.95)
+    if flood_p95 > base_p95 * args.max_slowdown and flood_p95 - base_p95 > 10:
+        failures.append("p95 latency %.1f ms under the flood, %.1f ms alone" % (flood_p95, base_p95))
+    finish(failures)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,138 @@
+#!/usr/bin/env python3
+"""
+ESP32 ASCOM Alpaca Flat Panel Calibrator
+Serial parser throughput benchmark
+
+Streams megabytes of serial commands into the simulator through its pseudo
+terminal and counts the replies. The stream mixes text commands, bracketed
+legacy commands and ';' batches, each answered with one line. Like a
+scripted host, the writer keeps at most --window commands unanswered; the
+simulator, like the UART, drops replies nobody reads. The run prints
+commands and bytes per second and the serial interface's retained heap from
+/api/heap. It fails if a reply is missing or an error comes back, or if the
+serial interface holds on to heap after the run.
+
+The simulator runs on its virtual clock, so loop()'s delay() does not sleep
+and the figure is the parser's and dispatcher's rate, not the UART's:
+
+    python3 tools/serial_throughput.py --sim build/sim/flatpanel-sim --megabytes 4
+"""
+
+import argparse
+import os
+import random
+import threading
+import time
+import tty
+
+from sim_harness import finish, get_json, open_target
+
+
+def command_stream(rng, size):
+    """Command lines totalling at least size bytes; every line gets one reply line"""
+    lines = []
+    total = 0
+    while total < size:
+        choice = rng.random()
+        level = rng.randint(0, 100)
+        if choice < 0.5:
+            line = b"BRIGHTNESS %d\n" % level
+        elif choice < 0.8:
+            line = b"<02#%d>\n" % level
+        elif choice < 0.9:
+            line = rng.choice((b"<01>\n", b"<00>\n", b"ON\n", b"OFF\n"))
+        else:
+            line = b"ON;BRIGHTNESS %d;OFF\n" % level
+        lines.append(line)
+        total += len(line)
+    return lines
+
+
+def serial_retained(target):
+    return get_json(target, "/api/heap")["interfaces"]["serial"]["retainedBytes"]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Measure serial command throughput through the simulator's pty")
+    parser.add_argument("--sim", required=True, help="simulator binary to start and test")
+    parser.add_argument("--port-offset", type=int, default=8000, help="simulator port offset (web UI on 80 + offset)")
+    parser.add_argument("--timeout", type=float, default=5, help="per request timeout, seconds")
+    parser.add_argument("--megabytes", type=float, default=2, help="size of the command stream")
+    parser.add_argument("--window", type=int, default=256,
+                        help="commands in flight; the simulator drops replies the terminal cannot take")
+    parser.add_argument("--seed", type=int, default=1, help="random seed for the command mix")
+    args = parser.parse_args()
+
+    lines = command_stream(random.Random(args.seed), int(args.megabytes * 1024 * 1024))
+    stream_bytes = sum(len(line) for line in lines)
+    replies = {"lines": 0, "errors": 0, "first_error": None}
+    progress = threading.Condition()
+    done = threading.Event()
+
+    with open_target(args, serial="pty", clock="virtual") as target:
+        fd = os.open(target.serial_path, os.O_RDWR | os.O_NOCTTY)
+        tty.setraw(fd)
+        heap_before = serial_retained(target)
+
+        def reader():
+            pending = b""
+            while not done.is_set():
+                try:
+                    data = os.read(fd, 65536)
+                except OSError:
+                    return
+                pending += data
+                *complete, pending = pending.split(b"\n")
+                with progress:
+                    for line in complete:
+                        line = line.strip()
+                        if not line:
+                            continue
+                        replies["lines"] += 1
+                        if line.startswith(b"Error"):
+                            replies["errors"] += 1
+                            replies["first_error"] = replies["first_error"] or line.decode(errors="replace")
+                    progress.notify()
+                if replies["lines"] >= len(lines):
+                    done.set()
+
+        thread = threading.Thread(target=reader, daemon=True)
+        thread.start()
+
+        started = time.time()
+        batch = max(1, args.window // 4)
+        for index in range(0, len(lines), batch):
+            with progress:
+                if not progress.wait_for(lambda: index - replies["lines"] <= args.window - batch, timeout=5):
+                    break
+            os.write(fd, b"".join(lines[index:index + batch]))
+        written = time.time() - started
+
+        # Wait for the replies to stop arriving
+        last, stalled = -1, 0
+        while not done.wait(0.5) and stalled < 4:
+            stalled = stalled + 1 if replies["lines"] == last else 0
+            last = replies["lines"]
+        elapsed = time.time() - started
+        done.set()
+        heap_after = serial_retained(target)
+        os.close(fd)
+
+    count = len(lines)
+    print("%d commands, %.2f MB written in %.2f s" % (count, stream_bytes / 1048576.0, written))
+    print("%d replies in %.2f s: %.0f commands/s, %.2f MB/s" % (
+        replies["lines"], elapsed, replies["lines"] / elapsed, stream_bytes / 1048576.0 / elapsed))
+    print("serial retained heap %d -> %d bytes" % (heap_before, heap_after))
+
+    failures = []
+    if replies["lines"] != count:
+        failures.append("%d replies to %d commands" % (replies["lines"], count))
+    if replies["errors"]:
+        failures.append("%d errors, first: %s" % (replies["errors"], replies["first_error"]))
+    if heap_after > heap_before:
+        failures.append("serial interface retained %d more bytes" % (heap_after - heap_before))
+    finish(failures)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,175 @@
+"""
+ESP32 ASCOM Alpaca Flat Panel Calibrator
+Shared harness for the host test tools
+
+Each tool in this directory runs either against a device (--host) or against
+the simulator, which it starts itself (--sim). This module holds what they
+share: the target arguments, starting and stopping the simulator, the HTTP
+and Alpaca request helpers, and pausing the per-client rate limit for tools
+that deliberately flood the device from one address.
+
+Only ports below 1024 move with --port-offset in the simulator; Alpaca
+(11111) and discovery (32227) keep their numbers, so only one simulator runs
+at a time.
+"""
+
+import contextlib
+import http.client
+import json
+import socket
+import subprocess
+import sys
+import threading
+import time
+
+ALPACA_PORT = 11111
+WEB_PORT = 80
+DISCOVERY_PORT = 32227
+DEVICE = "/api/v1/covercalibrator/0/"
+FORM = {"Content-Type": "application/x-www-form-urlencoded"}
+
+
+class Target:
+    """Where requests go, and the simulator process behind them if one was started"""
+
+    def __init__(self, host, web_port, timeout, process=None, serial_path=None):
+        self.host = host
+        self.web_port = web_port
+        self.alpaca_port = ALPACA_PORT
+        self.timeout = timeout
+        self.process = process
+        self.serial_path = serial_path
+
+    def close(self):
+        if self.process is not None:
+            self.process.terminate()
+            self.process.wait()
+            self.process = None
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+
+def add_target_arguments(parser):
+    """--host or --sim, plus the options every tool shares"""
+    target_group = parser.add_mutually_exclusive_group(required=True)
+    target_group.add_argument("--host", help="device IP address or host name")
+    target_group.add_argument("--sim", help="simulator binary to start and test")
+    parser.add_argument("--port-offset", type=int, default=8000, help="simulator port offset (web UI on 80 + offset)")
+    parser.add_argument("--timeout", type=float, default=5, help="per request timeout, seconds")
+
+
+def start_simulator(path, port_offset, serial="none", clock="real", options=()):
+    """Starts the simulator and waits for its web UI to listen.
+
+    With serial "stdio" the console is on the process's stdin and stdout.
+    With "pty" the returned path is the pseudo terminal the simulator opened.
+    Further simulator options, such as --nvs FILE, go in options.
+    """
+    command = [path, "--serial", serial, "--clock", clock, "--port-offset", str(port_offset)] + list(options)
+    pipes = {"stdin": subprocess.DEVNULL, "stdout": subprocess.DEVNULL, "stderr": subprocess.DEVNULL}
+    if serial == "stdio":
+        pipes.update(stdin=subprocess.PIPE, stdout=subprocess.PIPE)
+    elif serial == "pty":
+        pipes.update(stderr=subprocess.PIPE)
+    process = subprocess.Popen(command, **pipes)
+
+    serial_path = None
+    if serial == "pty":
+        # "sim: Serial on /dev/pts/N" comes before the servers start
+        for line in process.stderr:
+            line = line.decode(errors="replace").strip()
+            if line.startswith("sim: Serial on "):
+                serial_path = line[len("sim: Serial on "):]
+                break
+        if serial_path is None:
+            process.kill()
+            sys.exit("Simulator did not open a serial pty")
+        # Keep reading, or a full pipe would block the simulator
+        threading.Thread(target=process.stderr.read, daemon=True).start()
+
+    deadline = time.time() + 10
+    while time.time() < deadline:
+        try:
+            socket.create_connection(("127.0.0.1", WEB_PORT + port_offset), timeout=0.5).close()
+            return process, serial_path
+        except OSError:
+            time.sleep(0.2)
+    process.kill()
+    sys.exit("Simulator did not start listening")
+
+
+def open_target(args, serial="none", clock="real"):
+    """The device named by --host, or a simulator started from --sim"""
+    if args.sim:
+        process, serial_path = start_simulator(args.sim, args.port_offset, serial, clock)
+        return Target("127.0.0.1", WEB_PORT + args.port_offset, args.timeout, process, serial_path)
+    return Target(args.host, WEB_PORT, args.timeout)
+
+
+def request(host, port, method, path, body=None, timeout=5, source=None):
+    """One request on a fresh connection; returns the status and body"""
+    connection = http.client.HTTPConnection(host, port, timeout=timeout,
+                                            source_address=(source, 0) if source else None)
+    try:
+        connection.request(method, path, body=body, headers=FORM if body is not None else {})
+        response = connection.getresponse()
+        return response.status, response.read()
+    finally:
+        connection.close()
+
+
+def get_json(target, path):
+    _, body = request(target.host, target.web_port, "GET", path, timeout=target.timeout)
+    return json.loads(body)
+
+
+def post_form(target, path, body):
+    return request(target.host, target.web_port, "POST", path, body, timeout=target.timeout)
+
+
+def alpaca(target, verb, method, client_id, transaction, body=None):
+    """An Alpaca request on the calibrator; returns the decoded reply"""
+    query = "ClientID=%d&ClientTransactionID=%d" % (client_id, transaction)
+    if verb == "GET":
+        _, reply = request(target.host, target.alpaca_port, "GET", DEVICE + method + "?" + query,
+                           timeout=target.timeout)
+    else:
+        _, reply = request(target.host, target.alpaca_port, "PUT", DEVICE + method,
+                           query + ("&" + body if body else ""), timeout=target.timeout)
+    return json.loads(reply)
+
+
+def get_rate_limit(target):
+    return get_json(target, "/api/ratelimit")
+
+
+def set_rate_limit(target, limits):
+    post_form(target, "/api/ratelimit", "perSecond=%d&burst=%d" % (limits["perSecond"], limits["burst"]))
+
+
+@contextlib.contextmanager
+def rate_limit_paused(target):
+    """Turns per-client rate limiting off for the block; yields the limits it restores"""
+    limits = get_rate_limit(target)
+    set_rate_limit(target, dict(limits, perSecond=0))
+    try:
+        yield limits
+    finally:
+        set_rate_limit(target, limits)
+
+
+def percentile(samples, fraction):
+    ordered = sorted(samples)
+    return ordered[min(len(ordered) - 1, int(fraction * len(ordered)))]
+
+
+def finish(failures):
+    """Prints the verdict and exits non-zero on failure"""
+    if failures:
+        print("FAIL: %s" % "; ".join(failures))
+        sys.exit(1)
+    print("PASS")
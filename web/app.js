@@ -0,0 +1,166 @@
+/*
+ * ESP32 ASCOM Alpaca Flat Panel Calibrator
+ * Shared web UI script - embedded by tools/embed_web_assets.py
+ *
+ * Pages opt into behaviour through element IDs. The Alpaca setup page sets
+ * data-api='alpaca' on <body> so controls go through the Alpaca endpoints.
+ */
+
+const stateClasses = { Ready: 'status-ready', Off: 'status-off', Error: 'status-error' };
+const formHeaders = { 'Content-Type': 'application/x-www-form-urlencoded' };
+
+function alpacaPage() {
+  return document.body.dataset.api === 'alpaca';
+}
+
+function setText(id, text) {
+  const element = document.getElementById(id);
+  if (element) element.innerText = text;
+}
+
+function post(url, body, method) {
+  return fetch(url, { method: method || 'POST', headers: formHeaders, body: body });
+}
+
+// 409: an Alpaca client holds the calibrator. Offer to take control and retry
+function postCalibrator(body) {
+  post('/calibrator', body).then(response => {
+    if (response.status !== 409) return;
+    response.text().then(message => {
+      if (confirm(message + '. Take control?')) {
+        post('/calibrator', 'action=release').then(() => post('/calibrator', body));
+      }
+    });
+  });
+}
+
+// ClientID 0 never takes the Alpaca lease, so this page does not lock out the web UI and
+// serial. A refused command still answers HTTP 200; the error is in ErrorNumber.
+function putAlpaca(method, parameters) {
+  post('/api/v1/covercalibrator/0/' + method, 'ClientID=0&ClientTransactionID=1' + parameters, 'PUT')
+    .then(response => response.json())
+    .then(reply => {
+      if (reply.ErrorNumber !== 0) alert(reply.ErrorMessage);
+    });
+}
+
+function calibratorOn() {
+  if (alpacaPage()) {
+    putAlpaca('calibratoron', '');
+  } else {
+    postCalibrator('action=on');
+  }
+}
+
+function calibratorOff() {
+  if (alpacaPage()) {
+    putAlpaca('calibratoroff', '');
+  } else {
+    postCalibrator('action=off');
+  }
+}
+
+function setBrightness(value) {
+  const slider = document.getElementById('brightness');
+  if (slider) slider.value = value;
+  setText('brightnessValue', value + '%');
+  if (alpacaPage()) {
+    putAlpaca('calibratoron', '&Brightness=' + value);
+  } else {
+    postCalibrator('action=brightness&brightness=' + value);
+  }
+}
+
+function applyPreset(name) {
+  postCalibrator('action=preset&name=' + encodeURIComponent(name));
+}
+
+function presetField(id) {
+  return encodeURIComponent(document.getElementById(id).value);
+}
+
+function savePreset() {
+  post('/api/presets', 'name=' + presetField('presetName') + '&brightness=' + presetField('presetBrightness') +
+       '&rampMs=' + presetField('presetRamp') + '&exposureMs=' + presetField('presetExposure'))
+    .then(response => response.ok ? location.reload() : response.text().then(alert));
+}
+
+function deletePreset() {
+  post('/api/presets', 'delete=1&name=' + presetField('presetName'))
+    .then(response => response.ok ? location.reload() : response.text().then(alert));
+}
+
+function selectNetwork(name) {
+  document.getElementById('ssid').value = name;
+  document.getElementById('password').focus();
+}
+
+// WiFi page: replace the cached list once the background scan finishes
+function showNetworks(networks) {
+  const list = document.getElementById('networkList');
+  list.innerHTML = '';
+  if (networks.length === 0) {
+    list.innerHTML = '<p>No WiFi networks found</p>';
+    return;
+  }
+  const container = document.createElement('div');
+  container.className = 'network-list';
+  networks.forEach(network => {
+    const item = document.createElement('div');
+    item.className = 'network-item';
+    item.onclick = () => selectNetwork(network.ssid);
+    const name = document.createElement('strong');
+    name.innerText = network.ssid;
+    item.appendChild(name);
+    item.appendChild(document.createElement('br'));
+    item.appendChild(document.createTextNode('Signal: ' + network.rssi + ' dBm, Security: ' +
+                                             (network.secured ? 'Secured' : 'Open')));
+    container.appendChild(item);
+  });
+  list.appendChild(container);
+}
+
+function refreshNetworks() {
+  fetch('/api/scan')
+    .then(response => response.json())
+    .then(data => {
+      if (data.age >= 0) showNetworks(data.networks);
+      if (data.scanning) setTimeout(refreshNetworks, 2000);
+    });
+}
+
+function restartDevice() {
+  if (confirm('Are you sure you want to restart the device?')) {
+    fetch('/restart', { method: 'POST' })
+      .then(response => { alert('Device is restarting...'); });
+  }
+}
+
+// Live updates pushed by the device, on pages that show the calibrator
+function showState(data) {
+  const slider = document.getElementById('brightness');
+  if (slider) {
+    slider.max = data.maxBrightness;
+    slider.value = data.brightness;
+  }
+  setText('brightnessValue', data.brightness + '%');
+  setText('brightnessCell', data.brightness + '%');
+  setText('maxBrightnessCell', data.maxBrightness + '%');
+  setText('connectedCell', data.connected ? 'Yes' : 'No');
+  setText('currentDisplay', 'Current: ' + data.brightness + '%');
+  setText('stateDisplay', 'State: ' + data.state);
+  const stateCell = document.getElementById('stateCell');
+  if (stateCell) {
+    stateCell.innerText = data.state;
+    stateCell.className = stateClasses[data.state] || '';
+  }
+}
+
+if (document.getElementById('brightness')) {
+  const events = new EventSource('/events');
+  events.addEventListener('state', e => showState(JSON.parse(e.data)));
+}
+
+if (document.getElementById('networkList')) {
+  setTimeout(refreshNetworks, 2000);
+}